@@ -31,16 +31,49 @@
 
 /********************* SCHEDULING *******************/
 #define SENSOR_READ_INTERVAL 2000UL      // Read sensors every 2s (DHT11 needs 2s min)
-#define SENSOR_UPLOAD_INTERVAL 2000UL   // Upload to Firebase every 2s
+#define SENSOR_UPLOAD_INTERVAL 2000UL   // One upload record every 2s (sent per TELEMETRY POLICY)
 #define STATUS_UPDATE_INTERVAL 2000UL    // Update web status every 2s
 
+/********************* TELEMETRY POLICY *************/
+// Records are uploaded on change, alert events, activity or heartbeat only
+#define TELEMETRY_DEADBAND_TEMP 0.5        // °C change since the last upload
+#define TELEMETRY_DEADBAND_HUMIDITY 2.0    // %
+#define TELEMETRY_DEADBAND_ORIENTATION 0.5 // Orientation class index, so any class change counts
+#define TELEMETRY_DEADBAND_TILT 5.0        // Degrees
+#define TELEMETRY_DEADBAND_VIBRATION 1.0   // m/s² (|a| deviation from 1 g)
+#define TELEMETRY_HEARTBEAT_MS 60000UL     // Longest silence (also how stale lastSeen gets)
+#define TELEMETRY_ACTIVE_INTERVAL_MS SENSOR_UPLOAD_INTERVAL  // Rate while moving / in an excursion
+#define TELEMETRY_ACTIVE_HOLD_MS 10000UL   // Active rate continues this long after motion stops
+#define TELEMETRY_MOTION_MS2 1.0           // |a| deviation from 1 g that counts as motion
+
+/********************* TASKS ************************/
+// Sampling and network I/O run on separate cores, linked by a record queue
+#define SENSOR_TASK_CORE 1           // APP_CPU, away from the WiFi stack
+#define SENSOR_TASK_PRIORITY 5       // Above loop() and the network task
+#define SENSOR_TASK_STACK 6144
+#define NETWORK_TASK_CORE 0          // PRO_CPU, next to the WiFi stack
+#define NETWORK_TASK_PRIORITY 2
+#define NETWORK_TASK_STACK 16384     // TLS + JSON documents
+#define SENSOR_RECORD_QUEUE 16       // Upload records buffered (power of two, 32s at 2s)
+
+/********************* LOW POWER ********************/
+// Light sleep between scheduled reads/uploads, woken early by MPU6050 motion.
+// The web dashboard and direct AP are unresponsive while asleep, so sleep
+// is skipped whenever a client is connected to the direct AP.
+#define LOW_POWER_MODE 0                  // 1 = enable light sleep
+#define MPU6050_INT_PIN 19                // MPU6050 INT → GPIO (motion wake)
+#define MOTION_THRESHOLD_MG 40            // Motion interrupt threshold (mg)
+#define MOTION_DURATION_MS 5              // Time above threshold before wake (ms)
+#define MOTION_IDLE_TIMEOUT 30000UL       // No motion this long → stop IMU FIFO
+#define LOW_POWER_MIN_SLEEP_MS 5          // Don't sleep for less than this
+#define LOW_POWER_ACTIVE_MAX_SLEEP_MS 50  // Sleep cap while FIFO sampling (fills in ~170ms)
+
 /********************* DEBUG ***********************/
 #define ENABLE_DEBUG_LOGS 1
 #define DEBUG_SERIAL_BAUD 115200
 
 /********************* DHT11 ***********************/
 #define DHT11_PIN 4
-#define DHTTYPE DHT11
 #define DHT_MIN_INTERVAL 2000 // Minimum 2s between reads
 
 /********************* MPU6050 (I2C) ****************/
@@ -48,6 +81,34 @@
 #define I2C_SCL_PIN 22
 #define I2C_FREQUENCY 400000
 #define MPU6050_ADDR 0x68 // Default I2C address
+#define MPU6050_STARTUP_MS 100  // Register access after power-on (datasheet start-up time)
+
+/********************* MPU6050 FIFO *****************/
+// High-rate sampling: hardware FIFO drained in bursts into a RAM ring buffer
+#define MPU6050_FIFO_ENABLED 1       // 0 = one burst register read per SENSOR_READ_INTERVAL
+#define MPU6050_SAMPLE_RATE_HZ 500   // FIFO sample rate (200-1000 Hz)
+#define MPU6050_FIFO_DLPF 1          // DLPF_CFG in FIFO mode (1 = 184 Hz bandwidth)
+#define IMU_RING_CAPACITY 2048       // Raw samples buffered (12 B each, power of 2)
+
+/********************* ORIENTATION ******************/
+// Gyro + accelerometer fusion (Madgwick) at the IMU sample rate
+#define ORIENTATION_FUSION_BETA 0.2        // Accelerometer correction gain
+#define ORIENTATION_UPRIGHT_MAX_TILT 35.0  // Tilt ≤ this is Upright (degrees)
+#define ORIENTATION_INVERTED_MIN_TILT 145.0 // Tilt ≥ this is Upside Down (degrees)
+
+/********************* DROP DETECTION ***************/
+// Free fall followed by an impact, evaluated on every IMU sample
+#define DROP_FREE_FALL_G 0.35        // |a| below this is free fall (g)
+#define DROP_MIN_FREE_FALL_MS 80     // Ignore shorter dips (~3 cm fall)
+#define DROP_IMPACT_G 2.5            // |a| above this is an impact (g)
+#define DROP_IMPACT_END_G 1.5        // Impact over once |a| settles below (g)
+#define DROP_IMPACT_WINDOW_MS 100    // Impact must follow free fall within this
+
+/********************* VIBRATION SPECTRUM ***********/
+// FFT of |a| over FIFO sample windows (needs MPU6050_FIFO_ENABLED)
+#define VIBRATION_FFT_SIZE 256       // Points per window (256 or 512)
+// Band edges (Hz): handling sway | road / truck body | conveyors, motors | impacts
+#define VIBRATION_BAND_EDGES_HZ { 1.0f, 8.0f, 30.0f, 80.0f, 250.0f }
 
 /********************* THRESHOLDS ******************/
 // Default alert thresholds (can be overridden via Firebase)
@@ -57,6 +118,23 @@
 #define HUMIDITY_MAX_THRESHOLD 80.0 // %
 #define VIBRATION_THRESHOLD 15.0    // m/s²
 
+/********************* ALERTS ***********************/
+// One "opened" and one "resolved" write per excursion, not one per reading
+#define ALERT_ENV_DEBOUNCE_MS 10000UL        // Temp / humidity out of range this long to open
+#define ALERT_ENV_CLEAR_MS 30000UL           // Back in range this long to resolve
+#define ALERT_TEMP_HYSTERESIS 1.0            // °C inside the limit counts as back in range
+#define ALERT_HUMIDITY_HYSTERESIS 3.0        // %
+#define ALERT_VIBRATION_DEBOUNCE_MS 0UL      // Rough handling opens at once
+#define ALERT_VIBRATION_CLEAR_MS 10000UL
+#define ALERT_VIBRATION_HYSTERESIS 2.0       // m/s²
+#define ALERT_ORIENTATION_DEBOUNCE_MS 4000UL // Upside down this long to open
+#define ALERT_ORIENTATION_CLEAR_MS 4000UL
+#define ALERT_ORIENTATION_HYSTERESIS 15.0    // Degrees of tilt
+#define ALERT_COOLDOWN_MS 60000UL            // After a resolve, same type stays quiet this long
+#define ALERT_DROP_COOLDOWN_MS 10000UL       // Drops closer together are one alert
+#define ALERT_RATE_BURST 10                  // Alerts that may open back to back
+#define ALERT_RATE_REFILL_MS 60000UL         // ...then one more per minute
+
 /********************* STATUS LED *******************/
 #define STATUS_LED_PIN 2
 #define LED_ON HIGH   // Built-in LED is active HIGH on ESP32
@@ -67,14 +145,82 @@
 #define FIREBASE_DATABASE_URL "put_your_database_url_here"  // e.g., "your-project-id.firebaseio.com"
 #define FIREBASE_BASE_PATH "put_your_base_path_here"  // e.g., "parcels"
 #define FIREBASE_AUTH_TOKEN "put_your_database_auth_token_here" 
+#define FIREBASE_REQUEST_HEAD_BYTES 512  // Request line + headers (auth token included), static
+#define FIREBASE_SEND_SEGMENT_BYTES 1400 // Requests reach TLS in records of this size (about one TCP segment)
 
 // Memory optimization - reduced buffer sizes for ESP32-WROOM
 #define JSON_BUFFER_SIZE 768        // Reduced from 1024
 #define JSON_SMALL_BUFFER_SIZE 384  // For smaller payloads
 
+/********************* UPLOAD BATCHING **************/
+// All writes go out as one multi-path PATCH on the device root
+#define UPLOAD_BATCH_BYTES 12288        // Queue storage (static)
+#define UPLOAD_BATCH_FLUSH_BYTES 8192   // Flush once this much is queued
+#define UPLOAD_BATCH_HISTORY 10         // Flush once this many history/alert entries are queued
+#define UPLOAD_BATCH_MAX_AGE_MS 20000   // Oldest queued write waits at most this long
+#define UPLOAD_BATCH_RETRY_MS 5000      // Back-off after a failed flush
+
+/********************* HISTORY BLOCKS ***************/
+// History goes up as compressed columnar blocks (historyBlocks/), one per batch
+#define HISTORY_BLOCK_SAMPLES 15        // Samples per block (30 s at the active rate)
+#define HISTORY_BLOCK_MAX_BYTES 1400    // Encoded size limit, one offline log record once base64'd
+#define HISTORY_BLOCK_MAX_AGE_MS 20000  // Online, a partial block goes out once its oldest sample is this old
+
+/********************* OFFLINE LOG ******************/
+// Samples and alerts are kept in flash while offline and replayed later
+#define RECORD_LOG_PARTITION "spiffs"   // Raw data partition (partitions.csv)
+#define RECORD_LOG_REPLAY_BATCH 10      // Records per replay PATCH
+#define WIFI_RECONNECT_INTERVAL 5000UL  // Reconnect attempts while offline
+
+/********************* CONFIG SUBSCRIPTION **********/
+// Thresholds / assignment (info/) are streamed, polled only while the stream is down
+#define CONFIG_EVENT_MAX 1536           // Largest stream event kept (config/ snapshot)
+#define CONFIG_STREAM_TIMEOUT_MS 75000UL  // No keep-alive for this long = dead stream
+#define CONFIG_STREAM_RETRY_MS 30000UL  // Stream reconnect attempts while polling
+#define CONFIG_STREAM_CONNECT_MS 2000   // TLS connect bound for a stream attempt
+#define CONFIG_STREAM_HEAD_MS 5000UL    // Response head read over later service() calls
+#define CONFIG_POLL_INTERVAL 10000UL    // ETag-conditional GET of config/ while polling
+
+/********************* TRANSPORT ********************/
+// Backend for uploads and dashboard config
+#define TRANSPORT_FIREBASE 0            // Firebase REST over HTTPS
+#define TRANSPORT_MQTT 1                // MQTT 3.1.1 broker (bridged to the database)
+#define TELEMETRY_TRANSPORT TRANSPORT_FIREBASE
+
+/********************* MQTT *************************/
+// Used when TELEMETRY_TRANSPORT is TRANSPORT_MQTT
+#define MQTT_HOST "put_your_broker_host_here"
+#define MQTT_PORT 8883
+#define MQTT_TLS 1                      // 0 for a plain TCP broker (e.g. local testing on 1883)
+#define MQTT_USERNAME ""                // "" for none
+#define MQTT_PASSWORD ""
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_CONNECT_TIMEOUT_MS 5000
+#define MQTT_ACK_TIMEOUT_MS 5000        // CONNACK / SUBACK / PUBACK / PINGRESP wait
+#define MQTT_RECONNECT_MS 5000UL        // Between connect attempts
+#define MQTT_MAX_PACKET 1024            // Largest config message kept
+
+/********************* TIME SYNC ********************/
+// Samples carry the 64-bit monotonic µs clock, converted to wall-clock time on upload
+#define NTP_SERVER_1 "pool.ntp.org"
+#define NTP_SERVER_2 "time.google.com"
+#define NTP_SERVER_3 "time.cloudflare.com"
+#define TIME_GMT_OFFSET_S 19800         // Local time for logs only, uploads are UTC epoch ms
+#define TIME_VALID_AFTER 1577836800     // Jan 1 2020, anything earlier is an unset clock
+#define TIME_SYNC_WAIT_MS 15000UL       // Boot waits this long for the first sync
+#define TIME_SYNC_INTERVAL_MS 900000UL  // SNTP re-sync period, drift is measured between syncs
+#define TIME_SYNC_STEP_US 500000LL      // A sync this far off the prediction re-anchors
+#define TIME_SYNC_MIN_SPAN_US 60000000ULL  // Syncs closer than this do not update drift
+#define TIME_SYNC_MAX_DRIFT_PPM 200.0f
+#define TIME_SYNC_DRIFT_GAIN 0.25f      // Weight of each new drift measurement
+
 /********************* MEMORY MANAGEMENT ************/
 #define MIN_FREE_HEAP 50000  // Minimum free heap before warnings (50KB)
 #define HEAP_CHECK_INTERVAL 60000 // Check heap every minute
 
+// Sample cycle and web responses are built in fixed buffers, not on the heap
+#define JSON_ARENA_BYTES 8192           // ArduinoJson documents of one sample cycle (static)
+#define WEB_JSON_BYTES 1280             // /api/* responses (AsyncTCP task stack)
+
 
 #endif
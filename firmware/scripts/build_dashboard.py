@@ -0,0 +1,80 @@
+# ========================================
+# TRACEON - Dashboard asset build (PlatformIO pre-script)
+# ========================================
+# Turns web/dashboard.html into include/generated/dashboard.h:
+# - comments dropped, {{WEB_TITLE}} / {{WEB_REFRESH_MS}} filled in from include/config.h
+# - gzip -9, reproducible (no timestamp / file name in the header)
+# - strong ETag = hash of the compressed bytes
+#
+# The header is only rewritten when its content changes, so an unchanged
+# dashboard does not trigger a rebuild. Also runs standalone:
+#   python scripts/build_dashboard.py
+
+import gzip
+import hashlib
+import os
+import re
+
+SOURCE = os.path.join("web", "dashboard.html")
+CONFIG = os.path.join("include", "config.h")
+OUTPUT = os.path.join("include", "generated", "dashboard.h")
+
+
+def config_define(config, name):
+    match = re.search(r"^\s*#define\s+%s\s+(\"(?:[^\"\\]|\\.)*\"|\d+)" % name, config, re.MULTILINE)
+    if not match:
+        raise SystemExit("[DASHBOARD] %s not found in %s" % (name, CONFIG))
+    value = match.group(1)
+    return value[1:-1] if value.startswith('"') else value
+
+
+def build(project_dir):
+    with open(os.path.join(project_dir, SOURCE), encoding="utf-8") as f:
+        html = f.read()
+    with open(os.path.join(project_dir, CONFIG), encoding="utf-8") as f:
+        config = f.read()
+
+    html = re.sub(r"<!--.*?-->\s*", "", html, flags=re.DOTALL)
+    for name in ("WEB_TITLE", "WEB_REFRESH_MS"):
+        html = html.replace("{{%s}}" % name, config_define(config, name))
+
+    compressed = gzip.compress(html.encode("utf-8"), compresslevel=9, mtime=0)
+    etag = hashlib.sha256(compressed).hexdigest()[:16]
+
+    lines = [
+        "// Generated by scripts/build_dashboard.py from web/dashboard.html, do not edit",
+        "#ifndef DASHBOARD_H",
+        "#define DASHBOARD_H",
+        "",
+        "#include <pgmspace.h>",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "#define DASHBOARD_ETAG \"\\\"%s\\\"\"" % etag,
+        "",
+        "// %d bytes of HTML, gzip-compressed" % len(html.encode("utf-8")),
+        "static const size_t DASHBOARD_GZ_LENGTH = %d;" % len(compressed),
+        "static const uint8_t DASHBOARD_GZ[] PROGMEM = {",
+    ]
+    for i in range(0, len(compressed), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in compressed[i:i + 16]) + ",")
+    lines += ["};", "", "#endif // DASHBOARD_H", ""]
+    header = "\n".join(lines)
+
+    output = os.path.join(project_dir, OUTPUT)
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    os.makedirs(os.path.dirname(output), exist_ok=True)
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(header)
+    print("[DASHBOARD] %d bytes -> %d gzipped, ETag %s" % (len(html.encode("utf-8")), len(compressed), etag))
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO SCons environment)
+    project_dir = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+build(project_dir)
\ No newline at end of file
@@ -0,0 +1,289 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include <stdint.h>
+
+enum AlertState : uint8_t {
+    ALERT_NORMAL = 0,
+    ALERT_PENDING,      // Out of band, waiting out the debounce
+    ALERT_ACTIVE,       // Opened, tracking the peak
+    ALERT_RESOLVED      // Back in band, cooling down
+};
+
+enum AlertSide : uint8_t {
+    ALERT_HIGH = 0,     // Above the upper limit
+    ALERT_LOW           // Below the lower limit
+};
+
+enum AlertEventKind : uint8_t {
+    ALERT_EVENT_OPENED = 0,
+    ALERT_EVENT_RESOLVED
+};
+
+/**
+ * @brief One state change worth writing
+ */
+struct AlertEvent {
+    AlertEventKind kind;
+    AlertSide side;
+    float value;            // Reading at the transition
+    float openValue;        // Reading that opened the alert
+    float peak;             // Furthest reading out of band so far
+    float threshold;        // Limit that was crossed
+    uint32_t startMs;       // Reading first left the band (platform ms)
+    uint32_t durationMs;    // Time out of band (resolved only)
+};
+
+/**
+ * @brief Timing / hysteresis for one alert type
+ */
+struct AlertRule {
+    uint32_t debounceMs;    // Out of band this long before the alert opens
+    uint32_t clearMs;       // Back in band this long before it resolves
+    float hysteresis;       // "Back in band" means this far inside the limit
+    uint32_t cooldownMs;    // Quiet time after a resolve before the next opens
+};
+
+/**
+ * @brief Token bucket shared by all alert types
+ *
+ * Caps how many alerts can open in a burst and over time, whatever the
+ * individual rules allow. Only openings take a token; the resolution
+ * of an alert that was written is never held back.
+ */
+class AlertRateLimiter {
+public:
+    AlertRateLimiter(uint8_t burst, uint32_t refillMs)
+        : burst(burst), tokens(burst), refillMs(refillMs), lastRefill(0), started(false), denied(0) {}
+
+    bool take(uint32_t nowMs) {
+        if (!started) {
+            lastRefill = nowMs;
+            started = true;
+        }
+
+        if (refillMs > 0 && tokens < burst) {
+            uint32_t refills = (nowMs - lastRefill) / refillMs;
+            tokens = (tokens + refills >= burst) ? burst : tokens + refills;
+            lastRefill += refills * refillMs;
+        }
+        if (tokens == burst) {
+            lastRefill = nowMs;  // A full bucket does not bank time
+        }
+
+        if (tokens == 0) {
+            denied++;
+            return false;
+        }
+        tokens--;
+        return true;
+    }
+
+    uint32_t getDenied() const { return denied; }
+
+private:
+    uint8_t burst;
+    uint8_t tokens;
+    uint32_t refillMs;
+    uint32_t lastRefill;
+    bool started;
+    uint32_t denied;
+};
+
+/**
+ * @brief Per-alert-type state machine: normal → pending → active → resolved
+ *
+ * Turns a stream of readings into exactly one OPENED and one RESOLVED
+ * event per excursion, instead of one alert per reading:
+ * - pending: the reading must stay out of band for debounceMs
+ *   (a single noisy sample never opens an alert)
+ * - active: tracks the peak; must be back inside the limit by the
+ *   hysteresis margin for clearMs before it resolves, so a reading
+ *   hovering on the limit does not flap
+ * - resolved: no new alert opens for cooldownMs
+ *
+ * An excursion whose opening was refused by the rate limiter runs its
+ * course silently (no RESOLVED either, nothing was written).
+ *
+ * Limits are passed with every reading, so they can change at runtime.
+ * Use -HUGE_VALF / HUGE_VALF for a side without a limit. NaN readings
+ * (sensor not ready) are ignored.
+ */
+class AlertMonitor {
+public:
+    struct Stats {
+        uint32_t opened;
+        uint32_t resolved;
+        uint32_t suppressed;    // Excursions / pulses not written (rate limit, cooldown)
+    };
+
+    explicit AlertMonitor(const AlertRule& rule)
+        : rule(rule), state(ALERT_NORMAL), side(ALERT_HIGH), silent(false), clearing(false),
+          startMs(0), clearStartMs(0), resolvedMs(0), openValue(0), peak(0), threshold(0) {
+        stats.opened = 0;
+        stats.resolved = 0;
+        stats.suppressed = 0;
+    }
+
+    /**
+     * @brief Feed one reading
+     *
+     * @param value Reading
+     * @param low Lower limit (-HUGE_VALF for none)
+     * @param high Upper limit (HUGE_VALF for none)
+     * @param nowMs Time of the reading (platform ms)
+     * @param limiter Shared rate limit for openings
+     * @param event Filled when true is returned
+     * @return true if the alert opened or resolved with this reading
+     */
+    bool update(float value, float low, float high, uint32_t nowMs,
+                AlertRateLimiter& limiter, AlertEvent& event) {
+        if (value != value) {
+            return false;
+        }
+
+        switch (state) {
+            case ALERT_RESOLVED:
+                if (nowMs - resolvedMs < rule.cooldownMs) {
+                    return false;
+                }
+                state = ALERT_NORMAL;
+                // fall through
+
+            case ALERT_NORMAL:
+                if (value <= high && value >= low) {
+                    return false;
+                }
+                state = ALERT_PENDING;
+                side = (value > high) ? ALERT_HIGH : ALERT_LOW;
+                startMs = nowMs;
+                peak = value;
+                // fall through
+
+            case ALERT_PENDING:
+                threshold = (side == ALERT_HIGH) ? high : low;
+                if (!isOutside(value)) {
+                    state = ALERT_NORMAL;  // Shorter than the debounce
+                    return false;
+                }
+                trackPeak(value);
+                if (nowMs - startMs < rule.debounceMs) {
+                    return false;
+                }
+                return open(value, nowMs, limiter, event);
+
+            case ALERT_ACTIVE:
+                threshold = (side == ALERT_HIGH) ? high : low;
+                trackPeak(value);
+                if (!isCleared(value)) {
+                    clearing = false;
+                    return false;
+                }
+                if (!clearing) {
+                    clearing = true;
+                    clearStartMs = nowMs;
+                }
+                if (nowMs - clearStartMs < rule.clearMs) {
+                    return false;
+                }
+                return resolve(value, nowMs, event);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Report a momentary event (e.g. a drop) that has no duration
+     *
+     * Opens and immediately resolves internally, so the cooldown and
+     * rate limit still apply. The caller writes it as a single alert.
+     *
+     * @return true if the event should be written
+     */
+    bool pulse(float value, float limit, uint32_t nowMs, AlertRateLimiter& limiter, AlertEvent& event) {
+        if ((state == ALERT_RESOLVED && nowMs - resolvedMs < rule.cooldownMs) || !limiter.take(nowMs)) {
+            stats.suppressed++;
+            return false;
+        }
+
+        state = ALERT_RESOLVED;
+        resolvedMs = nowMs;
+        stats.opened++;
+        openValue = value;
+        fill(event, ALERT_EVENT_OPENED, ALERT_HIGH, value, value, limit, nowMs, 0);
+        return true;
+    }
+
+    AlertState getState() const { return state; }
+    bool isActive() const { return state == ALERT_ACTIVE; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    AlertRule rule;
+    AlertState state;
+    AlertSide side;
+    bool silent;            // Opening was suppressed, so is the resolution
+    bool clearing;
+    uint32_t startMs;
+    uint32_t clearStartMs;
+    uint32_t resolvedMs;
+    float openValue;
+    float peak;
+    float threshold;
+    Stats stats;
+
+    bool isOutside(float value) const {
+        return side == ALERT_HIGH ? value > threshold : value < threshold;
+    }
+
+    bool isCleared(float value) const {
+        return side == ALERT_HIGH ? value <= threshold - rule.hysteresis
+                                  : value >= threshold + rule.hysteresis;
+    }
+
+    void trackPeak(float value) {
+        if ((side == ALERT_HIGH && value > peak) || (side == ALERT_LOW && value < peak)) {
+            peak = value;
+        }
+    }
+
+    bool open(float value, uint32_t nowMs, AlertRateLimiter& limiter, AlertEvent& event) {
+        state = ALERT_ACTIVE;
+        clearing = false;
+        openValue = value;
+        silent = !limiter.take(nowMs);
+        if (silent) {
+            stats.suppressed++;
+            return false;
+        }
+
+        stats.opened++;
+        fill(event, ALERT_EVENT_OPENED, side, value, peak, threshold, startMs, 0);
+        return true;
+    }
+
+    bool resolve(float value, uint32_t nowMs, AlertEvent& event) {
+        state = ALERT_RESOLVED;
+        resolvedMs = nowMs;
+        if (silent) {
+            return false;
+        }
+
+        stats.resolved++;
+        fill(event, ALERT_EVENT_RESOLVED, side, value, peak, threshold, startMs, clearStartMs - startMs);
+        return true;
+    }
+
+    void fill(AlertEvent& event, AlertEventKind kind, AlertSide side, float value, float peak,
+              float threshold, uint32_t startMs, uint32_t durationMs) const {
+        event.kind = kind;
+        event.side = side;
+        event.value = value;
+        event.openValue = openValue;
+        event.peak = peak;
+        event.threshold = threshold;
+        event.startMs = startMs;
+        event.durationMs = durationMs;
+    }
+};
+
+#endif // ALERTENGINE_H
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "alloccounter.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stddef.h>
+
+static TaskHandle_t watchedTasks[AllocationCounter::MAX_TASKS];
+static volatile uint32_t taskCounts[AllocationCounter::MAX_TASKS];
+static portMUX_TYPE watchLock = portMUX_INITIALIZER_UNLOCKED;
+
+static int slotOf(TaskHandle_t task) {
+    if (!task) {
+        return -1;  // Before the scheduler runs
+    }
+    for (uint8_t i = 0; i < AllocationCounter::MAX_TASKS; i++) {
+        if (watchedTasks[i] == task) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool AllocationCounter::watchCurrentTask() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (slotOf(self) >= 0) {
+        return true;
+    }
+
+    // Two tasks starting at once must not claim the same slot
+    portENTER_CRITICAL(&watchLock);
+    bool claimed = false;
+    for (uint8_t i = 0; i < MAX_TASKS && !claimed; i++) {
+        if (!watchedTasks[i]) {
+            taskCounts[i] = 0;
+            watchedTasks[i] = self;
+            claimed = true;
+        }
+    }
+    portEXIT_CRITICAL(&watchLock);
+    return claimed;
+}
+
+uint32_t AllocationCounter::getCurrentTaskCount() {
+    int slot = slotOf(xTaskGetCurrentTaskHandle());
+    return slot >= 0 ? taskCounts[slot] : 0;
+}
+
+#ifdef ALLOC_COUNTER
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+static inline void countAllocation() {
+    int slot = slotOf(xTaskGetCurrentTaskHandle());
+    if (slot >= 0) {
+        taskCounts[slot]++;  // Only the task itself writes its slot
+    }
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    countAllocation();
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    countAllocation();
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    countAllocation();
+    return __real_realloc(ptr, size);
+}
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Counts heap allocations made by chosen FreeRTOS tasks
+ *
+ * malloc / calloc / realloc are wrapped at link time when the build sets
+ * ALLOC_COUNTER together with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+ * (the esp32dev-alloc env in platformio.ini). Without them nothing is
+ * wrapped and counts stay 0.
+ *
+ * Only allocations by the task that calls the allocator are seen: work
+ * handed to another task (lwIP, the WiFi driver) is not counted.
+ */
+class AllocationCounter {
+public:
+    static const uint8_t MAX_TASKS = 4;
+
+    /**
+     * @brief Start counting for the calling task
+     *
+     * @return false if every slot is taken
+     */
+    static bool watchCurrentTask();
+
+    /**
+     * @brief Allocations by the calling task since it was watched
+     */
+    static uint32_t getCurrentTaskCount();
+
+    static bool isEnabled();
+};
+
+/**
+ * @brief Allocations per repeated unit of work (e.g. one sample cycle)
+ *
+ * Read the count before the work, add() the difference after it.
+ */
+struct AllocationCycles {
+    uint32_t cycles;          // Cycles measured
+    uint32_t allocating;      // Cycles that allocated at all
+    uint32_t last;            // Allocations in the last cycle
+    uint32_t max;
+
+    AllocationCycles() : cycles(0), allocating(0), last(0), max(0) {}
+
+    void add(uint32_t allocations) {
+        cycles++;
+        last = allocations;
+        if (allocations > 0) {
+            allocating++;
+        }
+        if (allocations > max) {
+            max = allocations;
+        }
+    }
+};
+
+#endif // ALLOCCOUNTER_H
\ No newline at end of file
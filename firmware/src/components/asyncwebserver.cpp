@@ -1,12 +1,15 @@
 #include "Components/asyncwebserver.h"
-#include "Components/mpu6050.h"
-#include "Components/dht11.h"
+#include "Components/bufferwriter.h"
+#include "Components/sensorcore.h"
 #include "config.h"
+#include "generated/dashboard.h"
 
-WebServerManager::WebServerManager(MPU6050Sensor* mpuSensor, DHT11Sensor* dhtSensor, const String& devName)
-    : server(WEB_SERVER_PORT), mpu(mpuSensor), dht(dhtSensor), deviceName(devName),
-      deviceStatus("Initializing"), wifiSSID("Not Connected"), 
-      wifiRSSI(-100), firebaseConnected(false) {
+WebServerManager::WebServerManager(const SensorTask* sampler, const String& devName)
+    : server(WEB_SERVER_PORT), events("/api/events"), eventId(0), sampler(sampler), deviceName(devName),
+      wifiRSSI(-100), firebaseConnected(false), bootTimeline(nullptr) {
+    strlcpy(deviceStatus, "Initializing", sizeof(deviceStatus));
+    strlcpy(wifiSSID, "Not Connected", sizeof(wifiSSID));
+    memset(&firebaseStats, 0, sizeof(firebaseStats));
 }
 
 bool WebServerManager::begin(uint16_t port) {
@@ -14,9 +17,6 @@ bool WebServerManager::begin(uint16_t port) {
     Serial.printf("[WebServer] Starting on port %d...\n", port);
     #endif
     
-    // Add small delay to ensure port is fully released
-    delay(500);
-    
     setupRoutes();
     
     // Try to start server with error handling
@@ -46,217 +46,168 @@ bool WebServerManager::begin(uint16_t port) {
 void WebServerManager::setupRoutes() {
     // Root - Dashboard HTML
     server.on("/", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        request->send(200, "text/html", generateDashboardHTML());
+        handleDashboard(request);
     });
     
     // API - Sensor Data JSON
     server.on("/api/sensors", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        request->send(200, "application/json", generateSensorJSON());
+        char json[WEB_JSON_BYTES];
+        sendJSON(request, json, generateSensorJSON(json, sizeof(json)));
     });
     
     // API - Device Status JSON
     server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        request->send(200, "application/json", generateStatusJSON());
+        char json[WEB_JSON_BYTES];
+        sendJSON(request, json, generateStatusJSON(json, sizeof(json)));
     });
     
     // API - System Info
     server.on("/api/info", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        String json = "{";
-        json += "\"device\":\"" + deviceName + "\",";
-        json += "\"version\":\"" + String(FW_VERSION) + "\",";
-        json += "\"uptime\":" + String(millis() / 1000) + ",";
-        json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
-        json += "\"chipModel\":\"" + String(ESP.getChipModel()) + "\",";
-        json += "\"cpuFreq\":" + String(ESP.getCpuFreqMHz());
-        json += "}";
-        request->send(200, "application/json", json);
+        char json[WEB_JSON_BYTES];
+        sendJSON(request, json, generateInfoJSON(json, sizeof(json)));
     });
     
+    // Live updates, replaces polling for dashboards that support it
+    server.addHandler(&events);
+    
     // Handle 404
     server.onNotFound([this](AsyncWebServerRequest* request) {
         handleNotFound(request);
     });
 }
 
-String WebServerManager::generateDashboardHTML() {
-    // Memory-optimized HTML - split into smaller chunks
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
-    html += "<meta name='viewport' content='width=device-width,initial-scale=1.0'>";
-    html += "<title>" + String(WEB_TITLE) + "</title>";
-    
-    // Minified CSS
-    html += "<style>";
-    html += "*{margin:0;padding:0;box-sizing:border-box}";
-    html += "body{font-family:Arial,sans-serif;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);min-height:100vh;padding:20px}";
-    html += ".container{max-width:1200px;margin:0 auto}";
-    html += ".header{background:#fff;padding:20px;border-radius:10px;box-shadow:0 4px 6px rgba(0,0,0,0.1);margin-bottom:20px;text-align:center}";
-    html += ".header h1{color:#333;font-size:28px;margin-bottom:5px}";
-    html += ".device-name{color:#666;font-size:14px}";
-    html += ".status-bar{background:#fff;padding:15px;border-radius:10px;box-shadow:0 4px 6px rgba(0,0,0,0.1);margin-bottom:20px;display:flex;justify-content:space-around;flex-wrap:wrap;gap:15px}";
-    html += ".status-item{text-align:center}";
-    html += ".status-label{font-size:12px;color:#666;margin-bottom:5px}";
-    html += ".status-value{font-size:16px;font-weight:bold;color:#333}";
-    html += ".status-value.connected{color:#10b981}";
-    html += ".status-value.disconnected{color:#ef4444}";
-    html += ".grid{display:grid;grid-template-columns:repeat(auto-fit,minmax(300px,1fr));gap:20px;margin-bottom:20px}";
-    html += ".card{background:#fff;padding:20px;border-radius:10px;box-shadow:0 4px 6px rgba(0,0,0,0.1)}";
-    html += ".card h2{color:#333;font-size:18px;margin-bottom:15px;border-bottom:2px solid #667eea;padding-bottom:10px}";
-    html += ".sensor-row{display:flex;justify-content:space-between;padding:10px 0;border-bottom:1px solid #eee}";
-    html += ".sensor-row:last-child{border-bottom:none}";
-    html += ".sensor-label{color:#666;font-size:14px}";
-    html += ".sensor-value{font-weight:bold;color:#333;font-size:16px}";
-    html += ".alert{background:#fef3c7;border-left:4px solid #f59e0b;padding:12px;border-radius:5px;margin-top:10px}";
-    html += ".alert.danger{background:#fee2e2;border-left-color:#ef4444}";
-    html += ".alert-text{color:#92400e;font-size:14px}";
-    html += ".alert.danger .alert-text{color:#991b1b}";
-    html += ".footer{text-align:center;color:#fff;margin-top:20px;font-size:14px}";
-    html += "@media (max-width:768px){.grid{grid-template-columns:1fr}.status-bar{flex-direction:column}}";
-    html += "</style></head><body>";
-    
-    // Body content
-    html += "<div class='container'>";
-    html += "<div class='header'><h1>📦 " + String(WEB_TITLE) + "</h1>";
-    html += "<div class='device-name'>" + deviceName + "</div></div>";
-    
-    html += "<div class='status-bar'>";
-    html += "<div class='status-item'><div class='status-label'>Device Status</div>";
-    html += "<div class='status-value' id='deviceStatus'>Loading...</div></div>";
-    html += "<div class='status-item'><div class='status-label'>Wi-Fi</div>";
-    html += "<div class='status-value' id='wifiStatus'>Loading...</div></div>";
-    html += "<div class='status-item'><div class='status-label'>Signal</div>";
-    html += "<div class='status-value' id='wifiSignal'>--</div></div>";
-    html += "<div class='status-item'><div class='status-label'>Firebase</div>";
-    html += "<div class='status-value' id='firebaseStatus'>Loading...</div></div></div>";
-    
-    html += "<div class='grid'>";
-    
-    // Environment card
-    html += "<div class='card'><h2>🌡️ Environment</h2>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Temperature</span>";
-    html += "<span class='sensor-value' id='temp'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Humidity</span>";
-    html += "<span class='sensor-value' id='humidity'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Heat Index</span>";
-    html += "<span class='sensor-value' id='heatIndex'>--</span></div>";
-    html += "<div id='tempAlert'></div></div>";
-    
-    // Orientation card
-    html += "<div class='card'><h2>📐 Orientation</h2>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Position</span>";
-    html += "<span class='sensor-value' id='orientation'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Accel X</span>";
-    html += "<span class='sensor-value' id='accelX'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Accel Y</span>";
-    html += "<span class='sensor-value' id='accelY'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Accel Z</span>";
-    html += "<span class='sensor-value' id='accelZ'>--</span></div>";
-    html += "<div id='orientationAlert'></div></div>";
-    
-    // Motion card
-    html += "<div class='card'><h2>🔄 Motion & Vibration</h2>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Gyro X</span>";
-    html += "<span class='sensor-value' id='gyroX'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Gyro Y</span>";
-    html += "<span class='sensor-value' id='gyroY'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Gyro Z</span>";
-    html += "<span class='sensor-value' id='gyroZ'>--</span></div>";
-    html += "<div class='sensor-row'><span class='sensor-label'>Vibration</span>";
-    html += "<span class='sensor-value' id='vibration'>--</span></div>";
-    html += "<div id='vibrationAlert'></div></div></div>";
-    
-    html += "<div class='footer'>Last Updated: <span id='lastUpdate'>--</span> | ";
-    html += "Auto-refresh every " + String(WEB_REFRESH_MS / 1000) + " seconds</div></div>";
-    
-    // JavaScript
-    html += "<script>";
-    html += "function updateDashboard(){";
-    html += "fetch('/api/sensors').then(r=>r.json()).then(data=>{";
-    html += "document.getElementById('temp').textContent=data.temperature.toFixed(1)+'°C';";
-    html += "document.getElementById('humidity').textContent=data.humidity.toFixed(1)+'%';";
-    html += "document.getElementById('heatIndex').textContent=data.heatIndex.toFixed(1)+'°C';";
-    html += "document.getElementById('orientation').textContent=data.orientation;";
-    html += "document.getElementById('accelX').textContent=data.accelX.toFixed(2)+' m/s²';";
-    html += "document.getElementById('accelY').textContent=data.accelY.toFixed(2)+' m/s²';";
-    html += "document.getElementById('accelZ').textContent=data.accelZ.toFixed(2)+' m/s²';";
-    html += "document.getElementById('gyroX').textContent=data.gyroX.toFixed(2)+' rad/s';";
-    html += "document.getElementById('gyroY').textContent=data.gyroY.toFixed(2)+' rad/s';";
-    html += "document.getElementById('gyroZ').textContent=data.gyroZ.toFixed(2)+' rad/s';";
-    html += "document.getElementById('vibration').textContent=data.vibration?'Detected ⚠️':'Normal ✓';";
-    
-    // Alerts
-    html += "const tempAlert=document.getElementById('tempAlert');";
-    html += "if(data.tempAlert){tempAlert.innerHTML=\"<div class='alert danger'><div class='alert-text'>⚠️ Temperature Alert!</div></div>\";}else{tempAlert.innerHTML='';}";
-    
-    html += "const orientationAlert=document.getElementById('orientationAlert');";
-    html += "if(data.orientation.includes('Upside Down')||data.orientation.includes('Free Fall')){";
-    html += "orientationAlert.innerHTML=\"<div class='alert danger'><div class='alert-text'>⚠️ Abnormal Orientation!</div></div>\";}else{orientationAlert.innerHTML='';}";
-    
-    html += "const vibrationAlert=document.getElementById('vibrationAlert');";
-    html += "if(data.vibration){vibrationAlert.innerHTML=\"<div class='alert'><div class='alert-text'>⚠️ High Vibration!</div></div>\";}else{vibrationAlert.innerHTML='';}";
-    html += "}).catch(err=>console.error('Sensor fetch error:',err));";
-    
-    html += "fetch('/api/status').then(r=>r.json()).then(data=>{";
-    html += "document.getElementById('deviceStatus').textContent=data.status;";
-    html += "document.getElementById('wifiStatus').textContent=data.wifiSSID;";
-    html += "document.getElementById('wifiSignal').textContent=data.wifiSignal+'%';";
-    html += "const firebaseStatus=document.getElementById('firebaseStatus');";
-    html += "firebaseStatus.textContent=data.firebaseConnected?'Connected ✓':'Disconnected ✗';";
-    html += "firebaseStatus.className=data.firebaseConnected?'status-value connected':'status-value disconnected';";
-    html += "}).catch(err=>console.error('Status fetch error:',err));";
-    
-    html += "const now=new Date();";
-    html += "document.getElementById('lastUpdate').textContent=now.toLocaleTimeString();";
-    html += "}";
-    html += "updateDashboard();";
-    html += "setInterval(updateDashboard," + String(WEB_REFRESH_MS) + ");";
-    html += "</script></body></html>";
-    
-    return html;
+void WebServerManager::handleDashboard(AsyncWebServerRequest* request) {
+    // The page only changes with the firmware, browsers revalidate instead of downloading
+    const AsyncWebHeader* cached = request->getHeader("If-None-Match");
+    AsyncWebServerResponse* response;
+    if (cached && strstr(cached->value().c_str(), DASHBOARD_ETAG)) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse(200, "text/html", DASHBOARD_GZ, DASHBOARD_GZ_LENGTH);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", DASHBOARD_ETAG);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
 }
 
-String WebServerManager::generateSensorJSON() {
-    String json = "{";
+bool WebServerManager::generateSensorJSON(char* buffer, size_t capacity) {
+    // One consistent reading, the sensor task may be updating the drivers right now
+    LiveSample sample;
+    if (!sampler || !sampler->readLive(sample)) {
+        sample.envValid = false;
+        sample.imuReady = false;
+    }
+    
+    BufferWriter json(buffer, capacity);
+    json.print("{");
     
-    // DHT11 Data
-    if (dht && dht->isValid()) {
-        json += "\"temperature\":" + String(dht->getTemperature(), 1) + ",";
-        json += "\"humidity\":" + String(dht->getHumidity(), 1) + ",";
-        json += "\"heatIndex\":" + String(dht->getHeatIndex(), 1) + ",";
-        json += "\"tempAlert\":" + String(dht->isTemperatureAlert() ? "true" : "false") + ",";
+    // DHT11 Data (alert range as DHT11Sensor::isTemperatureAlert() defaults)
+    if (sample.envValid) {
+        json.printf("\"temperature\":%.1f,\"humidity\":%.1f,\"heatIndex\":%.1f,\"tempAlert\":%s,",
+                    sample.temperature, sample.humidity, sample.heatIndex,
+                    (sample.temperature < 0.0f || sample.temperature > 40.0f) ? "true" : "false");
     } else {
-        json += "\"temperature\":0,\"humidity\":0,\"heatIndex\":0,\"tempAlert\":false,";
+        json.print("\"temperature\":0,\"humidity\":0,\"heatIndex\":0,\"tempAlert\":false,");
     }
     
     // MPU6050 Data
-    if (mpu && mpu->isConnected()) {
-        json += "\"accelX\":" + String(mpu->getAccelX(), 2) + ",";
-        json += "\"accelY\":" + String(mpu->getAccelY(), 2) + ",";
-        json += "\"accelZ\":" + String(mpu->getAccelZ(), 2) + ",";
-        json += "\"gyroX\":" + String(mpu->getGyroX(), 2) + ",";
-        json += "\"gyroY\":" + String(mpu->getGyroY(), 2) + ",";
-        json += "\"gyroZ\":" + String(mpu->getGyroZ(), 2) + ",";
-        json += "\"orientation\":\"" + mpu->detectOrientation() + "\",";
-        json += "\"vibration\":" + String(mpu->detectVibration() ? "true" : "false");
+    if (sample.imuReady) {
+        json.printf("\"accelX\":%.2f,\"accelY\":%.2f,\"accelZ\":%.2f,",
+                    sample.accel[0], sample.accel[1], sample.accel[2]);
+        json.printf("\"gyroX\":%.2f,\"gyroY\":%.2f,\"gyroZ\":%.2f,",
+                    sample.gyro[0], sample.gyro[1], sample.gyro[2]);
+        json.printf("\"orientation\":\"%s\",", orientationName(sample.orientation));
+        json.printf("\"pitch\":%.1f,\"roll\":%.1f,\"tilt\":%.1f,\"vibration\":%s,",
+                    sample.pitch, sample.roll, sample.tilt,
+                    sample.vibrationDetected ? "true" : "false");
+        
+        // Spectrum features, band energies in (m/s²)²
+        const VibrationFeatures& features = sample.vibration;
+        const float energyScale = ImuScaleConfig::MS2_PER_LSB * ImuScaleConfig::MS2_PER_LSB;
+        json.printf("\"vibrationSpectrum\":{\"dominantHz\":%.1f,\"rms\":%.3f,\"fftCycles\":%lu,\"bandEdgesHz\":[",
+                    features.dominantHz, features.rms * ImuScaleConfig::MS2_PER_LSB,
+                    (unsigned long)sample.spectrumCycles);
+        for (uint8_t b = 0; b <= features.bandCount; b++) {
+            json.printf(b < features.bandCount ? "%.0f," : "%.0f", sample.bandEdgesHz[b]);
+        }
+        json.print("],\"bands\":[");
+        for (uint8_t b = 0; b < features.bandCount; b++) {
+            json.printf(b + 1 < features.bandCount ? "%.4f," : "%.4f", features.bandEnergy[b] * energyScale);
+        }
+        json.print("]}");
     } else {
-        json += "\"accelX\":0,\"accelY\":0,\"accelZ\":0,";
-        json += "\"gyroX\":0,\"gyroY\":0,\"gyroZ\":0,";
-        json += "\"orientation\":\"Sensor Error\",\"vibration\":false";
+        json.print("\"accelX\":0,\"accelY\":0,\"accelZ\":0,");
+        json.print("\"gyroX\":0,\"gyroY\":0,\"gyroZ\":0,");
+        json.print("\"orientation\":\"Sensor Error\",\"vibration\":false");
     }
     
-    json += "}";
-    return json;
+    json.print("}");
+    return !json.overflowed();
+}
+
+bool WebServerManager::generateStatusJSON(char* buffer, size_t capacity) {
+    BufferWriter json(buffer, capacity);
+    json.print("{\"status\":");
+    json.printJsonString(deviceStatus);
+    json.print(",\"wifiSSID\":");
+    json.printJsonString(wifiSSID);
+    json.printf(",\"wifiRSSI\":%d,\"wifiSignal\":%d,\"firebaseConnected\":%s,",
+                wifiRSSI, rssiToPercent(wifiRSSI), firebaseConnected ? "true" : "false");
+    json.printf("\"firebaseRequests\":%lu,\"firebaseHandshakes\":%lu,\"firebaseLatencyMs\":%lu,\"firebaseMaxLatencyMs\":%lu,",
+                (unsigned long)firebaseStats.requests, (unsigned long)firebaseStats.handshakes,
+                (unsigned long)firebaseStats.lastLatencyMs, (unsigned long)firebaseStats.maxLatencyMs);
+    json.printf("\"uptime\":%lu}", (unsigned long)(millis() / 1000));
+    return !json.overflowed();
 }
 
-String WebServerManager::generateStatusJSON() {
-    String json = "{";
-    json += "\"status\":\"" + deviceStatus + "\",";
-    json += "\"wifiSSID\":\"" + wifiSSID + "\",";
-    json += "\"wifiRSSI\":" + String(wifiRSSI) + ",";
-    json += "\"wifiSignal\":" + String(rssiToPercent(wifiRSSI)) + ",";
-    json += "\"firebaseConnected\":" + String(firebaseConnected ? "true" : "false") + ",";
-    json += "\"uptime\":" + String(millis() / 1000);
-    json += "}";
-    return json;
+bool WebServerManager::generateInfoJSON(char* buffer, size_t capacity) {
+    BufferWriter json(buffer, capacity);
+    json.print("{\"device\":");
+    json.printJsonString(deviceName.c_str());
+    json.printf(",\"version\":\"%s\",\"uptime\":%lu,\"freeHeap\":%lu,\"chipModel\":\"%s\",\"cpuFreq\":%lu",
+                FW_VERSION, (unsigned long)(millis() / 1000), (unsigned long)ESP.getFreeHeap(),
+                ESP.getChipModel(), (unsigned long)ESP.getCpuFreqMHz());
+    if (bootTimeline) {
+        uint32_t now = millis();
+        json.print(",\"boot\":{");
+        for (uint8_t p = 0; p < BOOT_PHASE_COUNT; p++) {
+            BootPhase phase = (BootPhase)p;
+            json.printf("%s\"%s\":{\"state\":\"%s\",\"startMs\":%lu,\"durationMs\":%lu}",
+                        p > 0 ? "," : "", bootPhaseName(phase),
+                        BootTimeline::stateName(bootTimeline->getState(phase)),
+                        (unsigned long)bootTimeline->getStartMs(phase),
+                        (unsigned long)bootTimeline->getDurationMs(phase, now));
+        }
+        json.print("}");
+    }
+    json.print("}");
+    return !json.overflowed();
+}
+
+void WebServerManager::sendJSON(AsyncWebServerRequest* request, const char* json, bool complete) {
+    if (!complete) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[WebServer] ⚠️ %s response over %d bytes (WEB_JSON_BYTES)\n", request->url().c_str(), WEB_JSON_BYTES);
+        #endif
+        request->send(500, "application/json", "{\"error\":\"response too large\"}");
+        return;
+    }
+    request->send(200, "application/json", json);
+}
+
+void WebServerManager::publishSample() {
+    if (events.count() == 0 || !generateSensorJSON(liveFrame, sizeof(liveFrame))) {
+        return;
+    }
+    events.send(liveFrame, "sensors", ++eventId);
+}
+
+void WebServerManager::publishStatus() {
+    if (events.count() == 0 || !generateStatusJSON(liveFrame, sizeof(liveFrame))) {
+        return;
+    }
+    events.send(liveFrame, "status", ++eventId);
 }
 
 void WebServerManager::handleNotFound(AsyncWebServerRequest* request) {
@@ -266,12 +217,12 @@ void WebServerManager::handleNotFound(AsyncWebServerRequest* request) {
     request->send(404, "text/plain", message);
 }
 
-void WebServerManager::setDeviceStatus(const String& status) {
-    deviceStatus = status;
+void WebServerManager::setDeviceStatus(const char* status) {
+    strlcpy(deviceStatus, status, sizeof(deviceStatus));
 }
 
-void WebServerManager::setWiFiInfo(const String& ssid, int rssi) {
-    wifiSSID = ssid;
+void WebServerManager::setWiFiInfo(const char* ssid, int rssi) {
+    strlcpy(wifiSSID, ssid, sizeof(wifiSSID));
     wifiRSSI = rssi;
 }
 
@@ -279,6 +230,10 @@ void WebServerManager::setFirebaseStatus(bool connected) {
     firebaseConnected = connected;
 }
 
+void WebServerManager::setFirebaseStats(const FirebaseClient::Stats& stats) {
+    firebaseStats = stats;
+}
+
 int WebServerManager::rssiToPercent(int rssi) {
     if (rssi >= -50) return 100;
     if (rssi <= -100) return 0;
@@ -5,29 +5,34 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 
-// Forward declarations
-class MPU6050Sensor;
-class DHT11Sensor;
+#include "boottimeline.h"
+#include "config.h"
+#include "firebaseclient.h"
+#include "sensorcore.h"
 
 /**
  * @brief Async Web Server Manager for TRACEON Dashboard
  * 
  * Provides HTTP endpoints:
- * - / (GET) - Dashboard HTML interface
+ * - / (GET) - Dashboard HTML interface, gzipped in flash (ETag / 304)
  * - /api/sensors (GET) - Real-time sensor data (JSON)
  * - /api/status (GET) - Device status (JSON)
- * - /api/info (GET) - System information (JSON)
+ * - /api/info (GET) - System information and boot phase timings (JSON)
+ * - /api/events (GET) - Server-sent events: "sensors" per sample, "status"
+ *   per status update. Each frame is serialized once and shared by every
+ *   subscriber; a client that falls SSE_MAX_QUEUED_MESSAGES frames behind
+ *   loses frames instead of growing its queue (every frame is a full
+ *   snapshot, only staleness is lost)
  */
 class WebServerManager {
 public:
     /**
      * @brief Construct web server manager
      * 
-     * @param mpuSensor Pointer to MPU6050 instance
-     * @param dhtSensor Pointer to DHT11 instance
+     * @param sampler Sensor task, source of the live readings
      * @param devName Device name string
      */
-    WebServerManager(MPU6050Sensor* mpuSensor, DHT11Sensor* dhtSensor, const String& devName);
+    WebServerManager(const SensorTask* sampler, const String& devName);
     
     /**
      * @brief Start web server
@@ -45,17 +50,17 @@ public:
     /**
      * @brief Update device status message
      * 
-     * @param status Status string (e.g., "Online", "Monitoring")
+     * @param status Status string (e.g., "Online", "Monitoring"), copied
      */
-    void setDeviceStatus(const String& status);
+    void setDeviceStatus(const char* status);
     
     /**
      * @brief Update WiFi connection info
      * 
-     * @param ssid Connected SSID
+     * @param ssid Connected SSID, copied
      * @param rssi Signal strength (dBm)
      */
-    void setWiFiInfo(const String& ssid, int rssi);
+    void setWiFiInfo(const char* ssid, int rssi);
     
     /**
      * @brief Update Firebase connection status
@@ -63,18 +68,48 @@ public:
      * @param connected Connection state
      */
     void setFirebaseStatus(bool connected);
+    
+    /**
+     * @brief Update Firebase connection diagnostics
+     * 
+     * @param stats Request / handshake / latency counters
+     */
+    void setFirebaseStats(const FirebaseClient::Stats& stats);
+    
+    /**
+     * @brief Boot phases reported by /api/info
+     * 
+     * @param timeline Updated by the boot code, read per request
+     */
+    void setBootTimeline(const BootTimeline* timeline) { bootTimeline = timeline; }
+    
+    /**
+     * @brief Push the latest sensor data to /api/events subscribers
+     * 
+     * Nothing is generated without subscribers. Call from one task only.
+     */
+    void publishSample();
+    
+    /**
+     * @brief Push the device status to /api/events subscribers
+     */
+    void publishStatus();
 
 private:
     AsyncWebServer server;
+    AsyncEventSource events;
+    uint32_t eventId;
+    char liveFrame[WEB_JSON_BYTES];   // publishSample() / publishStatus() output
     
-    MPU6050Sensor* mpu;
-    DHT11Sensor* dht;
+    const SensorTask* sampler;   // Read through its live snapshot only
     
     String deviceName;     // Device name
-    String deviceStatus;
-    String wifiSSID;
+    char deviceStatus[32];
+    char wifiSSID[33];     // 32-byte SSID + terminator
     int wifiRSSI;
     bool firebaseConnected;
+    FirebaseClient::Stats firebaseStats;
+    const BootTimeline* bootTimeline;
     
     /**
      * @brief Setup all HTTP routes
@@ -82,19 +117,35 @@ private:
     void setupRoutes();
     
     /**
-     * @brief Generate dashboard HTML (optimized for memory)
+     * @brief Serve the pre-gzipped dashboard straight from flash
+     * 
+     * Answers 304 when the browser already holds the current ETag.
      */
-    String generateDashboardHTML();
+    void handleDashboard(AsyncWebServerRequest* request);
     
     /**
-     * @brief Generate sensor data JSON
+     * @brief Generate sensor data JSON from the sensor task's latest reading
+     * 
+     * @param buffer Destination
+     * @param capacity Buffer size in bytes
+     * @return false if the JSON did not fit
      */
-    String generateSensorJSON();
+    bool generateSensorJSON(char* buffer, size_t capacity);
     
     /**
      * @brief Generate device status JSON
      */
-    String generateStatusJSON();
+    bool generateStatusJSON(char* buffer, size_t capacity);
+    
+    /**
+     * @brief Generate system info JSON (boot phases included)
+     */
+    bool generateInfoJSON(char* buffer, size_t capacity);
+    
+    /**
+     * @brief Send a generated JSON response, 500 if it was cut short
+     */
+    void sendJSON(AsyncWebServerRequest* request, const char* json, bool complete);
     
     /**
      * @brief Handle 404 errors
@@ -0,0 +1,85 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Characters base64Encode() writes for length bytes (no NUL)
+ */
+inline size_t base64EncodedLength(size_t length) {
+    return (length + 2) / 3 * 4;
+}
+
+/**
+ * @brief Standard base64 with padding (RFC 4648)
+ *
+ * @param out Receives base64EncodedLength(length) characters + NUL
+ * @return Characters written (without the NUL), 0 if capacity is too small
+ */
+inline size_t base64Encode(const uint8_t* data, size_t length, char* out, size_t capacity) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t needed = base64EncodedLength(length);
+    if (capacity < needed + 1) {
+        return 0;
+    }
+
+    char* p = out;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t chunk = (uint32_t)data[i] << 16;
+        if (i + 1 < length) chunk |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) chunk |= data[i + 2];
+
+        *p++ = ALPHABET[(chunk >> 18) & 0x3F];
+        *p++ = ALPHABET[(chunk >> 12) & 0x3F];
+        *p++ = (i + 1 < length) ? ALPHABET[(chunk >> 6) & 0x3F] : '=';
+        *p++ = (i + 2 < length) ? ALPHABET[chunk & 0x3F] : '=';
+    }
+    *p = '\0';
+    return needed;
+}
+
+/**
+ * @brief Inverse of base64Encode()
+ *
+ * @return Bytes written, 0 on invalid input or if capacity is too small
+ */
+inline size_t base64Decode(const char* text, size_t length, uint8_t* out, size_t capacity) {
+    if (length % 4 != 0) {
+        return 0;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < length; i += 4) {
+        uint32_t chunk = 0;
+        uint8_t padding = 0;
+        for (uint8_t k = 0; k < 4; k++) {
+            char c = text[i + k];
+            int v;
+            if (c >= 'A' && c <= 'Z') v = c - 'A';
+            else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') v = c - '0' + 52;
+            else if (c == '+') v = 62;
+            else if (c == '/') v = 63;
+            else if (c == '=' && i + 4 == length && k >= 2) { v = 0; padding++; }
+            else return 0;
+
+            if (padding > 0 && c != '=') {
+                return 0;  // Data after padding
+            }
+            chunk = (chunk << 6) | (uint32_t)v;
+        }
+
+        uint8_t bytes = 3 - padding;
+        if (written + bytes > capacity) {
+            return 0;
+        }
+        out[written++] = (chunk >> 16) & 0xFF;
+        if (bytes > 1) out[written++] = (chunk >> 8) & 0xFF;
+        if (bytes > 2) out[written++] = chunk & 0xFF;
+    }
+    return written;
+}
+
+#endif // BASE64_H
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef BOOTTIMELINE_H
+#define BOOTTIMELINE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Boot phases, each one waits only on the phases it needs
+ */
+enum BootPhase : uint8_t {
+    BOOT_SENSORS = 0,       // IMU / DHT11 drivers and the pipeline
+    BOOT_RECORD_LOG,        // Offline log mounted
+    BOOT_SAMPLING,          // Sensor task started → first record captured
+    BOOT_WIFI,              // Stored credentials (or the portal) → connected
+    BOOT_NTP,               // First SNTP sync (WiFi)
+    BOOT_MDNS,              // (WiFi)
+    BOOT_WEB_SERVER,        // (WiFi, after the portal has released port 80)
+    BOOT_REGISTER,          // info/ registration round trips (NTP, for registeredAt)
+    BOOT_PHASE_COUNT
+};
+
+inline const char* bootPhaseName(BootPhase phase) {
+    switch (phase) {
+        case BOOT_SENSORS:    return "sensors";
+        case BOOT_RECORD_LOG: return "recordLog";
+        case BOOT_SAMPLING:   return "firstSample";
+        case BOOT_WIFI:       return "wifi";
+        case BOOT_NTP:        return "ntp";
+        case BOOT_MDNS:       return "mdns";
+        case BOOT_WEB_SERVER: return "webServer";
+        case BOOT_REGISTER:   return "register";
+        default:              return "unknown";
+    }
+}
+
+/**
+ * @brief When each boot phase started and finished
+ *
+ * Phases overlap: sampling runs while the network side is still coming
+ * up. Each phase is started and finished once, a phase that is retried
+ * keeps its first start. Times are platform millis (since power-on).
+ *
+ * Each phase is written by one task (the sensor task closes
+ * BOOT_SAMPLING, the network task the network phases) and read by the
+ * web server: every field is a single aligned word.
+ */
+class BootTimeline {
+public:
+    enum State : uint8_t {
+        PENDING = 0,
+        RUNNING,
+        OK,
+        FAILED
+    };
+
+    BootTimeline() {
+        for (uint8_t p = 0; p < BOOT_PHASE_COUNT; p++) {
+            phases[p].startMs = 0;
+            phases[p].endMs = 0;
+            phases[p].state = PENDING;
+        }
+    }
+
+    void start(BootPhase phase, uint32_t nowMs) {
+        if (phases[phase].state != PENDING) {
+            return;
+        }
+        phases[phase].startMs = nowMs;
+        phases[phase].state = RUNNING;
+    }
+
+    /**
+     * @brief Close a phase (started now if it never was)
+     */
+    void finish(BootPhase phase, uint32_t nowMs, bool ok) {
+        if (isDone(phase)) {
+            return;
+        }
+        if (phases[phase].state == PENDING) {
+            phases[phase].startMs = nowMs;
+        }
+        phases[phase].endMs = nowMs;
+        phases[phase].state = ok ? OK : FAILED;
+    }
+
+    State getState(BootPhase phase) const { return (State)phases[phase].state; }
+    bool isStarted(BootPhase phase) const { return phases[phase].state != PENDING; }
+    bool isDone(BootPhase phase) const { return phases[phase].state >= OK; }
+    bool succeeded(BootPhase phase) const { return phases[phase].state == OK; }
+
+    uint32_t getStartMs(BootPhase phase) const { return phases[phase].startMs; }
+    uint32_t getEndMs(BootPhase phase) const { return phases[phase].endMs; }
+
+    /**
+     * @brief Time spent in the phase, so far if it is still running
+     */
+    uint32_t getDurationMs(BootPhase phase, uint32_t nowMs) const {
+        const Entry& entry = phases[phase];
+        if (entry.state == PENDING) return 0;
+        return (entry.state == RUNNING ? nowMs : entry.endMs) - entry.startMs;
+    }
+
+    bool isComplete() const {
+        for (uint8_t p = 0; p < BOOT_PHASE_COUNT; p++) {
+            if (!isDone((BootPhase)p)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static const char* stateName(State state) {
+        switch (state) {
+            case RUNNING: return "running";
+            case OK:      return "ok";
+            case FAILED:  return "failed";
+            default:      return "pending";
+        }
+    }
+
+private:
+    struct Entry {
+        volatile uint32_t startMs;
+        volatile uint32_t endMs;
+        volatile uint32_t state;
+    };
+    Entry phases[BOOT_PHASE_COUNT];
+};
+
+#endif // BOOTTIMELINE_H
\ No newline at end of file
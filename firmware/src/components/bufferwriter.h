@@ -0,0 +1,92 @@
+#ifndef BUFFERWRITER_H
+#define BUFFERWRITER_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Builds text in a fixed buffer, snprintf style
+ *
+ * Takes the place of String concatenation for responses assembled piece
+ * by piece: nothing is allocated, the buffer always holds a terminated
+ * string, and output that does not fit is cut off and flagged instead of
+ * growing the buffer.
+ */
+class BufferWriter {
+public:
+    /**
+     * @param buffer Destination
+     * @param capacity Buffer size in bytes (at least 1, for the terminator)
+     */
+    BufferWriter(char* buffer, size_t capacity)
+        : buffer(buffer), capacity(capacity), used(0), overflow(false) {
+        buffer[0] = '\0';
+    }
+
+    void print(const char* text) { write(text, strlen(text)); }
+
+    void write(const char* data, size_t length) {
+        size_t room = capacity - used - 1;
+        if (length > room) {
+            length = room;
+            overflow = true;
+        }
+        memcpy(buffer + used, data, length);
+        used += length;
+        buffer[used] = '\0';
+    }
+
+    __attribute__((format(printf, 2, 3)))
+    void printf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer + used, capacity - used, format, args);
+        va_end(args);
+
+        if (written < 0) {
+            buffer[used] = '\0';
+            overflow = true;
+        } else if ((size_t)written >= capacity - used) {
+            used = capacity - 1;
+            overflow = true;
+        } else {
+            used += written;
+        }
+    }
+
+    /**
+     * @brief Quoted JSON string, escaping quotes, backslashes and control characters
+     */
+    void printJsonString(const char* text) {
+        write("\"", 1);
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                char escaped[2] = { '\\', *c };
+                write(escaped, 2);
+            } else if ((unsigned char)*c < 0x20) {
+                printf("\\u%04x", (unsigned)*c);
+            } else {
+                write(c, 1);
+            }
+        }
+        write("\"", 1);
+    }
+
+    const char* c_str() const { return buffer; }
+    size_t length() const { return used; }
+
+    /**
+     * @brief Something was cut off
+     */
+    bool overflowed() const { return overflow; }
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+};
+
+#endif // BUFFERWRITER_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef CONFIGJSON_H
+#define CONFIGJSON_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "deviceconfig.h"
+
+/**
+ * @brief Set every leaf of a JSON value below leaf (path is restored on return)
+ */
+inline void applyConfigLeaves(DeviceConfig& config, String& leaf, JsonVariantConst value) {
+    if (value.is<JsonObjectConst>()) {
+        for (JsonPairConst child : value.as<JsonObjectConst>()) {
+            unsigned int mark = leaf.length();
+            if (mark > 0) {
+                leaf += '/';
+            }
+            leaf += child.key().c_str();
+            applyConfigLeaves(config, leaf, child.value());
+            leaf.remove(mark);
+        }
+    } else if (value.is<const char*>()) {
+        config.setString(leaf.c_str(), value.as<const char*>());
+    } else if (value.is<float>()) {
+        config.setNumber(leaf.c_str(), value.as<float>());
+    }
+    // null: deleted, already back to its default
+}
+
+/**
+ * @brief Replace the DeviceConfig subtree at path with a JSON value
+ *
+ * Shared by the transports: a database put / patch child, or a
+ * retained config message, both replace one subtree.
+ */
+inline void applyConfigJson(DeviceConfig& config, const char* path, JsonVariantConst value) {
+    config.reset(path);
+    String leaf = path;
+    applyConfigLeaves(config, leaf, value);
+}
+
+#endif // CONFIGJSON_H
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "configsubscription.h"
+
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}  // namespace
+
+ConfigSubscription::ConfigSubscription(FirebaseClient& firebase, DeviceConfig& config)
+    : firebase(firebase), config(config), started(false), state(IDLE), lastActivity(0),
+      lastConnectAttempt(0), lastPoll(0), headLineLength(0), headStatus(0), redirects(0),
+      headDeadline(0), chunked(false), chunkRemaining(-1), chunkSize(0), chunkSizeDone(false) {
+    memset(&stats, 0, sizeof(stats));
+    redirectHost[0] = '\0';
+}
+
+void ConfigSubscription::begin(const String& followPath) {
+    path = followPath;
+    stream.setInsecure();
+    started = true;
+
+    // First service() tries the stream, and polls straight away if that fails
+    uint32_t now = millis();
+    lastConnectAttempt = now - CONFIG_STREAM_RETRY_MS;
+    lastPoll = now - CONFIG_POLL_INTERVAL;
+}
+
+void ConfigSubscription::service() {
+    if (!started) {
+        return;
+    }
+
+    if (state == STREAMING) {
+        readStream();
+        return;
+    }
+    if (state == OPENING) {
+        readHead();
+        return;
+    }
+
+    uint32_t now = millis();
+    if (now - lastConnectAttempt >= CONFIG_STREAM_RETRY_MS) {
+        lastConnectAttempt = now;
+        redirects = 0;
+        if (openStream(firebase.getHost().c_str())) {
+            return;
+        }
+        #if ENABLE_DEBUG_LOGS
+        Serial.println("[CONFIG] ⚠️  Stream unavailable, polling");
+        #endif
+    }
+
+    if (now - lastPoll >= CONFIG_POLL_INTERVAL) {
+        lastPoll = now;
+        poll();
+    }
+}
+
+void ConfigSubscription::stop() {
+    stream.stop();
+    state = IDLE;
+    parser.reset();
+}
+
+void ConfigSubscription::drop() {
+    stats.drops++;
+    stop();
+    #if ENABLE_DEBUG_LOGS
+    Serial.println("[CONFIG] ⚠️  Stream lost");
+    #endif
+}
+
+bool ConfigSubscription::openStream(const char* host) {
+    stream.stop();
+    state = IDLE;
+    if (host[0] == '\0' || !stream.connect(host, PORT, CONFIG_STREAM_CONNECT_MS)) {
+        return false;
+    }
+
+    const String& authToken = firebase.getAuthToken();
+    String head;
+    head.reserve(160 + path.length() + authToken.length());
+    head += "GET /";
+    head += path;
+    head += ".json";
+    if (authToken.length() > 0) {
+        head += "?auth=";
+        head += authToken;
+    }
+    head += " HTTP/1.1\r\nHost: ";
+    head += host;
+    head += "\r\nAccept: text/event-stream\r\nConnection: keep-alive\r\n\r\n";
+
+    if (stream.print(head) != head.length()) {
+        stream.stop();
+        return false;
+    }
+
+    state = OPENING;
+    headLineLength = 0;
+    headStatus = 0;
+    redirectHost[0] = '\0';
+    chunked = false;
+    headDeadline = millis() + CONFIG_STREAM_HEAD_MS;
+    return true;
+}
+
+void ConfigSubscription::readHead() {
+    // One byte at a time, so nothing past the blank line (event data) is taken
+    while (state == OPENING && stream.available() > 0) {
+        char c = stream.read();
+        if (c == '\n') {
+            headLine[headLineLength] = '\0';
+            headLineLength = 0;
+            headerLine();
+        } else if (c != '\r' && headLineLength + 1 < sizeof(headLine)) {
+            headLine[headLineLength++] = c;
+        }
+    }
+
+    if (state == OPENING &&
+        ((int32_t)(millis() - headDeadline) >= 0 || (!stream.connected() && stream.available() <= 0))) {
+        stream.stop();
+        state = IDLE;
+        #if ENABLE_DEBUG_LOGS
+        Serial.println("[CONFIG] ⚠️  No stream response, polling");
+        #endif
+    }
+}
+
+void ConfigSubscription::headerLine() {
+    if (headStatus == 0) {
+        // Status line: HTTP/1.1 200 OK
+        if (strncmp(headLine, "HTTP/1.", 7) != 0 || strlen(headLine) < 12) {
+            stream.stop();
+            state = IDLE;
+            return;
+        }
+        headStatus = atoi(headLine + 9);
+        return;
+    }
+
+    if (headLine[0] != '\0') {
+        if (strncasecmp(headLine, "location:", 9) == 0) {
+            // The database may point the stream at the shard that owns it
+            const char* location = headLine + 9;
+            const char* scheme = strstr(location, "://");
+            const char* start = scheme ? scheme + 3 : location;
+            while (*start == ' ') start++;
+            size_t length = strcspn(start, "/ ");
+            if (length >= sizeof(redirectHost)) length = sizeof(redirectHost) - 1;
+            memcpy(redirectHost, start, length);
+            redirectHost[length] = '\0';
+        } else if (strncasecmp(headLine, "transfer-encoding:", 18) == 0 && strcasestr(headLine + 18, "chunked")) {
+            chunked = true;
+        }
+        return;
+    }
+
+    // Blank line: end of the head
+    if (headStatus == 200) {
+        state = STREAMING;
+        lastActivity = millis();
+        stats.connects++;
+        parser.reset();
+        chunkRemaining = -1;
+        chunkSize = 0;
+        chunkSizeDone = false;
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[CONFIG] ✅ Streaming %s\n", path.c_str());
+        #endif
+        return;
+    }
+
+    if ((headStatus == 301 || headStatus == 302 || headStatus == 307) && redirectHost[0] != '\0' &&
+        redirects < MAX_REDIRECTS) {
+        redirects++;
+        char host[sizeof(redirectHost)];
+        memcpy(host, redirectHost, sizeof(host));
+        if (openStream(host)) {
+            return;
+        }
+    }
+
+    stream.stop();
+    state = IDLE;
+}
+
+void ConfigSubscription::readStream() {
+    uint32_t now = millis();
+    char buffer[256];
+
+    // Bounded per pass so a burst of events cannot hold up uploads
+    for (uint8_t reads = 0; reads < 8 && state == STREAMING; reads++) {
+        int available = stream.available();
+        if (available <= 0) {
+            break;
+        }
+
+        int want = available < (int)sizeof(buffer) ? available : (int)sizeof(buffer);
+        int got = stream.read((uint8_t*)buffer, want);
+        if (got <= 0) {
+            break;
+        }
+
+        lastActivity = now;
+        if (chunked) {
+            feedChunked(buffer, got);
+        } else {
+            parser.feed(buffer, got, *this);
+        }
+    }
+
+    if (state != STREAMING) {
+        return;  // Cancelled by an event
+    }
+
+    // The server sends keep-alive events every 30 s, silence means a dead link
+    if ((!stream.connected() && stream.available() <= 0) ||
+        now - lastActivity >= CONFIG_STREAM_TIMEOUT_MS) {
+        drop();
+    }
+}
+
+void ConfigSubscription::feedChunked(const char* data, size_t length) {
+    size_t i = 0;
+    while (i < length && state == STREAMING) {
+        if (chunkRemaining < 0) {
+            // Size line: hex digits, optional ";extension", CRLF
+            char c = data[i++];
+            if (c == '\n') {
+                chunkRemaining = chunkSize;
+                chunkSize = 0;
+                chunkSizeDone = false;
+            } else if (!chunkSizeDone && hexValue(c) >= 0) {
+                chunkSize = chunkSize * 16 + hexValue(c);
+            } else {
+                chunkSizeDone = true;
+            }
+        } else if (chunkRemaining == 0) {
+            // CRLF closing the chunk data
+            if (data[i++] == '\n') {
+                chunkRemaining = -1;
+            }
+        } else {
+            size_t n = length - i < (size_t)chunkRemaining ? length - i : (size_t)chunkRemaining;
+            parser.feed(data + i, n, *this);
+            i += n;
+            chunkRemaining -= n;
+        }
+    }
+}
+
+void ConfigSubscription::onEvent(const char* event, const char* data, size_t length) {
+    bool put = strcmp(event, "put") == 0;
+    bool patch = strcmp(event, "patch") == 0;
+
+    if (put || patch) {
+        // {"path": "/thresholds/temperature", "data": ...}
+        JsonDocument doc;
+        if (deserializeJson(doc, data, length)) {
+            return;
+        }
+        apply(doc["path"] | "/", doc["data"], patch);
+        stats.events++;
+    } else if (strcmp(event, "cancel") == 0 || strcmp(event, "auth_revoked") == 0) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[CONFIG] ⚠️  Stream %s by server\n", event);
+        #endif
+        drop();
+    }
+    // keep-alive: nothing to do, the read already counted as activity
+}
+
+void ConfigSubscription::poll() {
+    String response;
+    bool changed = false;
+    stats.polls++;
+
+    if (!firebase.getIfChanged(path, etag, response, changed)) {
+        return;
+    }
+    if (!changed) {
+        stats.unchanged++;
+        return;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, response.c_str(), response.length())) {
+        return;
+    }
+    apply("/", doc.as<JsonVariantConst>(), false);
+}
+
+void ConfigSubscription::apply(const char* eventPath, JsonVariantConst value, bool merge) {
+    String base = eventPath;
+    while (base.startsWith("/")) {
+        base.remove(0, 1);
+    }
+    while (base.endsWith("/")) {
+        base.remove(base.length() - 1);
+    }
+
+    if (!merge) {
+        applyConfigJson(config, base.c_str(), value);
+        return;
+    }
+
+    // Patch keys may themselves be paths ("thresholds/vibration")
+    for (JsonPairConst child : value.as<JsonObjectConst>()) {
+        String childPath = base;
+        if (childPath.length() > 0) {
+            childPath += '/';
+        }
+        childPath += child.key().c_str();
+
+        applyConfigJson(config, childPath.c_str(), child.value());
+    }
+}
\ No newline at end of file
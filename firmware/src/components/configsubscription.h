@@ -0,0 +1,140 @@
+#ifndef CONFIGSUBSCRIPTION_H
+#define CONFIGSUBSCRIPTION_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFiClientSecure.h>
+
+#include "config.h"
+#include "configjson.h"
+#include "deviceconfig.h"
+#include "firebaseclient.h"
+#include "sseparser.h"
+
+/**
+ * @brief Keeps DeviceConfig in step with config/ in the database
+ *
+ * Holds a REST streaming request (Accept: text/event-stream) open on
+ * its own TLS connection, so a dashboard change to thresholds or the
+ * parcel assignment arrives as a put / patch event within about a
+ * second, with no polling. The first event is a snapshot of config/.
+ * Only the dashboard writes below config/, so the device's own writes
+ * (lastSeen, telemetry) never come back as events.
+ *
+ * Opening the stream never holds up the network task for long: the TLS
+ * connect is bounded by CONFIG_STREAM_CONNECT_MS, and the response head
+ * (status, redirect, headers) is read over the following service()
+ * calls as it arrives, within CONFIG_STREAM_HEAD_MS.
+ *
+ * If the stream cannot be opened, goes quiet past the keep-alive
+ * interval or is cancelled by the server, config/ is polled instead
+ * with an ETag-conditional GET on the shared FirebaseClient (unchanged
+ * data is neither downloaded twice nor parsed), and the stream is
+ * retried now and then.
+ *
+ * All calls come from the network task.
+ */
+class ConfigSubscription {
+public:
+    struct Stats {
+        uint32_t events;        // put / patch events applied
+        uint32_t connects;      // Streams opened
+        uint32_t drops;         // Streams lost (closed, silent, cancelled)
+        uint32_t polls;         // Fallback GETs
+        uint32_t unchanged;     // Fallback GETs answered "not modified"
+    };
+
+    ConfigSubscription(FirebaseClient& firebase, DeviceConfig& config);
+
+    /**
+     * @brief Start following a database path (without .json)
+     */
+    void begin(const String& path);
+
+    /**
+     * @brief Read pending events, or poll / reconnect when due
+     *
+     * Call every network task pass while WiFi is up.
+     */
+    void service();
+
+    /**
+     * @brief Close the stream (e.g. on WiFi loss), reopened by service()
+     */
+    void stop();
+
+    bool isStreaming() const { return state == STREAMING; }
+    uint32_t getOverflows() const { return parser.getOverflows(); }
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief SseParser callback
+     */
+    void onEvent(const char* event, const char* data, size_t length);
+
+private:
+    FirebaseClient& firebase;
+    DeviceConfig& config;
+    WiFiClientSecure stream;
+    SseParser<CONFIG_EVENT_MAX> parser;
+    String path;
+    String etag;
+    Stats stats;
+
+    enum State : uint8_t {
+        IDLE,         // Polling, stream retried every CONFIG_STREAM_RETRY_MS
+        OPENING,      // Request sent, reading the response head
+        STREAMING
+    };
+
+    bool started;
+    State state;
+    uint32_t lastActivity;
+    uint32_t lastConnectAttempt;
+    uint32_t lastPoll;
+
+    // Response head while OPENING
+    static const size_t HEAD_LINE_BYTES = 128;   // Longer header lines are cut short
+    char headLine[HEAD_LINE_BYTES];
+    size_t headLineLength;
+    int headStatus;                              // 0 until the status line is in
+    char redirectHost[64];                       // From Location: on a 3xx
+    uint8_t redirects;
+    uint32_t headDeadline;
+
+    // Transfer-Encoding: chunked on the stream body
+    bool chunked;
+    int32_t chunkRemaining;   // Bytes left in this chunk, -1 while reading the size line
+    uint32_t chunkSize;
+    bool chunkSizeDone;       // Past the hex digits of the size line
+
+    static const uint16_t PORT = 443;
+    static const uint8_t MAX_REDIRECTS = 2;
+
+    /**
+     * @brief Connect and send the stream request, then OPENING
+     *
+     * @return false if the connect or the request failed
+     */
+    bool openStream(const char* host);
+
+    /**
+     * @brief Read what has arrived of the response head (OPENING)
+     */
+    void readHead();
+    void headerLine();
+    void readStream();
+    void feedChunked(const char* data, size_t length);
+    void drop();
+    void poll();
+
+    /**
+     * @brief Apply value at eventPath (relative to the followed path)
+     *
+     * @param merge false: value replaces the subtree (put)
+     *              true: each child of value replaces its subtree (patch)
+     */
+    void apply(const char* eventPath, JsonVariantConst value, bool merge);
+};
+
+#endif // CONFIGSUBSCRIPTION_H
\ No newline at end of file
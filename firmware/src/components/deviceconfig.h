@@ -0,0 +1,182 @@
+#ifndef DEVICECONFIG_H
+#define DEVICECONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Alert limits set from the dashboard
+ */
+struct AlertThresholds {
+    float temperatureMin;   // °C
+    float temperatureMax;
+    float humidityMin;      // %
+    float humidityMax;
+    float vibration;        // m/s²
+};
+
+/**
+ * @brief In-RAM copy of the dashboard-controlled config/ subtree
+ *
+ * Updated leaf by leaf from database events, so it can follow both a
+ * full snapshot and a change deep in the tree:
+ * - reset(path): everything under path goes back to its default
+ *   (a put replaces the subtree, a null deletes it)
+ * - setNumber() / setString(): one value at path
+ *
+ * Paths are relative to config/ and '/' separated, without a leading
+ * slash (e.g. "thresholds/temperature/max", "" for all of config/).
+ * Unknown paths are ignored.
+ */
+class DeviceConfig {
+public:
+    static const size_t MAX_PARCEL_ID = 40;
+
+    explicit DeviceConfig(const AlertThresholds& defaults)
+        : defaults(defaults), thresholds(defaults), revision(0), changed(false) {
+        assignedParcelId[0] = '\0';
+    }
+
+    void reset(const char* path) {
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            if (isUnder(fieldPath(f), path)) {
+                if (f == FIELD_ASSIGNED_PARCEL) {
+                    setParcel("");
+                } else {
+                    setValue(f, *number(defaults, f));
+                }
+            }
+        }
+    }
+
+    /**
+     * @return false if path is not a known setting
+     */
+    bool setNumber(const char* path, float value) {
+        int f = find(path);
+        if (f < 0) {
+            return false;
+        }
+        if (f == FIELD_ASSIGNED_PARCEL) {
+            char text[16];
+            snprintf(text, sizeof(text), "%g", value);
+            setParcel(text);
+        } else {
+            setValue(f, value);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Set a value that arrived as a string (numeric limits are parsed)
+     */
+    bool setString(const char* path, const char* value) {
+        int f = find(path);
+        if (f < 0) {
+            return false;
+        }
+        if (f == FIELD_ASSIGNED_PARCEL) {
+            setParcel(value);
+        } else {
+            char* end;
+            float parsed = strtof(value, &end);
+            if (end == value) {
+                return false;
+            }
+            setValue(f, parsed);
+        }
+        return true;
+    }
+
+    const AlertThresholds& getThresholds() const { return thresholds; }
+    const char* getAssignedParcelId() const { return assignedParcelId; }
+    bool isAssigned() const { return assignedParcelId[0] != '\0'; }
+
+    /**
+     * @brief Bumped on every effective change
+     */
+    uint32_t getRevision() const { return revision; }
+
+    /**
+     * @brief True once after one or more changes
+     */
+    bool takeChanged() {
+        bool was = changed;
+        changed = false;
+        return was;
+    }
+
+private:
+    enum Field : uint8_t {
+        FIELD_TEMPERATURE_MIN = 0,
+        FIELD_TEMPERATURE_MAX,
+        FIELD_HUMIDITY_MIN,
+        FIELD_HUMIDITY_MAX,
+        FIELD_VIBRATION,
+        FIELD_ASSIGNED_PARCEL,
+        FIELD_COUNT
+    };
+
+    AlertThresholds defaults;
+    AlertThresholds thresholds;
+    char assignedParcelId[MAX_PARCEL_ID + 1];
+    uint32_t revision;
+    bool changed;
+
+    static const char* fieldPath(uint8_t f) {
+        static const char* const PATHS[FIELD_COUNT] = {
+            "thresholds/temperature/min",
+            "thresholds/temperature/max",
+            "thresholds/humidity/min",
+            "thresholds/humidity/max",
+            "thresholds/vibration",
+            "assignedParcelId"
+        };
+        return PATHS[f];
+    }
+
+    // field lies at or below path, on a segment boundary
+    static bool isUnder(const char* field, const char* path) {
+        size_t n = strlen(path);
+        return n == 0 || (strncmp(field, path, n) == 0 && (field[n] == '\0' || field[n] == '/'));
+    }
+
+    static int find(const char* path) {
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            if (strcmp(fieldPath(f), path) == 0) {
+                return f;
+            }
+        }
+        return -1;
+    }
+
+    static float* number(AlertThresholds& t, uint8_t f) {
+        float* fields[] = { &t.temperatureMin, &t.temperatureMax, &t.humidityMin, &t.humidityMax, &t.vibration };
+        return fields[f];
+    }
+
+    void setValue(uint8_t f, float value) {
+        float* target = number(thresholds, f);
+        if (*target != value) {
+            *target = value;
+            touch();
+        }
+    }
+
+    void setParcel(const char* id) {
+        if (strncmp(assignedParcelId, id, MAX_PARCEL_ID) != 0) {
+            strncpy(assignedParcelId, id, MAX_PARCEL_ID);
+            assignedParcelId[MAX_PARCEL_ID] = '\0';
+            touch();
+        }
+    }
+
+    void touch() {
+        revision++;
+        changed = true;
+    }
+};
+
+#endif // DEVICECONFIG_H
\ No newline at end of file
@@ -2,9 +2,10 @@
 #include "config.h"
 
 DHT11Sensor::DHT11Sensor(uint8_t pin) 
-    : dht(pin, DHTTYPE), pin(pin), 
+    : pin(pin), 
       temperature(0), humidity(0), 
-      dataValid(false), lastReadTime(0) {
+      dataValid(false), state(IDLE), lastReadTime(0),
+      stateStart(0), captureStart(0), errorCount(0), edgeCount(0) {
 }
 
 bool DHT11Sensor::begin() {
@@ -12,61 +13,109 @@ bool DHT11Sensor::begin() {
     Serial.printf("[DHT11] Initializing on pin %d...\n", pin);
     #endif
     
-    dht.begin();
+    // Idle line is high (pull-up)
+    pinMode(pin, INPUT_PULLUP);
     
-    // Give sensor time to stabilize (DHT11 requires ~2 seconds)
-    delay(2000);
+    // Sensor needs time to stabilize: schedule the first read instead of waiting
+    lastReadTime = millis();
     
-    // Test read
-    if (readSensor()) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.println("[DHT11] ✅ Sensor initialized");
-        Serial.printf("[DHT11] Initial - Temp: %.1f°C, Humidity: %.1f%%\n", 
-                      temperature, humidity);
-        #endif
-        return true;
-    } else {
-        #if ENABLE_DEBUG_LOGS
-        Serial.println("[DHT11] ⚠️  Sensor found but initial read failed");
-        Serial.println("[DHT11] Check wiring:");
-        Serial.println("  - VCC → 3.3V");
-        Serial.println("  - GND → GND");
-        Serial.println("  - DATA → GPIO 4");
-        Serial.println("  - Add 4.7-10kΩ pull-up resistor between DATA and VCC");
-        #endif
-        return false;
-    }
+    #if ENABLE_DEBUG_LOGS
+    Serial.println("[DHT11] ✅ Driver ready (first reading in 2s)");
+    #endif
+    
+    return true;
 }
 
 bool DHT11Sensor::readSensor() {
     // DHT11 requires minimum 2-second interval between reads
     unsigned long currentTime = millis();
-    if (currentTime - lastReadTime < READ_INTERVAL) {
-        // Too soon, return last valid state
+    if (state != IDLE || currentTime - lastReadTime < READ_INTERVAL) {
+        // Busy or too soon, return last valid state
         return dataValid;
     }
     
     lastReadTime = currentTime;
     
-    // Read temperature and humidity
-    float h = dht.readHumidity();
-    float t = dht.readTemperature();
+    // Start signal: pull the line low, update() releases it
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    stateStart = currentTime;
+    state = START_LOW;
     
-    // Check if readings are valid (not NaN)
-    if (isnan(h) || isnan(t)) {
+    return dataValid;
+}
+
+bool DHT11Sensor::update() {
+    bool completed = false;
+    
+    switch (state) {
+        case IDLE:
+            break;
+            
+        case START_LOW:
+            if (millis() - stateStart >= START_LOW_MS) {
+                edgeCount = 0;
+                captureStart = micros();
+                state = CAPTURING;
+                pinMode(pin, INPUT_PULLUP);
+                attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+            }
+            break;
+            
+        case CAPTURING:
+            if (edgeCount >= DHT_MAX_EDGES || micros() - captureStart >= CAPTURE_US) {
+                detachInterrupt(digitalPinToInterrupt(pin));
+                completed = completeRead();
+                state = IDLE;
+            }
+            break;
+    }
+    
+    return completed;
+}
+
+void IRAM_ATTR DHT11Sensor::onEdge(void* arg) {
+    DHT11Sensor* self = static_cast<DHT11Sensor*>(arg);
+    size_t n = self->edgeCount;
+    
+    if (n < DHT_MAX_EDGES) {
+        self->edges[n].timeUs = micros();
+        self->edges[n].level = digitalRead(self->pin);
+        self->edgeCount = n + 1;
+    }
+}
+
+bool DHT11Sensor::completeRead() {
+    DhtReading reading;
+    DhtDecodeResult result = decodeDht11(edges, edgeCount, reading);
+    
+    if (result != DHT_DECODE_OK) {
         #if ENABLE_DEBUG_LOGS
-        Serial.println("[DHT11] ❌ Read failed - NaN values");
+        Serial.printf("[DHT11] ❌ Read failed - decode error %d (%d edges)\n", 
+                      (int)result, (int)edgeCount);
+        if (errorCount == 0) {
+            Serial.println("[DHT11] Check wiring:");
+            Serial.println("  - VCC → 3.3V");
+            Serial.println("  - GND → GND");
+            Serial.println("  - DATA → GPIO 4");
+            Serial.println("  - Add 4.7-10kΩ pull-up resistor between DATA and VCC");
+        }
         #endif
+        errorCount++;
         dataValid = false;
         return false;
     }
     
+    float t = reading.temperature;
+    float h = reading.humidity;
+    
     // Validate ranges (DHT11 specs: 0-50°C, 20-90% RH)
     // Allow slightly wider range for tolerance
     if (t < -10 || t > 60 || h < 0 || h > 100) {
         #if ENABLE_DEBUG_LOGS
         Serial.printf("[DHT11] ⚠️  Out of range - T: %.1f°C, H: %.1f%%\n", t, h);
         #endif
+        errorCount++;
         dataValid = false;
         return false;
     }
@@ -89,7 +138,7 @@ float DHT11Sensor::getHeatIndex(bool fahrenheit) {
         return NAN;
     }
     
-    return dht.computeHeatIndex(temperature, humidity, fahrenheit);
+    return dhtHeatIndex(temperature, humidity, fahrenheit);
 }
 
 bool DHT11Sensor::isTemperatureAlert(float minTemp, float maxTemp) {
@@ -2,16 +2,24 @@
 #define DHT11_H
 
 #include <Arduino.h>
-#include <DHT.h>
+
+#include "dht11decode.h"
 
 /**
- * @brief DHT11 Temperature & Humidity Sensor Wrapper
+ * @brief DHT11 Temperature & Humidity Sensor Driver
  * 
  * Provides interface for:
  * - Temperature measurement (°C)
  * - Humidity measurement (%)
  * - Heat index calculation
  * - Alert threshold checking
+ * 
+ * Acquisition is a non-blocking state machine driven by update():
+ * - START_LOW: host holds the data line low for ~20 ms
+ * - CAPTURING: line released, a GPIO ISR timestamps every edge
+ * - complete: edges decoded by decodeDht11(), state back to IDLE
+ * 
+ * Interrupts stay enabled throughout, so WiFi/AsyncTCP are not stalled.
  */
 class DHT11Sensor {
 public:
@@ -25,17 +33,38 @@ public:
     /**
      * @brief Initialize DHT11 sensor
      * 
+     * Does not block: the first acquisition starts once the sensor has
+     * had READ_INTERVAL to stabilize.
+     * 
      * @return true if initialization successful
      */
     bool begin();
     
     /**
-     * @brief Read temperature and humidity
+     * @brief Start an acquisition if the sensor is idle and due
      * 
-     * @return true if read successful
+     * The result arrives asynchronously via update().
+     * 
+     * @return true if the last completed reading was valid
      */
     bool readSensor();
     
+    /**
+     * @brief Advance the acquisition state machine
+     * 
+     * Call every loop pass. Never blocks.
+     * 
+     * @return true if a valid reading completed during this call
+     */
+    bool update();
+    
+    /**
+     * @brief Check if an acquisition is in progress
+     * 
+     * The CPU must not sleep while busy, the capture ISR needs it.
+     */
+    bool isBusy() const { return state != IDLE; }
+    
     /**
      * @brief Get last temperature reading
      * 
@@ -82,17 +111,45 @@ public:
      * @return true if humidity outside safe range
      */
     bool isHumidityAlert(float minHumidity = 20.0, float maxHumidity = 80.0);
+    
+    /**
+     * @brief Number of failed acquisitions since boot
+     */
+    uint32_t getErrorCount() const { return errorCount; }
 
 private:
-    DHT dht;
+    enum State { IDLE, START_LOW, CAPTURING };
+    
     uint8_t pin;
     
     float temperature;
     float humidity;
     bool dataValid;
     
+    volatile State state;
     unsigned long lastReadTime;
+    unsigned long stateStart;     // millis() when START_LOW began
+    unsigned long captureStart;   // micros() when the line was released
+    uint32_t errorCount;
+    
+    DhtEdge edges[DHT_MAX_EDGES];
+    volatile size_t edgeCount;
+    
     static const unsigned long READ_INTERVAL = 2000; // DHT11 minimum 2 seconds
+    static const unsigned long START_LOW_MS = 20;    // Host start signal (>= 18 ms)
+    static const unsigned long CAPTURE_US = 8000;    // Full frame takes ~5 ms
+    
+    /**
+     * @brief Edge capture ISR
+     */
+    static void IRAM_ATTR onEdge(void* arg);
+    
+    /**
+     * @brief Decode captured edges and store the result
+     * 
+     * @return true if the reading was valid
+     */
+    bool completeRead();
 };
 
 #endif // DHT11_H
\ No newline at end of file
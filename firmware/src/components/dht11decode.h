@@ -0,0 +1,130 @@
+#ifndef DHT11DECODE_H
+#define DHT11DECODE_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One captured edge on the DHT11 data line
+ */
+struct DhtEdge {
+    uint32_t timeUs;  // Timestamp of the edge (µs, free-running)
+    uint8_t level;    // Line level after the edge (0 / 1)
+};
+
+/**
+ * @brief Decoded DHT11 measurement
+ */
+struct DhtReading {
+    float temperature;  // °C
+    float humidity;     // %
+};
+
+enum DhtDecodeResult {
+    DHT_DECODE_OK = 0,
+    DHT_DECODE_TOO_FEW_BITS,
+    DHT_DECODE_BAD_PULSE,
+    DHT_DECODE_CHECKSUM
+};
+
+// Response + 40 bits + end-of-frame, with margin for a release glitch
+#define DHT_MAX_EDGES 90
+
+// Bit timing: each bit is ~50 µs low followed by 26-28 µs (0) or 70 µs (1) high
+#define DHT_BIT_ONE_MIN_US 48
+#define DHT_PULSE_MIN_US 10
+#define DHT_PULSE_MAX_US 100
+
+/**
+ * @brief Decode a captured DHT11 pulse train
+ *
+ * Pure function over recorded edges, so it can be exercised on the host
+ * with recorded waveforms. The last 40 complete high pulses are the data
+ * bits; anything before them (the 80 µs response pulse) is ignored.
+ *
+ * @param edges Captured edges in time order
+ * @param count Number of edges
+ * @param out Decoded reading (only written on success)
+ * @return DHT_DECODE_OK or the reason the frame was rejected
+ */
+inline DhtDecodeResult decodeDht11(const DhtEdge* edges, size_t count, DhtReading& out) {
+    // Collect widths of complete high pulses (rising → falling), keep the last 40
+    uint32_t widths[40];
+    size_t found = 0;
+
+    for (size_t i = 0; i + 1 < count; i++) {
+        if (edges[i].level == 1 && edges[i + 1].level == 0) {
+            uint32_t width = edges[i + 1].timeUs - edges[i].timeUs;
+            if (found < 40) {
+                widths[found] = width;
+            } else {
+                for (size_t k = 1; k < 40; k++) widths[k - 1] = widths[k];
+                widths[39] = width;
+            }
+            found++;
+        }
+    }
+
+    if (found < 40) {
+        return DHT_DECODE_TOO_FEW_BITS;
+    }
+
+    uint8_t data[5] = {0, 0, 0, 0, 0};
+    for (size_t bit = 0; bit < 40; bit++) {
+        uint32_t width = widths[bit];
+        if (width < DHT_PULSE_MIN_US || width > DHT_PULSE_MAX_US) {
+            return DHT_DECODE_BAD_PULSE;
+        }
+        data[bit / 8] <<= 1;
+        if (width >= DHT_BIT_ONE_MIN_US) {
+            data[bit / 8] |= 1;
+        }
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+        return DHT_DECODE_CHECKSUM;
+    }
+
+    float t = data[2];
+    if (data[3] & 0x80) {
+        t = -1 - t;
+    }
+    t += (data[3] & 0x0F) * 0.1f;
+
+    out.temperature = t;
+    out.humidity = data[0] + data[1] * 0.1f;
+    return DHT_DECODE_OK;
+}
+
+/**
+ * @brief Heat index (feels-like temperature), NOAA Rothfusz regression
+ *
+ * @param tempC Temperature in °C
+ * @param humidity Relative humidity (%)
+ * @param fahrenheit Return in Fahrenheit instead of Celsius
+ */
+inline float dhtHeatIndex(float tempC, float humidity, bool fahrenheit) {
+    float t = tempC * 1.8f + 32.0f;
+    float hi = 0.5f * (t + 61.0f + ((t - 68.0f) * 1.2f) + (humidity * 0.094f));
+
+    if (hi > 79.0f) {
+        hi = -42.379f + 2.04901523f * t + 10.14333127f * humidity +
+             -0.22475541f * t * humidity +
+             -0.00683783f * t * t +
+             -0.05481717f * humidity * humidity +
+             0.00122874f * t * t * humidity +
+             0.00085282f * t * humidity * humidity +
+             -0.00000199f * t * t * humidity * humidity;
+
+        if (humidity < 13.0f && t >= 80.0f && t <= 112.0f) {
+            hi -= ((13.0f - humidity) * 0.25f) * sqrtf((17.0f - fabsf(t - 95.0f)) * 0.05882f);
+        } else if (humidity > 85.0f && t >= 80.0f && t <= 87.0f) {
+            hi += ((humidity - 85.0f) * 0.1f) * ((87.0f - t) * 0.2f);
+        }
+    }
+
+    return fahrenheit ? hi : (hi - 32.0f) / 1.8f;
+}
+
+#endif // DHT11DECODE_H
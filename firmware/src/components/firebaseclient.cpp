@@ -0,0 +1,376 @@
+#include "firebaseclient.h"
+#include "config.h"
+
+FirebaseClient::FirebaseClient(const char* databaseUrl, const char* authToken)
+    : host(databaseUrl), authToken(authToken), requestMethod(""), requestStart(0),
+      requestReused(false), requestFailed(false), segmentUsed(0) {
+    head[0] = '\0';
+    responseEtag[0] = '\0';
+
+    // Accept "https://host/" as well as a bare host
+    int scheme = host.indexOf("://");
+    if (scheme >= 0) {
+        host = host.substring(scheme + 3);
+    }
+    while (host.endsWith("/")) {
+        host.remove(host.length() - 1);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+}
+
+void FirebaseClient::begin() {
+    client.setInsecure();
+}
+
+bool FirebaseClient::put(const String& path, const String& json) {
+    int status = request("PUT", path, &json, nullptr);
+    return status >= 200 && status < 300;
+}
+
+bool FirebaseClient::post(const String& path, const String& json) {
+    int status = request("POST", path, &json, nullptr);
+    return status >= 200 && status < 300;
+}
+
+bool FirebaseClient::patch(const String& path, const String& json) {
+    int status = request("PATCH", path, &json, nullptr);
+    return status >= 200 && status < 300;
+}
+
+bool FirebaseClient::get(const String& path, String& response) {
+    int status = request("GET", path, nullptr, &response);
+    return status >= 200 && status < 300;
+}
+
+bool FirebaseClient::getIfChanged(const String& path, String& etag, String& response, bool& changed) {
+    static const char ETAG_HEADERS[] = "X-Firebase-ETag: true\r\nIf-None-Match: %s\r\n";
+    char headers[sizeof(ETAG_HEADERS) + sizeof(responseEtag)];
+    int headersLength = etag.length() > 0
+        ? snprintf(headers, sizeof(headers), ETAG_HEADERS, etag.c_str())
+        : snprintf(headers, sizeof(headers), "X-Firebase-ETag: true\r\n");
+    if (headersLength < 0 || headersLength >= (int)sizeof(headers)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[FIREBASE] ❌ ETag over %u bytes\n", (unsigned)sizeof(responseEtag) - 1);
+        #endif
+        return false;
+    }
+
+    String body;
+    int status = request("GET", path, nullptr, &body, headers);
+    if (status == 304) {
+        changed = false;
+        return true;
+    }
+    if (status < 200 || status >= 300) {
+        return false;
+    }
+
+    changed = (etag.length() == 0 || etag != responseEtag);
+    if (changed) {
+        etag = responseEtag;
+        response = body;
+    }
+    return true;
+}
+
+void FirebaseClient::stop() {
+    client.stop();
+}
+
+int FirebaseClient::request(const char* method, const String& path, const String* body, String* response,
+                            const char* headers) {
+    int status = attempt(method, path, body, response, headers);
+
+    // The server may have closed an idle keep-alive connection, retry once
+    // fresh. Only when no response started, so a write is never applied twice.
+    if (status == NO_RESPONSE && requestReused) {
+        client.stop();
+        status = attempt(method, path, body, response, headers);
+    }
+
+    return status;
+}
+
+int FirebaseClient::attempt(const char* method, const String& path, const String* body, String* response,
+                            const char* headers) {
+    if (beginRequest(method, path.c_str(), body ? (int)body->length() : -1, headers) && body) {
+        write(body->c_str(), body->length());
+    }
+    return endRequest(response);
+}
+
+bool FirebaseClient::beginRequest(const char* method, const char* path, int contentLength, const char* headers) {
+    requestMethod = method;
+    requestStart = millis();
+    requestReused = client.connected();
+    requestFailed = true;
+
+    if (host.length() == 0 || !ensureConnected()) {
+        return false;
+    }
+
+    // 48 bytes of fixed text, up to 11 digits and the CRLF
+    char length[64] = "";
+    if (contentLength >= 0) {
+        int lengthBytes = snprintf(length, sizeof(length), "Content-Type: application/json\r\nContent-Length: %d\r\n",
+                                   contentLength);
+        if (lengthBytes < 0 || lengthBytes >= (int)sizeof(length)) {
+            return false;
+        }
+    }
+    int headLength = snprintf(head, sizeof(head), "%s /%s.json%s%s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n%s%s\r\n",
+                              method, path, authToken.length() > 0 ? "?auth=" : "", authToken.c_str(),
+                              host.c_str(), headers ? headers : "", length);
+    if (headLength < 0 || headLength >= (int)sizeof(head)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[FIREBASE] ❌ Request head over %u bytes (FIREBASE_REQUEST_HEAD_BYTES)\n", (unsigned)sizeof(head));
+        #endif
+        return false;
+    }
+
+    segmentUsed = 0;
+    if (!send(head, headLength)) {
+        client.stop();
+        return false;
+    }
+
+    requestFailed = false;
+    return true;
+}
+
+bool FirebaseClient::write(const char* data, size_t length) {
+    if (requestFailed) {
+        return false;
+    }
+
+    if (!send(data, length)) {
+        client.stop();
+        requestFailed = true;
+        return false;
+    }
+    return true;
+}
+
+bool FirebaseClient::send(const char* data, size_t length) {
+    while (length > 0) {
+        // Whole segments straight from the caller's memory
+        if (segmentUsed == 0 && length >= sizeof(segment)) {
+            size_t direct = length - length % sizeof(segment);
+            if (client.write((const uint8_t*)data, direct) != direct) {
+                return false;
+            }
+            data += direct;
+            length -= direct;
+            continue;
+        }
+
+        size_t room = sizeof(segment) - segmentUsed;
+        size_t take = length < room ? length : room;
+        memcpy(segment + segmentUsed, data, take);
+        segmentUsed += take;
+        data += take;
+        length -= take;
+        if (segmentUsed == sizeof(segment) && !sendSegment()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FirebaseClient::sendSegment() {
+    size_t length = segmentUsed;
+    segmentUsed = 0;
+    return length == 0 || client.write((const uint8_t*)segment, length) == length;
+}
+
+int FirebaseClient::endRequest(String* response) {
+    if (!requestFailed && !sendSegment()) {
+        client.stop();
+        requestFailed = true;
+    }
+    int status = requestFailed ? NO_RESPONSE : readResponse(response);
+    requestFailed = true;
+
+    uint32_t latency = millis() - requestStart;
+    stats.requests++;
+    stats.lastLatencyMs = latency;
+    stats.totalLatencyMs += latency;
+    if (latency > stats.maxLatencyMs) {
+        stats.maxLatencyMs = latency;
+    }
+
+    if ((status < 200 || status >= 300) && status != 304) {
+        stats.failures++;
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[FIREBASE] ⚠️  %s failed (%d)\n", requestMethod, status);
+        #endif
+    }
+
+    return status;
+}
+
+int FirebaseClient::readResponse(String* response) {
+    uint32_t deadline = millis() + TIMEOUT_MS;
+    responseEtag[0] = '\0';
+
+    // Status line: HTTP/1.1 200 OK
+    char line[LINE_BYTES];
+    if (!readLine(line, sizeof(line), deadline) || strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12) {
+        client.stop();
+        return NO_RESPONSE;
+    }
+    int status = atoi(line + 9);
+
+    // Headers (204 / 304 never carry a body)
+    int contentLength = (status == 204 || status == 304) ? 0 : -1;
+    bool chunked = false;
+    bool closeAfter = false;
+    while (true) {
+        if (!readLine(line, sizeof(line), deadline)) {
+            client.stop();
+            return BROKEN_RESPONSE;
+        }
+        if (line[0] == '\0') {
+            break;
+        }
+
+        // Header names are case insensitive, ETag values are not
+        if (strncasecmp(line, "etag:", 5) == 0) {
+            const char* value = line + 5;
+            while (*value == ' ') value++;
+            size_t length = strlen(value);
+            while (length > 0 && value[length - 1] == ' ') length--;
+            if (length >= sizeof(responseEtag)) length = sizeof(responseEtag) - 1;
+            memcpy(responseEtag, value, length);
+            responseEtag[length] = '\0';
+        } else if (strncasecmp(line, "content-length:", 15) == 0) {
+            contentLength = atoi(line + 15);
+        } else if (strncasecmp(line, "transfer-encoding:", 18) == 0 && strcasestr(line + 18, "chunked")) {
+            chunked = true;
+        } else if (strncasecmp(line, "connection:", 11) == 0 && strcasestr(line + 11, "close")) {
+            closeAfter = true;
+        }
+    }
+
+    // Body must be consumed completely or the next response is misaligned
+    if (!readBody(response, contentLength, chunked, deadline)) {
+        client.stop();
+        return BROKEN_RESPONSE;
+    }
+
+    if (closeAfter || (contentLength < 0 && !chunked)) {
+        client.stop();
+    }
+
+    return status;
+}
+
+bool FirebaseClient::ensureConnected() {
+    if (client.connected()) {
+        return true;
+    }
+
+    client.stop();
+    stats.handshakes++;
+
+    if (!client.connect(host.c_str(), PORT)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[FIREBASE] ❌ TLS connect to %s failed\n", host.c_str());
+        #endif
+        return false;
+    }
+
+    #if ENABLE_DEBUG_LOGS
+    Serial.printf("[FIREBASE] 🔒 TLS connection #%lu opened\n", (unsigned long)stats.handshakes);
+    #endif
+
+    return true;
+}
+
+bool FirebaseClient::readLine(char* line, size_t capacity, uint32_t deadline) {
+    size_t length = 0;
+    line[0] = '\0';
+    while ((int32_t)(deadline - millis()) > 0) {
+        if (!client.available()) {
+            if (!client.connected()) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+
+        char c = client.read();
+        if (c == '\n') {
+            return true;
+        }
+        if (c != '\r' && length + 1 < capacity) {  // The rest of an overlong line is skipped
+            line[length++] = c;
+            line[length] = '\0';
+        }
+    }
+    return false;
+}
+
+bool FirebaseClient::readBody(String* response, int contentLength, bool chunked, uint32_t deadline) {
+    if (response) {
+        *response = "";
+    }
+
+    if (!chunked) {
+        return readBytes(response, contentLength, deadline);
+    }
+
+    char line[LINE_BYTES];
+    while (true) {
+        if (!readLine(line, sizeof(line), deadline)) {
+            return false;
+        }
+        int size = (int)strtol(line, nullptr, 16);
+        if (size == 0) {
+            return readLine(line, sizeof(line), deadline);  // Trailing CRLF
+        }
+        if (!readBytes(response, size, deadline)) {
+            return false;
+        }
+        readLine(line, sizeof(line), deadline);  // CRLF after the chunk
+    }
+}
+
+bool FirebaseClient::readBytes(String* response, int contentLength, uint32_t deadline) {
+    // Without a length the body runs until the server closes
+    int remaining = contentLength;
+    if (response && remaining > 0) {
+        response->reserve(response->length() + remaining);
+    }
+
+    while (remaining != 0 && (int32_t)(deadline - millis()) > 0) {
+        int available = client.available();
+        if (available <= 0) {
+            if (!client.connected()) {
+                return contentLength < 0;
+            }
+            delay(1);
+            continue;
+        }
+
+        char buffer[128];
+        int want = available < (int)sizeof(buffer) ? available : (int)sizeof(buffer);
+        if (remaining > 0 && want > remaining) {
+            want = remaining;
+        }
+
+        int got = client.read((uint8_t*)buffer, want);
+        if (got <= 0) {
+            continue;
+        }
+        if (response) {
+            response->concat(buffer, got);
+        }
+        if (remaining > 0) {
+            remaining -= got;
+        }
+    }
+
+    return remaining == 0 || contentLength < 0;
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#ifndef FIREBASECLIENT_H
+#define FIREBASECLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#include "config.h"
+
+/**
+ * @brief Firebase Realtime Database REST client over one kept-alive TLS connection
+ *
+ * Speaks HTTP/1.1 directly on a single WiFiClientSecure, so consecutive
+ * requests reuse the same TLS session instead of paying a handshake
+ * each. The connection is only re-established when it was closed by
+ * the server or a request failed on it; a request that fails on a
+ * reused connection is retried once on a fresh one.
+ *
+ * Request heads and response headers go through fixed buffers, so a
+ * request without a response body does not touch the heap. Outgoing
+ * bytes (head and body) are gathered into one segment buffer and reach
+ * TLS in records of FIREBASE_SEND_SEGMENT_BYTES, not one per write().
+ *
+ * Tracks handshakes and per-request latency for diagnostics.
+ */
+class FirebaseClient {
+public:
+    struct Stats {
+        uint32_t requests;        // Requests sent (retries included)
+        uint32_t failures;        // Requests without a 2xx response
+        uint32_t handshakes;      // TLS connections opened
+        uint32_t lastLatencyMs;   // Send → response body read
+        uint32_t maxLatencyMs;
+        uint32_t totalLatencyMs;
+    };
+
+    /**
+     * @brief Construct client
+     *
+     * @param databaseUrl Database host, with or without https:// prefix
+     * @param authToken Database secret / ID token ("" for none)
+     */
+    FirebaseClient(const char* databaseUrl, const char* authToken);
+
+    /**
+     * @brief Configure TLS (no connection is opened until the first request)
+     */
+    void begin();
+
+    bool put(const String& path, const String& json);
+    bool post(const String& path, const String& json);
+    bool patch(const String& path, const String& json);
+    bool get(const String& path, String& response);
+
+    /**
+     * @brief GET that skips unchanged data (ETag-conditional)
+     *
+     * Asks for the ETag of path and sends the last one seen as
+     * If-None-Match. A 304, or a 200 carrying the same ETag, leaves
+     * response untouched and changed false.
+     *
+     * @param etag Last ETag seen ("" for none), updated on a change
+     * @param response Filled with the response body when changed
+     * @param changed Set true if response holds new data
+     * @return false if the request failed
+     */
+    bool getIfChanged(const String& path, String& etag, String& response, bool& changed);
+
+    /**
+     * @brief Start a request whose body is written in pieces
+     *
+     * Follow with write() calls totalling contentLength bytes, then
+     * endRequest(). Lets a large body go out without building it in RAM.
+     * Not retried automatically, the caller still owns the body.
+     *
+     * @param method HTTP method
+     * @param path Database path (without .json)
+     * @param contentLength Body size in bytes (-1 for no body)
+     * @param headers Extra header lines, each ending in \r\n (nullptr for none)
+     * @return false if the connection or request head failed
+     */
+    bool beginRequest(const char* method, const char* path, int contentLength, const char* headers = nullptr);
+
+    /**
+     * @brief Send part of the request body
+     *
+     * Buffered, small pieces are cheap. The last segment goes out in
+     * endRequest().
+     */
+    bool write(const char* data, size_t length);
+
+    /**
+     * @brief Finish the request and read the full response
+     *
+     * Always call after beginRequest(), even if it failed.
+     *
+     * @param response Filled with the response body (nullptr to discard)
+     * @return HTTP status code, NO_RESPONSE or BROKEN_RESPONSE
+     */
+    int endRequest(String* response);
+
+    /**
+     * @brief Close the connection (e.g. on WiFi loss)
+     */
+    void stop();
+
+    bool isConnected() { return client.connected(); }
+    const String& getHost() const { return host; }
+    const String& getAuthToken() const { return authToken; }
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief Mean request latency (ms)
+     */
+    uint32_t getAverageLatencyMs() const {
+        return stats.requests ? stats.totalLatencyMs / stats.requests : 0;
+    }
+
+private:
+    WiFiClientSecure client;
+    String host;
+    String authToken;
+    Stats stats;
+
+    // Request in progress
+    const char* requestMethod;
+    uint32_t requestStart;
+    bool requestReused;
+    bool requestFailed;
+    char head[FIREBASE_REQUEST_HEAD_BYTES];
+    char segment[FIREBASE_SEND_SEGMENT_BYTES];
+    size_t segmentUsed;
+    char responseEtag[64];
+
+    static const uint16_t PORT = 443;
+    static const uint32_t TIMEOUT_MS = 10000;
+    static const size_t LINE_BYTES = 256;    // Longer response header lines are cut short
+    
+    // endRequest() results below 0
+    static const int NO_RESPONSE = -1;       // Connect / send failed or no status line
+    static const int BROKEN_RESPONSE = -2;   // Response started but was cut off
+
+    /**
+     * @brief Send one request and read the full response
+     *
+     * @param method HTTP method
+     * @param path Database path (without .json)
+     * @param body Request body (nullptr for none)
+     * @param response Filled with the response body (nullptr to discard)
+     * @param headers Extra header lines (nullptr for none)
+     * @return HTTP status code, NO_RESPONSE or BROKEN_RESPONSE
+     */
+    int request(const char* method, const String& path, const String* body, String* response,
+                const char* headers = nullptr);
+
+    /**
+     * @brief One attempt on the current (or a new) connection
+     */
+    int attempt(const char* method, const String& path, const String* body, String* response,
+                const char* headers);
+
+    bool ensureConnected();
+    bool send(const char* data, size_t length);
+    bool sendSegment();
+    int readResponse(String* response);
+    bool readLine(char* line, size_t capacity, uint32_t deadline);
+    bool readBody(String* response, int contentLength, bool chunked, uint32_t deadline);
+    bool readBytes(String* response, int contentLength, uint32_t deadline);
+};
+
+#endif // FIREBASECLIENT_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef FIREBASETRANSPORT_H
+#define FIREBASETRANSPORT_H
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "configsubscription.h"
+#include "deviceconfig.h"
+#include "firebaseclient.h"
+
+/**
+ * @brief Telemetry transport over the Firebase REST API
+ *
+ * - writes: one streamed PATCH of the batch on the device root, over
+ *   the kept-alive FirebaseClient connection
+ * - config: config/ followed by ConfigSubscription (stream, polled while
+ *   the stream is down)
+ *
+ * Paths are relative to the device root (e.g. "info").
+ */
+class FirebaseTransport {
+public:
+    explicit FirebaseTransport(DeviceConfig& config)
+        : client(FIREBASE_DATABASE_URL, FIREBASE_AUTH_TOKEN), subscription(client, config) {}
+
+    void begin(const String& deviceRoot) {
+        root = deviceRoot;
+        client.begin();
+        subscription.begin(root + "/config");
+    }
+
+    bool get(const String& path, String& json) { return client.get(root + "/" + path, json); }
+    bool put(const String& path, const String& json) { return client.put(root + "/" + path, json); }
+
+    /**
+     * @brief Follow config changes, call every network task pass while WiFi is up
+     */
+    void service() { subscription.service(); }
+
+    /**
+     * @brief Close all connections (e.g. on WiFi loss)
+     */
+    void stop() {
+        client.stop();
+        subscription.stop();
+    }
+
+    // UploadBatcher transport
+    bool beginPatch(size_t contentLength) {
+        return client.beginRequest("PATCH", root.c_str(), (int)contentLength);
+    }
+
+    bool write(const char* data, size_t length) { return client.write(data, length); }
+
+    bool endPatch() {
+        int status = client.endRequest(nullptr);
+        return status >= 200 && status < 300;
+    }
+
+    const FirebaseClient::Stats& getStats() const { return client.getStats(); }
+    uint32_t getAverageLatencyMs() const { return client.getAverageLatencyMs(); }
+    const ConfigSubscription& getSubscription() const { return subscription; }
+
+private:
+    FirebaseClient client;          // One kept-alive TLS connection
+    ConfigSubscription subscription;
+    String root;
+};
+
+#endif // FIREBASETRANSPORT_H
\ No newline at end of file
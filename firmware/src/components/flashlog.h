@@ -0,0 +1,56 @@
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include "recordlog.h"
+
+// Record types stored in the offline log
+enum LoggedRecordType : uint8_t {
+    RECORD_SAMPLE = 1,   // history entry
+    RECORD_ALERT = 2,    // alerts entry (pushed under a new key)
+    RECORD_ALERT_NODE = 3, // alerts/<key> node: PUSH_ID_LENGTH key, then JSON
+    RECORD_HISTORY_BLOCK = 4, // historyBlocks entry (pushed under a new key)
+    RECORD_HISTORY_BLOCK_UPTIME = 5  // Encoded block from before the first sync: u32 boot id, then the block
+};
+
+/**
+ * @brief RecordLog flash backend on a raw data partition
+ *
+ * Used without a file system, the partition is only ever erased and
+ * written through the log.
+ */
+class EspPartitionFlash {
+public:
+    EspPartitionFlash() : partition(nullptr) {}
+
+    /**
+     * @brief Look up the data partition by label (partitions.csv)
+     */
+    bool begin(const char* label) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        return partition != nullptr;
+    }
+
+    uint32_t size() { return partition ? partition->size : 0; }
+
+    bool read(uint32_t offset, void* data, size_t length) {
+        return esp_partition_read(partition, offset, data, length) == ESP_OK;
+    }
+
+    bool write(uint32_t offset, const void* data, size_t length) {
+        return esp_partition_write(partition, offset, data, length) == ESP_OK;
+    }
+
+    bool eraseSector(uint32_t offset) {
+        return esp_partition_erase_range(partition, offset, RecordLog<EspPartitionFlash>::SECTOR_SIZE) == ESP_OK;
+    }
+
+private:
+    const esp_partition_t* partition;
+};
+
+typedef RecordLog<EspPartitionFlash> FlashRecordLog;
+
+#endif // FLASHLOG_H
\ No newline at end of file
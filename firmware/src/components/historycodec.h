@@ -0,0 +1,556 @@
+#ifndef HISTORYCODEC_H
+#define HISTORYCODEC_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define HISTORY_CODEC_VERSION 1
+
+/**
+ * @brief One numeric history column
+ */
+struct HistoryColumn {
+    const char* name;       // Payload key the value came from
+    uint8_t decimals;       // Fixed-point resolution (10^-decimals)
+};
+
+/**
+ * @brief Bounds-checked byte writer / reader for the block format
+ */
+class HistoryWire {
+public:
+    class Writer {
+    public:
+        Writer(uint8_t* out, size_t capacity) : out(out), capacity(capacity), length(0), overflow(false) {}
+
+        void byte(uint8_t value) {
+            if (length < capacity) {
+                out[length++] = value;
+            } else {
+                overflow = true;
+            }
+        }
+
+        void bytes(const void* data, size_t count) {
+            if (length + count <= capacity) {
+                memcpy(out + length, data, count);
+                length += count;
+            } else {
+                overflow = true;
+            }
+        }
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                byte((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            byte((uint8_t)value);
+        }
+
+        void zigzag(int64_t value) {
+            varint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+        }
+
+        size_t size() const { return overflow ? 0 : length; }
+
+    private:
+        uint8_t* out;
+        size_t capacity;
+        size_t length;
+        bool overflow;
+    };
+
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t length) : data(data), length(length), offset(0), failed(false) {}
+
+        uint8_t byte() {
+            if (offset >= length) {
+                failed = true;
+                return 0;
+            }
+            return data[offset++];
+        }
+
+        const uint8_t* skip(size_t count) {
+            if (count > length - offset) {
+                failed = true;
+                return nullptr;
+            }
+            const uint8_t* start = data + offset;
+            offset += count;
+            return start;
+        }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (uint8_t shift = 0; shift < 64; shift += 7) {
+                uint8_t b = byte();
+                value |= (uint64_t)(b & 0x7F) << shift;
+                if (!(b & 0x80) || failed) {
+                    return value;
+                }
+            }
+            failed = true;
+            return 0;
+        }
+
+        int64_t zigzag() {
+            uint64_t raw = varint();
+            return (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+        }
+
+        bool ok() const { return !failed; }
+        bool atEnd() const { return offset == length; }
+        size_t position() const { return offset; }
+
+    private:
+        const uint8_t* data;
+        size_t length;
+        size_t offset;
+        bool failed;
+    };
+
+    static int64_t scale(uint8_t decimals) {
+        static const int64_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+        return POW10[decimals < 6 ? decimals : 6];
+    }
+};
+
+/**
+ * @brief Columnar encoder for a block of telemetry samples
+ *
+ * Samples are added row by row and written column by column, so each
+ * column is a run of similar values:
+ * - timestamps: first value, then zigzag varint delta-of-deltas
+ *   (a steady sample interval costs one byte per sample)
+ * - numeric columns: fixed point at the column's resolution, zigzag
+ *   varint deltas (a flat reading costs one byte); missing (NaN)
+ *   values are left out behind a presence bitmap
+ * - string columns: per-block dictionary plus (index, run length)
+ *   pairs, so a repeated SSID / orientation costs ~2 bytes per block
+ *
+ * Block layout (all integers varint unless noted):
+ *   u8 version, schema id, sample count,
+ *   numeric column count, u8 decimals per column, string column count,
+ *   timestamps, numeric columns (u8 0 = all present | 1 + bitmap,
+ *   then deltas of the present values), string columns (dictionary
+ *   size, [length, bytes]..., [index, run]...)
+ *
+ * Column names are not repeated in every block; they are identified by
+ * the schema id (see HistoryBlockDecoder).
+ *
+ * @tparam MaxSamples Samples held before the block must be encoded
+ * @tparam Numeric Numeric columns per sample
+ * @tparam Strings String columns per sample
+ * @tparam MaxString Longest string kept (longer ones are cut)
+ */
+template <size_t MaxSamples, size_t Numeric, size_t Strings, size_t MaxString = 32>
+class HistoryBlockEncoder {
+public:
+    HistoryBlockEncoder(const HistoryColumn* columns, uint16_t schemaId)
+        : columns(columns), schemaId(schemaId) {
+        clear();
+    }
+
+    void clear() {
+        count = 0;
+        memset(dictionarySize, 0, sizeof(dictionarySize));
+    }
+
+    /**
+     * @brief Append one sample
+     *
+     * @param values Numeric columns (NaN = missing)
+     * @param strings String columns (nullptr = "")
+     * @return false if the block is full
+     */
+    bool add(uint64_t timestampMs, const float* values, const char* const* strings) {
+        if (count >= MaxSamples) {
+            return false;
+        }
+
+        timestamps[count] = timestampMs;
+        for (size_t c = 0; c < Numeric; c++) {
+            float v = values[c];
+            present[count][c] = (v == v);
+            fixed[count][c] = present[count][c] ? toFixed(v, columns[c].decimals) : 0;
+        }
+        for (size_t s = 0; s < Strings; s++) {
+            indices[count][s] = intern(s, strings && strings[s] ? strings[s] : "");
+        }
+
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Encode the first samples of the block
+     *
+     * @param out Output buffer
+     * @param capacity Output buffer size
+     * @param samples Samples to encode (≤ getCount())
+     * @return Bytes written, 0 if they do not fit
+     */
+    size_t encode(uint8_t* out, size_t capacity, size_t samples) const {
+        if (samples > count) {
+            samples = count;
+        }
+
+        HistoryWire::Writer w(out, capacity);
+        w.byte(HISTORY_CODEC_VERSION);
+        w.varint(schemaId);
+        w.varint(samples);
+        w.varint(Numeric);
+        for (size_t c = 0; c < Numeric; c++) {
+            w.byte(columns[c].decimals);
+        }
+        w.varint(Strings);
+
+        // Timestamps: delta of deltas
+        int64_t previousDelta = 0;
+        for (size_t i = 0; i < samples; i++) {
+            if (i == 0) {
+                w.varint(timestamps[0]);
+                continue;
+            }
+            int64_t delta = (int64_t)(timestamps[i] - timestamps[i - 1]);
+            w.zigzag(delta - previousDelta);
+            previousDelta = delta;
+        }
+
+        for (size_t c = 0; c < Numeric; c++) {
+            bool allPresent = true;
+            for (size_t i = 0; i < samples && allPresent; i++) {
+                allPresent = present[i][c];
+            }
+
+            w.byte(allPresent ? 0 : 1);
+            if (!allPresent) {
+                for (size_t i = 0; i < samples; i += 8) {
+                    uint8_t bits = 0;
+                    for (size_t b = 0; b < 8 && i + b < samples; b++) {
+                        bits |= (uint8_t)(present[i + b][c] ? 1 : 0) << b;
+                    }
+                    w.byte(bits);
+                }
+            }
+
+            int64_t previous = 0;
+            for (size_t i = 0; i < samples; i++) {
+                if (present[i][c]) {
+                    w.zigzag((int64_t)fixed[i][c] - previous);
+                    previous = fixed[i][c];
+                }
+            }
+        }
+
+        for (size_t s = 0; s < Strings; s++) {
+            // Only the entries the encoded samples use (a partial block may
+            // not reach the later ones), renumbered in dictionary order
+            bool used[MaxSamples] = {};
+            for (size_t i = 0; i < samples; i++) {
+                used[indices[i][s]] = true;
+            }
+            uint8_t remap[MaxSamples];
+            uint8_t entries = 0;
+            for (size_t d = 0; d < dictionarySize[s]; d++) {
+                if (used[d]) {
+                    remap[d] = entries++;
+                }
+            }
+
+            w.varint(entries);
+            for (size_t d = 0; d < dictionarySize[s]; d++) {
+                if (used[d]) {
+                    size_t length = strlen(dictionary[s][d]);
+                    w.varint(length);
+                    w.bytes(dictionary[s][d], length);
+                }
+            }
+
+            for (size_t i = 0; i < samples;) {
+                size_t run = 1;
+                while (i + run < samples && indices[i + run][s] == indices[i][s]) {
+                    run++;
+                }
+                w.varint(remap[indices[i][s]]);
+                w.varint(run);
+                i += run;
+            }
+        }
+
+        return w.size();
+    }
+
+    /**
+     * @brief Drop the first samples (after they were encoded and sent)
+     */
+    void consume(size_t samples) {
+        if (samples >= count) {
+            clear();
+            return;
+        }
+
+        size_t remaining = count - samples;
+        memmove(timestamps, timestamps + samples, remaining * sizeof(timestamps[0]));
+        memmove(fixed, fixed + samples, remaining * sizeof(fixed[0]));
+        memmove(present, present + samples, remaining * sizeof(present[0]));
+        memmove(indices, indices + samples, remaining * sizeof(indices[0]));
+        count = remaining;
+
+        // Compact each dictionary down to the entries still referenced
+        for (size_t s = 0; s < Strings; s++) {
+            uint8_t remap[MaxSamples];
+            uint8_t kept = 0;
+            for (size_t d = 0; d < dictionarySize[s]; d++) {
+                bool used = false;
+                for (size_t i = 0; i < count && !used; i++) {
+                    used = (indices[i][s] == d);
+                }
+                if (used) {
+                    if (kept != d) {
+                        memcpy(dictionary[s][kept], dictionary[s][d], sizeof(dictionary[s][d]));
+                    }
+                    remap[d] = kept++;
+                }
+            }
+            dictionarySize[s] = kept;
+            for (size_t i = 0; i < count; i++) {
+                indices[i][s] = remap[indices[i][s]];
+            }
+        }
+    }
+
+    /**
+     * @brief Re-date the held samples
+     *
+     * @param convert uint64_t ms -> uint64_t ms, e.g. a monotonic stamp
+     *        to Unix time once the clock is synced
+     */
+    template <typename Convert>
+    void retime(Convert convert) {
+        for (size_t i = 0; i < count; i++) {
+            timestamps[i] = convert(timestamps[i]);
+        }
+    }
+
+    size_t getCount() const { return count; }
+    bool isFull() const { return count >= MaxSamples; }
+    uint64_t getTimestamp(size_t sample) const { return timestamps[sample]; }
+
+private:
+    const HistoryColumn* columns;
+    uint16_t schemaId;
+    size_t count;
+
+    uint64_t timestamps[MaxSamples];
+    int32_t fixed[MaxSamples][Numeric];
+    bool present[MaxSamples][Numeric];
+    uint8_t indices[MaxSamples][Strings];
+    // Each sample adds at most one entry, so MaxSamples entries always suffice
+    char dictionary[Strings][MaxSamples][MaxString + 1];
+    uint8_t dictionarySize[Strings];
+
+    static int32_t toFixed(float value, uint8_t decimals) {
+        double scaled = (double)value * (double)HistoryWire::scale(decimals);
+        if (scaled > 2147483647.0) return INT32_MAX;
+        if (scaled < -2147483647.0) return -INT32_MAX;
+        return (int32_t)llround(scaled);
+    }
+
+    uint8_t intern(size_t column, const char* text) {
+        char* entry;
+        for (uint8_t d = 0; d < dictionarySize[column]; d++) {
+            entry = dictionary[column][d];
+            if (strncmp(entry, text, MaxString) == 0) {
+                return d;
+            }
+        }
+
+        uint8_t d = dictionarySize[column]++;
+        entry = dictionary[column][d];
+        strncpy(entry, text, MaxString);
+        entry[MaxString] = '\0';
+        return d;
+    }
+};
+
+/**
+ * @brief Decoder for blocks written by HistoryBlockEncoder
+ *
+ * Allocation free: the block is walked once, column by column, and
+ * handed to a Visitor providing:
+ * - void onBlock(uint16_t schemaId, uint32_t samples, size_t numeric, size_t strings)
+ * - void onTimestamp(uint32_t sample, uint64_t timestampMs)
+ * - void onValue(size_t column, uint32_t sample, double value, bool present)
+ * - void onString(size_t column, uint32_t sample, const char* text, size_t length)
+ *
+ * Column names come from the schema the id refers to (the same
+ * HistoryColumn table the device encoded with).
+ */
+class HistoryBlockDecoder {
+public:
+    static const uint32_t MAX_SAMPLES = 65535;
+
+    /**
+     * @return false if the block is malformed (the visitor may have
+     *         seen part of it)
+     */
+    template <typename Visitor>
+    static bool decode(const uint8_t* data, size_t length, Visitor& visitor) {
+        HistoryWire::Reader r(data, length);
+        if (r.byte() != HISTORY_CODEC_VERSION) {
+            return false;
+        }
+
+        uint16_t schemaId = (uint16_t)r.varint();
+        uint64_t samples = r.varint();
+        uint64_t numeric = r.varint();
+        if (!r.ok() || samples > MAX_SAMPLES || numeric > 255) {
+            return false;
+        }
+        const uint8_t* decimals = r.skip((size_t)numeric);
+        uint64_t strings = r.varint();
+        if (!r.ok() || strings > 255) {
+            return false;
+        }
+
+        visitor.onBlock(schemaId, (uint32_t)samples, (size_t)numeric, (size_t)strings);
+
+        uint64_t timestamp = 0;
+        uint64_t delta = 0;  // Unsigned: corrupt input wraps instead of overflowing
+        for (uint32_t i = 0; i < samples && r.ok(); i++) {
+            if (i == 0) {
+                timestamp = r.varint();
+            } else {
+                delta += (uint64_t)r.zigzag();
+                timestamp += delta;
+            }
+            visitor.onTimestamp(i, timestamp);
+        }
+
+        for (size_t c = 0; c < numeric && r.ok(); c++) {
+            const uint8_t* bitmap = nullptr;
+            if (r.byte() != 0) {
+                bitmap = r.skip((size_t)((samples + 7) / 8));
+            }
+
+            double scale = (double)HistoryWire::scale(decimals[c]);
+            uint64_t value = 0;
+            for (uint32_t i = 0; i < samples && r.ok(); i++) {
+                bool present = !bitmap || (bitmap[i / 8] >> (i % 8)) & 1;
+                if (present) {
+                    value += (uint64_t)r.zigzag();
+                }
+                visitor.onValue(c, i, present ? (int64_t)value / scale : NAN, present);
+            }
+        }
+
+        for (size_t s = 0; s < strings && r.ok(); s++) {
+            uint64_t entries = r.varint();
+            if (entries > samples) {
+                return false;
+            }
+
+            // Remember where the dictionary starts, entries are looked up per run
+            HistoryWire::Reader dictionary = r;
+            for (uint64_t d = 0; d < entries && r.ok(); d++) {
+                r.skip((size_t)r.varint());
+            }
+
+            for (uint32_t i = 0; i < samples && r.ok();) {
+                uint64_t index = r.varint();
+                uint64_t run = r.varint();
+                if (index >= entries || run == 0 || run > samples - i) {
+                    return false;
+                }
+
+                HistoryWire::Reader lookup = dictionary;
+                const uint8_t* text = nullptr;
+                size_t textLength = 0;
+                for (uint64_t d = 0; d <= index; d++) {
+                    textLength = (size_t)lookup.varint();
+                    text = lookup.skip(textLength);
+                }
+
+                for (uint64_t k = 0; k < run; k++, i++) {
+                    visitor.onString(s, i, (const char*)text, textLength);
+                }
+            }
+        }
+
+        return r.ok() && r.atEnd();
+    }
+
+    /**
+     * @brief Copy an encoded block with its timestamps re-dated
+     *
+     * Only the timestamp section is rewritten; the header and the value
+     * columns are copied as they are.
+     *
+     * @param convert uint64_t ms -> uint64_t ms
+     * @param samples Receives the sample count
+     * @param firstMs Receives the first re-dated timestamp
+     * @param lastMs Receives the last one
+     * @return Bytes written, 0 if the block is malformed or does not fit
+     */
+    template <typename Convert>
+    static size_t retime(const uint8_t* data, size_t length, uint8_t* out, size_t capacity, Convert convert,
+                         uint32_t& samples, uint64_t& firstMs, uint64_t& lastMs) {
+        HistoryWire::Reader r(data, length);
+        if (r.byte() != HISTORY_CODEC_VERSION) {
+            return 0;
+        }
+        r.varint();  // Schema id
+        uint64_t count = r.varint();
+        uint64_t numeric = r.varint();
+        if (!r.ok() || count == 0 || count > MAX_SAMPLES || numeric > 255) {
+            return 0;
+        }
+        r.skip((size_t)numeric);
+        r.varint();  // String columns
+        if (!r.ok()) {
+            return 0;
+        }
+
+        HistoryWire::Writer w(out, capacity);
+        w.bytes(data, r.position());
+
+        uint64_t timestamp = 0, delta = 0;
+        uint64_t previous = 0;
+        int64_t previousDelta = 0;
+        for (uint32_t i = 0; i < count && r.ok(); i++) {
+            if (i == 0) {
+                timestamp = r.varint();
+            } else {
+                delta += (uint64_t)r.zigzag();
+                timestamp += delta;
+            }
+
+            uint64_t redated = convert(timestamp);
+            if (i == 0) {
+                w.varint(redated);
+                firstMs = redated;
+            } else {
+                int64_t redatedDelta = (int64_t)(redated - previous);
+                w.zigzag(redatedDelta - previousDelta);
+                previousDelta = redatedDelta;
+            }
+            previous = redated;
+        }
+        if (!r.ok()) {
+            return 0;
+        }
+
+        w.bytes(data + r.position(), length - r.position());
+        samples = (uint32_t)count;
+        lastMs = previous;
+        return w.size();
+    }
+};
+
+#endif // HISTORYCODEC_H
\ No newline at end of file
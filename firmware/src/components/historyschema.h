@@ -0,0 +1,152 @@
+#ifndef HISTORYSCHEMA_H
+#define HISTORYSCHEMA_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "historycodec.h"
+#include "sensorrecord.h"
+
+// Bumped whenever columns are added, removed or reordered
+#define HISTORY_SCHEMA_ID 2
+
+/**
+ * @brief Numeric history columns, in block order
+ *
+ * One per numeric key of current/, each the same value (and resolution)
+ * as the JSON key it is named after. Bands past the configured band count
+ * stay empty.
+ */
+enum HistoryNumericColumn : uint8_t {
+    HISTORY_TEMPERATURE = 0,
+    HISTORY_HUMIDITY,
+    HISTORY_HEAT_INDEX,
+    HISTORY_ACCEL_X,
+    HISTORY_ACCEL_Y,
+    HISTORY_ACCEL_Z,
+    HISTORY_GYRO_X,
+    HISTORY_GYRO_Y,
+    HISTORY_GYRO_Z,
+    HISTORY_PITCH,
+    HISTORY_ROLL,
+    HISTORY_TILT,
+    HISTORY_VIBRATION,
+    HISTORY_WIFI_RSSI,
+    HISTORY_DOMINANT_HZ,
+    HISTORY_VIBRATION_RMS,
+    HISTORY_VIBRATION_WINDOWS,
+    HISTORY_VIBRATION_BANDS,  // Mean square per band, VIBRATION_MAX_BANDS of them
+    HISTORY_STATS = HISTORY_VIBRATION_BANDS + VIBRATION_MAX_BANDS,  // n, min, max, mean, stddev per StatChannel
+    HISTORY_NUMERIC_COUNT = HISTORY_STATS + STAT_CHANNEL_COUNT * 5
+};
+
+enum HistoryStringColumn : uint8_t {
+    HISTORY_ORIENTATION = 0,
+    HISTORY_WIFI_SSID,
+    HISTORY_UPLOAD_REASON,
+    HISTORY_STRING_COUNT
+};
+
+#define HISTORY_STATS_COLUMNS(channel, decimals) \
+    { "stats." channel ".n", 0 }, { "stats." channel ".min", decimals }, { "stats." channel ".max", decimals }, \
+    { "stats." channel ".mean", decimals }, { "stats." channel ".stddev", decimals }
+
+inline const HistoryColumn* historyNumericColumns() {
+    static const HistoryColumn COLUMNS[HISTORY_NUMERIC_COUNT] = {
+        { "temperature", 1 }, { "humidity", 1 }, { "heatIndex", 1 },
+        { "accelX", 2 }, { "accelY", 2 }, { "accelZ", 2 },
+        { "gyroX", 2 }, { "gyroY", 2 }, { "gyroZ", 2 },
+        { "pitch", 1 }, { "roll", 1 }, { "tilt", 1 },
+        { "vibration", 0 }, { "wifiRSSI", 0 },
+        { "vibrationSpectrum.dominantHz", 1 }, { "vibrationSpectrum.rms", 3 }, { "vibrationSpectrum.windows", 0 },
+        // (m/s²)², named like the elements of current/'s bands array
+        { "vibrationSpectrum.bands.0", 4 }, { "vibrationSpectrum.bands.1", 4 },
+        { "vibrationSpectrum.bands.2", 4 }, { "vibrationSpectrum.bands.3", 4 },
+        { "vibrationSpectrum.bands.4", 4 }, { "vibrationSpectrum.bands.5", 4 },
+        { "vibrationSpectrum.bands.6", 4 }, { "vibrationSpectrum.bands.7", 4 },
+        // Same order as StatChannel
+        HISTORY_STATS_COLUMNS("temperature", 1),
+        HISTORY_STATS_COLUMNS("humidity", 1),
+        HISTORY_STATS_COLUMNS("accelX", 2),
+        HISTORY_STATS_COLUMNS("accelY", 2),
+        HISTORY_STATS_COLUMNS("accelZ", 2),
+        HISTORY_STATS_COLUMNS("gyroX", 2),
+        HISTORY_STATS_COLUMNS("gyroY", 2),
+        HISTORY_STATS_COLUMNS("gyroZ", 2),
+        HISTORY_STATS_COLUMNS("accelMagnitude", 2)
+    };
+    return COLUMNS;
+}
+
+#undef HISTORY_STATS_COLUMNS
+
+static_assert(VIBRATION_MAX_BANDS == 8, "One vibrationSpectrum.bands column per band");
+
+inline const char* historyStringColumnName(HistoryStringColumn column) {
+    switch (column) {
+        case HISTORY_ORIENTATION:   return "orientation";
+        case HISTORY_WIFI_SSID:     return "wifiSSID";
+        case HISTORY_UPLOAD_REASON: return "uploadReason";
+        default:                    return "unknown";
+    }
+}
+
+/**
+ * @brief Numeric columns of one record, NaN where current/ has no value
+ *
+ * @param values HISTORY_NUMERIC_COUNT entries
+ */
+inline void historyValues(const SensorRecord& record, float vibrationThreshold, int rssi, float* values) {
+    for (uint8_t c = 0; c < HISTORY_NUMERIC_COUNT; c++) {
+        values[c] = NAN;
+    }
+
+    if (record.envValid) {
+        values[HISTORY_TEMPERATURE] = record.temperature;
+        values[HISTORY_HUMIDITY] = record.humidity;
+        values[HISTORY_HEAT_INDEX] = record.heatIndex;
+    }
+
+    if (record.imuReady) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            values[HISTORY_ACCEL_X + axis] = record.accel[axis];
+            values[HISTORY_GYRO_X + axis] = record.gyro[axis];
+        }
+        values[HISTORY_PITCH] = record.pitch;
+        values[HISTORY_ROLL] = record.roll;
+        values[HISTORY_TILT] = record.tilt;
+        values[HISTORY_VIBRATION] = exceedsVibration(record, vibrationThreshold) ? 1.0f : 0.0f;
+        if (record.vibration.windows > 0) {
+            values[HISTORY_DOMINANT_HZ] = record.vibration.dominantHz;
+            values[HISTORY_VIBRATION_RMS] = record.vibration.rms * ImuScaleConfig::MS2_PER_LSB;
+            values[HISTORY_VIBRATION_WINDOWS] = record.vibration.windows;
+            const float energyScale = ImuScaleConfig::MS2_PER_LSB * ImuScaleConfig::MS2_PER_LSB;
+            for (uint8_t b = 0; b < record.vibration.bandCount && b < VIBRATION_MAX_BANDS; b++) {
+                values[HISTORY_VIBRATION_BANDS + b] = record.vibration.bandEnergy[b] * energyScale;
+            }
+        }
+    }
+    values[HISTORY_WIFI_RSSI] = rssi;
+
+    // IMU channels are raw counts
+    for (uint8_t ch = 0; ch < STAT_CHANNEL_COUNT; ch++) {
+        const RunningStats& stats = record.stats.get((StatChannel)ch);
+        if (stats.getCount() == 0) {
+            continue;
+        }
+
+        float scale = 1.0f;
+        if (ch >= STAT_ACCEL_X && ch <= STAT_ACCEL_Z) scale = ImuScaleConfig::MS2_PER_LSB;
+        else if (ch >= STAT_GYRO_X && ch <= STAT_GYRO_Z) scale = ImuScaleConfig::RADS_PER_LSB;
+        else if (ch == STAT_ACCEL_MAGNITUDE) scale = ImuScaleConfig::MS2_PER_LSB;
+
+        float* out = values + HISTORY_STATS + ch * 5;
+        out[0] = stats.getCount();
+        out[1] = stats.getMin() * scale;
+        out[2] = stats.getMax() * scale;
+        out[3] = stats.getMean() * scale;
+        out[4] = stats.getStdDev() * scale;
+    }
+}
+
+#endif // HISTORYSCHEMA_H
\ No newline at end of file
@@ -0,0 +1,217 @@
+#ifndef IMUFIFO_H
+#define IMUFIFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "imusample.h"
+#include "ringbuffer.h"
+
+/**
+ * @brief MPU6050 hardware FIFO driver
+ *
+ * Configures the sensor to push accelerometer + gyroscope samples into
+ * its 1 KB FIFO at a fixed rate and drains them in bursts into a
+ * RingBuffer of raw samples.
+ *
+ * The register source is a template parameter so the driver can run
+ * against the real I2C bus or an in-memory fake on the host. A Bus must
+ * provide:
+ * - bool writeRegister(uint8_t reg, uint8_t value)
+ * - bool readRegisters(uint8_t reg, uint8_t* dst, size_t len)
+ * - size_t maxReadLength() const
+ */
+template <typename Bus>
+class MPU6050Fifo {
+public:
+    // MPU6050 register map (subset)
+    static const uint8_t REG_SMPLRT_DIV = 0x19;
+    static const uint8_t REG_CONFIG = 0x1A;
+    static const uint8_t REG_FIFO_EN = 0x23;
+    static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+    static const uint8_t REG_TEMP_OUT_H = 0x41;
+    static const uint8_t REG_USER_CTRL = 0x6A;
+    static const uint8_t REG_FIFO_COUNTH = 0x72;
+    static const uint8_t REG_FIFO_R_W = 0x74;
+
+    static const uint8_t FIFO_EN_ACCEL_GYRO = 0x78;  // XG | YG | ZG | ACCEL
+    static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+    static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+
+    static const size_t FIFO_SIZE = 1024;
+    static const size_t BYTES_PER_SAMPLE = 12;
+    static const size_t MAX_BURST_SAMPLES = 10;
+
+    explicit MPU6050Fifo(Bus& bus)
+        : bus(bus), sampleRateHz(0), overflowCount(0), running(false) {}
+
+    /**
+     * @brief Configure sample rate and start filling the FIFO
+     *
+     * @param rateHz Sample rate (1000 Hz divided down, 4-1000 Hz)
+     * @param dlpfCfg Digital low-pass filter setting (1-6)
+     * @return true if all register writes succeeded
+     */
+    bool begin(uint16_t rateHz, uint8_t dlpfCfg) {
+        if (rateHz == 0 || rateHz > 1000) {
+            return false;
+        }
+        if (dlpfCfg < 1 || dlpfCfg > 6) {
+            // DLPF_CFG 0/7 switch the gyro to 8 kHz and break the rate math
+            return false;
+        }
+
+        uint8_t divider = (uint8_t)(1000 / rateHz - 1);
+        sampleRateHz = 1000 / (divider + 1);
+
+        running = bus.writeRegister(REG_USER_CTRL, 0) &&
+                  bus.writeRegister(REG_FIFO_EN, 0) &&
+                  bus.writeRegister(REG_SMPLRT_DIV, divider) &&
+                  bus.writeRegister(REG_CONFIG, dlpfCfg) &&
+                  bus.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET) &&
+                  bus.writeRegister(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO) &&
+                  bus.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+        return running;
+    }
+
+    /**
+     * @brief Drain every complete sample from the FIFO into a ring buffer
+     *
+     * A full FIFO means samples were lost and the byte stream is no longer
+     * aligned to sample boundaries, so it is reset and counted instead.
+     *
+     * @return Number of samples pushed into the ring
+     */
+    template <size_t N>
+    size_t drain(RingBuffer<ImuRawSample, N>& ring) {
+        if (!running) {
+            return 0;
+        }
+
+        uint8_t countBytes[2];
+        if (!bus.readRegisters(REG_FIFO_COUNTH, countBytes, 2)) {
+            return 0;
+        }
+
+        size_t count = ((size_t)countBytes[0] << 8) | countBytes[1];
+        if (count >= FIFO_SIZE) {
+            overflowCount++;
+            reset();
+            return 0;
+        }
+
+        size_t burst = bus.maxReadLength() / BYTES_PER_SAMPLE;
+        if (burst > MAX_BURST_SAMPLES) burst = MAX_BURST_SAMPLES;
+        if (burst == 0) burst = 1;
+
+        size_t remaining = count / BYTES_PER_SAMPLE;
+        size_t pushed = 0;
+        uint8_t raw[MAX_BURST_SAMPLES * BYTES_PER_SAMPLE];
+
+        while (remaining > 0) {
+            size_t n = remaining < burst ? remaining : burst;
+            if (!bus.readRegisters(REG_FIFO_R_W, raw, n * BYTES_PER_SAMPLE)) {
+                break;
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                const uint8_t* p = raw + i * BYTES_PER_SAMPLE;
+                ImuRawSample s;
+                s.ax = be16(p + 0);
+                s.ay = be16(p + 2);
+                s.az = be16(p + 4);
+                s.gx = be16(p + 6);
+                s.gy = be16(p + 8);
+                s.gz = be16(p + 10);
+                if (ring.push(s)) {
+                    pushed++;
+                }
+            }
+            remaining -= n;
+        }
+
+        return pushed;
+    }
+
+    /**
+     * @brief Stop writing samples into the FIFO (e.g. while the parcel is still)
+     */
+    void stop() {
+        bus.writeRegister(REG_USER_CTRL, 0);
+        running = false;
+    }
+
+    /**
+     * @brief Resume collection after stop(), discarding stale contents
+     */
+    bool start() {
+        if (sampleRateHz == 0) {
+            return false;
+        }
+        reset();
+        running = true;
+        return true;
+    }
+
+    /**
+     * @brief Discard FIFO contents and restart collection
+     */
+    void reset() {
+        bus.writeRegister(REG_USER_CTRL, 0);
+        bus.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+        bus.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+    }
+
+    /**
+     * @brief Read the current output registers directly (bypassing the FIFO)
+     *
+     * @param sample Raw accelerometer + gyroscope registers
+     * @param rawTemperature Raw die temperature register
+     * @return true if read successful
+     */
+    bool readSample(ImuRawSample& sample, int16_t& rawTemperature) {
+        uint8_t raw[14];
+        if (!bus.readRegisters(REG_ACCEL_XOUT_H, raw, 14)) {
+            return false;
+        }
+        sample.ax = be16(raw + 0);
+        sample.ay = be16(raw + 2);
+        sample.az = be16(raw + 4);
+        rawTemperature = be16(raw + 6);
+        sample.gx = be16(raw + 8);
+        sample.gy = be16(raw + 10);
+        sample.gz = be16(raw + 12);
+        return true;
+    }
+
+    /**
+     * @brief Read the raw die temperature register
+     *
+     * @param rawTemperature Register value (°C = raw / 340 + 36.53)
+     * @return true if read successful
+     */
+    bool readTemperature(int16_t& rawTemperature) {
+        uint8_t raw[2];
+        if (!bus.readRegisters(REG_TEMP_OUT_H, raw, 2)) {
+            return false;
+        }
+        rawTemperature = be16(raw);
+        return true;
+    }
+
+    uint16_t getSampleRate() const { return sampleRateHz; }
+    uint32_t getOverflowCount() const { return overflowCount; }
+    bool isRunning() const { return running; }
+
+private:
+    Bus& bus;
+    uint16_t sampleRateHz;
+    uint32_t overflowCount;
+    bool running;
+
+    static int16_t be16(const uint8_t* p) {
+        return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+    }
+};
+
+#endif // IMUFIFO_H
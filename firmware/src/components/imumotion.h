@@ -0,0 +1,81 @@
+#ifndef IMUMOTION_H
+#define IMUMOTION_H
+
+#include <stdint.h>
+
+/**
+ * @brief MPU6050 motion-detection interrupt driver
+ *
+ * Raises the INT pin when high-pass filtered acceleration exceeds a
+ * threshold for a number of consecutive 1 kHz samples. The pin is
+ * latched high until clear() reads INT_STATUS, so it can be used as a
+ * level-triggered wake source while the CPU sleeps.
+ *
+ * Uses the same Bus concept as MPU6050Fifo.
+ */
+template <typename Bus>
+class MPU6050Motion {
+public:
+    static const uint8_t REG_MOT_THR = 0x1F;
+    static const uint8_t REG_MOT_DUR = 0x20;
+    static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+    static const uint8_t REG_INT_PIN_CFG = 0x37;
+    static const uint8_t REG_INT_ENABLE = 0x38;
+    static const uint8_t REG_INT_STATUS = 0x3A;
+
+    static const uint8_t INT_PIN_LATCH = 0x20;     // LATCH_INT_EN
+    static const uint8_t INT_MOTION = 0x40;        // MOT_EN / MOT_INT
+    static const uint8_t ACCEL_HPF_MASK = 0x07;
+    static const uint8_t ACCEL_HPF_0_63HZ = 0x04;
+
+    explicit MPU6050Motion(Bus& bus) : bus(bus), enabled(false) {}
+
+    /**
+     * @brief Enable the motion interrupt on the INT pin
+     *
+     * @param thresholdMg Motion threshold in mg (2 mg per LSB, max 510)
+     * @param durationMs Consecutive samples above threshold (1 ms each)
+     * @return true if all register writes succeeded
+     */
+    bool begin(uint16_t thresholdMg, uint8_t durationMs) {
+        uint16_t threshold = thresholdMg / 2;
+        if (threshold == 0) threshold = 1;
+        if (threshold > 255) threshold = 255;
+
+        // High-pass filter only feeds the motion detector, output data is untouched
+        uint8_t accelConfig;
+        if (!bus.readRegisters(REG_ACCEL_CONFIG, &accelConfig, 1)) {
+            return false;
+        }
+        accelConfig = (accelConfig & ~ACCEL_HPF_MASK) | ACCEL_HPF_0_63HZ;
+
+        enabled = bus.writeRegister(REG_ACCEL_CONFIG, accelConfig) &&
+                  bus.writeRegister(REG_MOT_THR, (uint8_t)threshold) &&
+                  bus.writeRegister(REG_MOT_DUR, durationMs) &&
+                  bus.writeRegister(REG_INT_PIN_CFG, INT_PIN_LATCH) &&
+                  bus.writeRegister(REG_INT_ENABLE, INT_MOTION);
+        clear();
+        return enabled;
+    }
+
+    /**
+     * @brief Read and clear the latched interrupt
+     *
+     * @return true if motion was flagged since the last call
+     */
+    bool clear() {
+        uint8_t status = 0;
+        if (!enabled || !bus.readRegisters(REG_INT_STATUS, &status, 1)) {
+            return false;
+        }
+        return (status & INT_MOTION) != 0;
+    }
+
+    bool isEnabled() const { return enabled; }
+
+private:
+    Bus& bus;
+    bool enabled;
+};
+
+#endif // IMUMOTION_H
@@ -0,0 +1,64 @@
+#ifndef IMUSAMPLE_H
+#define IMUSAMPLE_H
+
+#include <stdint.h>
+
+/**
+ * @brief One raw MPU6050 sample as read from the hardware FIFO
+ *
+ * Values are the signed 16-bit register contents, in FIFO order
+ * (accelerometer X/Y/Z followed by gyroscope X/Y/Z). Samples stay in
+ * this form through buffering and detection; physical units are only
+ * produced at serialization via ImuScale.
+ */
+struct __attribute__((packed)) ImuRawSample {
+    int16_t ax, ay, az;
+    int16_t gx, gy, gz;
+};
+
+static_assert(sizeof(ImuRawSample) == 12, "ImuRawSample must match the FIFO record");
+
+/**
+ * @brief Compile-time register scale for a given sensor range
+ *
+ * @tparam AccelLsbPerG Accelerometer LSB per g (±8G = 4096)
+ * @tparam GyroLsbPerDpsX10 Gyroscope LSB per °/s, times 10 (±500°/s = 655)
+ */
+template <int32_t AccelLsbPerG, int32_t GyroLsbPerDpsX10>
+struct ImuScale {
+    static constexpr int32_t ACCEL_LSB_PER_G = AccelLsbPerG;
+    static constexpr float STANDARD_GRAVITY = 9.80665f;   // m/s²
+
+    // Multipliers from raw register values to physical units
+    static constexpr float G_PER_LSB = 1.0f / AccelLsbPerG;
+    static constexpr float MS2_PER_LSB = STANDARD_GRAVITY / AccelLsbPerG;
+    static constexpr float RADS_PER_LSB = (3.14159265f / 180.0f) * 10.0f / GyroLsbPerDpsX10;
+
+    /**
+     * @brief Acceleration in m/s² as raw register counts
+     */
+    static constexpr int32_t ms2ToRaw(float ms2) {
+        return (int32_t)(ms2 / MS2_PER_LSB + 0.5f);
+    }
+
+    /**
+     * @brief Acceleration in g as a squared raw magnitude, for |a|² compares
+     */
+    static constexpr uint32_t gToRawSq(float g) {
+        return (uint32_t)(g * AccelLsbPerG) * (uint32_t)(g * AccelLsbPerG);
+    }
+
+    /**
+     * @brief Squared magnitude of a raw acceleration vector
+     *
+     * Max 3·32768² fits in 32 bits unsigned.
+     */
+    static inline uint32_t magnitudeSq(int16_t x, int16_t y, int16_t z) {
+        return (uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y) + (uint32_t)((int32_t)z * z);
+    }
+};
+
+// Ranges configured in MPU6050Sensor::begin() (±8G, ±500°/s)
+typedef ImuScale<4096, 655> ImuScaleConfig;
+
+#endif // IMUSAMPLE_H
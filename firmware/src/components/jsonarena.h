@@ -0,0 +1,132 @@
+#ifndef JSONARENA_H
+#define JSONARENA_H
+
+#include <ArduinoJson.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief ArduinoJson allocator carving documents out of one static buffer
+ *
+ * ArduinoJson 7 documents always allocate (StaticJsonDocument is only a
+ * compatibility name), so every upload and alert built on the heap and
+ * released it a moment later. Documents built on a JsonArena bump through
+ * a fixed buffer instead; once the last block is released the arena starts
+ * over from the beginning.
+ *
+ * - the most recent block grows / shrinks in place, other reallocations copy
+ * - space is only reclaimed when nothing is allocated, so the documents
+ *   sharing an arena must be short-lived (built, serialized, dropped)
+ * - running out fails the allocation, the document reports overflowed()
+ *
+ * Not thread safe, one arena per task.
+ */
+template<size_t Capacity>
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    struct Stats {
+        size_t highWater;     // Most bytes in use at once (headers included)
+        uint32_t failures;    // Allocations that did not fit
+    };
+
+    JsonArena() : top(0), last(NO_BLOCK), outstanding(0) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void* allocate(size_t size) override {
+        size_t need = HEADER + align(size);
+        if (need > Capacity - top) {
+            stats.failures++;
+            return nullptr;
+        }
+
+        last = top;
+        top += need;
+        setEnd(last, top);
+        outstanding++;
+        if (top > stats.highWater) {
+            stats.highWater = top;
+        }
+        return buffer + last + HEADER;
+    }
+
+    void deallocate(void* ptr) override {
+        if (!ptr) {
+            return;
+        }
+
+        size_t offset = offsetOf(ptr);
+        if (offset == last) {
+            top = last;       // Most recent block, give it back right away
+            last = NO_BLOCK;
+        }
+        if (--outstanding == 0) {
+            top = 0;
+            last = NO_BLOCK;
+        }
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (!ptr) {
+            return allocate(newSize);
+        }
+
+        size_t offset = offsetOf(ptr);
+        if (offset == last && align(newSize) <= Capacity - offset - HEADER) {
+            top = offset + HEADER + align(newSize);
+            setEnd(offset, top);
+            if (top > stats.highWater) {
+                stats.highWater = top;
+            }
+            return ptr;
+        }
+
+        void* moved = allocate(newSize);
+        if (!moved) {
+            return nullptr;
+        }
+        size_t oldSize = blockSize(offset);
+        memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+        deallocate(ptr);
+        return moved;
+    }
+
+    /**
+     * @brief Bytes in use right now (0 between documents)
+     */
+    size_t getUsed() const { return top; }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    static const size_t ALIGNMENT = 8;
+    static const size_t HEADER = ALIGNMENT;   // End offset of the block, padded to keep data aligned
+    static const size_t NO_BLOCK = (size_t)-1;
+
+    alignas(ALIGNMENT) uint8_t buffer[Capacity];
+    size_t top;               // First free byte
+    size_t last;              // Offset of the most recent live block, NO_BLOCK if unknown
+    uint32_t outstanding;     // Live blocks
+    Stats stats;
+
+    static size_t align(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    size_t offsetOf(void* ptr) const {
+        return (size_t)((uint8_t*)ptr - buffer) - HEADER;
+    }
+
+    void setEnd(size_t offset, size_t end) {
+        uint32_t value = (uint32_t)end;
+        memcpy(buffer + offset, &value, sizeof(value));
+    }
+
+    size_t blockSize(size_t offset) const {
+        uint32_t end;
+        memcpy(&end, buffer + offset, sizeof(end));
+        return end - offset - HEADER;
+    }
+};
+
+#endif // JSONARENA_H
\ No newline at end of file
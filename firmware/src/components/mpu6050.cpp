@@ -1,10 +1,33 @@
 #include "mpu6050.h"
 #include "config.h"
 
+bool WireRegisterBus::writeRegister(uint8_t reg, uint8_t value) {
+    wire.beginTransmission(address);
+    wire.write(reg);
+    wire.write(value);
+    return wire.endTransmission() == 0;
+}
+
+bool WireRegisterBus::readRegisters(uint8_t reg, uint8_t* dst, size_t len) {
+    wire.beginTransmission(address);
+    wire.write(reg);
+    if (wire.endTransmission(false) != 0) {
+        return false;
+    }
+    
+    if (wire.requestFrom(address, (uint8_t)len) != len) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = wire.read();
+    }
+    return true;
+}
+
 MPU6050Sensor::MPU6050Sensor() 
-    : accelX(0), accelY(0), accelZ(0),
-      gyroX(0), gyroY(0), gyroZ(0),
-      temperature(0), initialized(false) {
+    : bus(Wire, MPU6050_ADDR), fifo(bus), motion(bus),
+      initialized(false) {
 }
 
 bool MPU6050Sensor::begin(int sdaPin, int sclPin) {
@@ -15,7 +38,11 @@ bool MPU6050Sensor::begin(int sdaPin, int sclPin) {
     // Initialize I2C (Wire will handle multiple initializations safely)
     Wire.begin(sdaPin, sclPin);
     Wire.setClock(I2C_FREQUENCY);
-    delay(200); // Critical delay for stability
+    
+    // Only waits if called right after power-on, the bootloader usually covers it
+    while (millis() < MPU6050_STARTUP_MS) {
+        delay(1);
+    }
     
     // Scan for I2C device
     #if ENABLE_DEBUG_LOGS
@@ -74,15 +101,30 @@ bool MPU6050Sensor::begin(int sdaPin, int sclPin) {
     
     initialized = true;
     
-    // Perform initial read to verify
-    delay(100);
-    if (!readSensorData()) {
+    // Perform initial read to verify (single read, before the FIFO starts),
+    // past the 8.5 ms delay of the 21 Hz filter just configured
+    delay(10);
+    ImuRawSample probe;
+    int16_t probeTemperature;
+    if (!readSample(probe, probeTemperature)) {
         #if ENABLE_DEBUG_LOGS
         Serial.println("[MPU6050] ⚠️  Initial read failed");
         #endif
         return false;
     }
     
+    #if MPU6050_FIFO_ENABLED
+    if (fifo.begin(MPU6050_SAMPLE_RATE_HZ, MPU6050_FIFO_DLPF)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[MPU6050] FIFO sampling at %d Hz\n", fifo.getSampleRate());
+        #endif
+    } else {
+        #if ENABLE_DEBUG_LOGS
+        Serial.println("[MPU6050] ⚠️  FIFO setup failed, using single reads");
+        #endif
+    }
+    #endif
+    
     #if ENABLE_DEBUG_LOGS
     Serial.println("[MPU6050] ✅ Initialization complete");
     #endif
@@ -90,100 +132,64 @@ bool MPU6050Sensor::begin(int sdaPin, int sclPin) {
     return true;
 }
 
-bool MPU6050Sensor::readSensorData() {
+bool MPU6050Sensor::enableMotionWake(uint16_t thresholdMg, uint8_t durationMs) {
     if (!initialized) {
         return false;
     }
     
-    sensors_event_t accel, gyro, temp;
+    bool ok = motion.begin(thresholdMg, durationMs);
     
-    // Get sensor events
-    if (!mpu.getEvent(&accel, &gyro, &temp)) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.println("[MPU6050] ⚠️  Failed to read sensor");
-        #endif
-        return false;
+    #if ENABLE_DEBUG_LOGS
+    if (ok) {
+        Serial.printf("[MPU6050] Motion wake armed: %d mg for %d ms\n", thresholdMg, durationMs);
+    } else {
+        Serial.println("[MPU6050] ⚠️  Motion interrupt setup failed");
     }
+    #endif
     
-    // Store acceleration (m/s²)
-    accelX = accel.acceleration.x;
-    accelY = accel.acceleration.y;
-    accelZ = accel.acceleration.z;
-    
-    // Store gyroscope (rad/s)
-    gyroX = gyro.gyro.x;
-    gyroY = gyro.gyro.y;
-    gyroZ = gyro.gyro.z;
-    
-    // Store temperature (°C)
-    temperature = temp.temperature;
-    
-    return true;
+    return ok;
 }
 
-String MPU6050Sensor::detectOrientation() {
+bool MPU6050Sensor::checkMotion() {
     if (!initialized) {
-        return "Sensor Not Ready";
+        return false;
     }
     
-    // Calculate total acceleration
-    float totalAccel = calculateMagnitude(accelX, accelY, accelZ);
-    
-    // Free fall detection (very low acceleration)
-    if (totalAccel < 5.0) {
-        return "Free Fall";
+    return motion.clear();
+}
+
+void MPU6050Sensor::setFifoSampling(bool enabled) {
+    if (!initialized) {
+        return;
     }
     
-    // Determine dominant axis
-    float absX = abs(accelX);
-    float absY = abs(accelY);
-    float absZ = abs(accelZ);
-    
-    // Z-axis dominant (normal orientation)
-    if (absZ > absX && absZ > absY) {
-        if (accelZ > 8.0) {
-            return "Upright";
-        } else if (accelZ < -8.0) {
-            return "Upside Down";
-        } else {
-            return "Tilted";
-        }
-    }
-    // X-axis dominant
-    else if (absX > absY && absX > absZ) {
-        if (accelX > 0) {
-            return "On Side (Right)";
-        } else {
-            return "On Side (Left)";
-        }
+    if (enabled) {
+        fifo.start();
+    } else {
+        fifo.stop();
     }
-    // Y-axis dominant
-    else {
-        if (accelY > 0) {
-            return "On Edge (Front)";
-        } else {
-            return "On Edge (Back)";
-        }
+}
+
+void MPU6050Sensor::service() {
+    if (!initialized || !fifo.isRunning()) {
+        return;
     }
+    
+    fifo.drain(samples);
 }
 
-bool MPU6050Sensor::detectVibration(float threshold) {
+bool MPU6050Sensor::readSample(ImuRawSample& sample, int16_t& rawTemperature) {
     if (!initialized) {
         return false;
     }
     
-    float totalAccel = getTotalAcceleration();
-    
-    // Normal gravity ~9.8 m/s², vibration adds deviation
-    float deviation = abs(totalAccel - 9.8);
+    // Single burst read of the output registers
+    if (!fifo.readSample(sample, rawTemperature)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.println("[MPU6050] ⚠️  Failed to read sensor");
+        #endif
+        return false;
+    }
     
-    return deviation > threshold;
-}
-
-float MPU6050Sensor::getTotalAcceleration() {
-    return calculateMagnitude(accelX, accelY, accelZ);
-}
-
-float MPU6050Sensor::calculateMagnitude(float x, float y, float z) {
-    return sqrt(x*x + y*y + z*z);
+    return true;
 }
\ No newline at end of file
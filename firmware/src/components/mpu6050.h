@@ -6,15 +6,46 @@
 #include <Adafruit_Sensor.h>
 #include <Wire.h>
 
+#include "config.h"
+#include "imufifo.h"
+#include "imumotion.h"
+#include "imusample.h"
+#include "ringbuffer.h"
+
+/**
+ * @brief MPU6050 register access over the Arduino Wire bus
+ *
+ * Register source used by MPU6050Fifo on real hardware.
+ */
+class WireRegisterBus {
+public:
+    WireRegisterBus(TwoWire& wire, uint8_t address) : wire(wire), address(address) {}
+
+    bool writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t* dst, size_t len);
+
+    // Largest single read the Wire buffer can hold
+    size_t maxReadLength() const { return I2C_BUFFER_LENGTH; }
+
+private:
+    TwoWire& wire;
+    uint8_t address;
+};
+
 /**
- * @brief MPU6050 6-Axis IMU Sensor Wrapper
+ * @brief MPU6050 6-Axis IMU hardware backend
  * 
  * Provides interface for:
- * - 3-axis accelerometer readings
- * - 3-axis gyroscope readings
- * - Orientation detection
- * - Vibration detection
- * - Temperature measurement
+ * - Sensor setup (ranges, filter, FIFO, motion interrupt)
+ * - Raw accelerometer / gyroscope samples
+ * - Die temperature
+ *
+ * With MPU6050_FIFO_ENABLED the sensor samples into its hardware FIFO at
+ * MPU6050_SAMPLE_RATE_HZ and service() drains the FIFO into a ring
+ * buffer. Otherwise readSample() reads the output registers directly.
+ * 
+ * Implements the Imu backend concept of SensorPipeline, which does all
+ * detection on the raw samples.
  */
 class MPU6050Sensor {
 public:
@@ -33,47 +64,76 @@ public:
     bool begin(int sdaPin = 21, int sclPin = 22);
     
     /**
-     * @brief Read all sensor data
+     * @brief Drain the hardware FIFO into the sample ring buffer
      * 
-     * @return true if read successful
+     * Must be called more often than the FIFO fills
+     * (1024 bytes = 85 samples, ~170 ms at 500 Hz).
      */
-    bool readSensorData();
+    void service();
     
-    // Accelerometer getters (m/s²)
-    float getAccelX() const { return accelX; }
-    float getAccelY() const { return accelY; }
-    float getAccelZ() const { return accelZ; }
+    /**
+     * @brief True while the FIFO is sampling at getSampleRate()
+     */
+    bool isStreaming() const { return initialized && fifo.isRunning(); }
     
-    // Gyroscope getters (rad/s)
-    float getGyroX() const { return gyroX; }
-    float getGyroY() const { return gyroY; }
-    float getGyroZ() const { return gyroZ; }
+    /**
+     * @brief FIFO sample rate (Hz)
+     */
+    uint16_t getSampleRate() const { return fifo.getSampleRate(); }
     
-    // Temperature getter (°C)
-    float getTemperature() const { return temperature; }
+    /**
+     * @brief Take the oldest buffered FIFO sample
+     */
+    bool popSample(ImuRawSample& sample) { return samples.pop(sample); }
     
     /**
-     * @brief Detect package orientation
+     * @brief FIFO samples drained but not popped yet
+     */
+    size_t getQueuedSamples() const { return samples.size(); }
+    
+    /**
+     * @brief Read the output registers directly (single-read mode)
+     * 
+     * @param sample Raw accelerometer + gyroscope registers
+     * @param rawTemperature Raw die temperature register
+     * @return true if read successful
+     */
+    bool readSample(ImuRawSample& sample, int16_t& rawTemperature);
+    
+    /**
+     * @brief Read the raw die temperature register (°C = raw / 340 + 36.53)
+     */
+    bool readTemperature(int16_t& rawTemperature) { return fifo.readTemperature(rawTemperature); }
+    
+    /**
+     * @brief FIFO overflows (lost samples) since boot
+     */
+    uint32_t getFifoOverflows() const { return fifo.getOverflowCount(); }
+    
+    /**
+     * @brief Arm the motion interrupt on the INT pin (wake source)
      * 
-     * @return String describing orientation
-     *         (Upright, Upside Down, On Side, Tilted, Free Fall)
+     * @param thresholdMg Motion threshold in mg
+     * @param durationMs Duration above threshold in ms
+     * @return true if configured
      */
-    String detectOrientation();
+    bool enableMotionWake(uint16_t thresholdMg, uint8_t durationMs);
     
     /**
-     * @brief Detect excessive vibration
+     * @brief Read and clear the latched motion interrupt
      * 
-     * @param threshold Vibration threshold in m/s² (default: 15.0)
-     * @return true if vibration exceeds threshold
+     * @return true if motion was detected since the last call
      */
-    bool detectVibration(float threshold = 15.0);
+    bool checkMotion();
     
     /**
-     * @brief Get total acceleration magnitude
+     * @brief Pause or resume high-rate FIFO sampling
+     * 
+     * While paused, the pipeline falls back to single reads.
      * 
-     * @return float Total acceleration (m/s²)
+     * @param enabled false to stop the FIFO
      */
-    float getTotalAcceleration();
+    void setFifoSampling(bool enabled);
     
     /**
      * @brief Check if sensor is working
@@ -84,18 +144,12 @@ public:
 
 private:
     Adafruit_MPU6050 mpu;
-    
-    // Sensor data
-    float accelX, accelY, accelZ;
-    float gyroX, gyroY, gyroZ;
-    float temperature;
+    WireRegisterBus bus;
+    MPU6050Fifo<WireRegisterBus> fifo;
+    MPU6050Motion<WireRegisterBus> motion;
+    RingBuffer<ImuRawSample, IMU_RING_CAPACITY> samples;
     
     bool initialized;
-    
-    /**
-     * @brief Calculate 3D vector magnitude
-     */
-    float calculateMagnitude(float x, float y, float z);
 };
 
 #endif // MPU6050_H
\ No newline at end of file
@@ -0,0 +1,528 @@
+#ifndef MQTTCLIENT_H
+#define MQTTCLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Minimal MQTT 3.1.1 client: QoS 0/1, retained messages, persistent sessions
+ *
+ * One kept-open connection:
+ * - connect(): CONNECT with an optional will; cleanSession false keeps
+ *   subscriptions and queued QoS 1 messages on the broker while the
+ *   device is offline
+ * - publish() / beginPublish() + write() + endPublish(): QoS 1 waits for
+ *   the PUBACK, so true means the broker has the message. A streamed
+ *   publish lets a large payload go out without building it in RAM
+ * - subscribe(): waits for the SUBACK
+ * - loop(): incoming messages (QoS 1 acked after the handler ran) and
+ *   keep-alive pings; a missing PINGRESP closes the link
+ *
+ * Incoming messages are only read from loop() and while waiting for an
+ * acknowledgement, never in the middle of a streamed publish.
+ *
+ * A Socket must provide:
+ * - bool connect(const char* host, uint16_t port)
+ * - size_t write(const uint8_t* data, size_t length)
+ * - int available()
+ * - int read(uint8_t* buffer, size_t length)
+ * - bool connected()
+ * - void stop()
+ *
+ * A Platform must provide:
+ * - uint32_t millis()
+ * - void delay(uint32_t ms)
+ *
+ * A Handler must provide:
+ * - void onMessage(const char* topic, size_t topicLength,
+ *                  const uint8_t* payload, size_t length, bool retained)
+ *
+ * @tparam MaxPacket Largest incoming packet kept (bigger ones are acked and dropped)
+ */
+template <typename Socket, typename Platform, typename Handler, size_t MaxPacket>
+class MqttClient {
+public:
+    struct Options {
+        const char* clientId;
+        const char* username;       // nullptr for none
+        const char* password;       // nullptr for none
+        uint16_t keepAliveSec;
+        bool cleanSession;
+        const char* willTopic;      // nullptr for no will
+        const char* willMessage;
+        bool willRetain;
+        uint32_t ackTimeoutMs;      // CONNACK / SUBACK / PUBACK / PINGRESP
+    };
+
+    struct Stats {
+        uint32_t connects;          // Sessions accepted by the broker
+        uint32_t published;         // PUBLISH packets sent
+        uint32_t acked;             // QoS 1 publishes acknowledged
+        uint32_t failures;          // Publishes / subscribes without an acknowledgement
+        uint32_t received;          // Messages handed to the handler
+        uint32_t oversized;         // Incoming packets larger than MaxPacket
+        uint32_t lastAckMs;         // PUBLISH → PUBACK
+        uint32_t maxAckMs;
+        uint32_t totalAckMs;
+    };
+
+    MqttClient(Socket& socket, Platform& platform, Handler& handler)
+        : socket(socket), platform(platform), handler(handler), open(false), sessionPresent(false),
+          keepAliveMs(0), ackTimeoutMs(5000), lastSend(0), pingSent(0), pingOutstanding(false),
+          nextPacketId(1), publishRemaining(0), publishQos(0), publishId(0), publishStart(0) {
+        memset(&stats, 0, sizeof(stats));
+        resetReceive();
+    }
+
+    /**
+     * @brief Open the socket and start a session
+     *
+     * @return true once the broker accepted the CONNECT
+     */
+    bool connect(const char* host, uint16_t port, const Options& options) {
+        close();
+        if (!socket.connect(host, port)) {
+            return false;
+        }
+        open = true;
+        keepAliveMs = (uint32_t)options.keepAliveSec * 1000;
+        ackTimeoutMs = options.ackTimeoutMs;
+
+        uint8_t flags = options.cleanSession ? 0x02 : 0x00;
+        size_t remaining = 10 + 2 + strlen(options.clientId);
+        if (options.willTopic) {
+            flags |= 0x04 | 0x08 | (options.willRetain ? 0x20 : 0x00);  // Will at QoS 1
+            remaining += 2 + strlen(options.willTopic) + 2 + strlen(options.willMessage);
+        }
+        if (options.username) {
+            flags |= 0x80;
+            remaining += 2 + strlen(options.username);
+        }
+        if (options.password) {
+            flags |= 0x40;
+            remaining += 2 + strlen(options.password);
+        }
+
+        static const uint8_t PROTOCOL[] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04 };
+        uint8_t keepAlive[2] = { (uint8_t)(options.keepAliveSec >> 8), (uint8_t)options.keepAliveSec };
+        bool ok = sendHeader(CONNECT << 4, remaining) &&
+                  send(PROTOCOL, sizeof(PROTOCOL)) &&
+                  send(&flags, 1) &&
+                  send(keepAlive, 2) &&
+                  sendString(options.clientId) &&
+                  (!options.willTopic || (sendString(options.willTopic) && sendString(options.willMessage))) &&
+                  (!options.username || sendString(options.username)) &&
+                  (!options.password || sendString(options.password));
+
+        connackCode = 0xFF;
+        if (!ok || !await(CONNACK, 0) || connackCode != 0) {
+            close();
+            return false;
+        }
+
+        pingOutstanding = false;
+        stats.connects++;
+        return true;
+    }
+
+    /**
+     * @brief Send DISCONNECT (the will is not published) and close
+     */
+    void disconnect() {
+        if (open) {
+            sendHeader(DISCONNECT << 4, 0);
+        }
+        close();
+    }
+
+    /**
+     * @brief Drop the connection without DISCONNECT (the will is published)
+     */
+    void close() {
+        if (open) {
+            socket.stop();
+        }
+        open = false;
+        publishRemaining = 0;
+        resetReceive();
+    }
+
+    bool connected() {
+        if (open && !socket.connected() && socket.available() <= 0) {
+            close();
+        }
+        return open;
+    }
+
+    /**
+     * @brief Subscribe to one topic filter
+     *
+     * @return true once the broker granted the subscription
+     */
+    bool subscribe(const char* topicFilter, uint8_t qos) {
+        if (!connected()) {
+            return false;
+        }
+
+        uint16_t id = takePacketId();
+        uint8_t packetId[2] = { (uint8_t)(id >> 8), (uint8_t)id };
+        bool ok = sendHeader((SUBSCRIBE << 4) | 0x02, 2 + 2 + strlen(topicFilter) + 1) &&
+                  send(packetId, 2) &&
+                  sendString(topicFilter) &&
+                  send(&qos, 1);
+
+        subackCode = 0x80;
+        if (!ok || !await(SUBACK, id) || subackCode == 0x80) {
+            stats.failures++;
+            return false;
+        }
+        return true;
+    }
+
+    bool publish(const char* topic, const uint8_t* payload, size_t length, uint8_t qos, bool retain) {
+        return beginPublish(topic, length, qos, retain) && write(payload, length) && endPublish();
+    }
+
+    /**
+     * @brief Start a PUBLISH whose payload is written in pieces
+     *
+     * Follow with write() calls totalling length bytes, then endPublish().
+     */
+    bool beginPublish(const char* topic, size_t length, uint8_t qos, bool retain) {
+        if (!connected()) {
+            return false;
+        }
+
+        publishQos = qos > 0 ? 1 : 0;
+        publishId = publishQos ? takePacketId() : 0;
+        size_t remaining = 2 + strlen(topic) + (publishQos ? 2 : 0) + length;
+        uint8_t header = (PUBLISH << 4) | (publishQos << 1) | (retain ? 0x01 : 0x00);
+
+        uint8_t packetId[2] = { (uint8_t)(publishId >> 8), (uint8_t)publishId };
+        if (!sendHeader(header, remaining) || !sendString(topic) || (publishQos && !send(packetId, 2))) {
+            stats.failures++;
+            return false;
+        }
+
+        publishRemaining = length;
+        publishStart = platform.millis();
+        return true;
+    }
+
+    bool write(const uint8_t* data, size_t length) {
+        if (!open || length > publishRemaining) {
+            return false;
+        }
+        publishRemaining -= length;
+        return send(data, length);
+    }
+
+    /**
+     * @brief Finish a streamed publish
+     *
+     * @return QoS 0: the packet was sent; QoS 1: the broker acknowledged it
+     */
+    bool endPublish() {
+        if (!open || publishRemaining != 0) {
+            // The broker would read the next packet as payload, the stream is lost
+            close();
+            stats.failures++;
+            return false;
+        }
+        stats.published++;
+
+        if (publishQos == 0) {
+            return true;
+        }
+        if (!await(PUBACK, publishId)) {
+            // Resent by the caller on a new connection
+            close();
+            stats.failures++;
+            return false;
+        }
+
+        uint32_t latency = platform.millis() - publishStart;
+        stats.acked++;
+        stats.lastAckMs = latency;
+        stats.totalAckMs += latency;
+        if (latency > stats.maxAckMs) {
+            stats.maxAckMs = latency;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read incoming messages and keep the session alive
+     *
+     * Call often, the handler runs from here.
+     */
+    void loop() {
+        if (!connected()) {
+            return;
+        }
+        pump();
+
+        uint32_t now = platform.millis();
+        if (pingOutstanding && now - pingSent >= ackTimeoutMs) {
+            close();  // Broker gone without closing the socket
+            return;
+        }
+        if (keepAliveMs > 0 && !pingOutstanding && now - lastSend >= keepAliveMs * 3 / 4) {
+            if (sendHeader(PINGREQ << 4, 0)) {
+                pingOutstanding = true;
+                pingSent = now;
+            }
+        }
+    }
+
+    /**
+     * @brief True if the broker still had a session for this client id
+     */
+    bool isSessionPresent() const { return sessionPresent; }
+
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief Mean PUBLISH → PUBACK time (ms)
+     */
+    uint32_t getAverageAckMs() const {
+        return stats.acked ? stats.totalAckMs / stats.acked : 0;
+    }
+
+private:
+    enum PacketType : uint8_t {
+        CONNECT = 1, CONNACK = 2, PUBLISH = 3, PUBACK = 4,
+        SUBSCRIBE = 8, SUBACK = 9, PINGREQ = 12, PINGRESP = 13, DISCONNECT = 14
+    };
+
+    enum ReceiveState : uint8_t {
+        RX_HEADER = 0,
+        RX_LENGTH,
+        RX_BODY
+    };
+
+    Socket& socket;
+    Platform& platform;
+    Handler& handler;
+    Stats stats;
+
+    bool open;
+    bool sessionPresent;
+    uint32_t keepAliveMs;
+    uint32_t ackTimeoutMs;
+    uint32_t lastSend;
+    uint32_t pingSent;
+    bool pingOutstanding;
+    uint16_t nextPacketId;
+
+    // Streamed publish in progress
+    size_t publishRemaining;
+    uint8_t publishQos;
+    uint16_t publishId;
+    uint32_t publishStart;
+
+    // Acknowledgement being waited for
+    uint8_t awaitType;
+    uint16_t awaitId;
+    bool awaitDone;
+    uint8_t connackCode;
+    uint8_t subackCode;
+
+    // Incoming packet
+    ReceiveState rxState;
+    uint8_t rxHeader;
+    uint32_t rxLength;
+    uint8_t rxShift;
+    uint32_t rxReceived;
+    uint8_t rxBuffer[MaxPacket];
+
+    uint16_t takePacketId() {
+        uint16_t id = nextPacketId++;
+        if (nextPacketId == 0) {
+            nextPacketId = 1;
+        }
+        return id;
+    }
+
+    bool send(const void* data, size_t length) {
+        if (!open) {
+            return false;
+        }
+        if (length > 0 && socket.write((const uint8_t*)data, length) != length) {
+            close();
+            return false;
+        }
+        lastSend = platform.millis();
+        return true;
+    }
+
+    bool sendHeader(uint8_t header, size_t remaining) {
+        uint8_t bytes[5];
+        size_t count = 0;
+        bytes[count++] = header;
+        do {
+            uint8_t digit = remaining % 128;
+            remaining /= 128;
+            bytes[count++] = digit | (remaining > 0 ? 0x80 : 0x00);
+        } while (remaining > 0 && count < sizeof(bytes));
+        return send(bytes, count);
+    }
+
+    bool sendString(const char* text) {
+        size_t length = strlen(text);
+        uint8_t prefix[2] = { (uint8_t)(length >> 8), (uint8_t)length };
+        return send(prefix, 2) && send(text, length);
+    }
+
+    /**
+     * @brief Read until the given acknowledgement arrives (other packets are handled)
+     */
+    bool await(uint8_t type, uint16_t id) {
+        awaitType = type;
+        awaitId = id;
+        awaitDone = false;
+
+        uint32_t start = platform.millis();
+        while (!awaitDone && open && platform.millis() - start < ackTimeoutMs) {
+            if (socket.available() > 0) {
+                pump();
+            } else if (!socket.connected()) {
+                close();
+            } else {
+                platform.delay(1);
+            }
+        }
+
+        awaitType = 0;
+        return awaitDone;
+    }
+
+    void pump() {
+        uint8_t chunk[64];
+        int available;
+        while (open && (available = socket.available()) > 0) {
+            int got = socket.read(chunk, available < (int)sizeof(chunk) ? available : (int)sizeof(chunk));
+            if (got <= 0) {
+                break;
+            }
+            for (int i = 0; i < got && open; i++) {
+                feed(chunk[i]);
+            }
+        }
+    }
+
+    void resetReceive() {
+        rxState = RX_HEADER;
+        awaitType = 0;
+        awaitDone = false;
+    }
+
+    void feed(uint8_t b) {
+        switch (rxState) {
+            case RX_HEADER:
+                rxHeader = b;
+                rxLength = 0;
+                rxShift = 0;
+                rxState = RX_LENGTH;
+                return;
+
+            case RX_LENGTH:
+                rxLength |= (uint32_t)(b & 0x7F) << rxShift;
+                rxShift += 7;
+                if (b & 0x80) {
+                    if (rxShift > 21) {
+                        close();  // Not MQTT
+                    }
+                    return;
+                }
+                rxReceived = 0;
+                if (rxLength > 0) {
+                    rxState = RX_BODY;
+                    return;
+                }
+                break;
+
+            case RX_BODY:
+                if (rxReceived < MaxPacket) {
+                    rxBuffer[rxReceived] = b;
+                }
+                if (++rxReceived < rxLength) {
+                    return;
+                }
+                break;
+        }
+
+        rxState = RX_HEADER;
+        size_t kept = rxLength < MaxPacket ? rxLength : MaxPacket;
+        handlePacket(rxHeader >> 4, rxHeader & 0x0F, kept, rxLength > MaxPacket);
+    }
+
+    void handlePacket(uint8_t type, uint8_t flags, size_t length, bool truncated) {
+        const uint8_t* body = rxBuffer;
+        uint16_t id = length >= 2 ? (uint16_t)((body[0] << 8) | body[1]) : 0;
+
+        switch (type) {
+            case CONNACK:
+                if (awaitType == CONNACK && length >= 2) {
+                    sessionPresent = body[0] & 0x01;
+                    connackCode = body[1];
+                    awaitDone = true;
+                }
+                break;
+
+            case PUBACK:
+                if (awaitType == PUBACK && id == awaitId) {
+                    awaitDone = true;
+                }
+                break;
+
+            case SUBACK:
+                if (awaitType == SUBACK && id == awaitId && length >= 3) {
+                    subackCode = body[2];
+                    awaitDone = true;
+                }
+                break;
+
+            case PINGRESP:
+                pingOutstanding = false;
+                break;
+
+            case PUBLISH:
+                handlePublish(flags, body, length, truncated);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void handlePublish(uint8_t flags, const uint8_t* body, size_t length, bool truncated) {
+        uint8_t qos = (flags >> 1) & 0x03;
+        size_t topicLength = length >= 2 ? (size_t)((body[0] << 8) | body[1]) : 0;
+        size_t offset = 2 + topicLength + (qos > 0 ? 2 : 0);
+        if (length < 2 || offset > length) {
+            if (truncated) {
+                stats.oversized++;  // Not even the topic fitted, cannot be acked
+            }
+            return;
+        }
+
+        if (truncated) {
+            stats.oversized++;
+        } else {
+            stats.received++;
+            handler.onMessage((const char*)body + 2, topicLength, body + offset, length - offset, flags & 0x01);
+        }
+
+        // Acked even when dropped, so the broker does not resend it forever
+        if (qos == 1) {
+            uint8_t ack[2] = { body[2 + topicLength], body[3 + topicLength] };
+            if (sendHeader(PUBACK << 4, 2)) {
+                send(ack, 2);
+            }
+        }
+    }
+};
+
+#endif // MQTTCLIENT_H
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "mqtttransport.h"
+
+#include "configjson.h"
+
+MqttTransport::MqttTransport(DeviceConfig& config)
+    : config(config), client(socket, platform, *this), started(false), lastConnectAttempt(0),
+      configMessages(0) {
+    memset(&linkStats, 0, sizeof(linkStats));
+}
+
+void MqttTransport::begin(const String& deviceRoot) {
+    root = deviceRoot;
+    clientId = root.substring(root.lastIndexOf('/') + 1);  // Device name, the broker keeps the session under it
+    batchTopic = root + "/batch";
+    statusTopic = root + "/status";
+    configPrefix = root + "/config/";
+    socket.begin();
+    started = true;
+
+    // Connected straight away, setup registers the device next
+    lastConnectAttempt = millis() - MQTT_RECONNECT_MS;
+    ensureConnected();
+}
+
+bool MqttTransport::ensureConnected() {
+    if (client.connected()) {
+        return true;
+    }
+
+    uint32_t now = millis();
+    if (!started || now - lastConnectAttempt < MQTT_RECONNECT_MS) {
+        return false;
+    }
+    lastConnectAttempt = now;
+
+    Client::Options options = {
+        clientId.c_str(),
+        strlen(MQTT_USERNAME) > 0 ? MQTT_USERNAME : nullptr,
+        strlen(MQTT_PASSWORD) > 0 ? MQTT_PASSWORD : nullptr,
+        MQTT_KEEPALIVE_S,
+        false,                  // Persistent session
+        statusTopic.c_str(),
+        "offline",
+        true,
+        MQTT_ACK_TIMEOUT_MS
+    };
+    if (!client.connect(MQTT_HOST, MQTT_PORT, options)) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.printf("[MQTT] ❌ Connect to %s:%u failed\n", MQTT_HOST, (unsigned)MQTT_PORT);
+        #endif
+        return false;
+    }
+
+    // Retained config follows the SUBACK; queued messages come first on a resumed session
+    String configFilter = configPrefix + "#";
+    if (!client.subscribe(configFilter.c_str(), 1) ||
+        !client.publish(statusTopic.c_str(), (const uint8_t*)"online", 6, 1, true)) {
+        client.close();
+        return false;
+    }
+
+    #if ENABLE_DEBUG_LOGS
+    Serial.printf("[MQTT] ✅ Connected as %s (%s session)\n", clientId.c_str(),
+                  client.isSessionPresent() ? "resumed" : "new");
+    #endif
+    return true;
+}
+
+bool MqttTransport::get(const String& path, String& json) {
+    (void)path;
+    (void)json;
+    return false;
+}
+
+bool MqttTransport::put(const String& path, const String& json) {
+    String topic = root + "/" + path;
+    return ensureConnected() &&
+           client.publish(topic.c_str(), (const uint8_t*)json.c_str(), json.length(), 1, true);
+}
+
+void MqttTransport::service() {
+    if (ensureConnected()) {
+        client.loop();
+    }
+}
+
+void MqttTransport::stop() {
+    client.close();
+}
+
+bool MqttTransport::beginPatch(size_t contentLength) {
+    return ensureConnected() && client.beginPublish(batchTopic.c_str(), contentLength, 1, false);
+}
+
+bool MqttTransport::write(const char* data, size_t length) {
+    return client.write((const uint8_t*)data, length);
+}
+
+bool MqttTransport::endPatch() {
+    return client.endPublish();
+}
+
+const FirebaseClient::Stats& MqttTransport::getStats() {
+    const Client::Stats& mqtt = client.getStats();
+    linkStats.requests = mqtt.published;
+    linkStats.failures = mqtt.failures;
+    linkStats.handshakes = mqtt.connects;
+    linkStats.lastLatencyMs = mqtt.lastAckMs;
+    linkStats.maxLatencyMs = mqtt.maxAckMs;
+    linkStats.totalLatencyMs = mqtt.totalAckMs;
+    return linkStats;
+}
+
+void MqttTransport::onMessage(const char* topic, size_t topicLength, const uint8_t* payload, size_t length,
+                              bool retained) {
+    (void)retained;
+    if (topicLength <= configPrefix.length() ||
+        strncmp(topic, configPrefix.c_str(), configPrefix.length()) != 0) {
+        return;
+    }
+
+    String path;
+    path.reserve(topicLength - configPrefix.length());
+    for (size_t i = configPrefix.length(); i < topicLength; i++) {
+        path += topic[i];
+    }
+    configMessages++;
+
+    // Empty (retained message cleared): back to the default
+    if (length == 0) {
+        config.reset(path.c_str());
+        return;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, payload, length)) {
+        // Not JSON: a plain text value (e.g. a parcel id)
+        String text;
+        text.reserve(length);
+        for (size_t i = 0; i < length; i++) {
+            text += (char)payload[i];
+        }
+        config.reset(path.c_str());
+        config.setString(path.c_str(), text.c_str());
+        return;
+    }
+    applyConfigJson(config, path.c_str(), doc.as<JsonVariantConst>());
+}
\ No newline at end of file
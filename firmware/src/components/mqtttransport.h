@@ -0,0 +1,133 @@
+#ifndef MQTTTRANSPORT_H
+#define MQTTTRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+
+#include "config.h"
+#include "deviceconfig.h"
+#include "firebaseclient.h"
+#include "mqttclient.h"
+
+/**
+ * @brief MqttClient socket on a WiFi client (TLS when MQTT_TLS)
+ */
+class EspMqttSocket {
+public:
+    void begin() {
+        #if MQTT_TLS
+        client.setInsecure();
+        #endif
+    }
+
+    bool connect(const char* host, uint16_t port) { return client.connect(host, port, MQTT_CONNECT_TIMEOUT_MS); }
+    size_t write(const uint8_t* data, size_t length) { return client.write(data, length); }
+    int available() { return client.available(); }
+    int read(uint8_t* buffer, size_t length) { return client.read(buffer, length); }
+    bool connected() { return client.connected(); }
+    void stop() { client.stop(); }
+
+private:
+    #if MQTT_TLS
+    WiFiClientSecure client;
+    #else
+    WiFiClient client;
+    #endif
+};
+
+/**
+ * @brief ESP32 platform for MqttClient
+ */
+struct EspMqttPlatform {
+    uint32_t millis() { return ::millis(); }
+    void delay(uint32_t ms) { ::delay(ms); }
+};
+
+/**
+ * @brief Telemetry transport over MQTT 3.1.1
+ *
+ * Topics below the device root (e.g. SmartParcels/TRACEON_XXXX):
+ * - batch: each UploadBatcher flush as one QoS 1 message, the payload
+ *   is the multi-path PATCH body ({"current": ..., "history/<key>": ...})
+ *   so a bridge can apply it to the database unchanged
+ * - <path>: put() values, retained (e.g. info)
+ * - config/<path>: retained, subscribed at QoS 1; each message replaces
+ *   that DeviceConfig subtree (config/thresholds, config/assignedParcelId),
+ *   an empty message resets it to its default
+ * - status: "online" retained, "offline" as the will
+ *
+ * The session is persistent (clean session off, client id = device
+ * name), so config changes published while the device was offline are
+ * delivered when it reconnects. Batches that were not acknowledged are
+ * kept and retried by the UploadBatcher, not by the client.
+ */
+class MqttTransport {
+public:
+    typedef MqttClient<EspMqttSocket, EspMqttPlatform, MqttTransport, MQTT_MAX_PACKET> Client;
+
+    explicit MqttTransport(DeviceConfig& config);
+
+    void begin(const String& deviceRoot);
+
+    /**
+     * @brief Not available over MQTT (retained values only reach subscribers)
+     */
+    bool get(const String& path, String& json);
+
+    bool put(const String& path, const String& json);
+
+    /**
+     * @brief Connect / reconnect, read config messages, keep-alive
+     *
+     * Call every network task pass while WiFi is up.
+     */
+    void service();
+
+    /**
+     * @brief Drop the connection (e.g. on WiFi loss), reopened by service()
+     */
+    void stop();
+
+    // UploadBatcher transport
+    bool beginPatch(size_t contentLength);
+    bool write(const char* data, size_t length);
+    bool endPatch();
+
+    /**
+     * @brief Link stats in the REST client's shape (status page)
+     *
+     * Publishes count as requests, sessions as handshakes and
+     * PUBLISH → PUBACK as latency.
+     */
+    const FirebaseClient::Stats& getStats();
+    uint32_t getAverageLatencyMs() const { return client.getAverageAckMs(); }
+    const Client::Stats& getMqttStats() const { return client.getStats(); }
+    bool isConnected() { return client.connected(); }
+    uint32_t getConfigMessages() const { return configMessages; }
+
+    /**
+     * @brief MqttClient callback
+     */
+    void onMessage(const char* topic, size_t topicLength, const uint8_t* payload, size_t length, bool retained);
+
+private:
+    DeviceConfig& config;
+    EspMqttSocket socket;
+    EspMqttPlatform platform;
+    Client client;
+    FirebaseClient::Stats linkStats;
+
+    String root;
+    String clientId;
+    String batchTopic;
+    String statusTopic;
+    String configPrefix;    // "<root>/config/"
+    bool started;
+    uint32_t lastConnectAttempt;
+    uint32_t configMessages;
+
+    bool ensureConnected();
+};
+
+#endif // MQTTTRANSPORT_H
\ No newline at end of file
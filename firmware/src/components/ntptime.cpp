@@ -0,0 +1,54 @@
+#include "ntptime.h"
+#include "config.h"
+
+#include <esp_sntp.h>
+#include <sys/time.h>
+
+static TimeSync::Config timeSyncConfig() {
+    TimeSync::Config config;
+    config.stepUs = TIME_SYNC_STEP_US;
+    config.minSpanUs = TIME_SYNC_MIN_SPAN_US;
+    config.maxDriftPpm = TIME_SYNC_MAX_DRIFT_PPM;
+    config.driftGain = TIME_SYNC_DRIFT_GAIN;
+    return config;
+}
+
+NtpTime::NtpTime() : sync(timeSyncConfig()) {
+}
+
+void NtpTime::begin() {
+    sntp_set_sync_interval(TIME_SYNC_INTERVAL_MS);
+    configTime(TIME_GMT_OFFSET_S, 0, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
+}
+
+bool NtpTime::service() {
+    // Reported once per sync, then back to RESET
+    if (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) {
+        return false;
+    }
+    
+    // The system clock runs on the same timer, any read delay cancels out
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    uint64_t mono = monotonicUs();
+    if (now.tv_sec < TIME_VALID_AFTER) {
+        return false;
+    }
+    
+    bool first = !sync.isSynced();
+    sync.sample(mono, (int64_t)now.tv_sec * 1000000LL + now.tv_usec);
+    
+    #if ENABLE_DEBUG_LOGS
+    TimeSync::Stats stats = sync.getStats();
+    if (first) {
+        Serial.printf("[NTP] ✅ Synced, unix %lu\n", (unsigned long)now.tv_sec);
+    } else {
+        Serial.printf("[NTP] Re-sync: %+lld us off, drift %.2f ppm\n",
+                      (long long)stats.lastErrorUs, stats.driftPpm);
+    }
+    #else
+    (void)first;
+    #endif
+    
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef NTPTIME_H
+#define NTPTIME_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include "timesync.h"
+
+/**
+ * @brief ESP32 SNTP feeding a TimeSync
+ *
+ * SNTP keeps re-syncing the system clock every TIME_SYNC_INTERVAL_MS;
+ * service() (network task) hands each completed sync to the TimeSync
+ * together with the monotonic clock. Conversions never read the system
+ * clock, so a sample is dated by the offset and drift in force, not by
+ * whenever it happens to be serialized.
+ */
+class NtpTime {
+public:
+    NtpTime();
+
+    /**
+     * @brief Start SNTP (needs a network)
+     */
+    void begin();
+
+    /**
+     * @brief Take a completed sync, if any
+     *
+     * @return true if a new pair was fed to the TimeSync
+     */
+    bool service();
+
+    /**
+     * @brief Same counter as millis(), in µs and never wrapping
+     */
+    static uint64_t monotonicUs() { return esp_timer_get_time(); }
+
+    bool isSynced() const { return sync.isSynced(); }
+    uint64_t toUnixMs(uint64_t monotonicUs) const { return sync.toUnixMs(monotonicUs); }
+    TimeSync::Stats getStats() const { return sync.getStats(); }
+
+private:
+    TimeSync sync;
+};
+
+#endif // NTPTIME_H
\ No newline at end of file
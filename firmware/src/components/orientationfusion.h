@@ -0,0 +1,191 @@
+#ifndef ORIENTATIONFUSION_H
+#define ORIENTATIONFUSION_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Package orientation classes
+ */
+enum Orientation : uint8_t {
+    ORIENTATION_UNKNOWN = 0,
+    ORIENTATION_UPRIGHT,
+    ORIENTATION_UPSIDE_DOWN,
+    ORIENTATION_TILTED,
+    ORIENTATION_SIDE_RIGHT,
+    ORIENTATION_SIDE_LEFT,
+    ORIENTATION_EDGE_FRONT,
+    ORIENTATION_EDGE_BACK,
+    ORIENTATION_FREE_FALL
+};
+
+/**
+ * @brief Display name for an orientation (only used at the output edge)
+ */
+inline const char* orientationName(Orientation orientation) {
+    switch (orientation) {
+        case ORIENTATION_UPRIGHT:     return "Upright";
+        case ORIENTATION_UPSIDE_DOWN: return "Upside Down";
+        case ORIENTATION_TILTED:      return "Tilted";
+        case ORIENTATION_SIDE_RIGHT:  return "On Side (Right)";
+        case ORIENTATION_SIDE_LEFT:   return "On Side (Left)";
+        case ORIENTATION_EDGE_FRONT:  return "On Edge (Front)";
+        case ORIENTATION_EDGE_BACK:   return "On Edge (Back)";
+        case ORIENTATION_FREE_FALL:   return "Free Fall";
+        default:                      return "Unknown";
+    }
+}
+
+/**
+ * @brief Madgwick gyro + accelerometer fusion
+ *
+ * Keeps a quaternion estimate updated from every IMU sample. The gyro
+ * is integrated and the accelerometer pulls pitch/roll back towards
+ * gravity with gain beta. Accelerometer correction is skipped while
+ * |a| is far from 1 g (drops, impacts) so shocks do not corrupt the
+ * attitude.
+ */
+class OrientationFusion {
+public:
+    OrientationFusion() : q0(1), q1(0), q2(0), q3(0), beta(0.1f), samplePeriod(0.002f) {}
+
+    /**
+     * @brief Set filter gain and update rate
+     *
+     * @param gain Madgwick beta (higher trusts the accelerometer more)
+     * @param sampleRateHz Rate update() is called at
+     */
+    void configure(float gain, uint16_t sampleRateHz) {
+        beta = gain;
+        samplePeriod = 1.0f / (sampleRateHz > 0 ? sampleRateHz : 1);
+    }
+
+    /**
+     * @brief Snap the estimate to the attitude implied by gravity alone
+     *
+     * @param ax, ay, az Acceleration (any unit)
+     */
+    void reset(float ax, float ay, float az) {
+        float roll = atan2f(ay, az);
+        float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+        float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+        float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+
+        q0 = cr * cp;
+        q1 = sr * cp;
+        q2 = cr * sp;
+        q3 = -sr * sp;
+    }
+
+    /**
+     * @brief Fold one sample into the estimate
+     *
+     * @param gx, gy, gz Angular rate (rad/s)
+     * @param ax, ay, az Acceleration in g
+     */
+    void update(float gx, float gy, float gz, float ax, float ay, float az) {
+        // Rate of change of quaternion from gyroscope
+        float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+        float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+        float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+        float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+        float normSq = ax * ax + ay * ay + az * az;
+        if (normSq > 0.25f && normSq < 2.25f) {
+            float recipNorm = 1.0f / sqrtf(normSq);
+            ax *= recipNorm;
+            ay *= recipNorm;
+            az *= recipNorm;
+
+            float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+            float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+            float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+            float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+            // Gradient descent step towards measured gravity
+            float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+            float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 +
+                       _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+            float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 +
+                       _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+            float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+            float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+            if (sNorm > 0.0f) {
+                recipNorm = 1.0f / sqrtf(sNorm);
+                qDot0 -= beta * s0 * recipNorm;
+                qDot1 -= beta * s1 * recipNorm;
+                qDot2 -= beta * s2 * recipNorm;
+                qDot3 -= beta * s3 * recipNorm;
+            }
+        }
+
+        q0 += qDot0 * samplePeriod;
+        q1 += qDot1 * samplePeriod;
+        q2 += qDot2 * samplePeriod;
+        q3 += qDot3 * samplePeriod;
+
+        float recipNorm = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        q0 *= recipNorm;
+        q1 *= recipNorm;
+        q2 *= recipNorm;
+        q3 *= recipNorm;
+    }
+
+    // Euler angles (degrees)
+    float getRoll() const { return toDegrees(atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2)); }
+    float getPitch() const { return toDegrees(asinf(clampUnit(-2.0f * (q1 * q3 - q0 * q2)))); }
+    float getYaw() const { return toDegrees(atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3)); }
+
+    /**
+     * @brief Angle between the package Z axis and vertical (0° = upright)
+     */
+    float getTilt() const {
+        float gx, gy, gz;
+        gravity(gx, gy, gz);
+        return toDegrees(acosf(clampUnit(gz)));
+    }
+
+    /**
+     * @brief Classify the current estimate
+     *
+     * @param uprightMaxTilt Tilt at or below this is upright (degrees)
+     * @param invertedMinTilt Tilt at or above this is upside down (degrees)
+     */
+    Orientation classify(float uprightMaxTilt, float invertedMinTilt) const {
+        float gx, gy, gz;
+        gravity(gx, gy, gz);
+
+        float absX = fabsf(gx), absY = fabsf(gy), absZ = fabsf(gz);
+
+        // Z-axis dominant (normal orientation)
+        if (absZ > absX && absZ > absY) {
+            float tilt = toDegrees(acosf(clampUnit(gz)));
+            if (tilt <= uprightMaxTilt) return ORIENTATION_UPRIGHT;
+            if (tilt >= invertedMinTilt) return ORIENTATION_UPSIDE_DOWN;
+            return ORIENTATION_TILTED;
+        }
+        if (absX > absY) {
+            return gx > 0 ? ORIENTATION_SIDE_RIGHT : ORIENTATION_SIDE_LEFT;
+        }
+        return gy > 0 ? ORIENTATION_EDGE_FRONT : ORIENTATION_EDGE_BACK;
+    }
+
+private:
+    float q0, q1, q2, q3;
+    float beta;
+    float samplePeriod;
+
+    // Expected direction of gravity in the sensor frame (unit vector)
+    void gravity(float& gx, float& gy, float& gz) const {
+        gx = 2.0f * (q1 * q3 - q0 * q2);
+        gy = 2.0f * (q0 * q1 + q2 * q3);
+        gz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+    }
+
+    static float toDegrees(float radians) { return radians * 57.29577951f; }
+    static float clampUnit(float v) { return v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : v); }
+};
+
+#endif // ORIENTATIONFUSION_H
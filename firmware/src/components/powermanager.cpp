@@ -0,0 +1,64 @@
+#include "powermanager.h"
+#include "mpu6050.h"
+#include "config.h"
+
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+EspSleepPlatform::EspSleepPlatform(MPU6050Sensor* mpuSensor, uint8_t intPin)
+    : mpu(mpuSensor), intPin(intPin), motionWake(false) {
+}
+
+bool EspSleepPlatform::begin() {
+    pinMode(intPin, INPUT);
+    
+    motionWake = mpu && mpu->isConnected() &&
+                 mpu->enableMotionWake(MOTION_THRESHOLD_MG, MOTION_DURATION_MS);
+    
+    if (motionWake) {
+        gpio_wakeup_enable((gpio_num_t)intPin, GPIO_INTR_HIGH_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+    }
+    
+    #if ENABLE_DEBUG_LOGS
+    Serial.printf("[POWER] Light sleep enabled (motion wake: %s)\n", motionWake ? "GPIO" : "off");
+    #endif
+    
+    return motionWake;
+}
+
+bool EspSleepPlatform::motionPending() {
+    if (!motionWake) {
+        // Without the interrupt the IMU must keep sampling
+        return true;
+    }
+    
+    if (digitalRead(intPin) == LOW) {
+        return false;
+    }
+    
+    return mpu->checkMotion();
+}
+
+bool EspSleepPlatform::sleepAllowed() {
+    // Radio is off during light sleep, don't strand direct-AP dashboard users
+    return WiFi.softAPgetStationNum() == 0;
+}
+
+void EspSleepPlatform::setImuStill(bool still) {
+    mpu->setFifoSampling(!still);
+    
+    #if ENABLE_DEBUG_LOGS
+    Serial.println(still ? "[POWER] 💤 No motion - IMU FIFO paused" : "[POWER] 🔔 Motion - IMU FIFO resumed");
+    #endif
+}
+
+void EspSleepPlatform::lightSleep(uint32_t ms) {
+    #if ENABLE_DEBUG_LOGS
+    Serial.flush();
+    #endif
+    
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+    esp_light_sleep_start();
+}
@@ -0,0 +1,50 @@
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include <Arduino.h>
+
+#include "sleepscheduler.h"
+
+class MPU6050Sensor;
+
+/**
+ * @brief ESP32 platform for SleepScheduler
+ * 
+ * Provides:
+ * - millis() clock
+ * - MPU6050 motion interrupt (latched on MPU6050_INT_PIN)
+ * - Light sleep with timer + GPIO wake
+ * - Sleep veto while clients are connected to the direct AP
+ */
+class EspSleepPlatform {
+public:
+    /**
+     * @brief Construct sleep platform
+     * 
+     * @param mpuSensor Pointer to MPU6050 instance
+     * @param intPin GPIO connected to the MPU6050 INT pin
+     */
+    EspSleepPlatform(MPU6050Sensor* mpuSensor, uint8_t intPin);
+    
+    /**
+     * @brief Configure the wake pin and arm the motion interrupt
+     * 
+     * @return true if the motion interrupt is available
+     */
+    bool begin();
+    
+    uint32_t millis() { return ::millis(); }
+    bool motionPending();
+    bool sleepAllowed();
+    void setImuStill(bool still);
+    void lightSleep(uint32_t ms);
+
+private:
+    MPU6050Sensor* mpu;
+    uint8_t intPin;
+    bool motionWake;
+};
+
+typedef SleepScheduler<EspSleepPlatform> PowerManager;
+
+#endif // POWERMANAGER_H
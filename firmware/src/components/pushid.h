@@ -0,0 +1,79 @@
+#ifndef PUSHID_H
+#define PUSHID_H
+
+#include <stdint.h>
+
+#define PUSH_ID_LENGTH 20
+
+/**
+ * @brief Client-side Firebase push IDs
+ *
+ * Same format the Firebase SDKs generate for push(): 8 characters of
+ * millisecond timestamp followed by 12 random characters, in an
+ * alphabet that sorts lexicographically in time order. IDs generated
+ * within the same millisecond increment the random part, so keys stay
+ * strictly ordered. Lets a batch carry several history entries without
+ * one POST each.
+ */
+class PushIdGenerator {
+public:
+    explicit PushIdGenerator(uint32_t seed) : state(seed ? seed : 0x9E3779B9u), lastTime(0) {
+        for (uint8_t i = 0; i < 12; i++) {
+            lastRandom[i] = 0;
+        }
+    }
+
+    /**
+     * @brief Write the next ID
+     *
+     * @param timestampMs Epoch milliseconds
+     * @param out PUSH_ID_LENGTH + 1 bytes (NUL terminated)
+     */
+    void generate(uint64_t timestampMs, char* out) {
+        static const char ALPHABET[] =
+            "-0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz";
+
+        bool sameTime = (timestampMs == lastTime);
+        lastTime = timestampMs;
+
+        for (int i = 7; i >= 0; i--) {
+            out[i] = ALPHABET[timestampMs % 64];
+            timestampMs /= 64;
+        }
+
+        if (!sameTime) {
+            for (uint8_t i = 0; i < 12; i++) {
+                lastRandom[i] = nextRandom() % 64;
+            }
+        } else {
+            // Increment the random part so IDs in one millisecond stay ordered
+            int i = 11;
+            for (; i >= 0 && lastRandom[i] == 63; i--) {
+                lastRandom[i] = 0;
+            }
+            if (i >= 0) {
+                lastRandom[i]++;
+            }
+        }
+
+        for (uint8_t i = 0; i < 12; i++) {
+            out[8 + i] = ALPHABET[lastRandom[i]];
+        }
+        out[PUSH_ID_LENGTH] = '\0';
+    }
+
+private:
+    uint32_t state;
+    uint64_t lastTime;
+    uint8_t lastRandom[12];
+
+    // xorshift32, seeded from the hardware RNG on the device
+    uint32_t nextRandom() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+#endif // PUSHID_H
\ No newline at end of file
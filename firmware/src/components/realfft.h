@@ -0,0 +1,109 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-size radix-2 FFT of a real signal
+ *
+ * N real points are packed as N/2 complex values, transformed in place
+ * with an iterative radix-2 FFT and split back into the N/2 + 1 bins of
+ * the real spectrum. Twiddles are computed once into member tables, so
+ * a transform does no trig and no heap allocation.
+ *
+ * @tparam N Transform size (power of two)
+ */
+template <size_t N>
+class RealFft {
+    static_assert(N >= 8 && (N & (N - 1)) == 0, "RealFft size must be a power of two");
+
+public:
+    static const size_t BINS = N / 2 + 1;
+
+    RealFft() {
+        for (size_t k = 0; k < N / 2; k++) {
+            float angle = 2.0f * 3.14159265f * k / N;
+            cosTable[k] = cosf(angle);
+            sinTable[k] = sinf(angle);
+        }
+    }
+
+    /**
+     * @brief Power spectrum |X[k]|² of N real samples
+     *
+     * @param data N samples, overwritten with intermediate results
+     * @param power BINS outputs, DC to Nyquist
+     */
+    void powerSpectrum(float* data, float* power) const {
+        const size_t M = N / 2;
+
+        // Complex FFT of z[k] = x[2k] + i·x[2k+1], interleaved in place
+        bitReverse(data);
+        for (size_t len = 2; len <= M; len <<= 1) {
+            size_t half = len / 2;
+            size_t step = N / len;
+
+            for (size_t i = 0; i < M; i += len) {
+                for (size_t j = 0; j < half; j++) {
+                    float wr = cosTable[j * step];
+                    float wi = -sinTable[j * step];
+                    size_t a = 2 * (i + j);
+                    size_t b = a + 2 * half;
+
+                    float tr = data[b] * wr - data[b + 1] * wi;
+                    float ti = data[b] * wi + data[b + 1] * wr;
+                    data[b] = data[a] - tr;
+                    data[b + 1] = data[a + 1] - ti;
+                    data[a] += tr;
+                    data[a + 1] += ti;
+                }
+            }
+        }
+
+        // Split Z into the spectrum of the even / odd real samples
+        float dc = data[0] + data[1];
+        float nyquist = data[0] - data[1];
+        power[0] = dc * dc;
+        power[M] = nyquist * nyquist;
+
+        for (size_t k = 1; k < M; k++) {
+            float zr = data[2 * k], zi = data[2 * k + 1];
+            float cr = data[2 * (M - k)], ci = -data[2 * (M - k) + 1];
+
+            float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+            float orr = 0.5f * (zr - cr), oi = 0.5f * (zi - ci);
+
+            float c = cosTable[k], s = sinTable[k];
+            float xr = er + c * oi - s * orr;
+            float xi = ei - c * orr - s * oi;
+            power[k] = xr * xr + xi * xi;
+        }
+    }
+
+private:
+    float cosTable[N / 2];
+    float sinTable[N / 2];
+
+    static void bitReverse(float* data) {
+        const size_t M = N / 2;
+        for (size_t i = 1, j = 0; i < M; i++) {
+            size_t bit = M >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+
+            if (i < j) {
+                float tr = data[2 * i], ti = data[2 * i + 1];
+                data[2 * i] = data[2 * j];
+                data[2 * i + 1] = data[2 * j + 1];
+                data[2 * j] = tr;
+                data[2 * j + 1] = ti;
+            }
+        }
+    }
+};
+
+#endif // REALFFT_H
\ No newline at end of file
@@ -0,0 +1,470 @@
+#ifndef RECORDLOG_H
+#define RECORDLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Append-only record log on raw NOR flash (store-and-forward)
+ *
+ * The region is a ring of 4 KB sectors. Each sector starts with a
+ * header carrying a sequence number and its erase count. Records are
+ * appended behind it and never rewritten. A sector is erased only when
+ * the head wraps round onto it, so every sector sees the same number of
+ * erases. When the ring is full the oldest sector is given up.
+ *
+ * Reading is a cursor: rewind() to the oldest unconsumed record,
+ * next() through a batch, then commit() once the batch has been
+ * delivered. commit() clears one state byte of the batch's last
+ * record, so each batch costs a single extra byte write.
+ *
+ * Crash safety:
+ * - records carry a CRC. A torn append fails its check on mount and
+ *   the sector is closed there, appends continue in a fresh sector
+ * - a torn sector erase / header write leaves an invalid header, the
+ *   sector is treated as free
+ * - commit markers only ever clear bits, any cleared bit counts
+ * - a batch delivered but not committed before power loss is replayed
+ *   again (at least once)
+ *
+ * A Flash must provide (NOR semantics, writes only clear bits):
+ * - uint32_t size()                                      bytes, multiple of 4 KB
+ * - bool read(uint32_t offset, void* data, size_t length)
+ * - bool write(uint32_t offset, const void* data, size_t length)
+ * - bool eraseSector(uint32_t offset)                    4 KB aligned
+ */
+template <typename Flash>
+class RecordLog {
+public:
+    static const uint32_t SECTOR_SIZE = 4096;
+    static const uint16_t MAX_PAYLOAD = 2048;
+
+    struct Record {
+        uint8_t type;             // Caller defined
+        uint64_t timestampMs;
+        uint16_t length;          // Payload bytes
+    };
+
+    struct Stats {
+        uint32_t appended;        // Records written
+        uint32_t replayed;        // Records committed
+        uint32_t lost;            // Unread records given up when the ring was full
+        uint32_t corrupt;         // Torn / damaged records skipped
+        uint32_t erases;          // Sector erases since mount
+        uint32_t maxSectorErases; // Highest erase count of any sector seen
+    };
+
+    explicit RecordLog(Flash& flash)
+        : flash(flash), sectors(0), headSector(0), headOffset(0), headSequence(0),
+          pending(0), readCount(0), lastReadValid(false), mounted(false) {
+        tail.sector = read.sector = lastRead.sector = 0;
+        tail.offset = read.offset = lastRead.offset = SECTOR_HEADER;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * @brief Recover head, tail and pending count from flash
+     *
+     * Formats the first sector if no valid sector is found.
+     *
+     * @return false if the region is too small or flash access failed
+     */
+    bool mount() {
+        mounted = false;
+        sectors = flash.size() / SECTOR_SIZE;
+        if (sectors < 2) {
+            return false;
+        }
+
+        // Newest valid sector is the head
+        SectorHeader header;
+        bool found = false;
+        for (uint32_t s = 0; s < sectors; s++) {
+            if (readSector(s, header) && (!found || header.sequence > headSequence)) {
+                headSector = s;
+                headSequence = header.sequence;
+                found = true;
+            }
+        }
+
+        pending = 0;
+        if (!found) {
+            if (!openSector(0, 1)) {
+                return false;
+            }
+            headSector = 0;
+            headSequence = 1;
+            headOffset = SECTOR_HEADER;
+            tail.sector = 0;
+            tail.offset = SECTOR_HEADER;
+            rewind();
+            mounted = true;
+            return true;
+        }
+
+        // Walk back through consecutive sequence numbers to the oldest
+        uint32_t oldest = headSector;
+        for (uint32_t i = 1; i < sectors; i++) {
+            uint32_t previous = (oldest + sectors - 1) % sectors;
+            if (!readSector(previous, header) || header.sequence != headSequence - i) {
+                break;
+            }
+            oldest = previous;
+        }
+
+        // Records after the newest commit marker are pending
+        tail.sector = oldest;
+        tail.offset = SECTOR_HEADER;
+        for (uint32_t s = oldest; ; s = (s + 1) % sectors) {
+            uint32_t offset = SECTOR_HEADER;
+            RecordHeader record;
+            Scan result;
+            while ((result = scan(s, offset, record)) == SCAN_RECORD) {
+                if (!verify(s, offset, record)) {
+                    result = SCAN_CORRUPT;
+                    break;
+                }
+                offset += recordSize(record.length);
+                pending++;
+                if (record.state != STATE_LIVE) {
+                    tail.sector = s;
+                    tail.offset = offset;
+                    pending = 0;
+                }
+            }
+            if (result == SCAN_CORRUPT) {
+                stats.corrupt++;
+            }
+
+            if (s == headSector) {
+                // Never append over a torn record or partly written bytes
+                headOffset = (result == SCAN_CORRUPT || !isErased(s, offset)) ? SECTOR_SIZE : offset;
+                break;
+            }
+        }
+
+        rewind();
+        mounted = true;
+        return true;
+    }
+
+    /**
+     * @brief Append one record
+     *
+     * @return false if not mounted, too large or the flash write failed
+     */
+    bool append(uint8_t type, uint64_t timestampMs, const char* payload, uint16_t length) {
+        if (!mounted || length > MAX_PAYLOAD) {
+            return false;
+        }
+
+        uint32_t size = recordSize(length);
+        if (headOffset + size > SECTOR_SIZE && !advanceHead()) {
+            return false;
+        }
+
+        RecordHeader record;
+        record.length = length;
+        record.type = type;
+        record.state = STATE_LIVE;
+        record.timestampMs = timestampMs;
+        record.crc = recordCrc(record, payload);
+
+        uint32_t at = sectorBase(headSector) + headOffset;
+        bool ok = flash.write(at, &record, sizeof(record)) &&
+                  flash.write(at + sizeof(record), payload, length);
+
+        // A failed write leaves a torn record, continue in a fresh sector
+        headOffset = ok ? headOffset + size : SECTOR_SIZE;
+        if (!ok) {
+            return false;
+        }
+
+        pending++;
+        stats.appended++;
+        return true;
+    }
+
+    /**
+     * @brief Move the read cursor back to the oldest unconsumed record
+     */
+    void rewind() {
+        read = tail;
+        readCount = 0;
+        lastReadValid = false;
+    }
+
+    /**
+     * @brief Read the record at the cursor and advance
+     *
+     * @param payload Receives the payload (not NUL terminated)
+     * @param capacity Payload buffer size, MAX_PAYLOAD is always enough
+     * @return false when no more records are pending
+     */
+    bool next(Record& out, char* payload, size_t capacity) {
+        if (!mounted) {
+            return false;
+        }
+
+        while (true) {
+            RecordHeader record;
+            Scan result = scan(read.sector, read.offset, record);
+
+            if (result == SCAN_RECORD) {
+                uint32_t at = sectorBase(read.sector) + read.offset;
+                Position current = read;
+                read.offset += recordSize(record.length);
+
+                if (record.length <= capacity &&
+                    flash.read(at + sizeof(record), payload, record.length) &&
+                    recordCrc(record, payload) == record.crc) {
+                    out.type = record.type;
+                    out.timestampMs = record.timestampMs;
+                    out.length = record.length;
+                    lastRead = current;
+                    lastReadValid = true;
+                    readCount++;
+                    return true;
+                }
+
+                stats.corrupt++;
+                readCount++;
+                continue;
+            }
+
+            if (result == SCAN_CORRUPT) {
+                stats.corrupt++;
+            }
+            if (read.sector == headSector) {
+                return false;
+            }
+            read.sector = (read.sector + 1) % sectors;
+            read.offset = SECTOR_HEADER;
+        }
+    }
+
+    /**
+     * @brief Mark everything read since rewind() as consumed
+     */
+    bool commit() {
+        if (readCount == 0) {
+            return true;
+        }
+
+        bool ok = true;
+        if (lastReadValid) {
+            uint8_t consumed = STATE_CONSUMED;
+            ok = flash.write(sectorBase(lastRead.sector) + lastRead.offset + STATE_OFFSET, &consumed, 1);
+        }
+
+        stats.replayed += readCount;
+        pending = pending > readCount ? pending - readCount : 0;
+        tail = read;
+        readCount = 0;
+        lastReadValid = false;
+        return ok;
+    }
+
+    bool isMounted() const { return mounted; }
+    uint32_t getPendingCount() const { return pending; }
+    uint32_t getSectorCount() const { return sectors; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t erases;
+        uint32_t crc;
+    };
+
+    struct RecordHeader {
+        uint16_t length;          // 0xFFFF: erased, end of sector
+        uint8_t type;
+        uint8_t state;            // STATE_LIVE until committed (not in the CRC)
+        uint32_t crc;             // length, type, timestamp, payload
+        uint64_t timestampMs;
+    };
+
+    struct Position {
+        uint32_t sector;
+        uint32_t offset;
+    };
+
+    enum Scan {
+        SCAN_RECORD,
+        SCAN_END,
+        SCAN_CORRUPT
+    };
+
+    static const uint32_t MAGIC = 0x544C4F47;   // "TLOG"
+    static const uint32_t SECTOR_HEADER = sizeof(SectorHeader);
+    static const uint32_t STATE_OFFSET = 3;
+    static const uint8_t STATE_LIVE = 0xFF;
+    static const uint8_t STATE_CONSUMED = 0x00;
+
+    Flash& flash;
+    uint32_t sectors;
+    uint32_t headSector;
+    uint32_t headOffset;
+    uint32_t headSequence;
+    Position tail;            // Oldest unconsumed record
+    Position read;            // Cursor
+    Position lastRead;        // Last record returned by next()
+    uint32_t pending;
+    uint32_t readCount;
+    bool lastReadValid;
+    bool mounted;
+    Stats stats;
+
+    static uint32_t sectorBase(uint32_t sector) { return sector * SECTOR_SIZE; }
+    static uint32_t recordSize(uint16_t length) { return (sizeof(RecordHeader) + length + 3) & ~3u; }
+
+    static uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+        const uint8_t* p = (const uint8_t*)data;
+        crc = ~crc;
+        while (length--) {
+            crc ^= *p++;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    static uint32_t sectorCrc(const SectorHeader& header) {
+        return crc32(0, &header, offsetof(SectorHeader, crc));
+    }
+
+    static uint32_t recordCrc(const RecordHeader& record, const char* payload) {
+        uint32_t crc = crc32(0, &record.length, sizeof(record.length));
+        crc = crc32(crc, &record.type, sizeof(record.type));
+        crc = crc32(crc, &record.timestampMs, sizeof(record.timestampMs));
+        return crc32(crc, payload, record.length);
+    }
+
+    bool readSector(uint32_t sector, SectorHeader& header) {
+        return flash.read(sectorBase(sector), &header, sizeof(header)) &&
+               header.magic == MAGIC && header.crc == sectorCrc(header);
+    }
+
+    Scan scan(uint32_t sector, uint32_t offset, RecordHeader& record) {
+        if (offset + sizeof(record) > SECTOR_SIZE) {
+            return SCAN_END;
+        }
+        if (!flash.read(sectorBase(sector) + offset, &record, sizeof(record))) {
+            return SCAN_CORRUPT;
+        }
+        if (record.length == 0xFFFF) {
+            return SCAN_END;
+        }
+        if (record.length > MAX_PAYLOAD || offset + recordSize(record.length) > SECTOR_SIZE) {
+            return SCAN_CORRUPT;
+        }
+        return SCAN_RECORD;
+    }
+
+    // CRC check without a payload-sized buffer
+    bool verify(uint32_t sector, uint32_t offset, const RecordHeader& record) {
+        uint32_t crc = crc32(0, &record.length, sizeof(record.length));
+        crc = crc32(crc, &record.type, sizeof(record.type));
+        crc = crc32(crc, &record.timestampMs, sizeof(record.timestampMs));
+
+        uint8_t buffer[64];
+        uint32_t at = sectorBase(sector) + offset + sizeof(record);
+        for (uint32_t done = 0; done < record.length; ) {
+            size_t length = record.length - done < sizeof(buffer) ? record.length - done : sizeof(buffer);
+            if (!flash.read(at + done, buffer, length)) {
+                return false;
+            }
+            crc = crc32(crc, buffer, length);
+            done += length;
+        }
+        return crc == record.crc;
+    }
+
+    bool isErased(uint32_t sector, uint32_t offset) {
+        uint8_t buffer[64];
+        while (offset < SECTOR_SIZE) {
+            size_t length = SECTOR_SIZE - offset < sizeof(buffer) ? SECTOR_SIZE - offset : sizeof(buffer);
+            if (!flash.read(sectorBase(sector) + offset, buffer, length)) {
+                return false;
+            }
+            for (size_t i = 0; i < length; i++) {
+                if (buffer[i] != 0xFF) {
+                    return false;
+                }
+            }
+            offset += length;
+        }
+        return true;
+    }
+
+    uint32_t countRecords(uint32_t sector, uint32_t offset) {
+        uint32_t count = 0;
+        RecordHeader record;
+        while (scan(sector, offset, record) == SCAN_RECORD) {
+            offset += recordSize(record.length);
+            count++;
+        }
+        return count;
+    }
+
+    bool openSector(uint32_t sector, uint32_t sequence) {
+        SectorHeader header;
+        uint32_t erases = readSector(sector, header) ? header.erases : 0;
+
+        stats.erases++;
+        if (!flash.eraseSector(sectorBase(sector))) {
+            return false;
+        }
+
+        header.magic = MAGIC;
+        header.sequence = sequence;
+        header.erases = erases + 1;
+        header.crc = sectorCrc(header);
+        if (header.erases > stats.maxSectorErases) {
+            stats.maxSectorErases = header.erases;
+        }
+        return flash.write(sectorBase(sector), &header, sizeof(header));
+    }
+
+    bool advanceHead() {
+        uint32_t next = (headSector + 1) % sectors;
+
+        // Ring full: give up the oldest sector
+        if (next == tail.sector) {
+            uint32_t dropped = countRecords(tail.sector, tail.offset);
+            pending = pending > dropped ? pending - dropped : 0;
+
+            if (read.sector == next) {
+                // Records already read from it are still in flight, the rest are lost
+                stats.lost += dropped > readCount ? dropped - readCount : 0;
+                readCount = 0;
+            } else {
+                readCount = readCount > dropped ? readCount - dropped : 0;
+            }
+
+            tail.sector = (next + 1) % sectors;
+            tail.offset = SECTOR_HEADER;
+            if (read.sector == next) {
+                read = tail;
+            }
+            if (lastRead.sector == next) {
+                lastReadValid = false;
+            }
+        }
+
+        if (!openSector(next, headSequence + 1)) {
+            return false;
+        }
+
+        headSector = next;
+        headSequence++;
+        headOffset = SECTOR_HEADER;
+        return true;
+    }
+};
+
+#endif // RECORDLOG_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef REPLAYSENSORS_H
+#define REPLAYSENSORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dht11decode.h"
+#include "imusample.h"
+
+/**
+ * @brief Imu backend that replays recorded raw samples
+ *
+ * Plugs into SensorPipeline in place of MPU6050Sensor, so the whole
+ * processing core runs on the host against captured data. Each
+ * service() call releases the next samplesPerService samples, like a
+ * FIFO drain would.
+ */
+class ReplayImu {
+public:
+    ReplayImu(const ImuRawSample* samples, size_t count, uint16_t sampleRateHz, size_t samplesPerService)
+        : samples(samples), count(count), sampleRateHz(sampleRateHz),
+          samplesPerService(samplesPerService), released(0), next(0), rawTemperature(0) {}
+
+    bool isConnected() const { return true; }
+    bool isStreaming() const { return sampleRateHz > 0; }
+    uint16_t getSampleRate() const { return sampleRateHz; }
+
+    void service() {
+        released += samplesPerService;
+        if (released > count) released = count;
+    }
+
+    size_t getQueuedSamples() const { return released > next ? released - next : 0; }
+
+    bool popSample(ImuRawSample& sample) {
+        if (next >= released) {
+            return false;
+        }
+        sample = samples[next++];
+        return true;
+    }
+
+    bool readSample(ImuRawSample& sample, int16_t& temperature) {
+        if (next >= count) {
+            return false;
+        }
+        sample = samples[next++];
+        temperature = rawTemperature;
+        return true;
+    }
+
+    bool readTemperature(int16_t& temperature) {
+        temperature = rawTemperature;
+        return true;
+    }
+
+    void setRawTemperature(int16_t raw) { rawTemperature = raw; }
+    bool finished() const { return next >= count; }
+
+private:
+    const ImuRawSample* samples;
+    size_t count;
+    uint16_t sampleRateHz;
+    size_t samplesPerService;
+    size_t released;
+    size_t next;
+    int16_t rawTemperature;
+};
+
+/**
+ * @brief Env backend that replays recorded DHT11 readings
+ *
+ * readSensor() queues the next reading, update() completes it.
+ */
+class ReplayEnv {
+public:
+    ReplayEnv(const DhtReading* readings, size_t count)
+        : readings(readings), count(count), next(0), pending(false), dataValid(false) {
+        current.temperature = 0;
+        current.humidity = 0;
+    }
+
+    bool readSensor() {
+        if (next < count) {
+            pending = true;
+        }
+        return dataValid;
+    }
+
+    bool update() {
+        if (!pending) {
+            return false;
+        }
+        pending = false;
+        current = readings[next++];
+        dataValid = true;
+        return true;
+    }
+
+    bool isValid() const { return dataValid; }
+    float getTemperature() const { return current.temperature; }
+    float getHumidity() const { return current.humidity; }
+
+private:
+    const DhtReading* readings;
+    size_t count;
+    size_t next;
+    bool pending;
+    bool dataValid;
+    DhtReading current;
+};
+
+/**
+ * @brief Host platform: simulated clock, no cycle counter
+ */
+struct ReplayPlatform {
+    static uint32_t cycleCount() { return 0; }
+
+    // Simulated clock, advanced by the test
+    static uint32_t& now() {
+        static uint32_t ms = 0;
+        return ms;
+    }
+    static uint32_t millis() { return now(); }
+    static uint64_t monotonicUs() { return (uint64_t)now() * 1000; }
+};
+
+#endif // REPLAYSENSORS_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Fixed-capacity lock-free ring buffer (single producer, single consumer)
+ *
+ * Storage is a plain array sized at compile time, so no heap is used.
+ * One side may push() while the other side pop()s without any locking:
+ * - head is only written by the producer
+ * - tail is only written by the consumer
+ *
+ * Capacity must be a power of two so indices can wrap with a mask.
+ * When the buffer is full, new items are dropped and counted. The
+ * highest fill level seen is kept for sizing.
+ */
+template <typename T, size_t Capacity>
+class RingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "RingBuffer capacity must be a power of two");
+
+public:
+    RingBuffer() : head(0), tail(0), dropped(0), highWater(0) {}
+
+    /**
+     * @brief Append one item (producer side)
+     *
+     * @return false if the buffer was full and the item was dropped
+     */
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t used = h - tail.load(std::memory_order_acquire);
+        if (used >= Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        buffer[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+
+        if (used + 1 > highWater.load(std::memory_order_relaxed)) {
+            highWater.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer side)
+     *
+     * @return false if the buffer was empty
+     */
+    bool pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = buffer[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Copy an item without removing it (consumer side)
+     *
+     * @param offset 0 for the oldest item, 1 for the next, ...
+     * @return false if fewer than offset + 1 items are buffered
+     */
+    bool peek(size_t offset, T& item) const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) - t <= offset) {
+            return false;
+        }
+
+        item = buffer[(t + offset) & MASK];
+        return true;
+    }
+
+    // Number of items currently buffered
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return Capacity; }
+
+    // Items rejected because the buffer was full
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Highest number of items buffered at once
+    size_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t MASK = Capacity - 1;
+
+    T buffer[Capacity];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<uint32_t> dropped;      // Producer side
+    std::atomic<size_t> highWater;      // Producer side
+};
+
+#endif // RINGBUFFER_H
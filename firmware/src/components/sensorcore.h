@@ -0,0 +1,25 @@
+#ifndef SENSORCORE_H
+#define SENSORCORE_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include "config.h"
+#include "dht11.h"
+#include "mpu6050.h"
+#include "sensorpipeline.h"
+#include "sensortask.h"
+
+/**
+ * @brief ESP32 platform for SensorPipeline
+ */
+struct EspSensorPlatform {
+    static uint32_t cycleCount() { return ESP.getCycleCount(); }
+    static uint32_t millis() { return ::millis(); }
+    static uint64_t monotonicUs() { return esp_timer_get_time(); }
+};
+
+typedef SensorPipeline<MPU6050Sensor, DHT11Sensor, EspSensorPlatform, VIBRATION_FFT_SIZE> SensorCore;
+typedef SensorProducer<SensorCore, EspSensorPlatform, SENSOR_RECORD_QUEUE> SensorTask;
+
+#endif // SENSORCORE_H
\ No newline at end of file
@@ -0,0 +1,349 @@
+#ifndef SENSORPIPELINE_H
+#define SENSORPIPELINE_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "imusample.h"
+#include "orientationfusion.h"
+#include "ringbuffer.h"
+#include "shockdetector.h"
+#include "vibrationspectrum.h"
+#include "windowstats.h"
+
+/**
+ * @brief Sensor processing core, generic over the sensor backends
+ *
+ * Owns all detection and aggregation state (detection window, drop
+ * detector, attitude fusion, vibration spectrum, upload statistics).
+ * The backends are template parameters, so hardware drivers and
+ * replay drivers plug in at compile time. Nothing on the sample path
+ * goes through a virtual call, and the core has no Arduino dependency.
+ *
+ * An Imu backend must provide:
+ * - bool isConnected()
+ * - void service()             move hardware-buffered samples to a queue
+ * - bool isStreaming()         true while samples arrive at getSampleRate()
+ * - uint16_t getSampleRate()
+ * - size_t getQueuedSamples()  samples service() moved that are not popped yet
+ * - bool popSample(ImuRawSample&)
+ * - bool readSample(ImuRawSample&, int16_t& rawTemperature)   one immediate sample
+ * - bool readTemperature(int16_t& rawTemperature)
+ *
+ * An Env backend must provide:
+ * - bool update()              advance, true when a valid reading completed
+ * - bool readSensor()          start an acquisition if one is due
+ * - bool isValid()
+ * - float getTemperature(), float getHumidity()
+ *
+ * A Platform must provide:
+ * - static uint32_t cycleCount()   free-running CPU cycle counter
+ * - static uint64_t monotonicUs()  64-bit monotonic clock, dates drop events
+ *
+ * @tparam SpectrumSize Vibration FFT size (power of two)
+ */
+template <typename Imu, typename Env, typename Platform, size_t SpectrumSize>
+class SensorPipeline {
+public:
+    typedef VibrationSpectrum<SpectrumSize> Spectrum;
+
+    struct Config {
+        ShockDetector::Config drop;   // Drop thresholds
+        float fusionBeta;             // Madgwick gain
+        float uprightMaxTilt;         // Orientation tilt limits (degrees)
+        float invertedMinTilt;
+        const float* bandEdgesHz;     // Vibration band edges
+        uint8_t bandEdgeCount;
+        uint16_t readRateHz;          // read() rate when the IMU is not streaming
+    };
+
+    SensorPipeline(Imu& imu, Env& env)
+        : imu(imu), env(env), imuReady(false), rawTemperature(0),
+          windowSamples(0), windowMinMagSq(0), windowMaxMagSq(0), spectrumCycles(0) {
+        latest.ax = latest.ay = latest.az = 0;
+        latest.gx = latest.gy = latest.gz = 0;
+    }
+
+    /**
+     * @brief Configure detection for the backends' current state
+     *
+     * Call after the backends have been started.
+     */
+    void begin(const Config& cfg) {
+        config = cfg;
+        imuReady = imu.isConnected();
+
+        uint16_t rate = imu.isStreaming() ? imu.getSampleRate() : config.readRateHz;
+        shock.configure(config.drop, rate, ImuScaleConfig::ACCEL_LSB_PER_G);
+        fusion.configure(config.fusionBeta, rate);
+
+        // Single reads are too slow for a spectrum, it stays unconfigured
+        if (imu.isStreaming()) {
+            spectrum.configure(rate, config.bandEdgesHz, config.bandEdgeCount);
+        }
+    }
+
+    /**
+     * @brief Per loop pass: drain the IMU and advance the environment sensor
+     */
+    void service() {
+        if (imuReady) {
+            imu.service();
+        }
+        if (env.update()) {
+            stats.add(STAT_TEMPERATURE, env.getTemperature());
+            stats.add(STAT_HUMIDITY, env.getHumidity());
+        }
+    }
+
+    /**
+     * @brief Per read interval: fold the IMU window, start an env reading
+     *
+     * @return true if a new IMU window is available
+     */
+    bool read() {
+        bool ok = imuReady && readImu();
+        env.readSensor();
+        return ok;
+    }
+
+    /**
+     * @brief Start a new upload interval (window statistics + spectrum)
+     */
+    void beginUploadWindow() {
+        stats.reset();
+        spectrum.resetAverage();
+    }
+
+    // Accelerometer (m/s²)
+    float getAccelX() const { return latest.ax * ImuScaleConfig::MS2_PER_LSB; }
+    float getAccelY() const { return latest.ay * ImuScaleConfig::MS2_PER_LSB; }
+    float getAccelZ() const { return latest.az * ImuScaleConfig::MS2_PER_LSB; }
+
+    // Gyroscope (rad/s)
+    float getGyroX() const { return latest.gx * ImuScaleConfig::RADS_PER_LSB; }
+    float getGyroY() const { return latest.gy * ImuScaleConfig::RADS_PER_LSB; }
+    float getGyroZ() const { return latest.gz * ImuScaleConfig::RADS_PER_LSB; }
+
+    // IMU die temperature (°C)
+    float getImuTemperature() const { return rawTemperature / 340.0f + 36.53f; }
+
+    const ImuRawSample& getRawSample() const { return latest; }
+    bool isImuReady() const { return imuReady; }
+
+    /**
+     * @brief Number of samples folded into the last window
+     */
+    uint32_t getWindowSampleCount() const { return windowSamples; }
+
+    /**
+     * @brief Peak acceleration magnitude seen in the last window (m/s²)
+     */
+    float getPeakAcceleration() const {
+        return sqrtf((float)windowMaxMagSq) * ImuScaleConfig::MS2_PER_LSB;
+    }
+
+    /**
+     * @brief Magnitude of the latest sample (m/s²)
+     */
+    float getTotalAcceleration() const {
+        uint32_t magSq = ImuScaleConfig::magnitudeSq(latest.ax, latest.ay, latest.az);
+        return sqrtf((float)magSq) * ImuScaleConfig::MS2_PER_LSB;
+    }
+
+    /**
+     * @brief True if any sample in the last window deviated from 1 g by
+     * more than the threshold
+     *
+     * Compared as raw |a|², so no square root or float per check.
+     *
+     * @param threshold Vibration threshold in m/s² (default: 15.0)
+     */
+    bool detectVibration(float threshold = 15.0f) const {
+        if (!imuReady || windowSamples == 0) {
+            return false;
+        }
+
+        int32_t oneG = ImuScaleConfig::ACCEL_LSB_PER_G;
+        int32_t limit = ImuScaleConfig::ms2ToRaw(threshold);
+
+        uint32_t upper = (uint32_t)(oneG + limit) * (uint32_t)(oneG + limit);
+        if (windowMaxMagSq > upper) {
+            return true;
+        }
+
+        if (limit < oneG) {
+            uint32_t lower = (uint32_t)(oneG - limit) * (uint32_t)(oneG - limit);
+            return windowMinMagSq < lower;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Package orientation from the fused attitude
+     *
+     * Format with orientationName() at the output edge.
+     */
+    Orientation detectOrientation() const {
+        if (!imuReady) {
+            return ORIENTATION_UNKNOWN;
+        }
+
+        // Free fall in progress at the end of the window
+        if (shock.inFreeFall()) {
+            return ORIENTATION_FREE_FALL;
+        }
+
+        return fusion.classify(config.uprightMaxTilt, config.invertedMinTilt);
+    }
+
+    // Fused attitude (degrees)
+    float getPitch() const { return fusion.getPitch(); }
+    float getRoll() const { return fusion.getRoll(); }
+    float getYaw() const { return fusion.getYaw(); }
+    float getTilt() const { return fusion.getTilt(); }
+
+    /**
+     * @brief Take the oldest unreported drop event
+     */
+    bool popDropEvent(DropEvent& event) { return drops.pop(event); }
+
+    /**
+     * @brief Vibration spectrum features (raw counts)
+     *
+     * Band energies are raw² and rms is raw, scale with
+     * ImuScaleConfig::MS2_PER_LSB.
+     */
+    const typename Spectrum::Features& getVibrationFeatures() const { return spectrum.getFeatures(); }
+
+    /**
+     * @brief Vibration band edge (Hz), band b spans edges b to b + 1
+     */
+    float getVibrationBandEdge(uint8_t i) const { return spectrum.getBandEdge(i); }
+
+    /**
+     * @brief Platform cycles spent on the last spectrum window
+     */
+    uint32_t getSpectrumCycles() const { return spectrumCycles; }
+
+    /**
+     * @brief Per-channel statistics since beginUploadWindow()
+     *
+     * IMU channels are raw register counts, scale with ImuScaleConfig.
+     */
+    const WindowStats& getStats() const { return stats; }
+
+    Imu& getImu() { return imu; }
+    Env& getEnv() { return env; }
+
+private:
+    Imu& imu;
+    Env& env;
+    Config config;
+    bool imuReady;
+
+    ShockDetector shock;
+    OrientationFusion fusion;
+    RingBuffer<DropEvent, 8> drops;
+    Spectrum spectrum;
+    WindowStats stats;
+
+    // Latest sample, raw registers
+    ImuRawSample latest;
+    int16_t rawTemperature;
+
+    // Detection window (all samples since the previous read)
+    uint32_t windowSamples;
+    uint32_t windowMinMagSq;   // Raw |a|²
+    uint32_t windowMaxMagSq;
+
+    uint32_t spectrumCycles;
+
+    bool readImu() {
+        ImuRawSample s;
+
+        if (!imu.isStreaming()) {
+            if (!imu.readSample(s, rawTemperature)) {
+                return false;
+            }
+            startWindow();
+            fold(s, false, Platform::monotonicUs());
+
+            // Too slow to integrate the gyro, take attitude from gravity alone
+            fusion.reset(s.ax, s.ay, s.az);
+            windowSamples = 1;
+            return true;
+        }
+
+        imu.service();
+
+        // Buffered samples are evenly spaced, the newest one was just drained
+        uint64_t periodUs = 1000000UL / imu.getSampleRate();
+        size_t queued = imu.getQueuedSamples();
+        uint64_t sampleUs = Platform::monotonicUs() - (queued > 0 ? queued - 1 : 0) * periodUs;
+
+        uint32_t count = 0;
+        while (imu.popSample(s)) {
+            if (count == 0) {
+                startWindow();
+            }
+            fold(s, true, sampleUs);
+            sampleUs += periodUs;
+            count++;
+
+            // Fusion is the one float stage in the per-sample path
+            fusion.update(s.gx * ImuScaleConfig::RADS_PER_LSB,
+                          s.gy * ImuScaleConfig::RADS_PER_LSB,
+                          s.gz * ImuScaleConfig::RADS_PER_LSB,
+                          s.ax * ImuScaleConfig::G_PER_LSB,
+                          s.ay * ImuScaleConfig::G_PER_LSB,
+                          s.az * ImuScaleConfig::G_PER_LSB);
+        }
+
+        if (count == 0) {
+            return false;
+        }
+
+        windowSamples = count;
+        imu.readTemperature(rawTemperature);
+        return true;
+    }
+
+    void startWindow() {
+        windowMinMagSq = UINT32_MAX;
+        windowMaxMagSq = 0;
+    }
+
+    void fold(const ImuRawSample& sample, bool streaming, uint64_t sampleUs) {
+        uint32_t magSq = ImuScaleConfig::magnitudeSq(sample.ax, sample.ay, sample.az);
+        if (magSq < windowMinMagSq) windowMinMagSq = magSq;
+        if (magSq > windowMaxMagSq) windowMaxMagSq = magSq;
+
+        latest = sample;
+
+        float magnitude = sqrtf((float)magSq);
+
+        if (streaming && spectrum.add(magnitude)) {
+            uint32_t start = Platform::cycleCount();
+            spectrum.compute();
+            spectrumCycles = Platform::cycleCount() - start;
+        }
+
+        stats.add(STAT_ACCEL_X, sample.ax);
+        stats.add(STAT_ACCEL_Y, sample.ay);
+        stats.add(STAT_ACCEL_Z, sample.az);
+        stats.add(STAT_GYRO_X, sample.gx);
+        stats.add(STAT_GYRO_Y, sample.gy);
+        stats.add(STAT_GYRO_Z, sample.gz);
+        stats.add(STAT_ACCEL_MAGNITUDE, magnitude);
+
+        if (shock.update(sample.ax, sample.ay, sample.az)) {
+            DropEvent event = shock.getEvent();
+            event.atUs = sampleUs;
+            drops.push(event);
+        }
+    }
+};
+
+#endif // SENSORPIPELINE_H
\ No newline at end of file
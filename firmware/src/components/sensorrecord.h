@@ -0,0 +1,97 @@
+#ifndef SENSORRECORD_H
+#define SENSORRECORD_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "imusample.h"
+#include "orientationfusion.h"
+#include "vibrationspectrum.h"
+#include "windowstats.h"
+
+/**
+ * @brief Everything uploaded for one upload interval
+ *
+ * Fixed size and self-contained, so the sensor task can hand it to the
+ * network task by value through a RingBuffer. The network side never
+ * touches the live pipeline state.
+ */
+struct SensorRecord {
+    uint64_t captureUs;             // Capture time (64-bit monotonic µs, see TimeSync)
+    uint32_t uptimeMs;              // Capture time (platform millis)
+    bool envValid;
+    bool imuReady;
+
+    float temperature;              // °C
+    float humidity;                 // %
+    float heatIndex;                // °C
+
+    float accel[3];                 // Latest sample, m/s²
+    float gyro[3];                  // Latest sample, rad/s
+    Orientation orientation;
+    float pitch;                    // Fused attitude (degrees)
+    float roll;
+    float tilt;
+
+    float minAcceleration;          // |a| range over the interval (m/s²)
+    float maxAcceleration;
+
+    WindowStats stats;              // IMU channels in raw counts
+    VibrationFeatures vibration;    // Raw counts
+};
+
+/**
+ * @brief Latest reading as shown live (dashboard, /api/events)
+ *
+ * Published by the sensor task once per read through a SeqLock, so the
+ * web handlers on other tasks see one consistent reading instead of
+ * driver fields that may be mid-update. Values are scaled (°C, m/s²,
+ * rad/s), spectrum features stay in raw counts like SensorRecord.
+ */
+struct LiveSample {
+    uint32_t uptimeMs;              // Read time (platform millis)
+    bool envValid;
+    bool imuReady;
+    bool vibrationDetected;         // Last read window left 1 g ± the configured threshold
+    Orientation orientation;
+
+    float temperature;              // °C
+    float humidity;                 // %
+    float heatIndex;                // °C
+
+    float accel[3];                 // m/s²
+    float gyro[3];                  // rad/s
+    float pitch;                    // Fused attitude (degrees)
+    float roll;
+    float tilt;
+
+    VibrationFeatures vibration;    // Raw counts, since the last upload window
+    float bandEdgesHz[VIBRATION_MAX_BANDS + 1];
+    uint32_t spectrumCycles;        // Cycles spent on the last spectrum window
+};
+
+/**
+ * @brief Furthest |a| got from 1 g during the interval (m/s²)
+ *
+ * NaN if the interval has no IMU samples.
+ */
+inline float vibrationDeviation(const SensorRecord& record) {
+    const float oneG = ImuScaleConfig::STANDARD_GRAVITY;
+    if (!record.imuReady || record.stats.get(STAT_ACCEL_MAGNITUDE).getCount() == 0) {
+        return NAN;
+    }
+    float above = record.maxAcceleration - oneG;
+    float below = oneG - record.minAcceleration;
+    return above > below ? above : below;
+}
+
+/**
+ * @brief True if |a| left 1 g ± threshold at any point in the interval
+ *
+ * @param threshold Vibration threshold in m/s²
+ */
+inline bool exceedsVibration(const SensorRecord& record, float threshold) {
+    return vibrationDeviation(record) > threshold;
+}
+
+#endif // SENSORRECORD_H
\ No newline at end of file
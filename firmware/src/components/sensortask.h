@@ -0,0 +1,201 @@
+#ifndef SENSORTASK_H
+#define SENSORTASK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "dht11decode.h"
+#include "imusample.h"
+#include "ringbuffer.h"
+#include "sensorrecord.h"
+#include "seqlock.h"
+
+/**
+ * @brief Sensor side of the sensor → network pipeline
+ *
+ * step() is the body of the sensor task: it services the pipeline,
+ * folds a read every readIntervalMs and, every recordIntervalMs,
+ * captures a SensorRecord into a lock-free single-producer /
+ * single-consumer queue and starts a new upload window. The network
+ * task pops records at its own pace, so a slow or stalled request
+ * never holds up sampling. If the network side falls behind for longer
+ * than the queue covers, new records are dropped and counted.
+ *
+ * Drop events stay on the pipeline's own SPSC queue
+ * (Pipeline::popDropEvent), which the network task may consume.
+ *
+ * After every read the latest values are also published as a LiveSample
+ * (SeqLock), so any task can show them with readLive() without touching
+ * the pipeline while the sensor task updates it. Its vibration flag uses
+ * the configured threshold, which the network task updates with
+ * setVibrationThreshold() when the dashboard changes it.
+ *
+ * No RTOS calls in here, the same class runs under std::thread on the
+ * host. A Platform must provide:
+ * - static uint32_t millis()
+ * - static uint64_t monotonicUs()   64-bit, same clock as millis()
+ *
+ * @tparam QueueSize Records buffered (power of two)
+ */
+template <typename Pipeline, typename Platform, size_t QueueSize>
+class SensorProducer {
+public:
+    struct Config {
+        uint32_t readIntervalMs;     // SENSOR_READ_INTERVAL
+        uint32_t recordIntervalMs;   // SENSOR_UPLOAD_INTERVAL
+        float vibrationThreshold;    // m/s², VIBRATION_THRESHOLD until configured
+    };
+
+    struct Stats {
+        uint32_t records;            // Records captured
+        uint32_t dropped;            // Records lost to a full queue
+        uint32_t highWater;          // Most records queued at once
+        uint32_t maxStepMs;          // Longest step()
+    };
+
+    SensorProducer(Pipeline& pipeline, const Config& config)
+        : pipeline(pipeline), config(config), liveStaging(), vibrationThreshold(config.vibrationThreshold),
+          records(0), maxStepMs(0) {
+        lastRead = lastRecord = Platform::millis();
+    }
+
+    /**
+     * @brief One pass of the sensor task
+     */
+    void step() {
+        uint32_t start = Platform::millis();
+
+        pipeline.service();
+
+        if (start - lastRead >= config.readIntervalMs) {
+            pipeline.read();
+            captureLive(liveStaging, start);
+            live.publish(liveStaging);
+            lastRead = start;
+        }
+
+        if (start - lastRecord >= config.recordIntervalMs) {
+            capture(record, start);
+            queue.push(record);
+            records.fetch_add(1, std::memory_order_relaxed);
+            pipeline.beginUploadWindow();
+            lastRecord = start;
+        }
+
+        uint32_t elapsed = Platform::millis() - start;
+        if (elapsed > maxStepMs.load(std::memory_order_relaxed)) {
+            maxStepMs.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Take the oldest record (network task)
+     */
+    bool popRecord(SensorRecord& out) { return queue.pop(out); }
+
+    size_t getQueuedRecords() const { return queue.size(); }
+
+    /**
+     * @brief Threshold for LiveSample::vibrationDetected from the next read on (any task)
+     */
+    void setVibrationThreshold(float threshold) { vibrationThreshold.store(threshold, std::memory_order_relaxed); }
+
+    /**
+     * @brief Latest reading, consistent and lock-free (any task)
+     *
+     * @return false before the first read
+     */
+    bool readLive(LiveSample& out) const { return live.read(out); }
+
+    /**
+     * @brief Readings published so far, changes with every new LiveSample
+     */
+    uint32_t getLiveVersion() const { return live.getVersion(); }
+
+    // Deadlines for the sleep scheduler
+    uint32_t getLastReadMs() const { return lastRead; }
+    uint32_t getLastRecordMs() const { return lastRecord; }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.records = records.load(std::memory_order_relaxed);
+        stats.dropped = queue.getDropped();
+        stats.highWater = queue.getHighWater();
+        stats.maxStepMs = maxStepMs.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    Pipeline& pipeline;
+    Config config;
+    RingBuffer<SensorRecord, QueueSize> queue;
+    SensorRecord record;     // Staging copy, keeps the task stack small
+    LiveSample liveStaging;
+    SeqLock<LiveSample> live;
+    std::atomic<float> vibrationThreshold;   // Set by the network task
+
+    uint32_t lastRead;
+    uint32_t lastRecord;
+    std::atomic<uint32_t> records;     // Read by the network task
+    std::atomic<uint32_t> maxStepMs;
+
+    void capture(SensorRecord& out, uint32_t now) {
+        out.captureUs = Platform::monotonicUs();
+        out.uptimeMs = now;
+
+        out.envValid = pipeline.getEnv().isValid();
+        out.temperature = out.envValid ? pipeline.getEnv().getTemperature() : 0;
+        out.humidity = out.envValid ? pipeline.getEnv().getHumidity() : 0;
+        out.heatIndex = out.envValid ? dhtHeatIndex(out.temperature, out.humidity, false) : 0;
+
+        out.imuReady = pipeline.isImuReady();
+        out.accel[0] = pipeline.getAccelX();
+        out.accel[1] = pipeline.getAccelY();
+        out.accel[2] = pipeline.getAccelZ();
+        out.gyro[0] = pipeline.getGyroX();
+        out.gyro[1] = pipeline.getGyroY();
+        out.gyro[2] = pipeline.getGyroZ();
+        out.orientation = pipeline.detectOrientation();
+        out.pitch = pipeline.getPitch();
+        out.roll = pipeline.getRoll();
+        out.tilt = pipeline.getTilt();
+
+        out.stats = pipeline.getStats();
+        const RunningStats& magnitude = out.stats.get(STAT_ACCEL_MAGNITUDE);
+        out.minAcceleration = magnitude.getMin() * ImuScaleConfig::MS2_PER_LSB;
+        out.maxAcceleration = magnitude.getMax() * ImuScaleConfig::MS2_PER_LSB;
+
+        out.vibration = pipeline.getVibrationFeatures();
+    }
+
+    void captureLive(LiveSample& out, uint32_t now) {
+        out.uptimeMs = now;
+
+        out.envValid = pipeline.getEnv().isValid();
+        out.temperature = out.envValid ? pipeline.getEnv().getTemperature() : 0;
+        out.humidity = out.envValid ? pipeline.getEnv().getHumidity() : 0;
+        out.heatIndex = out.envValid ? dhtHeatIndex(out.temperature, out.humidity, false) : 0;
+
+        out.imuReady = pipeline.isImuReady();
+        out.accel[0] = pipeline.getAccelX();
+        out.accel[1] = pipeline.getAccelY();
+        out.accel[2] = pipeline.getAccelZ();
+        out.gyro[0] = pipeline.getGyroX();
+        out.gyro[1] = pipeline.getGyroY();
+        out.gyro[2] = pipeline.getGyroZ();
+        out.orientation = pipeline.detectOrientation();
+        out.pitch = pipeline.getPitch();
+        out.roll = pipeline.getRoll();
+        out.tilt = pipeline.getTilt();
+        out.vibrationDetected = pipeline.detectVibration(vibrationThreshold.load(std::memory_order_relaxed));
+
+        out.vibration = pipeline.getVibrationFeatures();
+        for (uint8_t b = 0; b <= out.vibration.bandCount && b <= VIBRATION_MAX_BANDS; b++) {
+            out.bandEdgesHz[b] = pipeline.getVibrationBandEdge(b);
+        }
+        out.spectrumCycles = pipeline.getSpectrumCycles();
+    }
+};
+
+#endif // SENSORTASK_H
\ No newline at end of file
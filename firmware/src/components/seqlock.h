@@ -0,0 +1,112 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief Latest value of T, one writer and any number of readers (seqlock)
+ *
+ * The writer never waits and never takes a lock: publish() bumps the
+ * sequence to odd, copies the value in and bumps it back to even. A
+ * reader copies the value out and keeps it only if the sequence was the
+ * same even number before and after, so it always gets one complete
+ * publish, never a mix of two. A reader overlapping a publish retries;
+ * with publishes milliseconds apart and a copy of a few hundred bytes
+ * that is rare and short.
+ *
+ * The value is stored as relaxed atomic words, so the concurrent copy
+ * is well defined and the class runs unchanged under std::thread on the
+ * host. T must be trivially copyable.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+public:
+    SeqLock() : sequence(0) {
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Replace the value (writer side, one task only)
+     */
+    void publish(const T& value) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = 0;
+            memcpy(&word, in + i * 4, chunk(i));
+            words[i].store(word, std::memory_order_relaxed);
+        }
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy out the latest complete value (any task)
+     *
+     * @return false if nothing has been published yet (out is untouched)
+     */
+    bool read(T& out) const {
+        T copy;
+        uint32_t seq;
+        while (!attempt(copy, seq)) {
+        }
+        if (seq == 0) {
+            return false;
+        }
+        out = copy;
+        return true;
+    }
+
+    /**
+     * @brief Single attempt at read()
+     *
+     * @return false if a publish overlapped (out may then be torn) or
+     *         nothing has been published yet
+     */
+    bool tryRead(T& out) const {
+        uint32_t seq;
+        return attempt(out, seq) && seq != 0;
+    }
+
+    /**
+     * @brief Number of completed publishes
+     */
+    uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static const size_t WORDS = (sizeof(T) + 3) / 4;
+
+    static size_t chunk(size_t i) { return i + 1 < WORDS ? 4 : sizeof(T) - i * 4; }
+
+    bool attempt(T& out, uint32_t& seq) const {
+        seq = sequence.load(std::memory_order_acquire);
+        if (seq & 1) {
+            return false;
+        }
+
+        uint8_t* dest = reinterpret_cast<uint8_t*>(&out);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = words[i].load(std::memory_order_relaxed);
+            memcpy(dest + i * 4, &word, chunk(i));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == seq;
+    }
+
+    std::atomic<uint32_t> sequence;   // Odd while a publish is in progress
+    std::atomic<uint32_t> words[WORDS];
+};
+
+#endif // SEQLOCK_H
\ No newline at end of file
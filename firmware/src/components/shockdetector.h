@@ -0,0 +1,207 @@
+#ifndef SHOCKDETECTOR_H
+#define SHOCKDETECTOR_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief One detected drop (free fall followed by an impact)
+ */
+struct DropEvent {
+    float peakG;             // Peak impact acceleration (g)
+    float impactDurationMs;  // Time spent above the impact threshold
+    float freeFallMs;        // Time spent below the free-fall threshold
+    float dropHeightM;       // Estimated fall height, h = ½·g·t²
+    char impactAxis;         // Dominant axis at peak ('X', 'Y' or 'Z')
+    int8_t impactSign;       // Direction along that axis (+1 / -1)
+    uint64_t atUs;           // Monotonic time of the sample that completed it (set by the caller)
+};
+
+/**
+ * @brief Streaming free-fall → impact detector
+ *
+ * Fed one raw accelerometer sample at a time at a fixed rate. Uses a
+ * small state machine and integer squared magnitudes, so each update is
+ * three multiplies and a few compares with constant memory (no sample
+ * history). Floats are only produced when an event completes.
+ *
+ * States:
+ * - IDLE: waiting for |a| to drop below the free-fall threshold
+ * - FREE_FALL: counting free-fall samples
+ * - AWAIT_IMPACT: free fall ended, impact must follow within a window
+ * - IMPACT: tracking peak and duration until |a| settles
+ */
+class ShockDetector {
+public:
+    struct Config {
+        float freeFallG;        // |a| below this is free fall (g)
+        float minFreeFallMs;    // Shorter dips are ignored
+        float impactG;          // |a| above this is an impact (g)
+        float impactEndG;       // Impact ends when |a| falls below this (g)
+        float impactWindowMs;   // Max gap between free fall and impact
+    };
+
+    ShockDetector() : state(IDLE), sampleMs(1.0f), lsbPerG(1.0f), freeFallSamples(0),
+                      waitSamples(0), impactSamples(0), peakSq(0),
+                      peakX(0), peakY(0), peakZ(0) {
+        Config defaults = { 0.35f, 80.0f, 2.5f, 1.5f, 100.0f };
+        configure(defaults, 1000, 4096);
+    }
+
+    /**
+     * @brief Set thresholds and the sample rate they are evaluated at
+     *
+     * @param cfg Thresholds in g / ms
+     * @param sampleRateHz Rate update() is called at
+     * @param accelLsbPerG Raw accelerometer counts per g
+     */
+    void configure(const Config& cfg, uint16_t sampleRateHz, int32_t accelLsbPerG) {
+        sampleMs = 1000.0f / (sampleRateHz > 0 ? sampleRateHz : 1);
+        lsbPerG = (float)accelLsbPerG;
+        freeFallSq = rawSq(cfg.freeFallG);
+        impactSq = rawSq(cfg.impactG);
+        impactEndSq = rawSq(cfg.impactEndG);
+        minFreeFallSamples = (uint32_t)(cfg.minFreeFallMs / sampleMs);
+        impactWindowSamples = (uint32_t)(cfg.impactWindowMs / sampleMs);
+        reset();
+    }
+
+    void reset() {
+        state = IDLE;
+        freeFallSamples = 0;
+        waitSamples = 0;
+        impactSamples = 0;
+    }
+
+    /**
+     * @brief Process one accelerometer sample
+     *
+     * @param ax, ay, az Raw accelerometer registers
+     * @return true if this sample completed a drop event (see getEvent())
+     */
+    bool update(int16_t ax, int16_t ay, int16_t az) {
+        uint32_t magSq = (uint32_t)((int32_t)ax * ax) + (uint32_t)((int32_t)ay * ay) +
+                         (uint32_t)((int32_t)az * az);
+
+        switch (state) {
+            case IDLE:
+                if (magSq < freeFallSq) {
+                    state = FREE_FALL;
+                    freeFallSamples = 1;
+                }
+                break;
+
+            case FREE_FALL:
+                if (magSq < freeFallSq) {
+                    freeFallSamples++;
+                } else if (freeFallSamples < minFreeFallSamples) {
+                    state = IDLE;
+                } else if (magSq > impactSq) {
+                    startImpact(ax, ay, az, magSq);
+                } else {
+                    state = AWAIT_IMPACT;
+                    waitSamples = 0;
+                }
+                break;
+
+            case AWAIT_IMPACT:
+                if (magSq > impactSq) {
+                    startImpact(ax, ay, az, magSq);
+                } else if (++waitSamples > impactWindowSamples) {
+                    // Caught or slid to a stop, not a drop
+                    state = IDLE;
+                }
+                break;
+
+            case IMPACT:
+                if (magSq > peakSq) {
+                    peakSq = magSq;
+                    peakX = ax;
+                    peakY = ay;
+                    peakZ = az;
+                }
+                if (magSq > impactEndSq) {
+                    impactSamples++;
+                } else {
+                    finishImpact();
+                    state = IDLE;
+                    return true;
+                }
+                break;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief True while the current sample stream is in free fall
+     */
+    bool inFreeFall() const {
+        return state == FREE_FALL && freeFallSamples >= minFreeFallSamples;
+    }
+
+    /**
+     * @brief Most recently completed drop event
+     */
+    const DropEvent& getEvent() const { return event; }
+
+private:
+    enum State { IDLE, FREE_FALL, AWAIT_IMPACT, IMPACT };
+
+    State state;
+    float sampleMs;
+    float lsbPerG;
+    uint32_t freeFallSq, impactSq, impactEndSq;
+    uint32_t minFreeFallSamples;
+    uint32_t impactWindowSamples;
+
+    uint32_t freeFallSamples;
+    uint32_t waitSamples;
+    uint32_t impactSamples;
+    uint32_t peakSq;
+    int16_t peakX, peakY, peakZ;
+
+    DropEvent event;
+
+    uint32_t rawSq(float g) const {
+        float raw = g * lsbPerG;
+        return (uint32_t)(raw * raw);
+    }
+
+    void startImpact(int16_t ax, int16_t ay, int16_t az, uint32_t magSq) {
+        state = IMPACT;
+        impactSamples = 1;
+        peakSq = magSq;
+        peakX = ax;
+        peakY = ay;
+        peakZ = az;
+    }
+
+    void finishImpact() {
+        const float g = 9.80665f;
+        float fallS = freeFallSamples * sampleMs / 1000.0f;
+
+        event.peakG = sqrtf((float)peakSq) / lsbPerG;
+        event.impactDurationMs = impactSamples * sampleMs;
+        event.freeFallMs = freeFallSamples * sampleMs;
+        event.dropHeightM = 0.5f * g * fallS * fallS;
+        event.atUs = 0;
+
+        int32_t absX = abs((int32_t)peakX), absY = abs((int32_t)peakY), absZ = abs((int32_t)peakZ);
+        if (absX >= absY && absX >= absZ) {
+            event.impactAxis = 'X';
+            event.impactSign = peakX >= 0 ? 1 : -1;
+        } else if (absY >= absZ) {
+            event.impactAxis = 'Y';
+            event.impactSign = peakY >= 0 ? 1 : -1;
+        } else {
+            event.impactAxis = 'Z';
+            event.impactSign = peakZ >= 0 ? 1 : -1;
+        }
+
+        freeFallSamples = 0;
+    }
+};
+
+#endif // SHOCKDETECTOR_H
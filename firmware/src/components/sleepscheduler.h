@@ -0,0 +1,125 @@
+#ifndef SLEEPSCHEDULER_H
+#define SLEEPSCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Decides when (and for how long) the main loop may light-sleep
+ *
+ * The platform is a template parameter so the same decision logic runs
+ * on the ESP32 and in a simulated clock/GPIO on the host. A Platform
+ * must provide:
+ * - uint32_t millis()
+ * - bool motionPending()        latched motion interrupt (reads & clears)
+ * - bool sleepAllowed()         false while something needs the radio/CPU
+ * - void setImuStill(bool)      stop / restart high-rate IMU sampling
+ * - void lightSleep(uint32_t)   sleep until timeout or motion interrupt
+ *
+ * Two modes:
+ * - Active: IMU FIFO is sampling, sleeps are capped so it is drained in time
+ * - Still: no motion for idleTimeoutMs, IMU stops sampling and the CPU
+ *   sleeps until the next DHT11 read / upload or a motion interrupt
+ */
+template <typename Platform>
+class SleepScheduler {
+public:
+    struct Config {
+        uint32_t readIntervalMs;     // SENSOR_READ_INTERVAL
+        uint32_t uploadIntervalMs;   // SENSOR_UPLOAD_INTERVAL
+        uint32_t idleTimeoutMs;      // No motion for this long → still
+        uint32_t minSleepMs;         // Shorter sleeps are not worth it
+        uint32_t activeMaxSleepMs;   // Cap while the IMU FIFO is filling
+    };
+
+    struct Stats {
+        uint32_t sleeps;
+        uint32_t sleptMs;
+        uint32_t motionWakes;
+    };
+
+    SleepScheduler(Platform& platform, const Config& config)
+        : platform(platform), config(config), still(false), lastMotion(0) {
+        stats.sleeps = 0;
+        stats.sleptMs = 0;
+        stats.motionWakes = 0;
+    }
+
+    /**
+     * @brief Time until the next scheduled read or upload
+     *
+     * @param now Current time (ms)
+     * @param lastRead Time of the last sensor read (ms)
+     * @param lastUpload Time of the last upload (ms)
+     * @return Milliseconds until the earliest deadline (0 if overdue)
+     */
+    uint32_t timeToNextDeadline(uint32_t now, uint32_t lastRead, uint32_t lastUpload) const {
+        uint32_t toRead = remaining(now, lastRead, config.readIntervalMs);
+        uint32_t toUpload = remaining(now, lastUpload, config.uploadIntervalMs);
+        return toRead < toUpload ? toRead : toUpload;
+    }
+
+    /**
+     * @brief Handle motion state and sleep until the next deadline
+     *
+     * Call once at the end of each loop pass in place of delay().
+     *
+     * @return Milliseconds requested for sleep (0 if the loop should run on)
+     */
+    uint32_t idle(uint32_t lastRead, uint32_t lastUpload) {
+        uint32_t now = platform.millis();
+
+        if (platform.motionPending()) {
+            lastMotion = now;
+            if (still) {
+                still = false;
+                stats.motionWakes++;
+                platform.setImuStill(false);
+            }
+        } else if (!still && now - lastMotion >= config.idleTimeoutMs) {
+            still = true;
+            platform.setImuStill(true);
+        }
+
+        uint32_t sleepMs = timeToNextDeadline(now, lastRead, lastUpload);
+        if (!still && sleepMs > config.activeMaxSleepMs) {
+            sleepMs = config.activeMaxSleepMs;
+        }
+
+        if (sleepMs < config.minSleepMs || !platform.sleepAllowed()) {
+            return 0;
+        }
+
+        platform.lightSleep(sleepMs);
+        stats.sleeps++;
+        stats.sleptMs += sleepMs;
+        return sleepMs;
+    }
+
+    /**
+     * @brief Record motion seen by other means (e.g. a drop event)
+     */
+    void notifyMotion() {
+        lastMotion = platform.millis();
+        if (still) {
+            still = false;
+            platform.setImuStill(false);
+        }
+    }
+
+    bool isStill() const { return still; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    Platform& platform;
+    Config config;
+    bool still;
+    uint32_t lastMotion;
+    Stats stats;
+
+    static uint32_t remaining(uint32_t now, uint32_t last, uint32_t interval) {
+        uint32_t elapsed = now - last;
+        return elapsed >= interval ? 0 : interval - elapsed;
+    }
+};
+
+#endif // SLEEPSCHEDULER_H
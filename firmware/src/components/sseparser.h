@@ -0,0 +1,143 @@
+#ifndef SSEPARSER_H
+#define SSEPARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Incremental text/event-stream (Server-Sent Events) parser
+ *
+ * Bytes are fed as they arrive off the socket, split anywhere. Each
+ * complete event (terminated by a blank line) is handed to
+ * Handler::onEvent(const char* event, const char* data, size_t length).
+ * Lines may end in LF, CR or CRLF; several data: lines are joined with
+ * '\n'; comments and fields other than event: / data: are ignored.
+ *
+ * An event whose data does not fit is dropped whole (counted in
+ * getOverflows()), a truncated JSON payload would be worse than none.
+ *
+ * @tparam MaxData Largest event payload in bytes (static storage)
+ */
+template <size_t MaxData>
+class SseParser {
+public:
+    SseParser() : overflows(0) {
+        reset();
+    }
+
+    /**
+     * @brief Forget any partial line / event (e.g. after a reconnect)
+     */
+    void reset() {
+        lineLength = 0;
+        dataLength = 0;
+        event[0] = '\0';
+        lineOverflow = false;
+        eventOverflow = false;
+        afterCR = false;
+    }
+
+    /**
+     * @brief Consume stream bytes, dispatching any events they complete
+     */
+    template <typename Handler>
+    void feed(const char* bytes, size_t length, Handler& handler) {
+        for (size_t i = 0; i < length; i++) {
+            char c = bytes[i];
+
+            if (c == '\n' && afterCR) {
+                afterCR = false;  // Second half of CRLF
+                continue;
+            }
+            afterCR = (c == '\r');
+
+            if (c == '\r' || c == '\n') {
+                endLine(handler);
+            } else if (lineLength < sizeof(line) - 1) {
+                line[lineLength++] = c;
+            } else {
+                lineOverflow = true;
+            }
+        }
+    }
+
+    uint32_t getOverflows() const { return overflows; }
+
+private:
+    static const size_t MAX_EVENT_NAME = 24;
+
+    char line[MaxData + 8];           // "data: " + payload
+    size_t lineLength;
+    char data[MaxData + 1];
+    size_t dataLength;
+    char event[MAX_EVENT_NAME + 1];
+    bool lineOverflow;
+    bool eventOverflow;
+    bool afterCR;
+    uint32_t overflows;
+
+    template <typename Handler>
+    void endLine(Handler& handler) {
+        line[lineLength] = '\0';
+
+        if (lineLength == 0 && !lineOverflow) {
+            dispatch(handler);
+        } else if (lineOverflow) {
+            eventOverflow = true;
+        } else if (line[0] != ':') {
+            field();
+        }
+
+        lineLength = 0;
+        lineOverflow = false;
+    }
+
+    void field() {
+        // "name: value" / "name:value" / "name"
+        char* value = strchr(line, ':');
+        size_t valueLength = 0;
+        if (value) {
+            *value++ = '\0';
+            if (*value == ' ') {
+                value++;
+            }
+            valueLength = lineLength - (value - line);
+        } else {
+            value = line + lineLength;
+        }
+
+        if (strcmp(line, "event") == 0) {
+            size_t n = valueLength < MAX_EVENT_NAME ? valueLength : MAX_EVENT_NAME;
+            memcpy(event, value, n);
+            event[n] = '\0';
+        } else if (strcmp(line, "data") == 0) {
+            size_t separator = dataLength > 0 ? 1 : 0;
+            if (dataLength + separator + valueLength > MaxData) {
+                eventOverflow = true;
+                return;
+            }
+            if (separator) {
+                data[dataLength++] = '\n';
+            }
+            memcpy(data + dataLength, value, valueLength);
+            dataLength += valueLength;
+        }
+    }
+
+    template <typename Handler>
+    void dispatch(Handler& handler) {
+        if (eventOverflow) {
+            overflows++;
+        } else if (dataLength > 0 || event[0] != '\0') {
+            data[dataLength] = '\0';
+            handler.onEvent(event[0] != '\0' ? event : "message", data, dataLength);
+        }
+
+        dataLength = 0;
+        event[0] = '\0';
+        eventOverflow = false;
+    }
+};
+
+#endif // SSEPARSER_H
\ No newline at end of file
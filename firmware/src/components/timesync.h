@@ -0,0 +1,126 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maps the 64-bit monotonic microsecond clock to Unix time
+ *
+ * Samples are stamped with the monotonic counter when they are taken
+ * and only converted to wall-clock time when they are serialized, so a
+ * sample that waited in a queue (or was taken before the first sync)
+ * still gets the time it was captured.
+ *
+ * Every NTP sync contributes one (monotonic, Unix) pair. The latest
+ * pair anchors the conversion; successive pairs measure how fast the
+ * local crystal runs against NTP (drift, ppm), which is smoothed and
+ * extrapolated between syncs. A pair that disagrees with the prediction
+ * by more than stepUs (first sync, server change, manual set) re-anchors
+ * without feeding the drift estimate.
+ *
+ * Plain arithmetic, the caller reads both clocks at the same instant.
+ */
+class TimeSync {
+public:
+    struct Config {
+        int64_t stepUs;             // TIME_SYNC_STEP_US
+        uint64_t minSpanUs;         // TIME_SYNC_MIN_SPAN_US, shortest span that updates drift
+        float maxDriftPpm;          // TIME_SYNC_MAX_DRIFT_PPM
+        float driftGain;            // TIME_SYNC_DRIFT_GAIN, weight of a new drift measurement
+    };
+
+    struct Stats {
+        uint32_t syncs;             // Pairs accepted
+        uint32_t steps;             // Pairs that re-anchored (first sync included)
+        int64_t lastErrorUs;        // Last pair minus its prediction
+        float driftPpm;             // Local clock fast (+) or slow (-) against NTP
+        uint64_t lastSyncUs;        // Monotonic time of the last pair
+    };
+
+    explicit TimeSync(const Config& config)
+        : config(config), synced(false), anchorMonoUs(0), anchorUnixUs(0),
+          driftPpm(0), syncs(0), steps(0), lastErrorUs(0), lastSyncUs(0) {}
+
+    /**
+     * @brief Feed one NTP-derived pair
+     *
+     * @param monotonicUs Monotonic counter when unixUs was read
+     * @param unixUs      Wall-clock microseconds since the epoch
+     */
+    void sample(uint64_t monotonicUs, int64_t unixUs) {
+        syncs++;
+        lastSyncUs = monotonicUs;
+
+        if (!synced) {
+            anchor(monotonicUs, unixUs);
+            steps++;
+            lastErrorUs = 0;
+            return;
+        }
+
+        int64_t error = unixUs - toUnixUs(monotonicUs);
+        lastErrorUs = error;
+        if (error > config.stepUs || error < -config.stepUs) {
+            anchor(monotonicUs, unixUs);
+            steps++;
+            return;
+        }
+
+        // Drift over the whole span since the last pair, not just the residual
+        int64_t spanUs = (int64_t)(monotonicUs - anchorMonoUs);
+        if (spanUs >= (int64_t)config.minSpanUs) {
+            double measured = (double)((unixUs - anchorUnixUs) - spanUs) * 1e6 / (double)spanUs;
+            double next = driftPpm + config.driftGain * (measured - driftPpm);
+            if (next > config.maxDriftPpm) next = config.maxDriftPpm;
+            if (next < -config.maxDriftPpm) next = -config.maxDriftPpm;
+            driftPpm = (float)next;
+            anchor(monotonicUs, unixUs);
+        }
+    }
+
+    bool isSynced() const { return synced; }
+
+    /**
+     * @brief Wall-clock time of a monotonic stamp, before or after the anchor
+     *
+     * Only meaningful once isSynced().
+     */
+    int64_t toUnixUs(uint64_t monotonicUs) const {
+        int64_t delta = (int64_t)(monotonicUs - anchorMonoUs);
+        return anchorUnixUs + delta + (int64_t)((double)delta * driftPpm * 1e-6);
+    }
+
+    uint64_t toUnixMs(uint64_t monotonicUs) const {
+        int64_t us = toUnixUs(monotonicUs);
+        return us > 0 ? (uint64_t)us / 1000 : 0;
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.syncs = syncs;
+        stats.steps = steps;
+        stats.lastErrorUs = lastErrorUs;
+        stats.driftPpm = driftPpm;
+        stats.lastSyncUs = lastSyncUs;
+        return stats;
+    }
+
+private:
+    Config config;
+    bool synced;
+    uint64_t anchorMonoUs;
+    int64_t anchorUnixUs;
+    float driftPpm;
+    uint32_t syncs;
+    uint32_t steps;
+    int64_t lastErrorUs;
+    uint64_t lastSyncUs;
+
+    void anchor(uint64_t monotonicUs, int64_t unixUs) {
+        anchorMonoUs = monotonicUs;
+        anchorUnixUs = unixUs;
+        synced = true;
+    }
+};
+
+#endif // TIMESYNC_H
\ No newline at end of file
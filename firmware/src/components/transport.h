@@ -0,0 +1,43 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "uploadbatcher.h"
+
+/**
+ * Telemetry transport, picked at build time with TELEMETRY_TRANSPORT.
+ *
+ * Every backend provides:
+ * - explicit Backend(DeviceConfig& config)   kept in step with the dashboard
+ * - void begin(const String& deviceRoot)
+ * - bool get(const String& path, String& json)
+ * - bool put(const String& path, const String& json)
+ * - void service()                             config changes, reconnects
+ * - void stop()                                on WiFi loss
+ * - bool beginPatch(size_t contentLength)      UploadBatcher Transport:
+ *   bool write(const char* data, size_t length)  one batch of writes,
+ *   bool endPatch()                              true once delivered
+ * - getStats(), getAverageLatencyMs()          link diagnostics
+ *
+ * Paths are relative to the device root.
+ */
+#if TELEMETRY_TRANSPORT == TRANSPORT_MQTT
+#include "mqtttransport.h"
+typedef MqttTransport TelemetryTransport;
+#else
+#include "firebasetransport.h"
+typedef FirebaseTransport TelemetryTransport;
+#endif
+
+/**
+ * @brief ESP32 platform for UploadBatcher
+ */
+struct EspBatchPlatform {
+    uint32_t millis() { return ::millis(); }
+};
+
+typedef UploadBatcher<TelemetryTransport, EspBatchPlatform, UPLOAD_BATCH_BYTES> TelemetryBatcher;
+
+#endif // TRANSPORT_H
\ No newline at end of file
@@ -0,0 +1,329 @@
+#ifndef UPLOADBATCHER_H
+#define UPLOADBATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pushid.h"
+
+/**
+ * @brief Collects database writes into one multi-location PATCH
+ *
+ * Writes are queued as (path, JSON value) pairs relative to one root
+ * and sent together as {"path": value, ...}, which the Realtime
+ * Database applies atomically. Two kinds of write:
+ * - set(): latest value wins, an earlier queued write to the same path
+ *   is replaced (current readings, lastSeen)
+ * - push(): appended under a client-generated ordered key, so many
+ *   history samples / alerts can share one request
+ *
+ * Both also come in a form that writes the value straight into the
+ * queue (e.g. serializeJson() after measureJson()), so a value never
+ * exists in RAM twice. The PATCH body is streamed from the queue.
+ *
+ * Because push keys are generated on the device, resending a batch
+ * writes the same keys again. A PATCH is therefore idempotent and a
+ * failed flush can be retried without duplicating entries.
+ *
+ * Flush policy (isDue()):
+ * - priority: an urgent write is queued
+ * - size: queued bytes reach flushBytes
+ * - count: maxPushes pushed entries are queued
+ * - age: the oldest queued write is maxAgeMs old
+ *
+ * A Transport must provide:
+ * - bool beginPatch(size_t contentLength)
+ * - bool write(const char* data, size_t length)
+ * - bool endPatch()                        true on a 2xx response
+ *
+ * A Platform must provide:
+ * - uint32_t millis()
+ *
+ * @tparam Capacity Bytes of queued paths + values (static storage)
+ */
+template <typename Transport, typename Platform, size_t Capacity>
+class UploadBatcher {
+public:
+    enum Priority : uint8_t {
+        PRIORITY_NORMAL = 0,
+        PRIORITY_URGENT
+    };
+
+    struct Config {
+        size_t flushBytes;     // Flush once this many bytes are queued
+        uint16_t maxPushes;    // Flush once this many push() entries are queued
+        uint32_t maxAgeMs;     // Oldest write waits at most this long
+        uint32_t retryMs;      // Back-off after a failed flush
+    };
+
+    struct Stats {
+        uint32_t flushes;      // Successful PATCH requests
+        uint32_t failures;     // Failed flush attempts
+        uint32_t writes;       // Writes queued
+        uint32_t dropped;      // Writes rejected because the queue was full
+        uint32_t lastEntries;  // Writes in the last successful PATCH
+        uint32_t lastBytes;    // Body size of the last successful PATCH
+    };
+
+    UploadBatcher(Transport& transport, Platform& platform, const Config& config, uint32_t seed)
+        : transport(transport), platform(platform), config(config), ids(seed),
+          used(0), entries(0), pushes(0), urgent(false), oldest(0), retryAt(0), backingOff(false) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * @brief Queue a write that replaces any earlier queued value at path
+     *
+     * @param path Path below the batch root (e.g. "current")
+     * @param value Serialized JSON value
+     * @param length Value length in bytes
+     * @return false if the queue is full (write dropped)
+     */
+    bool set(const char* path, const char* value, size_t length, Priority priority = PRIORITY_NORMAL) {
+        return set(path, length, CopyFill{ value, length }, priority);
+    }
+
+    /**
+     * @brief set() with the value written in place
+     *
+     * @param length Exact value length in bytes
+     * @param fill Called as fill(char* out) only if the write fits, must
+     *             write exactly length bytes (no terminator)
+     */
+    template <typename Fill>
+    bool set(const char* path, size_t length, Fill fill, Priority priority = PRIORITY_NORMAL) {
+        size_t pathLength = strlen(path);
+        size_t existing = find(path, pathLength);
+        size_t freed = 0;
+        if (existing != NOT_FOUND) {
+            freed = entrySize(existing);
+        }
+
+        if (used - freed + HEADER_BYTES + pathLength + length > Capacity) {
+            stats.dropped++;
+            return false;
+        }
+
+        if (existing != NOT_FOUND) {
+            remove(existing);
+        }
+        fill(append(path, pathLength, length, priority));
+        return true;
+    }
+
+    /**
+     * @brief Queue a write under a new ordered key in a collection
+     *
+     * @param collection Collection below the batch root (e.g. "history")
+     * @param value Serialized JSON value
+     * @param length Value length in bytes
+     * @param timestampMs Epoch milliseconds for the key
+     * @return false if the queue is full (write dropped)
+     */
+    bool push(const char* collection, const char* value, size_t length, uint64_t timestampMs,
+              Priority priority = PRIORITY_NORMAL) {
+        return push(collection, length, CopyFill{ value, length }, timestampMs, priority);
+    }
+
+    /**
+     * @brief push() with the value written in place, see set()
+     */
+    template <typename Fill>
+    bool push(const char* collection, size_t length, Fill fill, uint64_t timestampMs,
+              Priority priority = PRIORITY_NORMAL) {
+        char path[MAX_PATH + 1];
+        char id[PUSH_ID_LENGTH + 1];
+        ids.generate(timestampMs, id);
+
+        int pathLength = snprintf(path, sizeof(path), "%s/%s", collection, id);
+        if (pathLength <= 0 || (size_t)pathLength > MAX_PATH ||
+            used + HEADER_BYTES + pathLength + length > Capacity) {
+            stats.dropped++;
+            return false;
+        }
+
+        fill(append(path, pathLength, length, priority));
+        pushes++;
+        return true;
+    }
+
+    /**
+     * @brief Reserve an ordered key without queueing anything
+     *
+     * For nodes written more than once with set() (e.g. an alert that is
+     * opened and later resolved). Same sequence as push() keys.
+     *
+     * @param out PUSH_ID_LENGTH + 1 bytes (NUL terminated)
+     */
+    void generateKey(uint64_t timestampMs, char* out) {
+        ids.generate(timestampMs, out);
+    }
+
+    /**
+     * @brief True if the flush policy says the queue should be sent now
+     */
+    bool isDue() const {
+        if (entries == 0) {
+            return false;
+        }
+
+        uint32_t now = platform.millis();
+        if (backingOff && (int32_t)(now - retryAt) < 0) {
+            return false;
+        }
+
+        return urgent ||
+               used >= config.flushBytes ||
+               pushes >= config.maxPushes ||
+               now - oldest >= config.maxAgeMs;
+    }
+
+    /**
+     * @brief Send everything queued as one PATCH
+     *
+     * Retried once straight away (the transport may have dropped an
+     * idle connection), then backs off for retryMs.
+     *
+     * @return true if the queue was sent (or was empty)
+     */
+    bool flush() {
+        if (entries == 0) {
+            return true;
+        }
+
+        if (!send() && !send()) {
+            stats.failures++;
+            backingOff = true;
+            retryAt = platform.millis() + config.retryMs;
+            return false;
+        }
+
+        stats.flushes++;
+        stats.lastEntries = entries;
+        stats.lastBytes = bodyLength();
+
+        used = 0;
+        entries = 0;
+        pushes = 0;
+        urgent = false;
+        backingOff = false;
+        return true;
+    }
+
+    /**
+     * @brief True while waiting out the back-off after a failed flush
+     */
+    bool isBackingOff() const { return backingOff; }
+
+    size_t getPendingBytes() const { return used; }
+    uint16_t getPendingEntries() const { return entries; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    static const size_t HEADER_BYTES = 4;   // uint16 path length + uint16 value length
+    static const size_t MAX_PATH = 64;
+    static const size_t NOT_FOUND = (size_t)-1;
+
+    struct CopyFill {
+        const char* value;
+        size_t length;
+        void operator()(char* out) const { memcpy(out, value, length); }
+    };
+
+    Transport& transport;
+    Platform& platform;
+    Config config;
+    PushIdGenerator ids;
+
+    // Entries: [pathLength:2][valueLength:2][path][value], back to back
+    uint8_t buffer[Capacity];
+    size_t used;
+    uint16_t entries;
+    uint16_t pushes;
+    bool urgent;
+    uint32_t oldest;
+    uint32_t retryAt;
+    bool backingOff;
+    Stats stats;
+
+    static uint16_t read16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+    size_t entrySize(size_t offset) const {
+        return HEADER_BYTES + read16(buffer + offset) + read16(buffer + offset + 2);
+    }
+
+    size_t find(const char* path, size_t pathLength) const {
+        for (size_t offset = 0; offset < used; offset += entrySize(offset)) {
+            if (read16(buffer + offset) == pathLength &&
+                memcmp(buffer + offset + HEADER_BYTES, path, pathLength) == 0) {
+                return offset;
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    void remove(size_t offset) {
+        size_t size = entrySize(offset);
+        memmove(buffer + offset, buffer + offset + size, used - offset - size);
+        used -= size;
+        entries--;
+    }
+
+    // Queues the entry header and path, returns where the value goes
+    char* append(const char* path, size_t pathLength, size_t length, Priority priority) {
+        if (entries == 0) {
+            oldest = platform.millis();
+        }
+
+        uint8_t* p = buffer + used;
+        p[0] = pathLength & 0xFF;
+        p[1] = pathLength >> 8;
+        p[2] = length & 0xFF;
+        p[3] = length >> 8;
+        memcpy(p + HEADER_BYTES, path, pathLength);
+
+        used += HEADER_BYTES + pathLength + length;
+        entries++;
+        stats.writes++;
+        if (priority == PRIORITY_URGENT) {
+            urgent = true;
+        }
+        return (char*)p + HEADER_BYTES + pathLength;
+    }
+
+    // {"path":value,"path":value}
+    size_t bodyLength() const {
+        size_t length = 2 + (entries - 1);
+        for (size_t offset = 0; offset < used; offset += entrySize(offset)) {
+            length += entrySize(offset) - HEADER_BYTES + 3;
+        }
+        return length;
+    }
+
+    bool send() {
+        if (!transport.beginPatch(bodyLength())) {
+            transport.endPatch();
+            return false;
+        }
+
+        bool ok = transport.write("{", 1);
+        for (size_t offset = 0; ok && offset < used; offset += entrySize(offset)) {
+            uint16_t pathLength = read16(buffer + offset);
+            uint16_t valueLength = read16(buffer + offset + 2);
+            const char* path = (const char*)buffer + offset + HEADER_BYTES;
+
+            ok = (offset == 0 || transport.write(",", 1)) &&
+                 transport.write("\"", 1) &&
+                 transport.write(path, pathLength) &&
+                 transport.write("\":", 2) &&
+                 transport.write(path + pathLength, valueLength);
+        }
+        ok = ok && transport.write("}", 1);
+
+        return transport.endPatch() && ok;
+    }
+};
+
+#endif // UPLOADBATCHER_H
\ No newline at end of file
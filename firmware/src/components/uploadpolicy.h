@@ -0,0 +1,160 @@
+#ifndef UPLOADPOLICY_H
+#define UPLOADPOLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Decides which telemetry records are worth uploading
+ *
+ * A record is published when:
+ * - first: nothing has been published yet
+ * - event: the caller flags it (an alert opened / resolved)
+ * - change: any channel moved more than its deadband since the last
+ *   published value (not the last sample, so slow drift still shows),
+ *   or got further than that in between when the caller passes the
+ *   range the channel covered
+ * - active: the device is moving / in an excursion, records go out at
+ *   activeIntervalMs until activeHoldMs after the activity stopped
+ * - heartbeat: nothing was published for heartbeatMs
+ *
+ * Everything else is suppressed. A NaN channel (sensor not ready) is
+ * skipped; it turning valid or invalid counts as a change.
+ *
+ * @tparam Channels Number of values compared per record
+ */
+template <size_t Channels>
+class UploadPolicy {
+public:
+    enum Reason : uint8_t {
+        REASON_NONE = 0,        // Suppressed
+        REASON_FIRST,
+        REASON_EVENT,
+        REASON_CHANGE,
+        REASON_ACTIVE,
+        REASON_HEARTBEAT,
+        REASON_COUNT
+    };
+
+    struct Config {
+        float deadband[Channels];   // Per-channel change that triggers an upload
+        uint32_t heartbeatMs;       // Longest silence
+        uint32_t activeIntervalMs;  // Upload interval while active
+        uint32_t activeHoldMs;      // Stay active this long after the last activity
+    };
+
+    struct Stats {
+        uint32_t sent;
+        uint32_t suppressed;
+        uint32_t byReason[REASON_COUNT];
+    };
+
+    explicit UploadPolicy(const Config& config)
+        : config(config), published(false), lastSentMs(0), lastActivityMs(0), activeSeen(false) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * @brief Decide on one record
+     *
+     * A publishing decision is final: the values become the new
+     * reference for the deadbands.
+     *
+     * @param values Channels values of the record
+     * @param event An alert changed state with this record
+     * @param activity Motion / an excursion is going on right now
+     * @param nowMs Record time (platform ms)
+     * @param lows Lowest value of each channel since the last published
+     *        record (nullptr, or NaN for a channel, to compare values only)
+     * @param highs Highest value of each channel, likewise
+     * @return Why the record is published, REASON_NONE to skip it
+     */
+    Reason evaluate(const float* values, bool event, bool activity, uint32_t nowMs,
+                    const float* lows = nullptr, const float* highs = nullptr) {
+        if (activity) {
+            lastActivityMs = nowMs;
+            activeSeen = true;
+        }
+
+        Reason reason = REASON_NONE;
+        if (!published) {
+            reason = REASON_FIRST;
+        } else if (event) {
+            reason = REASON_EVENT;
+        } else if (hasChanged(values, lows, highs)) {
+            reason = REASON_CHANGE;
+        } else if (isActive(nowMs) && nowMs - lastSentMs >= config.activeIntervalMs) {
+            reason = REASON_ACTIVE;
+        } else if (nowMs - lastSentMs >= config.heartbeatMs) {
+            reason = REASON_HEARTBEAT;
+        }
+
+        stats.byReason[reason]++;
+        if (reason == REASON_NONE) {
+            stats.suppressed++;
+            return reason;
+        }
+
+        memcpy(reference, values, sizeof(reference));
+        published = true;
+        lastSentMs = nowMs;
+        stats.sent++;
+        return reason;
+    }
+
+    /**
+     * @brief True while uploads run at the active rate
+     */
+    bool isActive(uint32_t nowMs) const {
+        return activeSeen && nowMs - lastActivityMs < config.activeHoldMs;
+    }
+
+    const Stats& getStats() const { return stats; }
+
+    static const char* reasonName(Reason reason) {
+        switch (reason) {
+            case REASON_FIRST:     return "first";
+            case REASON_EVENT:     return "event";
+            case REASON_CHANGE:    return "change";
+            case REASON_ACTIVE:    return "active";
+            case REASON_HEARTBEAT: return "heartbeat";
+            default:               return "suppressed";
+        }
+    }
+
+private:
+    Config config;
+    float reference[Channels];  // Values last published
+    bool published;
+    uint32_t lastSentMs;
+    uint32_t lastActivityMs;
+    bool activeSeen;
+    Stats stats;
+
+    bool hasChanged(const float* values, const float* lows, const float* highs) const {
+        for (size_t c = 0; c < Channels; c++) {
+            bool wasValid = reference[c] == reference[c];
+            bool isValid = values[c] == values[c];
+            if (wasValid != isValid) {
+                return true;
+            }
+            if (!isValid) {
+                continue;
+            }
+            // An excursion that came back within the deadband still counts
+            if (exceeds(c, values[c]) || (lows && exceeds(c, lows[c])) || (highs && exceeds(c, highs[c]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // False for NaN
+    bool exceeds(size_t c, float value) const {
+        float delta = value - reference[c];
+        return delta > config.deadband[c] || -delta > config.deadband[c];
+    }
+};
+
+#endif // UPLOADPOLICY_H
\ No newline at end of file
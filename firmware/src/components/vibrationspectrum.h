@@ -0,0 +1,214 @@
+#ifndef VIBRATIONSPECTRUM_H
+#define VIBRATIONSPECTRUM_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "realfft.h"
+
+static const uint8_t VIBRATION_MAX_BANDS = 8;
+
+/**
+ * @brief Spectrum summary, independent of the FFT size
+ */
+struct VibrationFeatures {
+    float dominantHz;                       // Strongest non-DC frequency
+    float rms;                              // AC RMS over all bins
+    float bandEnergy[VIBRATION_MAX_BANDS];  // Mean square per band
+    uint8_t bandCount;
+    uint32_t windows;                       // Windows averaged
+
+    /**
+     * @brief Fold in the features of a later interval
+     *
+     * Band energies and the mean square are averaged weighted by window
+     * count, as if both intervals had gone into one Welch average. The
+     * dominant frequency is that of the louder interval. Features of a
+     * different band layout replace these.
+     */
+    void merge(const VibrationFeatures& other) {
+        if (other.windows == 0) {
+            return;
+        }
+        if (windows == 0 || bandCount != other.bandCount) {
+            *this = other;
+            return;
+        }
+
+        uint32_t total = windows + other.windows;
+        float self = (float)windows / total;
+        float weight = (float)other.windows / total;
+        if (other.rms > rms) {
+            dominantHz = other.dominantHz;
+        }
+        rms = sqrtf(rms * rms * self + other.rms * other.rms * weight);
+        for (uint8_t b = 0; b < bandCount && b < VIBRATION_MAX_BANDS; b++) {
+            bandEnergy[b] = bandEnergy[b] * self + other.bandEnergy[b] * weight;
+        }
+        windows = total;
+    }
+};
+
+/**
+ * @brief Vibration features from the spectrum of |a|
+ *
+ * Collects fixed windows of acceleration magnitude, removes the mean
+ * (gravity), applies a Hann window and averages the power spectra of
+ * all windows since resetAverage() (Welch's method). From the average
+ * it derives:
+ * - band energies (mean square per configured frequency band)
+ * - total AC RMS
+ * - dominant frequency
+ *
+ * Units follow the input: feeding raw counts gives raw² energies, scale
+ * them at serialization. All storage is inside the object.
+ *
+ * @tparam N Window / FFT size (power of two)
+ */
+template <size_t N>
+class VibrationSpectrum {
+public:
+    static const uint8_t MAX_BANDS = VIBRATION_MAX_BANDS;
+
+    typedef VibrationFeatures Features;
+
+    VibrationSpectrum() : sampleRateHz(0), fill(0), windows(0), bandCount(0) {
+        for (size_t i = 0; i < N; i++) {
+            hann[i] = 0.5f - 0.5f * cosf(2.0f * 3.14159265f * i / N);
+        }
+        for (uint8_t i = 0; i <= MAX_BANDS; i++) {
+            edges[i] = 0;
+        }
+        resetAverage();
+        clearFeatures();
+    }
+
+    /**
+     * @brief Set the sample rate and frequency bands
+     *
+     * @param rateHz Rate add() is called at
+     * @param bandEdgesHz Ascending band edges, edgeCount - 1 bands
+     * @param edgeCount Number of edges (at most MAX_BANDS + 1)
+     */
+    void configure(uint16_t rateHz, const float* bandEdgesHz, uint8_t edgeCount) {
+        sampleRateHz = rateHz;
+        if (edgeCount > MAX_BANDS + 1) edgeCount = MAX_BANDS + 1;
+        bandCount = edgeCount > 1 ? edgeCount - 1 : 0;
+        for (uint8_t i = 0; i < edgeCount; i++) {
+            edges[i] = bandEdgesHz[i];
+        }
+        fill = 0;
+        resetAverage();
+        clearFeatures();
+    }
+
+    /**
+     * @brief Append one sample
+     *
+     * @return true when a window is full and compute() should be called
+     */
+    bool add(float value) {
+        if (sampleRateHz == 0) {
+            return false;
+        }
+        samples[fill++] = value;
+        return fill == N;
+    }
+
+    /**
+     * @brief Transform the full window and refresh the features
+     */
+    void compute() {
+        if (fill < N) {
+            return;
+        }
+        fill = 0;
+
+        float mean = 0;
+        for (size_t i = 0; i < N; i++) mean += samples[i];
+        mean /= N;
+        for (size_t i = 0; i < N; i++) samples[i] = (samples[i] - mean) * hann[i];
+
+        fft.powerSpectrum(samples, power);
+        for (size_t k = 0; k < RealFft<N>::BINS; k++) {
+            average[k] += power[k];
+        }
+        windows++;
+
+        updateFeatures();
+    }
+
+    /**
+     * @brief Start a new averaging interval (features keep their values
+     * until the next window completes)
+     */
+    void resetAverage() {
+        for (size_t k = 0; k < RealFft<N>::BINS; k++) {
+            average[k] = 0;
+        }
+        windows = 0;
+    }
+
+    const Features& getFeatures() const { return features; }
+    float getBandEdge(uint8_t i) const { return edges[i]; }
+    uint16_t getSampleRate() const { return sampleRateHz; }
+
+private:
+    RealFft<N> fft;
+    float hann[N];
+    float samples[N];
+    float power[RealFft<N>::BINS];
+    float average[RealFft<N>::BINS];
+
+    uint16_t sampleRateHz;
+    size_t fill;
+    uint32_t windows;
+    float edges[MAX_BANDS + 1];
+    uint8_t bandCount;
+    Features features;
+
+    void clearFeatures() {
+        features.dominantHz = 0;
+        features.rms = 0;
+        features.bandCount = bandCount;
+        features.windows = 0;
+        for (uint8_t b = 0; b < MAX_BANDS; b++) {
+            features.bandEnergy[b] = 0;
+        }
+    }
+
+    void updateFeatures() {
+        // One-sided mean square per bin (Parseval, Hann Σw² = 3N/8)
+        const float norm = 2.0f / ((float)N * (3.0f * N / 8.0f) * windows);
+        const float binHz = (float)sampleRateHz / N;
+
+        clearFeatures();
+        features.windows = windows;
+
+        float total = 0, peak = 0;
+        size_t peakBin = 0;
+        for (size_t k = 1; k < RealFft<N>::BINS; k++) {
+            float meanSquare = average[k] * norm;
+            float hz = k * binHz;
+            total += meanSquare;
+
+            if (meanSquare > peak) {
+                peak = meanSquare;
+                peakBin = k;
+            }
+
+            for (uint8_t b = 0; b < bandCount; b++) {
+                if (hz >= edges[b] && hz < edges[b + 1]) {
+                    features.bandEnergy[b] += meanSquare;
+                    break;
+                }
+            }
+        }
+
+        features.rms = sqrtf(total);
+        features.dominantHz = peakBin * binHz;
+    }
+};
+
+#endif // VIBRATIONSPECTRUM_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#ifndef WINDOWSTATS_H
+#define WINDOWSTATS_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Streaming min / max / mean / standard deviation (Welford)
+ *
+ * Constant memory and one division per sample, numerically stable for
+ * long windows. Values are unitless: callers may accumulate raw sensor
+ * counts and apply a scale when the summary is read.
+ */
+class RunningStats {
+public:
+    RunningStats() { reset(); }
+
+    void reset() {
+        n = 0;
+        meanValue = 0;
+        m2 = 0;
+        minValue = 0;
+        maxValue = 0;
+    }
+
+    /**
+     * @brief Fold one value into the summary
+     */
+    void add(float value) {
+        if (n == 0) {
+            minValue = value;
+            maxValue = value;
+        } else {
+            if (value < minValue) minValue = value;
+            if (value > maxValue) maxValue = value;
+        }
+
+        n++;
+        float delta = value - meanValue;
+        meanValue += delta / n;
+        m2 += delta * (value - meanValue);
+    }
+
+    /**
+     * @brief Fold another summary in, as if its values had been added here
+     *
+     * Pairwise update of Chan et al.: counts add, the means combine
+     * weighted by count, and the spread between them adds to m2.
+     */
+    void merge(const RunningStats& other) {
+        if (other.n == 0) {
+            return;
+        }
+        if (n == 0) {
+            *this = other;
+            return;
+        }
+
+        if (other.minValue < minValue) minValue = other.minValue;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+
+        uint32_t total = n + other.n;
+        float delta = other.meanValue - meanValue;
+        meanValue += delta * other.n / total;
+        m2 += other.m2 + delta * delta * ((float)n * other.n / total);
+        n = total;
+    }
+
+    uint32_t getCount() const { return n; }
+    float getMin() const { return minValue; }
+    float getMax() const { return maxValue; }
+    float getMean() const { return meanValue; }
+
+    /**
+     * @brief Population standard deviation (0 for fewer than two values)
+     */
+    float getStdDev() const {
+        return n > 1 ? sqrtf(m2 / n) : 0.0f;
+    }
+
+private:
+    uint32_t n;
+    float meanValue;
+    float m2;
+    float minValue;
+    float maxValue;
+};
+
+/**
+ * @brief Channels summarized over each upload window
+ */
+enum StatChannel : uint8_t {
+    STAT_TEMPERATURE = 0,
+    STAT_HUMIDITY,
+    STAT_ACCEL_X,
+    STAT_ACCEL_Y,
+    STAT_ACCEL_Z,
+    STAT_GYRO_X,
+    STAT_GYRO_Y,
+    STAT_GYRO_Z,
+    STAT_ACCEL_MAGNITUDE,
+    STAT_CHANNEL_COUNT
+};
+
+/**
+ * @brief Payload key for a channel
+ */
+inline const char* statChannelName(StatChannel channel) {
+    switch (channel) {
+        case STAT_TEMPERATURE:     return "temperature";
+        case STAT_HUMIDITY:        return "humidity";
+        case STAT_ACCEL_X:         return "accelX";
+        case STAT_ACCEL_Y:         return "accelY";
+        case STAT_ACCEL_Z:         return "accelZ";
+        case STAT_GYRO_X:          return "gyroX";
+        case STAT_GYRO_Y:          return "gyroY";
+        case STAT_GYRO_Z:          return "gyroZ";
+        case STAT_ACCEL_MAGNITUDE: return "accelMagnitude";
+        default:                   return "unknown";
+    }
+}
+
+/**
+ * @brief One RunningStats per channel, reset at every upload
+ *
+ * Sensors fold in every sample they produce (the IMU at its FIFO rate,
+ * the DHT11 per completed reading), so the uploaded summary covers the
+ * whole interval instead of the last read.
+ */
+class WindowStats {
+public:
+    void add(StatChannel channel, float value) {
+        channels[channel].add(value);
+    }
+
+    const RunningStats& get(StatChannel channel) const {
+        return channels[channel];
+    }
+
+    void reset() {
+        for (uint8_t i = 0; i < STAT_CHANNEL_COUNT; i++) {
+            channels[i].reset();
+        }
+    }
+
+    /**
+     * @brief Fold in the summary of another window, channel by channel
+     */
+    void merge(const WindowStats& other) {
+        for (uint8_t i = 0; i < STAT_CHANNEL_COUNT; i++) {
+            channels[i].merge(other.channels[i]);
+        }
+    }
+
+private:
+    RunningStats channels[STAT_CHANNEL_COUNT];
+};
+
+#endif // WINDOWSTATS_H
\ No newline at end of file
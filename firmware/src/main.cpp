@@ -6,8 +6,6 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <ESPmDNS.h>
 
@@ -15,29 +13,119 @@
 #include "Components/mpu6050.h"
 #include "Components/dht11.h"
 #include "Components/asyncwebserver.h"
+#include "Components/alertengine.h"
+#include "Components/transport.h"
+#include "Components/flashlog.h"
+#include "Components/base64.h"
+#include "Components/historyschema.h"
+#include "Components/powermanager.h"
+#include "Components/ntptime.h"
+#include "Components/boottimeline.h"
+#include "Components/sensorcore.h"
+#include "Components/uploadpolicy.h"
+#include "Components/jsonarena.h"
+#include "Components/alloccounter.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
 // ============================================================================
 MPU6050Sensor mpu;
 DHT11Sensor dht(DHT11_PIN);
+SensorCore sensors(mpu, dht);  // Detection + aggregation over both sensors
+SensorTask sampler(sensors, SensorTask::Config{ SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, VIBRATION_THRESHOLD });
 WebServerManager* webServer = nullptr;
 WiFiManager wifiManager;
-WiFiClientSecure httpsClient;
+DeviceConfig deviceConfig(AlertThresholds{
+  TEMP_MIN_THRESHOLD, TEMP_MAX_THRESHOLD, HUMIDITY_MIN_THRESHOLD, HUMIDITY_MAX_THRESHOLD, VIBRATION_THRESHOLD
+});
+TelemetryTransport transport(deviceConfig);  // Firebase REST or MQTT (TELEMETRY_TRANSPORT), follows config
+EspBatchPlatform batchPlatform;
+TelemetryBatcher* uploadBatch = nullptr;  // Created once the device path is known
+EspPartitionFlash logFlash;
+FlashRecordLog recordLog(logFlash);      // Samples / alerts kept while offline
+NtpTime ntpTime;                         // Monotonic sample clock → wall-clock time
+BootTimeline bootTimeline;               // Phase timings, serial + /api/info
+JsonArena<JSON_ARENA_BYTES> jsonArena;   // Upload / alert documents (network task only)
+
+#if LOW_POWER_MODE
+EspSleepPlatform sleepPlatform(&mpu, MPU6050_INT_PIN);
+PowerManager powerManager(sleepPlatform, PowerManager::Config{
+  SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, MOTION_IDLE_TIMEOUT,
+  LOW_POWER_MIN_SLEEP_MS, LOW_POWER_ACTIVE_MAX_SLEEP_MS
+});
+#endif
 
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
 String DEVICE_NAME = "TRACEON_UNKNOWN";
 String DEVICE_MAC = "";
-unsigned long lastSensorRead = 0;
-unsigned long lastUploadTime = 0;
 unsigned long lastStatusUpdate = 0;
 unsigned long lastHeapCheck = 0;
 
 bool sensorsInitialized = false;
 bool firebaseReady = false;
 bool webServerStarted = false;
+bool wifiLost = true;        // Until the boot has connected
+bool bootComplete = false;   // Every boot phase finished (advanceBoot)
+char wifiSsid[33] = "";      // Read once per connection, not per upload
+
+// Heap allocations per unit of steady-state work (ALLOC_COUNTER builds)
+AllocationCycles sensorStepAllocations;    // Sensor task, one sampler.step()
+AllocationCycles sampleCycleAllocations;   // Network task, alerts + upload of one record
+AllocationCycles flushAllocations;         // Network task, replay + batch flush
+
+// One state machine per alert type (normal → pending → active → resolved)
+enum AlertType : uint8_t {
+  ALERT_TYPE_TEMPERATURE = 0,
+  ALERT_TYPE_HUMIDITY,
+  ALERT_TYPE_VIBRATION,
+  ALERT_TYPE_ORIENTATION,
+  ALERT_TYPE_DROP,
+  ALERT_TYPE_COUNT
+};
+AlertMonitor alertMonitors[ALERT_TYPE_COUNT] = {
+  AlertMonitor(AlertRule{ ALERT_ENV_DEBOUNCE_MS, ALERT_ENV_CLEAR_MS, ALERT_TEMP_HYSTERESIS, ALERT_COOLDOWN_MS }),
+  AlertMonitor(AlertRule{ ALERT_ENV_DEBOUNCE_MS, ALERT_ENV_CLEAR_MS, ALERT_HUMIDITY_HYSTERESIS, ALERT_COOLDOWN_MS }),
+  AlertMonitor(AlertRule{ ALERT_VIBRATION_DEBOUNCE_MS, ALERT_VIBRATION_CLEAR_MS, ALERT_VIBRATION_HYSTERESIS, ALERT_COOLDOWN_MS }),
+  AlertMonitor(AlertRule{ ALERT_ORIENTATION_DEBOUNCE_MS, ALERT_ORIENTATION_CLEAR_MS, ALERT_ORIENTATION_HYSTERESIS, ALERT_COOLDOWN_MS }),
+  AlertMonitor(AlertRule{ 0, 0, 0, ALERT_DROP_COOLDOWN_MS })
+};
+AlertRateLimiter alertLimiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);  // Shared by all alert types
+char alertKeys[ALERT_TYPE_COUNT][PUSH_ID_LENGTH + 1];  // alerts/<key> of each type's current alert
+
+// Values the upload deadbands are applied to
+enum TelemetryChannel : uint8_t {
+  TELEMETRY_TEMPERATURE = 0,
+  TELEMETRY_HUMIDITY,
+  TELEMETRY_ORIENTATION,
+  TELEMETRY_TILT,
+  TELEMETRY_VIBRATION,
+  TELEMETRY_CHANNEL_COUNT
+};
+typedef UploadPolicy<TELEMETRY_CHANNEL_COUNT> TelemetryPolicy;
+TelemetryPolicy telemetryPolicy(TelemetryPolicy::Config{
+  { TELEMETRY_DEADBAND_TEMP, TELEMETRY_DEADBAND_HUMIDITY, TELEMETRY_DEADBAND_ORIENTATION, TELEMETRY_DEADBAND_TILT, TELEMETRY_DEADBAND_VIBRATION },
+  TELEMETRY_HEARTBEAT_MS, TELEMETRY_ACTIVE_INTERVAL_MS, TELEMETRY_ACTIVE_HOLD_MS
+});
+// Window stats / spectrum of the records suppressed since the last upload
+WindowStats suppressedStats;
+VibrationFeatures suppressedSpectrum = {};
+
+// history/ samples collected into one compressed block per batch
+typedef HistoryBlockEncoder<HISTORY_BLOCK_SAMPLES, HISTORY_NUMERIC_COUNT, HISTORY_STRING_COUNT> HistoryBlock;
+HistoryBlock historyBlock(historyNumericColumns(), HISTORY_SCHEMA_ID);
+unsigned long historyBlockStarted = 0;
+bool historyBlockSynced = false;  // Samples of the block are epoch ms, not monotonic ms
+
+// Blocks sealed before the first sync go to flash with monotonic stamps,
+// which only this boot can convert
+uint32_t bootId = 0;
+bool uptimeBlocksLogged = false;
+unsigned long onlineSince = 0;  // millis() of the last (re)connect
+
+bool replayInFlight = false;  // Replayed records queued, committed once the batch is sent
+volatile bool networkBusy = false;  // Network task mid-pass, no light sleep
 
 // ============================================================================
 // FORWARD DECLARATIONS
@@ -46,16 +134,38 @@ String generateDeviceName();
 String getMacAddress();
 void setupSensors();
 void setupWebServer();
+void setupUploads();
 void setupFirebase();
-void readSensors();
-void uploadToFirebase();
-void checkAndUploadAlerts();
+bool setupRecordLog();
+bool advanceBoot(unsigned long now);
+bool connectWiFi(unsigned long now);
+void setupDirectAccess();
+bool setupMdns();
+void printBootSummary();
+void sensorTaskLoop(void *parameter);
+void networkTaskLoop(void *parameter);
+void uploadToFirebase(const SensorRecord &record, bool alertChanged);
+bool checkAndUploadAlerts(const SensorRecord &record);
+bool alertExcursion();
+unsigned long long recordTimestamp(const SensorRecord &record);
+unsigned long long uptimeTimestamp(uint32_t uptimeMs);
+unsigned long long sampleTimestamp(uint64_t monotonicUs);
+void writeAlert(AlertType type, const AlertEvent &event);
+bool queueAlert(const char *key, const JsonDocument &alertDoc, unsigned long long timestampMillis);
+bool setJson(const char *path, const JsonDocument &doc,
+             TelemetryBatcher::Priority priority = TelemetryBatcher::PRIORITY_NORMAL);
+void flushUploads();
+void sealHistoryBlock();
+void publishHistorySchema();
+bool isUploadOnline();
+void replayRecordLog();
+void replayUptimeBlock(const FlashRecordLog::Record &record, const char *payload);
+size_t historyBlockNode(char *node, size_t capacity, const uint8_t *block, size_t length, uint32_t samples,
+                        unsigned long long from, unsigned long long to, bool synced);
+void addWindowStats(JsonDocument &doc, const WindowStats &window, StatChannel channel, float scale, float resolution);
+void addVibrationSpectrum(JsonDocument &doc, const VibrationFeatures &features);
 void checkHeapMemory();
 void checkResetButton();
-bool firebasePut(const String &path, const String &jsonPayload);
-bool firebasePost(const String &path, const String &jsonPayload);
-bool firebaseGet(const String &path, String &response);
-unsigned long long getTimestampMillis();  // ✅ FIXED: Return 64-bit value
 
 // ============================================================================
 // WIFI RESET BUTTON
@@ -96,7 +206,6 @@ void checkResetButton() {
 // ============================================================================
 void setup() {
   Serial.begin(DEBUG_SERIAL_BAUD);
-  delay(1000);
   
   #if ENABLE_DEBUG_LOGS
   Serial.println("\n\n");
@@ -125,7 +234,7 @@ void setup() {
   String last6 = tempMac.substring(tempMac.length() - 6);
   DEVICE_NAME = String(DEVICE_PREFIX) + last6;
   
-  webServer = new WebServerManager(&mpu, &dht, DEVICE_NAME);
+  webServer = new WebServerManager(&sampler, DEVICE_NAME);
   
   #if ENABLE_DEBUG_LOGS
   Serial.printf("[DEVICE] Name: %s\n", DEVICE_NAME.c_str());
@@ -133,12 +242,8 @@ void setup() {
   #endif
   
   // ========== WiFiManager Setup ==========
-  #if ENABLE_DEBUG_LOGS
-  Serial.println("\n[WiFi] Starting WiFiManager...");
-  Serial.printf("[WiFi] AP Name: %s\n", DEVICE_NAME.c_str());
-  Serial.printf("[WiFi] AP Password: %s\n", WM_AP_PASSWORD);
-  #endif
-  
+  // Non-blocking: the network task only opens the portal if the stored network does not connect
+  wifiManager.setConfigPortalBlocking(false);
   wifiManager.setConfigPortalTimeout(WIFI_PORTAL_TIMEOUT);
   wifiManager.setConnectTimeout(WIFI_CONNECT_TIMEOUT / 1000);
   wifiManager.setAPStaticIPConfig(IPAddress(192,168,4,1), IPAddress(192,168,4,1), IPAddress(255,255,255,0));
@@ -161,72 +266,143 @@ void setup() {
     }
   });
   
-  if (!wifiManager.autoConnect(DEVICE_NAME.c_str(), WM_AP_PASSWORD)) {
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[WiFi] ❌ Failed to connect, restarting...");
-    #endif
-    delay(3000);
-    ESP.restart();
-  }
-
-  #if ENABLE_DEBUG_LOGS
-  Serial.println("\n[WiFi] ✅ Connected!");
-  Serial.printf("[WiFi] SSID: %s\n", WiFi.SSID().c_str());
-  Serial.printf("[WiFi] IP: %s\n", WiFi.localIP().toString().c_str());
-  Serial.printf("[WiFi] RSSI: %d dBm\n", WiFi.RSSI());
-  Serial.printf("[WiFi] Signal: %d%%\n", (WiFi.RSSI() + 100) * 2);
-  #endif
+  // ========== Local Boot ==========
+  // Nothing here waits on the network: samples go to RAM (and the flash log)
+  // right away, WiFi / NTP / mDNS / web server / registration follow in the
+  // network task (advanceBoot)
+  bootTimeline.start(BOOT_SENSORS, millis());
+  setupSensors();
+  bootTimeline.finish(BOOT_SENSORS, millis(), sensorsInitialized);
   
-  // ========== NTP Time Sync ==========
-  #if ENABLE_DEBUG_LOGS
-  Serial.print("\n[NTP] Syncing time with server... ");
-  #endif
+  // Tells this boot's monotonic stamps in the flash log from earlier boots'
+  bootId = esp_random();
+  bootTimeline.start(BOOT_RECORD_LOG, millis());
+  bootTimeline.finish(BOOT_RECORD_LOG, millis(), setupRecordLog());
+  
+  setupUploads();
+  webServer->setBootTimeline(&bootTimeline);
   
-  configTime(19800, 0, "pool.ntp.org", "time.google.com", "time.cloudflare.com");
+  // ========== Tasks ==========
+  // Sampling never waits on a network request: it runs on the other core
+  // at a higher priority and hands records over through a lock-free queue
+  if (sensorsInitialized) {
+    bootTimeline.start(BOOT_SAMPLING, millis());
+    xTaskCreatePinnedToCore(sensorTaskLoop, "sensors", SENSOR_TASK_STACK, nullptr,
+                            SENSOR_TASK_PRIORITY, nullptr, SENSOR_TASK_CORE);
+  } else {
+    bootTimeline.finish(BOOT_SAMPLING, millis(), false);
+  }
+  xTaskCreatePinnedToCore(networkTaskLoop, "network", NETWORK_TASK_STACK, nullptr,
+                          NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+}
+
+// ============================================================================
+// NETWORK BOOT (network task)
+// ============================================================================
+// One step per pass, nothing in here waits on a timeout. Each phase starts
+// once the phases it needs are done; true once every phase has finished
+bool advanceBoot(unsigned long now) {
+  if (!bootTimeline.isDone(BOOT_WIFI)) {
+    if (!connectWiFi(now)) return false;
+    bootTimeline.finish(BOOT_WIFI, millis(), true);
+    wifiLost = false;
+    onlineSince = millis();
+    setupDirectAccess();
+  }
   
-  int ntpRetries = 0;
-  time_t now = time(nullptr);
-  while (now < 1000000000 && ntpRetries < 30) {
-    delay(500);
-    now = time(nullptr);
-    ntpRetries++;
-    if (ntpRetries % 5 == 0) {
-      Serial.print(".");
+  if (!bootTimeline.isStarted(BOOT_NTP)) {
+    bootTimeline.start(BOOT_NTP, millis());
+    ntpTime.begin();
+  } else if (!bootTimeline.isDone(BOOT_NTP)) {
+    if (ntpTime.isSynced()) {
+      bootTimeline.finish(BOOT_NTP, millis(), true);
+    } else if (millis() - bootTimeline.getStartMs(BOOT_NTP) >= TIME_SYNC_WAIT_MS) {
+      // Keeps trying in the background, held samples are dated once it syncs
+      bootTimeline.finish(BOOT_NTP, millis(), false);
     }
   }
   
-  #if ENABLE_DEBUG_LOGS
-  if (now > 1000000000) {
-    Serial.println(" ✅ Success");
-    Serial.printf("[NTP] Current time: %s", ctime(&now));
-    Serial.printf("[NTP] Unix timestamp: %lu\n", (unsigned long)now);
-  } else {
-    Serial.println(" ⚠️ Failed (using device uptime)");
+  if (!bootTimeline.isDone(BOOT_MDNS)) {
+    bootTimeline.start(BOOT_MDNS, millis());
+    bootTimeline.finish(BOOT_MDNS, millis(), setupMdns());
   }
-  #endif
   
-  digitalWrite(STATUS_LED_PIN, LED_ON);
+  if (!bootTimeline.isDone(BOOT_WEB_SERVER)) {
+    bootTimeline.start(BOOT_WEB_SERVER, millis());
+    setupWebServer();
+    bootTimeline.finish(BOOT_WEB_SERVER, millis(), webServerStarted);
+  }
   
-  // ========== mDNS Setup ==========
-  #if ENABLE_DEBUG_LOGS
-  Serial.print("\n[mDNS] Starting... ");
-  #endif
+  // registeredAt / lastSeen want wall-clock time
+  if (bootTimeline.isDone(BOOT_NTP) && !bootTimeline.isDone(BOOT_REGISTER)) {
+    bootTimeline.start(BOOT_REGISTER, millis());
+    setupFirebase();
+    bootTimeline.finish(BOOT_REGISTER, millis(), firebaseReady);
+  }
   
-  MDNS.end();
-  delay(100);
+  if (!bootTimeline.isComplete()) return false;
   
-  if (MDNS.begin(MDNS_HOSTNAME)) {
-    MDNS.addService("http", "tcp", 80);
+  printBootSummary();
+  return true;
+}
+
+// Stored credentials first, the config portal if they do not connect in time.
+// A portal that times out goes back to the stored network, sampling carries on.
+bool connectWiFi(unsigned long now) {
+  static unsigned long attemptStart = 0;
+  static bool portalOpen = false;
+  
+  if (!bootTimeline.isStarted(BOOT_WIFI)) {
+    bootTimeline.start(BOOT_WIFI, now);
     #if ENABLE_DEBUG_LOGS
-    Serial.println("✅ Success");
-    Serial.printf("[mDNS] Access via: http://%s.local\n", MDNS_HOSTNAME);
+    Serial.println("\n[WiFi] Connecting to the stored network...");
     #endif
-  } else {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin();
+    attemptStart = now;
+    return false;
+  }
+  
+  if (portalOpen) {
+    if (wifiManager.process()) return true;
+    if (wifiManager.getConfigPortalActive()) return false;
+    
     #if ENABLE_DEBUG_LOGS
-    Serial.println("⚠️ Failed (not critical)");
+    Serial.println("[WiFi] ⚠️ Portal timed out, retrying the stored network");
     #endif
+    portalOpen = false;
+    WiFi.mode(WIFI_STA);
+    WiFi.begin();
+    attemptStart = now;
+    return false;
   }
+  
+  if (WiFi.status() == WL_CONNECTED) return true;
+  if (wifiManager.getWiFiIsSaved() && now - attemptStart < WIFI_CONNECT_TIMEOUT) return false;
+  
+  #if ENABLE_DEBUG_LOGS
+  Serial.println("[WiFi] Starting WiFiManager portal...");
+  Serial.printf("[WiFi] AP Name: %s\n", DEVICE_NAME.c_str());
+  Serial.printf("[WiFi] AP Password: %s\n", WM_AP_PASSWORD);
+  #endif
+  wifiManager.startConfigPortal(DEVICE_NAME.c_str(), WM_AP_PASSWORD);
+  portalOpen = true;
+  return false;
+}
 
+void setupDirectAccess() {
+  strlcpy(wifiSsid, WiFi.SSID().c_str(), sizeof(wifiSsid));
+  
+  #if ENABLE_DEBUG_LOGS
+  Serial.println("\n[WiFi] ✅ Connected!");
+  Serial.printf("[WiFi] SSID: %s\n", wifiSsid);
+  Serial.printf("[WiFi] IP: %s\n", WiFi.localIP().toString().c_str());
+  Serial.printf("[WiFi] RSSI: %d dBm\n", WiFi.RSSI());
+  Serial.printf("[WiFi] Signal: %d%%\n", (WiFi.RSSI() + 100) * 2);
+  #endif
+  
+  digitalWrite(STATUS_LED_PIN, LED_ON);
+  
   // ========== Simultaneous AP Mode ==========
   #if ENABLE_DEBUG_LOGS
   Serial.print("[AP] Starting simultaneous Access Point... ");
@@ -244,12 +420,29 @@ void setup() {
     Serial.printf("[AP] Direct Access IP: http://%s\n", apIP.toString().c_str());
     #endif
   }
+}
+
+bool setupMdns() {
+  #if ENABLE_DEBUG_LOGS
+  Serial.print("\n[mDNS] Starting... ");
+  #endif
   
-  setupSensors();
-  setupWebServer();
-  setupFirebase();
+  if (MDNS.begin(MDNS_HOSTNAME)) {
+    MDNS.addService("http", "tcp", 80);
+    #if ENABLE_DEBUG_LOGS
+    Serial.println("✅ Success");
+    Serial.printf("[mDNS] Access via: http://%s.local\n", MDNS_HOSTNAME);
+    #endif
+    return true;
+  }
   
-  // ========== System Ready ==========
+  #if ENABLE_DEBUG_LOGS
+  Serial.println("⚠️ Failed (not critical)");
+  #endif
+  return false;
+}
+
+void printBootSummary() {
   #if ENABLE_DEBUG_LOGS
   String ipAddress = WiFi.localIP().toString();
   String apIP = WiFi.softAPIP().toString();
@@ -266,6 +459,16 @@ void setup() {
   Serial.printf("    Then: http://%s\n", apIP.c_str());
   Serial.println("-------------------------------------");
   Serial.printf("🔥 Firebase: /%s/%s\n", FIREBASE_BASE_PATH, DEVICE_NAME.c_str());
+  Serial.println("-------------------------------------");
+  Serial.println("⏱️  BOOT PHASES (start / duration):");
+  Serial.println("-------------------------------------");
+  for (uint8_t p = 0; p < BOOT_PHASE_COUNT; p++) {
+    BootPhase phase = (BootPhase)p;
+    Serial.printf("  %-12s %6lu ms %6lu ms  %s\n", bootPhaseName(phase),
+                  (unsigned long)bootTimeline.getStartMs(phase),
+                  (unsigned long)bootTimeline.getDurationMs(phase, millis()),
+                  bootTimeline.succeeded(phase) ? "✅" : "⚠️");
+  }
   Serial.println("=====================================\n");
   #endif
 }
@@ -273,73 +476,148 @@ void setup() {
 // ============================================================================
 // LOOP - MAIN EXECUTION
 // ============================================================================
+// All work runs in the two pinned tasks started by setup()
 void loop() {
-  unsigned long now = millis();
-  
-  checkResetButton();
-  
-  if (WiFi.status() != WL_CONNECTED) {
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[WiFi] ⚠️ Connection lost, reconnecting...");
-    #endif
-    digitalWrite(STATUS_LED_PIN, LED_OFF);
-    WiFi.reconnect();
-    delay(5000);
-    return;
-  }
-  
-  if (now - lastSensorRead >= SENSOR_READ_INTERVAL) {
-    readSensors();
-    lastSensorRead = now;
-  }
-  
-  if (now - lastUploadTime >= SENSOR_UPLOAD_INTERVAL) {
-    if (sensorsInitialized && firebaseReady) {
-      uploadToFirebase();
-      checkAndUploadAlerts();
+  vTaskDelete(NULL);
+}
+
+// ============================================================================
+// SENSOR TASK (APP_CPU, high priority)
+// ============================================================================
+void sensorTaskLoop(void *parameter) {
+  AllocationCounter::watchCurrentTask();
+  
+  for (;;) {
+    // Drain the IMU FIFO every pass so it never overflows between reads,
+    // advance the non-blocking DHT11 acquisition, queue a record per upload interval
+    uint32_t allocations = AllocationCounter::getCurrentTaskCount();
+    sampler.step();
+    sensorStepAllocations.add(AllocationCounter::getCurrentTaskCount() - allocations);
+    
+    // Time to first sample, reported with the boot phases
+    if (!bootTimeline.isDone(BOOT_SAMPLING) && sampler.getStats().records > 0) {
+      bootTimeline.finish(BOOT_SAMPLING, sampler.getLastRecordMs(), true);
+    }
+    
+    #if LOW_POWER_MODE
+    // Sleep until the next read/record deadline or a motion interrupt
+    // (never mid DHT11 transfer, the edge-capture ISR needs the CPU,
+    // nor while the network task is in the middle of a request)
+    if (dht.isBusy() || networkBusy ||
+        powerManager.idle(sampler.getLastReadMs(), sampler.getLastRecordMs()) == 0) {
+      delay(dht.isBusy() ? 1 : 10);
     }
-    lastUploadTime = now;
+    #else
+    delay(dht.isBusy() ? 1 : 10);
+    #endif
   }
+}
+
+// ============================================================================
+// NETWORK TASK (PRO_CPU)
+// ============================================================================
+void networkTaskLoop(void *parameter) {
+  AllocationCounter::watchCurrentTask();
   
-  // ✅ ADD THIS: Refresh thresholds every 60 seconds
-  static unsigned long lastThresholdCheck = 0;
-  if (now - lastThresholdCheck >= 60000) {  // Every 60 seconds
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[THRESHOLDS] Refreshing from Firebase...");
-    #endif
-    lastThresholdCheck = now;
-    // Thresholds will be read in next checkAndUploadAlerts() call
-  }
-
-  if (now - lastStatusUpdate >= STATUS_UPDATE_INTERVAL) {
-    webServer->setWiFiInfo(WiFi.SSID(), WiFi.RSSI());
-    webServer->setFirebaseStatus(firebaseReady);
-    lastStatusUpdate = now;
-  }
-  
-  static unsigned long lastStatusCheck = 0;
-  if (now - lastStatusCheck >= 30000) {
-    if (firebaseReady) {
-      String assignmentPath = String(FIREBASE_BASE_PATH) + "/" + DEVICE_NAME + "/info/assignedParcelId";
-      String response;
-      if (firebaseGet(assignmentPath, response)) {
-        response.replace("\"", "");
-        if (response != "null" && response.length() > 2) {
-          webServer->setDeviceStatus("Assigned to Parcel");
-        } else {
-          webServer->setDeviceStatus("Available");
-        }
+  for (;;) {
+    networkBusy = true;
+    unsigned long now = millis();
+    
+    checkResetButton();
+    
+    // WiFi, NTP, mDNS, the web server and registration come up while sampling
+    // already runs. Afterwards: sampling carries on while offline, uploads go
+    // to the flash log meanwhile
+    if (!bootComplete) {
+      bootComplete = advanceBoot(now);
+    } else if (WiFi.status() != WL_CONNECTED) {
+      static unsigned long lastReconnect = 0;
+      if (!wifiLost || now - lastReconnect >= WIFI_RECONNECT_INTERVAL) {
+        #if ENABLE_DEBUG_LOGS
+        Serial.println("[WiFi] ⚠️ Connection lost, reconnecting...");
+        #endif
+        digitalWrite(STATUS_LED_PIN, LED_OFF);
+        transport.stop();
+        WiFi.reconnect();
+        wifiLost = true;
+        lastReconnect = now;
       }
+    } else if (wifiLost) {
+      #if ENABLE_DEBUG_LOGS
+      Serial.printf("[WiFi] ✅ Reconnected, %lu records to replay\n", (unsigned long)recordLog.getPendingCount());
+      #endif
+      digitalWrite(STATUS_LED_PIN, LED_ON);
+      strlcpy(wifiSsid, WiFi.SSID().c_str(), sizeof(wifiSsid));
+      wifiLost = false;
+      onlineSince = now;
     }
-    lastStatusCheck = now;
-  }
-  
-  if (now - lastHeapCheck >= HEAP_CHECK_INTERVAL) {
-    checkHeapMemory();
-    lastHeapCheck = now;
+    
+    // Every SNTP re-sync refines the offset / drift used to date samples
+    if (!wifiLost) {
+      ntpTime.service();
+    }
+    
+    // Alerts are checked as records arrive, drops included. Records queue up
+    // while a request is slow, none are skipped, and the queue is emptied
+    // every pass: samples from before the first sync wait in the history
+    // block (or the flash log) to be dated, not in the sensor queue
+    SensorRecord record;
+    while (sampler.popRecord(record)) {
+      uint32_t allocations = AllocationCounter::getCurrentTaskCount();
+      bool alertChanged = checkAndUploadAlerts(record);
+      uploadToFirebase(record, alertChanged);
+      sampleCycleAllocations.add(AllocationCounter::getCurrentTaskCount() - allocations);
+    }
+    
+    // Size / age / priority policy, and retries after a failed flush
+    if (bootComplete && !wifiLost) {
+      uint32_t allocations = AllocationCounter::getCurrentTaskCount();
+      replayRecordLog();
+      flushUploads();
+      flushAllocations.add(AllocationCounter::getCurrentTaskCount() - allocations);
+    }
+    
+    // Dashboard changes to thresholds / assignment arrive as stream events / retained messages
+    if (bootComplete && !wifiLost) {
+      transport.service();
+    }
+    if (deviceConfig.takeChanged()) {
+      const AlertThresholds &limits = deviceConfig.getThresholds();
+      sampler.setVibrationThreshold(limits.vibration);
+      webServer->setDeviceStatus(deviceConfig.isAssigned() ? "Assigned to Parcel" : "Available");
+      #if ENABLE_DEBUG_LOGS
+      Serial.println("[THRESHOLDS] ✅ Updated from Firebase:");
+      Serial.printf("  Temp: %.1f - %.1f°C\n", limits.temperatureMin, limits.temperatureMax);
+      Serial.printf("  Humidity: %.1f - %.1f%%\n", limits.humidityMin, limits.humidityMax);
+      Serial.printf("  Vibration: %.1f m/s²\n", limits.vibration);
+      Serial.printf("  Parcel: %s\n", deviceConfig.isAssigned() ? deviceConfig.getAssignedParcelId() : "none");
+      #endif
+    }
+
+    if (now - lastStatusUpdate >= STATUS_UPDATE_INTERVAL) {
+      webServer->setWiFiInfo(wifiSsid, WiFi.RSSI());
+      webServer->setFirebaseStatus(firebaseReady);
+      webServer->setFirebaseStats(transport.getStats());
+      webServer->publishStatus();
+      lastStatusUpdate = now;
+    }
+    
+    // Live dashboards get every new reading once, queued for upload or not
+    static uint32_t publishedReading = 0;
+    uint32_t reading = sampler.getLiveVersion();
+    if (webServerStarted && reading != publishedReading) {
+      webServer->publishSample();
+      publishedReading = reading;
+    }
+    
+    if (now - lastHeapCheck >= HEAP_CHECK_INTERVAL) {
+      checkHeapMemory();
+      lastHeapCheck = now;
+    }
+    
+    networkBusy = false;
+    delay(10);
   }
-  
-  delay(10);
 }
 
 // ============================================================================
@@ -353,16 +631,26 @@ void setupSensors() {
   bool mpuOk = false;
   bool dhtOk = false;
   
-  delay(500);
-  
   if (mpu.begin(I2C_SDA_PIN, I2C_SCL_PIN)) {
     mpuOk = true;
   }
   
+  #if LOW_POWER_MODE
+  sleepPlatform.begin();
+  #endif
+  
   if (dht.begin()) {
     dhtOk = true;
   }
   
+  static const float vibrationBands[] = VIBRATION_BAND_EDGES_HZ;
+  sensors.begin(SensorCore::Config{
+    { DROP_FREE_FALL_G, DROP_MIN_FREE_FALL_MS, DROP_IMPACT_G, DROP_IMPACT_END_G, DROP_IMPACT_WINDOW_MS },
+    ORIENTATION_FUSION_BETA, ORIENTATION_UPRIGHT_MAX_TILT, ORIENTATION_INVERTED_MIN_TILT,
+    vibrationBands, sizeof(vibrationBands) / sizeof(vibrationBands[0]),
+    1000 / SENSOR_READ_INTERVAL
+  });
+  
   sensorsInitialized = (mpuOk || dhtOk);
   
   if (sensorsInitialized) {
@@ -382,7 +670,7 @@ void setupSensors() {
 // WEB SERVER INITIALIZATION
 // ============================================================================
 void setupWebServer() {
-  webServer->setWiFiInfo(WiFi.SSID(), WiFi.RSSI());
+  webServer->setWiFiInfo(wifiSsid, WiFi.RSSI());
   
   #if ENABLE_DEBUG_LOGS
   Serial.print("\n[WEB] Starting server on port 80... ");
@@ -406,188 +694,221 @@ void setupWebServer() {
 }
 
 // ============================================================================
-// FIREBASE INITIALIZATION
+// OFFLINE RECORD LOG
 // ============================================================================
-void setupFirebase() {
+bool setupRecordLog() {
   #if ENABLE_DEBUG_LOGS
-  Serial.println("\n[FIREBASE] Initializing...");
+  Serial.print("\n[LOG] Mounting offline record log... ");
   #endif
   
-  httpsClient.setInsecure();
-  
-  String devicePath = String(FIREBASE_BASE_PATH) + "/" + DEVICE_NAME + "/info";
-  String infoPath = devicePath + "/info";
-
-  // ✅ CRITICAL FIX: Read existing data BEFORE updating
-  String existingData;
-  String existingAssignedParcelId = "";
-  bool hasCustomThresholds = false;
-  
-  if (firebaseGet(infoPath, existingData)) {
+  if (!logFlash.begin(RECORD_LOG_PARTITION) || !recordLog.mount()) {
     #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] ✅ Found existing device data");
+    Serial.println("❌ Failed (offline data will not be kept)");
     #endif
-    
-    // Parse existing data
-    StaticJsonDocument<1024> existingDoc;
-    deserializeJson(existingDoc, existingData);
-    
-    // Extract assigned parcel ID
-    if (existingDoc.containsKey("assignedParcelId")) {
-      existingAssignedParcelId = existingDoc["assignedParcelId"].as<String>();
-      if (existingAssignedParcelId.length() > 0) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.printf("[FIREBASE] 🔗 Device is assigned to: %s\n", existingAssignedParcelId.c_str());
-        #endif
-        hasCustomThresholds = true;
-      }
-    }
+    return false;
   }
   
-  // ✅ FIXED: Use 64-bit timestamp
-  unsigned long long timestamp = getTimestampMillis();
+  #if ENABLE_DEBUG_LOGS
+  Serial.printf("✅ %lu sectors, %lu records pending\n",
+                (unsigned long)recordLog.getSectorCount(), (unsigned long)recordLog.getPendingCount());
+  #endif
+  return true;
+}
+
+// ============================================================================
+// FIREBASE INITIALIZATION
+// ============================================================================
+// Before any network: writes queue up (or go to the flash log) until the boot connects
+void setupUploads() {
+  uploadBatch = new TelemetryBatcher(transport, batchPlatform, TelemetryBatcher::Config{
+    UPLOAD_BATCH_FLUSH_BYTES, UPLOAD_BATCH_HISTORY, UPLOAD_BATCH_MAX_AGE_MS, UPLOAD_BATCH_RETRY_MS
+  }, esp_random());
+  
+  // Column names / resolutions of historyBlocks/, referenced by schema id
+  publishHistorySchema();
+}
+
+void setupFirebase() {
+  #if ENABLE_DEBUG_LOGS
+  Serial.println("\n[FIREBASE] Initializing...");
+  #endif
+  
+  // config/ (thresholds, assignment) is followed from the network task
+  transport.begin(String(FIREBASE_BASE_PATH) + "/" + DEVICE_NAME);
+  
+  unsigned long long timestamp = sampleTimestamp(NtpTime::monotonicUs());
   char timestampBuffer[20];
-  sprintf(timestampBuffer, "%llu", timestamp);
-  
-  StaticJsonDocument<JSON_SMALL_BUFFER_SIZE> infoDoc;
-  infoDoc["deviceName"] = DEVICE_NAME;
-  infoDoc["macAddress"] = DEVICE_MAC;
-  infoDoc["firmwareVersion"] = FW_VERSION;
-
-  // ✅ PRESERVE registeredAt if exists
-  if (existingData.length() > 0) {
-    StaticJsonDocument<1024> existingDoc;
-    deserializeJson(existingDoc, existingData);
-    if (existingDoc.containsKey("registeredAt")) {
-      infoDoc["registeredAt"] = existingDoc["registeredAt"];
-    } else {
-      infoDoc["registeredAt"] = timestampBuffer;
-    }
-  } else {
+  snprintf(timestampBuffer, sizeof(timestampBuffer), "%llu", timestamp);
+  
+  // A new device starts out available with the default thresholds. Only the
+  // REST transport can read info/ back; over MQTT the assignment and the
+  // thresholds are the retained config/ topics, owned by the dashboard side
+  String existingInfo;
+  if (transport.get("info", existingInfo) && existingInfo == "null") {
+    JsonDocument infoDoc(&jsonArena);
     infoDoc["registeredAt"] = timestampBuffer;
-  }
-  
-  // ✅ PRESERVE assignedParcelId
-  if (existingAssignedParcelId.length() > 0) {
-    infoDoc["assignedParcelId"] = existingAssignedParcelId;
-    infoDoc["status"] = "assigned";  // Keep assigned status
-  } else {
-    infoDoc["assignedParcelId"] = "";
     infoDoc["status"] = "available";
-  }
-
-  // infoDoc["registeredAt"] = timestampBuffer;  // ✅ Send as string
-  // infoDoc["status"] = "available";
-  // infoDoc["assignedParcelId"] = "";
-  infoDoc["lastSeen"] = timestampBuffer;  // ✅ Send as string
-  infoDoc["ipAddress"] = WiFi.localIP().toString();
-  infoDoc["wifiSSID"] = WiFi.SSID();
-  infoDoc["localAccess"] = "http://" + WiFi.localIP().toString();
-  infoDoc["mdnsAccess"] = "http://" + String(MDNS_HOSTNAME) + ".local";
-
-  // ✅ PRESERVE custom thresholds if assigned
-  if (hasCustomThresholds) {
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] 🔧 Preserving custom thresholds from parcel assignment");
-    #endif
-    // Don't overwrite thresholds - keep existing ones from parcel
-  } else {
-    // Only set default thresholds if not assigned
-    JsonObject thresholds = infoDoc.createNestedObject("thresholds");
+    infoDoc["assignedParcelId"] = "";
+    JsonObject thresholds = infoDoc["thresholds"].to<JsonObject>();
     thresholds["temperature"]["min"] = TEMP_MIN_THRESHOLD;
     thresholds["temperature"]["max"] = TEMP_MAX_THRESHOLD;
     thresholds["humidity"]["min"] = HUMIDITY_MIN_THRESHOLD;
     thresholds["humidity"]["max"] = HUMIDITY_MAX_THRESHOLD;
     thresholds["vibration"] = VIBRATION_THRESHOLD;
+    
+    String infoJson;
+    serializeJson(infoDoc, infoJson);
+    #if ENABLE_DEBUG_LOGS
+    Serial.println("[FIREBASE] 🆕 New device, writing initial info");
+    #endif
+    transport.put("info", infoJson);
+  }
+  
+  // The device follows config/, written by the dashboard next to info/.
+  // Seeded once from info/ (or the defaults) for devices registered before
+  String existingConfig;
+  if (transport.get("config", existingConfig) && existingConfig == "null") {
+    JsonDocument infoDoc(&jsonArena);
+    if (existingInfo != "null") {
+      deserializeJson(infoDoc, existingInfo);
+    }
+    JsonDocument configDoc(&jsonArena);
+    configDoc["assignedParcelId"] = infoDoc["assignedParcelId"] | "";
+    JsonObject thresholds = configDoc["thresholds"].to<JsonObject>();
+    thresholds["temperature"]["min"] = infoDoc["thresholds"]["temperature"]["min"] | TEMP_MIN_THRESHOLD;
+    thresholds["temperature"]["max"] = infoDoc["thresholds"]["temperature"]["max"] | TEMP_MAX_THRESHOLD;
+    thresholds["humidity"]["min"] = infoDoc["thresholds"]["humidity"]["min"] | HUMIDITY_MIN_THRESHOLD;
+    thresholds["humidity"]["max"] = infoDoc["thresholds"]["humidity"]["max"] | HUMIDITY_MAX_THRESHOLD;
+    thresholds["vibration"] = infoDoc["thresholds"]["vibration"] | VIBRATION_THRESHOLD;
+    
+    String configJson;
+    serializeJson(configDoc, configJson);
+    transport.put("config", configJson);
   }
   
-  String infoJson;
-  serializeJson(infoDoc, infoJson);
+  // Fields the device owns, merged into info/ one by one (PATCH over REST,
+  // the batch topic over MQTT), so the assignment, thresholds and status set
+  // from the dashboard are never overwritten by a reboot
+  String ipAddress = WiFi.localIP().toString();
+  String localAccess = "http://" + ipAddress;
+  String mdnsAccess = "http://" + String(MDNS_HOSTNAME) + ".local";
+  const char *fields[][2] = {
+    { "info/deviceName", DEVICE_NAME.c_str() },
+    { "info/macAddress", DEVICE_MAC.c_str() },
+    { "info/firmwareVersion", FW_VERSION },
+    { "info/lastSeen", timestampBuffer },   // String, full 64-bit timestamp
+    { "info/ipAddress", ipAddress.c_str() },
+    { "info/wifiSSID", wifiSsid },
+    { "info/localAccess", localAccess.c_str() },
+    { "info/mdnsAccess", mdnsAccess.c_str() }
+  };
+  for (const auto &field : fields) {
+    JsonDocument value(&jsonArena);
+    value.set(field[1]);
+    setJson(field[0], value);
+  }
   
   #if ENABLE_DEBUG_LOGS
-  Serial.printf("[FIREBASE] Registering at: %s\n", devicePath.c_str());
+  Serial.printf("[FIREBASE] Registering at: %s/%s/info\n", FIREBASE_BASE_PATH, DEVICE_NAME.c_str());
   Serial.printf("[FIREBASE] Timestamp: %s\n", timestampBuffer);
   #endif
   
-  if (firebasePut(infoPath, infoJson)) {
-    firebaseReady = true;
-    webServer->setFirebaseStatus(true);
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] ✅ Device updated successfully");
-    if (existingAssignedParcelId.length() > 0) {
-      Serial.println("[FIREBASE] ✅ Parcel assignment preserved!");
-    }
-    #endif
-  } else {
-    firebaseReady = false;
-    webServer->setFirebaseStatus(false);
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] ❌ Failed to update device");
-    #endif
-  }
-
-  if (firebasePut(devicePath, infoJson)) {
-    firebaseReady = true;
-    webServer->setFirebaseStatus(true);
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] ✅ Device registered");
-    #endif
-  } else {
-    firebaseReady = false;
-    webServer->setFirebaseStatus(false);
-  }
+  firebaseReady = uploadBatch->flush();
+  webServer->setFirebaseStatus(firebaseReady);
+  #if ENABLE_DEBUG_LOGS
+  Serial.println(firebaseReady ? "[FIREBASE] ✅ Device registered" : "[FIREBASE] ❌ Failed to register device");
+  #endif
 }
 
 // ============================================================================
-// SENSOR READING
+// FIREBASE UPLOAD
 // ============================================================================
-void readSensors() {
-  if (!sensorsInitialized) return;
-  
-  if (mpu.isConnected()) {
-    mpu.readSensorData();
+void uploadToFirebase(const SensorRecord &latest, bool alertChanged) {
+  // Suppressed records are not lost: their window stats and spectrum fold
+  // into the next published record, whose summary then covers every
+  // sample since the last upload
+  SensorRecord record = latest;
+  record.stats = suppressedStats;
+  record.stats.merge(latest.stats);
+  record.vibration = suppressedSpectrum;
+  record.vibration.merge(latest.vibration);
+  const RunningStats &magnitude = record.stats.get(STAT_ACCEL_MAGNITUDE);
+  if (magnitude.getCount() > 0) {
+    record.minAcceleration = magnitude.getMin() * ImuScaleConfig::MS2_PER_LSB;
+    record.maxAcceleration = magnitude.getMax() * ImuScaleConfig::MS2_PER_LSB;
   }
   
-  if (dht.isValid()) {
-    dht.readSensor();
+  // Flat readings are not re-sent every interval: deadbands, alert
+  // events, motion / excursions (full rate) and a heartbeat decide. The
+  // env deadbands also see how far the readings went in between.
+  float telemetry[TELEMETRY_CHANNEL_COUNT] = {
+    record.envValid ? record.temperature : NAN,
+    record.envValid ? record.humidity : NAN,
+    record.imuReady ? (float)record.orientation : NAN,  // Any change of class
+    record.imuReady ? record.tilt : NAN,
+    vibrationDeviation(record)  // Furthest from 1 g since the last upload
+  };
+  float lows[TELEMETRY_CHANNEL_COUNT] = { NAN, NAN, NAN, NAN, NAN };
+  float highs[TELEMETRY_CHANNEL_COUNT] = { NAN, NAN, NAN, NAN, NAN };
+  const RunningStats &temperature = record.stats.get(STAT_TEMPERATURE);
+  const RunningStats &humidity = record.stats.get(STAT_HUMIDITY);
+  if (record.envValid && temperature.getCount() > 0) {
+    lows[TELEMETRY_TEMPERATURE] = temperature.getMin();
+    highs[TELEMETRY_TEMPERATURE] = temperature.getMax();
   }
-}
-
-// ============================================================================
-// FIREBASE UPLOAD
-// ============================================================================
-void uploadToFirebase() {
-  String devicePathBase = String(FIREBASE_BASE_PATH) + "/" + DEVICE_NAME;
+  if (record.envValid && humidity.getCount() > 0) {
+    lows[TELEMETRY_HUMIDITY] = humidity.getMin();
+    highs[TELEMETRY_HUMIDITY] = humidity.getMax();
+  }
+  bool activity = alertExcursion() || vibrationDeviation(latest) > TELEMETRY_MOTION_MS2;
+  TelemetryPolicy::Reason reason = telemetryPolicy.evaluate(telemetry, alertChanged, activity, record.uptimeMs,
+                                                            lows, highs);
+  if (reason == TelemetryPolicy::REASON_NONE) {
+    suppressedStats = record.stats;
+    suppressedSpectrum = record.vibration;
+    return;
+  }
+  suppressedStats.reset();
+  suppressedSpectrum = VibrationFeatures{};
   
-  // ✅ FIXED: Get 64-bit timestamp
-  unsigned long long timestampMillis = getTimestampMillis();
+  // ✅ FIXED: Get 64-bit timestamp (of the capture, not of this upload)
+  unsigned long long timestampMillis = recordTimestamp(record);
   char timestampBuffer[20];
   sprintf(timestampBuffer, "%llu", timestampMillis);
   
-  StaticJsonDocument<JSON_BUFFER_SIZE> currentDoc;
+  // Built in the arena and serialized straight into the upload batch, the
+  // steady state of a sample cycle does not touch the heap
+  JsonDocument currentDoc(&jsonArena);
   
   currentDoc["timestamp"] = timestampBuffer;  // ✅ Send as string
+  if (!ntpTime.isSynced()) {
+    currentDoc["timeSynced"] = false;  // Uptime ms, not epoch
+  }
   currentDoc["state"] = "Monitoring";
+  currentDoc["uploadReason"] = TelemetryPolicy::reasonName(reason);
   
-  if (dht.isValid()) {
-    currentDoc["temperature"] = round(dht.getTemperature() * 10) / 10.0;
-    currentDoc["humidity"] = round(dht.getHumidity() * 10) / 10.0;
-    currentDoc["heatIndex"] = round(dht.getHeatIndex() * 10) / 10.0;
+  if (record.envValid) {
+    currentDoc["temperature"] = round(record.temperature * 10) / 10.0;
+    currentDoc["humidity"] = round(record.humidity * 10) / 10.0;
+    currentDoc["heatIndex"] = round(record.heatIndex * 10) / 10.0;
   } else {
     currentDoc["temperature"] = 0;
     currentDoc["humidity"] = 0;
     currentDoc["heatIndex"] = 0;
   }
   
-  if (mpu.isConnected()) {
-    currentDoc["accelX"] = round(mpu.getAccelX() * 100) / 100.0;
-    currentDoc["accelY"] = round(mpu.getAccelY() * 100) / 100.0;
-    currentDoc["accelZ"] = round(mpu.getAccelZ() * 100) / 100.0;
-    currentDoc["gyroX"] = round(mpu.getGyroX() * 100) / 100.0;
-    currentDoc["gyroY"] = round(mpu.getGyroY() * 100) / 100.0;
-    currentDoc["gyroZ"] = round(mpu.getGyroZ() * 100) / 100.0;
-    currentDoc["orientation"] = mpu.detectOrientation();
-    currentDoc["vibration"] = mpu.detectVibration();
+  if (record.imuReady) {
+    currentDoc["accelX"] = round(record.accel[0] * 100) / 100.0;
+    currentDoc["accelY"] = round(record.accel[1] * 100) / 100.0;
+    currentDoc["accelZ"] = round(record.accel[2] * 100) / 100.0;
+    currentDoc["gyroX"] = round(record.gyro[0] * 100) / 100.0;
+    currentDoc["gyroY"] = round(record.gyro[1] * 100) / 100.0;
+    currentDoc["gyroZ"] = round(record.gyro[2] * 100) / 100.0;
+    currentDoc["orientation"] = orientationName(record.orientation);
+    currentDoc["pitch"] = round(record.pitch * 10) / 10.0;
+    currentDoc["roll"] = round(record.roll * 10) / 10.0;
+    currentDoc["tilt"] = round(record.tilt * 10) / 10.0;
+    currentDoc["vibration"] = exceedsVibration(record, deviceConfig.getThresholds().vibration);
   } else {
     currentDoc["accelX"] = 0;
     currentDoc["accelY"] = 0;
@@ -599,294 +920,528 @@ void uploadToFirebase() {
     currentDoc["vibration"] = false;
   }
   
-  currentDoc["wifiSSID"] = WiFi.SSID();
-  currentDoc["wifiRSSI"] = WiFi.RSSI();
+  // Summaries over the whole upload window (IMU channels are raw counts)
+  addWindowStats(currentDoc, record.stats, STAT_TEMPERATURE, 1.0f, 10);
+  addWindowStats(currentDoc, record.stats, STAT_HUMIDITY, 1.0f, 10);
+  addWindowStats(currentDoc, record.stats, STAT_ACCEL_X, ImuScaleConfig::MS2_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_ACCEL_Y, ImuScaleConfig::MS2_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_ACCEL_Z, ImuScaleConfig::MS2_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_GYRO_X, ImuScaleConfig::RADS_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_GYRO_Y, ImuScaleConfig::RADS_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_GYRO_Z, ImuScaleConfig::RADS_PER_LSB, 100);
+  addWindowStats(currentDoc, record.stats, STAT_ACCEL_MAGNITUDE, ImuScaleConfig::MS2_PER_LSB, 100);
+  if (record.imuReady) {
+    addVibrationSpectrum(currentDoc, record.vibration);
+  }
   
-  String jsonStr;
-  serializeJson(currentDoc, jsonStr);
+  currentDoc["wifiSSID"] = wifiSsid;
+  currentDoc["wifiRSSI"] = WiFi.RSSI();
   
-  String currentPath = devicePathBase + "/current";
-  if (firebasePut(currentPath, jsonStr)) {
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[FIREBASE] ✅ Data uploaded");
-    #endif
-    
-    String historyPath = devicePathBase + "/history";
-    firebasePost(historyPath, jsonStr);
-    
-    // ✅ FIXED: Update lastSeen with full 64-bit timestamp as string
-    String lastSeenPath = devicePathBase + "/info/lastSeen";
-    String lastSeenPayload = "\"" + String(timestampBuffer) + "\"";  // Wrap in quotes for Firebase
-    
-    #if ENABLE_DEBUG_LOGS
-    Serial.printf("[FIREBASE] Updating lastSeen: %s\n", timestampBuffer);
-    #endif
-    
-    firebasePut(lastSeenPath, lastSeenPayload);
-    
-    webServer->setFirebaseStatus(true);
-    firebaseReady = true;
-  } else {
-    webServer->setFirebaseStatus(false);
-    firebaseReady = false;
+  // Queued, sent with the next flush as one PATCH. current and lastSeen
+  // keep only their latest value.
+  setJson("current", currentDoc);
+  
+  // History keeps every sample, as a column of the current block
+  float historyRow[HISTORY_NUMERIC_COUNT];
+  historyValues(record, deviceConfig.getThresholds().vibration, WiFi.RSSI(), historyRow);
+  const char *historyStrings[HISTORY_STRING_COUNT] = {
+    currentDoc["orientation"] | "",
+    wifiSsid,
+    TelemetryPolicy::reasonName(reason)
+  };
+  // A block holds one clock: the first sync re-dates the monotonic stamps
+  // of the samples held from before it
+  bool synced = ntpTime.isSynced();
+  if (synced && !historyBlockSynced) {
+    historyBlock.retime([](uint64_t ms) { return ntpTime.toUnixMs(ms * 1000); });
+    historyBlockSynced = true;
+  }
+  if (historyBlock.getCount() == 0) {
+    historyBlockStarted = millis();
+    historyBlockSynced = synced;
+  }
+  historyBlock.add(timestampMillis, historyRow, historyStrings);
+  if (historyBlock.isFull()) {
+    sealHistoryBlock();
   }
+  
+  // ✅ FIXED: Update lastSeen with full 64-bit timestamp as string
+  char lastSeenPayload[24];
+  int lastSeenLength = snprintf(lastSeenPayload, sizeof(lastSeenPayload), "\"%s\"", timestampBuffer);  // Wrap in quotes for Firebase
+  uploadBatch->set("info/lastSeen", lastSeenPayload, lastSeenLength);
 }
 
 // ============================================================================
-// ALERT CHECKING
+// UPLOAD BATCH
 // ============================================================================
-void checkAndUploadAlerts() {
-  if (!sensorsInitialized || !firebaseReady) return;
-  
-  String devicePathBase = String(FIREBASE_BASE_PATH) + "/" + DEVICE_NAME;
+bool isUploadOnline() {
+  return !wifiLost && !uploadBatch->isBackingOff();
+}
 
-  // ✅ READ THRESHOLDS FROM FIREBASE (not config.h)
-  String thresholdsPath = devicePathBase + "/info/thresholds";
-  String response;
+void flushUploads() {
+  // Pending history samples ride along with every flush (held until full
+  // before the first sync, so the sync can still re-date them)
+  if (historyBlock.getCount() > 0 && historyBlockSynced &&
+      (uploadBatch->isDue() || millis() - historyBlockStarted >= HISTORY_BLOCK_MAX_AGE_MS)) {
+    sealHistoryBlock();
+  }
+  
+  if (!uploadBatch->isDue()) return;
   
-  float tempMin = TEMP_MIN_THRESHOLD; // Defaults
-  float tempMax = TEMP_MAX_THRESHOLD;
-  float humidMin = HUMIDITY_MIN_THRESHOLD;
-  float humidMax = HUMIDITY_MAX_THRESHOLD;
-  float vibThreshold = VIBRATION_THRESHOLD;
+  uint16_t entries = uploadBatch->getPendingEntries();
+  bool ok = uploadBatch->flush();
+  firebaseReady = ok;
+  webServer->setFirebaseStatus(ok);
   
-  // Try to read from Firebase
-  if (firebaseGet(thresholdsPath, response)) {
-    StaticJsonDocument<512> doc;
-    deserializeJson(doc, response);
+  // A successful flush clears the whole queue, replayed records included
+  if (ok && replayInFlight) {
+    recordLog.commit();
+    replayInFlight = false;
+  }
+  
+  #if ENABLE_DEBUG_LOGS
+  if (ok) {
+    Serial.printf("[FIREBASE] ✅ Batch uploaded: %u writes, %lu bytes\n",
+                  entries, (unsigned long)uploadBatch->getStats().lastBytes);
+  } else {
+    Serial.printf("[FIREBASE] ⚠️  Batch upload failed, %u writes kept for retry\n", entries);
+  }
+  #endif
+}
+
+// ============================================================================
+// HISTORY BLOCKS
+// ============================================================================
+void sealHistoryBlock() {
+  static uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+  static char node[FlashRecordLog::MAX_PAYLOAD];
+  
+  while (historyBlock.getCount() > 0) {
+    // Noisy samples can outgrow the size limit: send the front half, keep the rest
+    size_t samples = historyBlock.getCount();
+    size_t length = 0;
+    while (samples > 0 && (length = historyBlock.encode(encoded, sizeof(encoded), samples)) == 0) {
+      samples /= 2;
+    }
+    if (samples == 0) {
+      historyBlock.consume(1);  // Cannot happen with a sane limit, never wedge on it
+      continue;
+    }
     
-    if (doc.containsKey("temperature")) {
-      tempMin = doc["temperature"]["min"] | TEMP_MIN_THRESHOLD;
-      tempMax = doc["temperature"]["max"] | TEMP_MAX_THRESHOLD;
+    unsigned long long from = historyBlock.getTimestamp(0);
+    unsigned long long to = historyBlock.getTimestamp(samples - 1);
+    
+    // Still on the monotonic clock: kept in flash as encoded, re-dated at
+    // replay once this boot has synced
+    if (!historyBlockSynced) {
+      memcpy(node, &bootId, sizeof(bootId));
+      memcpy(node + sizeof(bootId), encoded, length);
+      uptimeBlocksLogged |= recordLog.append(RECORD_HISTORY_BLOCK_UPTIME, from, node, sizeof(bootId) + length);
+      historyBlock.consume(samples);
+      continue;
     }
-    if (doc.containsKey("humidity")) {
-      humidMin = doc["humidity"]["min"] | HUMIDITY_MIN_THRESHOLD;
-      humidMax = doc["humidity"]["max"] | HUMIDITY_MAX_THRESHOLD;
+    
+    size_t nodeLength = historyBlockNode(node, sizeof(node), encoded, length, samples, from, to, true);
+    if (nodeLength == 0) {
+      historyBlock.consume(samples);
+      continue;
     }
-    if (doc.containsKey("vibration")) {
-      vibThreshold = doc["vibration"] | VIBRATION_THRESHOLD;
+    
+    // Offline (or the batch is full): kept in flash, one record per block
+    if (!isUploadOnline() || !uploadBatch->push("historyBlocks", node, nodeLength, from)) {
+      recordLog.append(RECORD_HISTORY_BLOCK, from, node, nodeLength);
     }
     
     #if ENABLE_DEBUG_LOGS
-    Serial.println("[ALERTS] ✅ Using Firebase thresholds:");
-    Serial.printf("  Temp: %.1f - %.1f°C\n", tempMin, tempMax);
-    Serial.printf("  Humidity: %.1f - %.1f%%\n", humidMin, humidMax);
-     Serial.printf("  Vibration: %.1f m/s²\n", vibThreshold);
-    #endif
-  } else {
-    #if ENABLE_DEBUG_LOGS
-    Serial.println("[ALERTS] ℹ️ No custom thresholds found, using defaults");
+    Serial.printf("[HISTORY] Block of %u samples: %u bytes (%u as a node)\n",
+                  (unsigned)samples, (unsigned)length, (unsigned)nodeLength);
     #endif
+    historyBlock.consume(samples);
   }
+}
 
-  String alertsPath = devicePathBase + "/alerts";
-  
-  // ✅ FIXED: Get 64-bit timestamp
-  unsigned long long timestampMillis = getTimestampMillis();
-  char timestampBuffer[20];
-  sprintf(timestampBuffer, "%llu", timestampMillis);
+// historyBlocks/ entry of an encoded block, 0 if it does not fit
+size_t historyBlockNode(char *node, size_t capacity, const uint8_t *block, size_t length, uint32_t samples,
+                        unsigned long long from, unsigned long long to, bool synced) {
+  int header = snprintf(node, capacity,
+                        "{\"format\":\"columnar\",\"version\":%d,\"schema\":%d,\"count\":%u,%s"
+                        "\"from\":\"%llu\",\"to\":\"%llu\",\"data\":\"",
+                        HISTORY_CODEC_VERSION, HISTORY_SCHEMA_ID, (unsigned)samples,
+                        synced ? "" : "\"timeSynced\":false,",  // Uptime ms, not epoch
+                        from, to);
+  if (header < 0 || (size_t)header + 2 >= capacity) return 0;
+  
+  size_t dataLength = base64Encode(block, length, node + header, capacity - header - 2);
+  if (dataLength == 0) return 0;
+  size_t nodeLength = header + dataLength;
+  node[nodeLength++] = '"';
+  node[nodeLength++] = '}';
+  return nodeLength;
+}
+
+void publishHistorySchema() {
+  const HistoryColumn *columns = historyNumericColumns();
+  
+  JsonDocument doc;  // Once per boot
+  doc["schema"] = HISTORY_SCHEMA_ID;
+  doc["version"] = HISTORY_CODEC_VERSION;
+  JsonArray numeric = doc["numeric"].to<JsonArray>();
+  for (uint8_t c = 0; c < HISTORY_NUMERIC_COUNT; c++) {
+    JsonObject column = numeric.add<JsonObject>();
+    column["name"] = columns[c].name;
+    column["decimals"] = columns[c].decimals;
+  }
+  JsonArray strings = doc["strings"].to<JsonArray>();
+  for (uint8_t s = 0; s < HISTORY_STRING_COUNT; s++) {
+    strings.add(historyStringColumnName((HistoryStringColumn)s));
+  }
   
-  if (dht.isValid()) {
-    float temp = dht.getTemperature();
-    
-    if (temp < tempMin || temp > tempMax) {
-      StaticJsonDocument<JSON_SMALL_BUFFER_SIZE> alertDoc;
-      alertDoc["type"] = "temperature";
-      alertDoc["severity"] = (temp > tempMax) ? "critical" : "warning";
-      alertDoc["message"] = (temp > tempMax) ? 
-                           "Temperature exceeded maximum" : "Temperature below minimum";
-      alertDoc["value"] = temp;
-      alertDoc["threshold"] = (temp > tempMax) ? tempMax : tempMin;
-      alertDoc["timestamp"] = timestampBuffer;  // ✅ Send as string
-      alertDoc["resolved"] = false;
-      
-      String alertJson;
-      serializeJson(alertDoc, alertJson);
-      firebasePost(alertsPath, alertJson);
+  setJson("historySchema", doc);
+}
 
-      if (firebasePost(alertsPath, alertJson)) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.printf("[ALERTS] 🚨 Temperature alert sent: %.1f°C (threshold: %.1f°C)\n", 
-                      temp, (temp > tempMax) ? tempMax : tempMin);
-        #endif
-      }
-    }
-    
-    float humid = dht.getHumidity();
+// ============================================================================
+// WINDOW STATISTICS
+// ============================================================================
+void addWindowStats(JsonDocument &doc, const WindowStats &window, StatChannel channel, float scale, float resolution) {
+  const RunningStats &stats = window.get(channel);
+  if (stats.getCount() == 0) return;
+  
+  JsonVariant summary = doc["stats"][statChannelName(channel)];
+  summary["n"] = stats.getCount();
+  summary["min"] = round(stats.getMin() * scale * resolution) / resolution;
+  summary["max"] = round(stats.getMax() * scale * resolution) / resolution;
+  summary["mean"] = round(stats.getMean() * scale * resolution) / resolution;
+  summary["stddev"] = round(stats.getStdDev() * scale * resolution) / resolution;
+}
 
-    if (humid < humidMin || humid > humidMax) {
-      StaticJsonDocument<JSON_SMALL_BUFFER_SIZE> alertDoc;
-      alertDoc["type"] = "humidity";
-      alertDoc["severity"] = (humid > humidMax) ? "critical" : "warning";
-      alertDoc["message"] = (temp > humidMax) ? 
-                           "Humidity exceeded maximum" : "Humidity below minimum";
-      alertDoc["value"] = humid;
-      alertDoc["threshold"] = (humid > humidMax) ? humidMax : humidMin;
-      alertDoc["timestamp"] = timestampBuffer;  // ✅ Send as string
-      alertDoc["resolved"] = false;
-      
-      String alertJson;
-      serializeJson(alertDoc, alertJson);
-      firebasePost(alertsPath, alertJson);
+void addVibrationSpectrum(JsonDocument &doc, const VibrationFeatures &features) {
+  if (features.windows == 0) return;
+  
+  const float energyScale = ImuScaleConfig::MS2_PER_LSB * ImuScaleConfig::MS2_PER_LSB;
+  
+  JsonVariant spectrum = doc["vibrationSpectrum"];
+  spectrum["dominantHz"] = round(features.dominantHz * 10) / 10.0;
+  spectrum["rms"] = round(features.rms * ImuScaleConfig::MS2_PER_LSB * 1000) / 1000.0;
+  spectrum["windows"] = features.windows;
+  for (uint8_t b = 0; b < features.bandCount; b++) {
+    spectrum["bands"][b] = round(features.bandEnergy[b] * energyScale * 10000) / 10000.0;  // (m/s²)²
+  }
+}
 
-      if (firebasePost(alertsPath, alertJson)) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.printf("[ALERTS] 🚨 Humidity alert sent: %.1f%% (threshold: %.1f%%)\n", 
-                      humid, (humid > humidMax) ? humidMax : humidMin);
-        #endif
-      }
+// ============================================================================
+// ALERT CHECKING
+// ============================================================================
+bool checkAndUploadAlerts(const SensorRecord &record) {
+  if (!sensorsInitialized) return false;
+  
+  // ✅ Thresholds from Firebase, kept current by the config stream (defaults from config.h)
+  const AlertThresholds &limits = deviceConfig.getThresholds();
+  uint32_t at = record.uptimeMs;
+  AlertEvent event;
+  bool changed = false;
+  
+  // Each type opens once per excursion and resolves once, not every record
+  if (record.envValid) {
+    if (alertMonitors[ALERT_TYPE_TEMPERATURE].update(record.temperature, limits.temperatureMin,
+                                                     limits.temperatureMax, at, alertLimiter, event)) {
+      writeAlert(ALERT_TYPE_TEMPERATURE, event);
+      changed = true;
+    }
+    if (alertMonitors[ALERT_TYPE_HUMIDITY].update(record.humidity, limits.humidityMin,
+                                                  limits.humidityMax, at, alertLimiter, event)) {
+      writeAlert(ALERT_TYPE_HUMIDITY, event);
+      changed = true;
     }
   }
   
   // ========== VIBRATION ALERTS (using synced threshold) ==========
-  if (mpu.isConnected() && mpu.detectVibration(vibThreshold)) {
-    StaticJsonDocument<JSON_SMALL_BUFFER_SIZE> alertDoc;
-    alertDoc["type"] = "vibration";
-    alertDoc["severity"] = "warning";
-    alertDoc["message"] = "Excessive vibration detected - possible rough handling";
-    alertDoc["value"] = mpu.getTotalAcceleration();
-    alertDoc["threshold"] = vibThreshold;
-    alertDoc["timestamp"] = timestampBuffer;  // ✅ Send as string
+  if (alertMonitors[ALERT_TYPE_VIBRATION].update(vibrationDeviation(record), -HUGE_VALF,
+                                                 limits.vibration, at, alertLimiter, event)) {
+    writeAlert(ALERT_TYPE_VIBRATION, event);
+    changed = true;
+  }
+
+  // ========== ORIENTATION ALERTS ==========
+  // Tilt past ORIENTATION_INVERTED_MIN_TILT is what classifies as Upside Down
+  if (record.imuReady &&
+      alertMonitors[ALERT_TYPE_ORIENTATION].update(record.tilt, -HUGE_VALF, ORIENTATION_INVERTED_MIN_TILT,
+                                                   at, alertLimiter, event)) {
+    writeAlert(ALERT_TYPE_ORIENTATION, event);
+    changed = true;
+  }
+
+  // ========== DROP ALERTS ==========
+  DropEvent drop;
+  while (sensors.popDropEvent(drop)) {  // SPSC queue, the sensor task is the producer
+    // Momentary: one alert per drop, tumbling down stairs counts once
+    if (!alertMonitors[ALERT_TYPE_DROP].pulse(drop.peakG, DROP_IMPACT_G, at, alertLimiter, event)) {
+      continue;
+    }
+    changed = true;
+    
+    // Dated to the IMU sample that completed the impact
+    unsigned long long timestampMillis = sampleTimestamp(drop.atUs);
+    char timestampBuffer[20];
+    sprintf(timestampBuffer, "%llu", timestampMillis);
+    char impactAxis[3] = { drop.impactSign > 0 ? '+' : '-', drop.impactAxis, '\0' };
+    char *key = alertKeys[ALERT_TYPE_DROP];
+    uploadBatch->generateKey(timestampMillis, key);
+    
+    JsonDocument alertDoc(&jsonArena);
+    alertDoc["type"] = "drop";
+    alertDoc["severity"] = "critical";
+    alertDoc["message"] = "Drop detected - package fell and hit a surface";
+    alertDoc["value"] = round(drop.peakG * 100) / 100.0;
+    alertDoc["peakG"] = round(drop.peakG * 100) / 100.0;
+    alertDoc["impactDurationMs"] = round(drop.impactDurationMs);
+    alertDoc["freeFallMs"] = round(drop.freeFallMs);
+    alertDoc["dropHeightM"] = round(drop.dropHeightM * 100) / 100.0;
+    alertDoc["impactAxis"] = impactAxis;
+    alertDoc["timestamp"] = timestampBuffer;
+    if (!ntpTime.isSynced()) {
+      alertDoc["timeSynced"] = false;  // Uptime ms, not epoch
+    }
     alertDoc["resolved"] = false;
     
-    String alertJson;
-    serializeJson(alertDoc, alertJson);
-    firebasePost(alertsPath, alertJson);
-
-    if (firebasePost(alertsPath, alertJson)) {
+    if (queueAlert(key, alertDoc, timestampMillis)) {
       #if ENABLE_DEBUG_LOGS
-      Serial.printf("[ALERTS] 🚨 Vibration alert sent: %.2f m/s² (threshold: %.2f m/s²)\n", 
-                    mpu.getTotalAcceleration(), vibThreshold);
+      Serial.printf("[ALERTS] 🚨 Drop alert queued: %.1f g from ~%.2f m\n", 
+                    drop.peakG, drop.dropHeightM);
       #endif
     }
   }
+  
+  return changed;
+}
 
-  // ========== ORIENTATION ALERTS ==========
-  if (mpu.isConnected()) {
-    String orientation = mpu.detectOrientation();
-    
-    if (orientation == "Upside Down" || orientation == "Free Fall") {
-      StaticJsonDocument<JSON_SMALL_BUFFER_SIZE> alertDoc;
-      alertDoc["type"] = "orientation";
-      alertDoc["severity"] = "critical";
-      alertDoc["message"] = "Dangerous orientation detected: " + orientation;
-      alertDoc["value"] = orientation;
-      alertDoc["timestamp"] = timestampBuffer;
-      alertDoc["resolved"] = false;
-      
-      String alertJson;
-      serializeJson(alertDoc, alertJson);
-      firebasePost(alertsPath, alertJson);
-      
-      if (firebasePost(alertsPath, alertJson)) {
-        #if ENABLE_DEBUG_LOGS
-        Serial.printf("[ALERTS] 🚨 Orientation alert sent: %s\n", orientation.c_str());
-        #endif
-      }
+bool alertExcursion() {
+  for (uint8_t t = 0; t < ALERT_TYPE_COUNT; t++) {
+    AlertState state = alertMonitors[t].getState();
+    if (state == ALERT_PENDING || state == ALERT_ACTIVE) {
+      return true;
     }
   }
+  return false;
 }
 
-// ============================================================================
-// FIREBASE REST API HELPERS
-// ============================================================================
-bool firebasePut(const String &path, const String &jsonPayload) {
-  if (String(FIREBASE_DATABASE_URL).length() == 0) return false;
+void writeAlert(AlertType type, const AlertEvent &event) {
+  bool opened = (event.kind == ALERT_EVENT_OPENED);
+  bool high = (event.side == ALERT_HIGH);
   
-  HTTPClient http;
-  String url = String(FIREBASE_DATABASE_URL) + "/" + path + ".json";
+  // ✅ Dated when the reading first left the band, not when the debounce ended
+  unsigned long long startMillis = uptimeTimestamp(event.startMs);
+  char timestampBuffer[20];
+  sprintf(timestampBuffer, "%llu", startMillis);
   
-  if (String(FIREBASE_AUTH_TOKEN).length() > 0) {
-    url += "?auth=" + String(FIREBASE_AUTH_TOKEN);
+  // Opened and resolved write the same alerts/<key> node
+  char *key = alertKeys[type];
+  if (opened) {
+    uploadBatch->generateKey(startMillis, key);
   }
   
-  http.begin(httpsClient, url);
-  http.addHeader("Content-Type", "application/json");
-  http.setTimeout(10000);
+  JsonDocument alertDoc(&jsonArena);
+  const char *unit = "";
+  switch (type) {
+    case ALERT_TYPE_TEMPERATURE:
+      alertDoc["type"] = "temperature";
+      alertDoc["severity"] = high ? "critical" : "warning";
+      alertDoc["message"] = high ? "Temperature exceeded maximum" : "Temperature below minimum";
+      unit = "°C";
+      break;
+    case ALERT_TYPE_HUMIDITY:
+      alertDoc["type"] = "humidity";
+      alertDoc["severity"] = high ? "critical" : "warning";
+      alertDoc["message"] = high ? "Humidity exceeded maximum" : "Humidity below minimum";
+      unit = "%";
+      break;
+    case ALERT_TYPE_VIBRATION:
+      alertDoc["type"] = "vibration";
+      alertDoc["severity"] = "warning";
+      alertDoc["message"] = "Excessive vibration detected - possible rough handling";
+      unit = " m/s²";
+      break;
+    case ALERT_TYPE_ORIENTATION:
+      alertDoc["type"] = "orientation";
+      alertDoc["severity"] = "critical";
+      alertDoc["message"] = "Dangerous orientation detected: Upside Down";
+      alertDoc["orientation"] = orientationName(ORIENTATION_UPSIDE_DOWN);
+      unit = "°";
+      break;
+    default:
+      return;
+  }
   
-  int httpCode = http.PUT(jsonPayload);
-  bool success = (httpCode >= 200 && httpCode < 300);
+  alertDoc["value"] = round(event.openValue * 100) / 100.0;
+  alertDoc["threshold"] = event.threshold;
+  alertDoc["timestamp"] = timestampBuffer;  // ✅ Send as string
+  if (!ntpTime.isSynced()) {
+    alertDoc["timeSynced"] = false;  // Uptime ms, not epoch; a resolve after sync re-dates the node
+  }
+  alertDoc["resolved"] = !opened;
+  if (!opened) {
+    char resolvedBuffer[20];
+    sprintf(resolvedBuffer, "%llu", startMillis + event.durationMs);
+    alertDoc["resolvedAt"] = resolvedBuffer;
+    alertDoc["durationMs"] = event.durationMs;
+    alertDoc["peak"] = round(event.peak * 100) / 100.0;
+  }
   
-  http.end();
-  return success;
+  if (queueAlert(key, alertDoc, startMillis)) {
+    #if ENABLE_DEBUG_LOGS
+    if (opened) {
+      Serial.printf("[ALERTS] 🚨 %s alert opened: %.2f%s (threshold: %.2f%s)\n",
+                    alertDoc["type"].as<const char*>(), event.value, unit, event.threshold, unit);
+    } else {
+      Serial.printf("[ALERTS] ✅ %s alert resolved after %lu s, peak %.2f%s\n",
+                    alertDoc["type"].as<const char*>(), (unsigned long)(event.durationMs / 1000), event.peak, unit);
+    }
+    #endif
+  }
 }
 
-bool firebasePost(const String &path, const String &jsonPayload) {
-  if (String(FIREBASE_DATABASE_URL).length() == 0) return false;
-  
-  HTTPClient http;
-  String url = String(FIREBASE_DATABASE_URL) + "/" + path + ".json";
-  
-  if (String(FIREBASE_AUTH_TOKEN).length() > 0) {
-    url += "?auth=" + String(FIREBASE_AUTH_TOKEN);
+bool queueAlert(const char *key, const JsonDocument &alertDoc, unsigned long long timestampMillis) {
+  char path[8 + PUSH_ID_LENGTH];
+  snprintf(path, sizeof(path), "alerts/%s", key);
+  
+  // Critical alerts flush the batch on the next loop pass
+  bool critical = strcmp(alertDoc["severity"] | "", "critical") == 0 && !(alertDoc["resolved"] | false);
+  if (isUploadOnline() &&
+      setJson(path, alertDoc, critical ? TelemetryBatcher::PRIORITY_URGENT : TelemetryBatcher::PRIORITY_NORMAL)) {
+    return true;
   }
   
-  http.begin(httpsClient, url);
-  http.addHeader("Content-Type", "application/json");
-  http.setTimeout(10000);
-  
-  int httpCode = http.POST(jsonPayload);
-  bool success = (httpCode >= 200 && httpCode < 300);
-  
-  http.end();
-  return success;
+  // Offline: every alert write is kept as one flash record, <key><json>
+  static char payload[FlashRecordLog::MAX_PAYLOAD];
+  memcpy(payload, key, PUSH_ID_LENGTH);
+  size_t length = serializeJson(alertDoc, payload + PUSH_ID_LENGTH, sizeof(payload) - PUSH_ID_LENGTH);
+  if (alertDoc.overflowed() || PUSH_ID_LENGTH + length + 1 >= sizeof(payload)) {
+    return false;  // serializeJson() cuts off silently, never log a truncated node
+  }
+  return recordLog.append(RECORD_ALERT_NODE, timestampMillis, payload, PUSH_ID_LENGTH + length);
 }
 
-bool firebaseGet(const String &path, String &response) {
-  if (String(FIREBASE_DATABASE_URL).length() == 0) return false;
-  
-  HTTPClient http;
-  String url = String(FIREBASE_DATABASE_URL) + "/" + path + ".json";
-  
-  if (String(FIREBASE_AUTH_TOKEN).length() > 0) {
-    url += "?auth=" + String(FIREBASE_AUTH_TOKEN);
+// ArduinoJson writer into space already sized with measureJson()
+struct SpanWriter {
+  char *out;
+  size_t write(uint8_t c) { *out++ = (char)c; return 1; }
+  size_t write(const uint8_t *data, size_t length) { memcpy(out, data, length); out += length; return length; }
+};
+
+bool setJson(const char *path, const JsonDocument &doc, TelemetryBatcher::Priority priority) {
+  // A document that ran out of arena is missing values
+  if (doc.overflowed()) {
+    #if ENABLE_DEBUG_LOGS
+    Serial.printf("[MEMORY] ⚠️ %s dropped, JSON arena full (JSON_ARENA_BYTES)\n", path);
+    #endif
+    return false;
   }
   
-  http.begin(httpsClient, url);
-  http.setTimeout(10000);
-  
-  int httpCode = http.GET();
+  // Measured, then serialized once, in place in the batch queue
+  return uploadBatch->set(path, measureJson(doc), [&doc](char *out) {
+    SpanWriter writer{ out };
+    serializeJson(doc, writer);
+  }, priority);
+}
+
+void replayRecordLog() {
+  if (replayInFlight || recordLog.getPendingCount() == 0 || !isUploadOnline()) return;
+  
+  // Blocks this boot logged before the first sync are re-dated as they are
+  // replayed: the sync gets TIME_SYNC_WAIT_MS after a (re)connect before
+  // they go out on the uptime clock
+  if (uptimeBlocksLogged && !ntpTime.isSynced() && millis() - onlineSince < TIME_SYNC_WAIT_MS) return;
+  
+  static char payload[FlashRecordLog::MAX_PAYLOAD];
+  FlashRecordLog::Record record;
+  uint16_t queued = 0;
+  
+  // Oldest first, stops early if the batch could not take the largest record
+  recordLog.rewind();
+  while (queued < RECORD_LOG_REPLAY_BATCH &&
+         uploadBatch->getPendingBytes() + FlashRecordLog::MAX_PAYLOAD + 64 <= UPLOAD_BATCH_BYTES &&
+         recordLog.next(record, payload, sizeof(payload))) {
+    // Urgent: sent right away, not held back by the age policy
+    if (record.type == RECORD_ALERT_NODE && record.length > PUSH_ID_LENGTH) {
+      char path[8 + PUSH_ID_LENGTH];
+      snprintf(path, sizeof(path), "alerts/%.*s", PUSH_ID_LENGTH, payload);
+      uploadBatch->set(path, payload + PUSH_ID_LENGTH, record.length - PUSH_ID_LENGTH, TelemetryBatcher::PRIORITY_URGENT);
+    } else if (record.type == RECORD_HISTORY_BLOCK_UPTIME) {
+      replayUptimeBlock(record, payload);
+    } else {
+      const char *collection = (record.type == RECORD_ALERT) ? "alerts"
+                             : (record.type == RECORD_HISTORY_BLOCK) ? "historyBlocks" : "history";
+      uploadBatch->push(collection, payload, record.length, record.timestampMs, TelemetryBatcher::PRIORITY_URGENT);
+    }
+    queued++;
+  }
   
-  if (httpCode >= 200 && httpCode < 300) {
-    response = http.getString();
-    http.end();
-    return true;
+  // Only damaged records were read, nothing to wait for
+  if (queued == 0) {
+    recordLog.commit();
+    return;
   }
+  replayInFlight = true;
   
-  http.end();
-  return false;
+  #if ENABLE_DEBUG_LOGS
+  Serial.printf("[LOG] Replaying %u records (%lu pending)\n", queued, (unsigned long)recordLog.getPendingCount());
+  #endif
+}
+
+// A block logged before the first sync, stamped in monotonic ms. The clock
+// restarts with every boot, so only this boot's blocks can be converted;
+// the others keep uptime stamps and say so
+void replayUptimeBlock(const FlashRecordLog::Record &record, const char *payload) {
+  static uint8_t redated[HISTORY_BLOCK_MAX_BYTES + 16];  // Epoch stamps take a few more bytes
+  static char node[FlashRecordLog::MAX_PAYLOAD];
+  
+  uint32_t loggedBoot;
+  if (record.length <= sizeof(loggedBoot)) return;
+  memcpy(&loggedBoot, payload, sizeof(loggedBoot));
+  
+  bool convert = loggedBoot == bootId && ntpTime.isSynced();
+  uint32_t samples = 0;
+  uint64_t from = 0, to = 0;
+  size_t length = HistoryBlockDecoder::retime((const uint8_t *)payload + sizeof(loggedBoot),
+                                              record.length - sizeof(loggedBoot), redated, sizeof(redated),
+                                              [convert](uint64_t ms) { return convert ? ntpTime.toUnixMs(ms * 1000) : ms; },
+                                              samples, from, to);
+  size_t nodeLength = length > 0 ? historyBlockNode(node, sizeof(node), redated, length, samples, from, to, convert) : 0;
+  if (nodeLength > 0) {
+    uploadBatch->push("historyBlocks", node, nodeLength, from, TelemetryBatcher::PRIORITY_URGENT);
+  }
 }
 
 // ============================================================================
-// TIMESTAMP FUNCTION - ✅ CRITICAL FIX APPLIED
+// TIMESTAMPS
 // ============================================================================
-unsigned long long getTimestampMillis() {  // ✅ FIXED: Return 64-bit
-  time_t nowSeconds = time(nullptr);
+// Samples are stamped with the monotonic clock when taken and converted here,
+// at serialization, with the NTP offset and drift in force
+unsigned long long sampleTimestamp(uint64_t monotonicUs) {
+  if (ntpTime.isSynced()) {
+    return ntpTime.toUnixMs(monotonicUs);
+  }
   
-  if (nowSeconds > 1577836800) { // After Jan 1, 2020
-    // ✅ FIXED: Proper 64-bit handling
-    unsigned long long milliseconds = (unsigned long long)nowSeconds * 1000ULL;
-    
-    #if ENABLE_DEBUG_LOGS
-    static unsigned long lastLog = 0;
-    if (millis() - lastLog > 10000) { // Log every 10 seconds
-      Serial.printf("[TIMESTAMP] NTP seconds: %lu\n", (unsigned long)nowSeconds);
-      Serial.printf("[TIMESTAMP] Milliseconds: %llu\n", milliseconds);
-      lastLog = millis();
-    }
-    #endif
-    
-    return milliseconds;  // ✅ Return full 64-bit value
-  } else {
-    #if ENABLE_DEBUG_LOGS
-    static bool warningShown = false;
-    if (!warningShown) {
-      Serial.println("[TIMESTAMP] ⚠️ Using millis() - NTP not synced");
-      warningShown = true;
-    }
-    #endif
-    return (unsigned long long)millis();  // ✅ Cast to match return type
+  // Alerts, current/ and history samples before the first sync (history is re-dated later)
+  #if ENABLE_DEBUG_LOGS
+  static bool warningShown = false;
+  if (!warningShown) {
+    Serial.println("[TIMESTAMP] ⚠️ Using uptime - NTP not synced");
+    warningShown = true;
   }
+  #endif
+  return monotonicUs / 1000;
+}
+
+unsigned long long recordTimestamp(const SensorRecord &record) {
+  // A record may have waited in the queue, date it at capture
+  return sampleTimestamp(record.captureUs);
+}
+
+unsigned long long uptimeTimestamp(uint32_t uptimeMs) {
+  // millis() is the same clock in ms, unwrapped against now
+  uint64_t nowUs = NtpTime::monotonicUs();
+  uint32_t ageMs = (uint32_t)(nowUs / 1000) - uptimeMs;
+  return sampleTimestamp(nowUs - (uint64_t)ageMs * 1000);
 }
 
 // ============================================================================
@@ -901,6 +1456,86 @@ void checkHeapMemory() {
                 ESP.getHeapSize() / 1024);
   #endif
   
+  #if ENABLE_DEBUG_LOGS
+  SensorTask::Stats tasks = sampler.getStats();
+  Serial.printf("[TASKS] %lu records, %lu dropped, queue high-water %lu/%d, longest sensor step %lu ms\n",
+                (unsigned long)tasks.records, (unsigned long)tasks.dropped,
+                (unsigned long)tasks.highWater, SENSOR_RECORD_QUEUE, (unsigned long)tasks.maxStepMs);
+  
+  const FlashRecordLog::Stats &log = recordLog.getStats();
+  Serial.printf("[LOG] %lu pending, %lu logged, %lu replayed, %lu lost, %lu corrupt, max sector erases %lu\n",
+                (unsigned long)recordLog.getPendingCount(), (unsigned long)log.appended,
+                (unsigned long)log.replayed, (unsigned long)log.lost, (unsigned long)log.corrupt,
+                (unsigned long)log.maxSectorErases);
+  
+  const FirebaseClient::Stats &fb = transport.getStats();
+  Serial.printf("[FIREBASE] %lu requests, %lu TLS handshakes, %lu failed, latency avg %lu ms / max %lu ms\n",
+                (unsigned long)fb.requests, (unsigned long)fb.handshakes, (unsigned long)fb.failures,
+                (unsigned long)transport.getAverageLatencyMs(), (unsigned long)fb.maxLatencyMs);
+  if (uploadBatch) {
+    const TelemetryBatcher::Stats &batch = uploadBatch->getStats();
+    Serial.printf("[FIREBASE] %lu writes in %lu batches, %lu failed flushes, %lu dropped\n",
+                  (unsigned long)batch.writes, (unsigned long)batch.flushes,
+                  (unsigned long)batch.failures, (unsigned long)batch.dropped);
+  }
+  
+  uint32_t alertsOpened = 0, alertsResolved = 0, alertsSuppressed = 0;
+  for (uint8_t t = 0; t < ALERT_TYPE_COUNT; t++) {
+    const AlertMonitor::Stats &monitor = alertMonitors[t].getStats();
+    alertsOpened += monitor.opened;
+    alertsResolved += monitor.resolved;
+    alertsSuppressed += monitor.suppressed;
+  }
+  const TelemetryPolicy::Stats &policy = telemetryPolicy.getStats();
+  uint32_t evaluated = policy.sent + policy.suppressed;
+  Serial.printf("[UPLOADS] %lu sent (%lu change, %lu event, %lu active, %lu heartbeat), %lu suppressed (%lu%% saved)\n",
+                (unsigned long)policy.sent, (unsigned long)policy.byReason[TelemetryPolicy::REASON_CHANGE],
+                (unsigned long)policy.byReason[TelemetryPolicy::REASON_EVENT],
+                (unsigned long)policy.byReason[TelemetryPolicy::REASON_ACTIVE],
+                (unsigned long)policy.byReason[TelemetryPolicy::REASON_HEARTBEAT],
+                (unsigned long)policy.suppressed,
+                (unsigned long)(evaluated ? 100ULL * policy.suppressed / evaluated : 0));
+  
+  Serial.printf("[ALERTS] %lu opened, %lu resolved, %lu suppressed (%lu rate limited)\n",
+                (unsigned long)alertsOpened, (unsigned long)alertsResolved,
+                (unsigned long)alertsSuppressed, (unsigned long)alertLimiter.getDenied());
+  
+  if (AllocationCounter::isEnabled()) {
+    Serial.printf("[MEMORY] Heap allocations per cycle (last / max, cycles allocating): "
+                  "sensor step %lu / %lu (%lu of %lu), sample %lu / %lu (%lu of %lu), flush %lu / %lu (%lu of %lu)\n",
+                  (unsigned long)sensorStepAllocations.last, (unsigned long)sensorStepAllocations.max,
+                  (unsigned long)sensorStepAllocations.allocating, (unsigned long)sensorStepAllocations.cycles,
+                  (unsigned long)sampleCycleAllocations.last, (unsigned long)sampleCycleAllocations.max,
+                  (unsigned long)sampleCycleAllocations.allocating, (unsigned long)sampleCycleAllocations.cycles,
+                  (unsigned long)flushAllocations.last, (unsigned long)flushAllocations.max,
+                  (unsigned long)flushAllocations.allocating, (unsigned long)flushAllocations.cycles);
+  }
+  const JsonArena<JSON_ARENA_BYTES>::Stats &arena = jsonArena.getStats();
+  Serial.printf("[MEMORY] JSON arena high-water %lu / %d bytes, %lu failed allocations\n",
+                (unsigned long)arena.highWater, JSON_ARENA_BYTES, (unsigned long)arena.failures);
+  
+  TimeSync::Stats clock = ntpTime.getStats();
+  Serial.printf("[NTP] %s, %lu syncs (%lu steps), last correction %lld us, drift %.2f ppm\n",
+                ntpTime.isSynced() ? "synced" : "not synced", (unsigned long)clock.syncs,
+                (unsigned long)clock.steps, (long long)clock.lastErrorUs, clock.driftPpm);
+  
+  #if TELEMETRY_TRANSPORT == TRANSPORT_MQTT
+  const MqttTransport::Client::Stats &mqtt = transport.getMqttStats();
+  Serial.printf("[MQTT] %s, %lu sessions, %lu published / %lu acked, %lu config messages, %lu oversized\n",
+                transport.isConnected() ? "connected" : "disconnected",
+                (unsigned long)mqtt.connects, (unsigned long)mqtt.published, (unsigned long)mqtt.acked,
+                (unsigned long)transport.getConfigMessages(), (unsigned long)mqtt.oversized);
+  #else
+  const ConfigSubscription &subscription = transport.getSubscription();
+  const ConfigSubscription::Stats &cfg = subscription.getStats();
+  Serial.printf("[CONFIG] %s, %lu events, %lu streams opened, %lu lost, %lu polls (%lu unchanged), %lu oversized\n",
+                subscription.isStreaming() ? "streaming" : "polling",
+                (unsigned long)cfg.events, (unsigned long)cfg.connects, (unsigned long)cfg.drops,
+                (unsigned long)cfg.polls, (unsigned long)cfg.unchanged,
+                (unsigned long)subscription.getOverflows());
+  #endif
+  #endif
+  
   if (freeHeap < MIN_FREE_HEAP) {
     #if ENABLE_DEBUG_LOGS
     Serial.println("[MEMORY] ⚠️ Low memory warning!");
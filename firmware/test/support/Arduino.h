@@ -0,0 +1,118 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * @brief Host (env:native) stand-in for the Arduino core
+ *
+ * Only what the components under test use: String, Serial and the
+ * clock. millis() is a fake clock that only delay() and
+ * hostAdvanceMillis() move, so timeouts run instantly and the same way
+ * every time.
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+inline uint32_t& hostClockMs() {
+    static uint32_t now = 0;
+    return now;
+}
+
+inline void hostAdvanceMillis(uint32_t ms) { hostClockMs() += ms; }
+
+inline uint32_t millis() { return hostClockMs(); }
+inline void delay(uint32_t ms) { hostAdvanceMillis(ms); }
+
+class String {
+public:
+    String(const char* text = "") : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+    explicit String(long number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return (unsigned int)value.size(); }
+    bool reserve(unsigned int size) {
+        value.reserve(size);
+        return true;
+    }
+
+    String& operator+=(const String& other) {
+        value += other.value;
+        return *this;
+    }
+    String& operator+=(const char* text) {
+        value += text;
+        return *this;
+    }
+    String& operator+=(char c) {
+        value += c;
+        return *this;
+    }
+    bool concat(const char* text, unsigned int length) {
+        value.append(text, length);
+        return true;
+    }
+    bool concat(const String& other) {
+        value += other.value;
+        return true;
+    }
+
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+    int indexOf(char c) const { return find(value.find(c)); }
+    int indexOf(const char* text) const { return find(value.find(text)); }
+    String substring(unsigned int from, unsigned int to = 0xFFFFFFFF) const {
+        if (from > value.size()) return String();
+        if (to > value.size()) to = (unsigned int)value.size();
+        return to > from ? String(value.substr(from, to - from)) : String();
+    }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+    void remove(unsigned int index, unsigned int count = 0xFFFFFFFF) {
+        if (index < value.size()) value.erase(index, count);
+    }
+    long toInt() const { return atol(value.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend bool operator==(const String& a, const String& b) { return a.value == b.value; }
+    friend bool operator!=(const String& a, const String& b) { return a.value != b.value; }
+
+private:
+    static int find(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+
+    std::string value;
+};
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void flush() { fflush(stdout); }
+    size_t print(const char* text) { return fputs(text, stdout) >= 0 ? strlen(text) : 0; }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+    size_t println(const String& text) { return println(text.c_str()); }
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include <Arduino.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @brief One in-process connection between a WiFiClientSecure and the test
+ *
+ * sent: bytes the client wrote, not yet taken by the server handler
+ * received: bytes the server queued, read by the client
+ */
+struct FakeSocket {
+    std::string host;
+    uint16_t port = 0;
+    std::string sent;
+    std::string received;
+    bool open = true;
+
+    void reply(const std::string& bytes) { received += bytes; }
+    void close() { open = false; }
+};
+
+/**
+ * @brief Stand-in network the host WiFiClientSecure connects to
+ *
+ * accept decides whether a connect succeeds; serve runs after every
+ * client write and plays the server: it looks at socket.sent (and
+ * erases what it consumed) and queues the response with reply().
+ * Everything runs on the test thread, so a request written is answered
+ * before the client reads.
+ */
+struct FakeNetwork {
+    std::function<bool(const char* host, uint16_t port)> accept;
+    std::function<void(FakeSocket& socket)> serve;
+    uint32_t connects = 0;
+    std::shared_ptr<FakeSocket> last;   // Most recently opened
+
+    void reset() {
+        accept = nullptr;
+        serve = nullptr;
+        connects = 0;
+        last.reset();
+    }
+};
+
+inline FakeNetwork& fakeNetwork() {
+    static FakeNetwork network;
+    return network;
+}
+
+class WiFiClientSecure {
+public:
+    void setInsecure() {}
+
+    int connect(const char* host, uint16_t port) {
+        stop();
+        FakeNetwork& network = fakeNetwork();
+        network.connects++;
+        if (network.accept && !network.accept(host, port)) {
+            return 0;
+        }
+        socket = std::make_shared<FakeSocket>();
+        socket->host = host;
+        socket->port = port;
+        network.last = socket;
+        return 1;
+    }
+    int connect(const char* host, uint16_t port, int32_t timeoutMs) {
+        (void)timeoutMs;
+        return connect(host, port);
+    }
+
+    uint8_t connected() { return socket && socket->open; }
+
+    void stop() {
+        if (socket) {
+            socket->open = false;
+            socket.reset();
+        }
+    }
+
+    size_t write(const uint8_t* data, size_t length) {
+        if (!connected()) {
+            return 0;
+        }
+        socket->sent.append((const char*)data, length);
+        if (fakeNetwork().serve) {
+            fakeNetwork().serve(*socket);
+        }
+        return length;
+    }
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    int available() { return socket ? (int)socket->received.size() : 0; }
+
+    int read() {
+        if (available() <= 0) {
+            return -1;
+        }
+        uint8_t c = socket->received[0];
+        socket->received.erase(0, 1);
+        return c;
+    }
+    int read(uint8_t* buffer, size_t length) {
+        int got = available() < (int)length ? available() : (int)length;
+        if (got <= 0) {
+            return -1;
+        }
+        memcpy(buffer, socket->received.data(), got);
+        socket->received.erase(0, got);
+        return got;
+    }
+
+private:
+    std::shared_ptr<FakeSocket> socket;
+};
+
+#endif // HOST_WIFICLIENTSECURE_H
\ No newline at end of file
@@ -0,0 +1,111 @@
+#ifndef HOST_IMUTRACE_H
+#define HOST_IMUTRACE_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "dht11decode.h"
+#include "imusample.h"
+
+/**
+ * @brief Raw sample trace of one parcel trip, for replay on the host
+ *
+ * Counts are ±8 g / ±500 °/s registers like the device records them.
+ * The trip, in order:
+ * - resting upright (10 s)
+ * - carried: slow sway plus a 12 Hz / 0.3 g road vibration (20 s)
+ * - a drop: free fall, then an impact of about 6 g (at dropAt / impactAt)
+ * - resting upright again (5 s)
+ * - tipped onto its side (10 s)
+ *
+ * Sensor noise comes from a fixed LCG, so every run replays the same
+ * samples on every host.
+ */
+struct ImuTrace {
+    std::vector<ImuRawSample> samples;
+    uint16_t rateHz;
+    size_t dropAt;       // First free fall sample
+    size_t impactAt;     // First impact sample
+};
+
+class TraceNoise {
+public:
+    explicit TraceNoise(uint32_t seed) : state(seed) {}
+
+    // Uniform in [-amplitude, amplitude]
+    int16_t next(int16_t amplitude) {
+        state = state * 1664525u + 1013904223u;
+        return (int16_t)((int32_t)(state >> 16) % (2 * amplitude + 1) - amplitude);
+    }
+
+private:
+    uint32_t state;
+};
+
+inline ImuTrace parcelTripTrace(uint16_t rateHz, float freeFallMs = 350.0f, uint32_t seed = 1) {
+    const float PI_F = 3.14159265f;
+    const int16_t ONE_G = 4096;
+    ImuTrace trace;
+    trace.rateHz = rateHz;
+    TraceNoise noise(seed);
+
+    auto push = [&](float xG, float yG, float zG, int16_t gyro) {
+        ImuRawSample s;
+        s.ax = (int16_t)(lroundf(xG * ONE_G) + noise.next(20));
+        s.ay = (int16_t)(lroundf(yG * ONE_G) + noise.next(20));
+        s.az = (int16_t)(lroundf(zG * ONE_G) + noise.next(20));
+        s.gx = (int16_t)(gyro + noise.next(8));
+        s.gy = (int16_t)(gyro / 2 + noise.next(8));
+        s.gz = noise.next(8);
+        trace.samples.push_back(s);
+    };
+    auto seconds = [&](float s) { return (size_t)(s * rateHz); };
+
+    for (size_t i = 0; i < seconds(10); i++) {
+        push(0, 0, 1, 0);
+    }
+    for (size_t i = 0; i < seconds(20); i++) {
+        float t = (float)i / rateHz;
+        float sway = 0.15f * sinf(2 * PI_F * 0.8f * t);
+        float road = 0.3f * sinf(2 * PI_F * 12.0f * t);
+        push(sway, 0.5f * sway, 1 + road, (int16_t)(400 * sway));
+    }
+
+    trace.dropAt = trace.samples.size();
+    for (size_t i = 0; i < (size_t)(freeFallMs * rateHz / 1000); i++) {
+        push(0.02f, 0.02f, 0.03f, 300);
+    }
+    trace.impactAt = trace.samples.size();
+    for (size_t i = 0; i < seconds(0.03f); i++) {
+        push(1.5f, 1.0f, 5.5f, 2000);
+    }
+
+    for (size_t i = 0; i < seconds(5); i++) {
+        push(0, 0, 1, 0);
+    }
+    for (size_t i = 0; i < seconds(10); i++) {
+        push(1, 0, 0, 0);
+    }
+    return trace;
+}
+
+/**
+ * @brief DHT11 readings to go with a trace, one per second
+ *
+ * A slow warm-up (22 → 26 °C) with humidity around 45 %, in the 1 °C /
+ * 1 % steps a DHT11 reports.
+ */
+inline std::vector<DhtReading> parcelTripClimate(size_t seconds) {
+    std::vector<DhtReading> readings;
+    for (size_t i = 0; i < seconds; i++) {
+        DhtReading r;
+        r.temperature = floorf(22.0f + 4.0f * i / (seconds > 1 ? seconds - 1 : 1));
+        r.humidity = (float)(45 + (int)(i / 7) % 3 - 1);
+        readings.push_back(r);
+    }
+    return readings;
+}
+
+#endif // HOST_IMUTRACE_H
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef HOST_TRIPREPLAY_H
+#define HOST_TRIPREPLAY_H
+
+#include <memory>
+#include <vector>
+
+#include "config.h"
+#include "imutrace.h"
+#include "replaysensors.h"
+#include "sensorpipeline.h"
+#include "sensortask.h"
+
+typedef SensorPipeline<ReplayImu, ReplayEnv, ReplayPlatform, VIBRATION_FFT_SIZE> ReplayPipeline;
+
+/**
+ * @brief The pipeline configuration setupSensors() uses on the device
+ */
+inline ReplayPipeline::Config deviceSensorConfig() {
+    static const float bands[] = VIBRATION_BAND_EDGES_HZ;
+    return ReplayPipeline::Config{
+        { DROP_FREE_FALL_G, DROP_MIN_FREE_FALL_MS, DROP_IMPACT_G, DROP_IMPACT_END_G, DROP_IMPACT_WINDOW_MS },
+        ORIENTATION_FUSION_BETA, ORIENTATION_UPRIGHT_MAX_TILT, ORIENTATION_INVERTED_MIN_TILT,
+        bands, sizeof(bands) / sizeof(bands[0]),
+        1
+    };
+}
+
+/**
+ * @brief A drop event as the network task took it off the pipeline
+ */
+struct ReplayDrop {
+    DropEvent event;
+    uint32_t takenMs;    // Simulated millis() of the step it was popped after
+};
+
+/**
+ * @brief SensorRecords of a trip, as the network task would pop them
+ *
+ * The trace goes through the device pipeline and SensorProducer with
+ * the device intervals, one sensor task step every 10 ms of simulated
+ * time. Drop events are popped after every step into drops, if given.
+ */
+inline std::vector<SensorRecord> replayTrip(const ImuTrace& trace, const std::vector<DhtReading>& climate,
+                                            std::vector<ReplayDrop>* drops = nullptr) {
+    const uint32_t STEP_MS = 10;
+    ReplayImu imu(trace.samples.data(), trace.samples.size(), trace.rateHz, trace.rateHz * STEP_MS / 1000);
+    ReplayEnv env(climate.data(), climate.size());
+    std::unique_ptr<ReplayPipeline> pipeline(new ReplayPipeline(imu, env));   // FFT buffers, off the stack
+    pipeline->begin(deviceSensorConfig());
+
+    ReplayPlatform::now() = 1000;
+    SensorProducer<ReplayPipeline, ReplayPlatform, 8> producer(
+        *pipeline, { SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, VIBRATION_THRESHOLD });
+
+    std::vector<SensorRecord> records;
+    SensorRecord record;
+    while (!imu.finished()) {
+        ReplayPlatform::now() += STEP_MS;
+        producer.step();
+        while (producer.popRecord(record)) {
+            records.push_back(record);
+        }
+        ReplayDrop drop;
+        while (drops && pipeline->popDropEvent(drop.event)) {
+            drop.takenMs = ReplayPlatform::now();
+            drops->push_back(drop);
+        }
+    }
+    return records;
+}
+
+#endif // HOST_TRIPREPLAY_H
\ No newline at end of file
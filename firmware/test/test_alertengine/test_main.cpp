@@ -0,0 +1,356 @@
+// Alert engine and window stats: Welford summaries against a
+// two-pass reference and merged across windows, and the normal -> pending -> active -> resolved
+// machine on synthetic sensor streams - one opened and one resolved write
+// per excursion, debounce, hysteresis, cooldown and the shared rate limit.
+#include <unity.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+#include "config.h"
+#include "alertengine.h"
+#include "windowstats.h"
+
+namespace {
+
+const uint32_t STEP_MS = SENSOR_UPLOAD_INTERVAL;  // One record per upload interval
+
+const AlertRule TEMPERATURE_RULE = { ALERT_ENV_DEBOUNCE_MS, ALERT_ENV_CLEAR_MS, ALERT_TEMP_HYSTERESIS, ALERT_COOLDOWN_MS };
+const AlertRule HUMIDITY_RULE = { ALERT_ENV_DEBOUNCE_MS, ALERT_ENV_CLEAR_MS, ALERT_HUMIDITY_HYSTERESIS, ALERT_COOLDOWN_MS };
+const AlertRule VIBRATION_RULE = { ALERT_VIBRATION_DEBOUNCE_MS, ALERT_VIBRATION_CLEAR_MS, ALERT_VIBRATION_HYSTERESIS,
+                                   ALERT_COOLDOWN_MS };
+
+// Small deterministic noise in [-1, 1)
+struct Noise {
+    uint32_t state;
+    explicit Noise(uint32_t seed) : state(seed) {}
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / (1u << 23) - 1.0f;
+    }
+};
+
+/**
+ * One alert type as checkAndUploadAlerts drives it: a reading per
+ * STEP_MS against fixed limits, every write kept.
+ */
+struct Stream {
+    AlertMonitor monitor;
+    AlertRateLimiter& limiter;
+    float low, high;
+    uint32_t now;
+    std::vector<AlertEvent> writes;
+
+    Stream(const AlertRule& rule, AlertRateLimiter& limiter, float low, float high)
+        : monitor(rule), limiter(limiter), low(low), high(high), now(0) {}
+
+    void feed(float value) {
+        AlertEvent event;
+        if (monitor.update(value, low, high, now, limiter, event)) {
+            writes.push_back(event);
+        }
+        now += STEP_MS;
+    }
+
+    void hold(float value, uint32_t ms, Noise* noise = nullptr, float spread = 0) {
+        for (uint32_t end = now + ms; now < end;) {
+            feed(noise ? value + spread * noise->next() : value);
+        }
+    }
+};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_running_stats_match_two_pass() {
+    // An upload window of raw |a| counts: 1 g at 4096 LSB/g plus vibration
+    const size_t COUNT = 100000;
+    std::vector<float> values(COUNT);
+    Noise noise(7);
+    for (size_t i = 0; i < COUNT; i++) {
+        values[i] = 4096 + 300 * sinf(i * 0.5f) + 40 * noise.next();
+    }
+
+    RunningStats stats;
+    double sum = 0;
+    float lowest = values[0], highest = values[0];
+    for (float v : values) {
+        stats.add(v);
+        sum += v;
+        lowest = v < lowest ? v : lowest;
+        highest = v > highest ? v : highest;
+    }
+    double mean = sum / COUNT, m2 = 0;
+    for (float v : values) m2 += (v - mean) * (v - mean);
+
+    TEST_ASSERT_EQUAL_UINT32(COUNT, stats.getCount());
+    TEST_ASSERT_EQUAL_FLOAT(lowest, stats.getMin());
+    TEST_ASSERT_EQUAL_FLOAT(highest, stats.getMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, (float)mean, stats.getMean());
+    TEST_ASSERT_FLOAT_WITHIN(sqrt(m2 / COUNT) * 1e-3, (float)sqrt(m2 / COUNT), stats.getStdDev());
+
+    // A single value has no spread; reset starts over
+    stats.reset();
+    stats.add(-3.5f);
+    TEST_ASSERT_EQUAL_FLOAT(-3.5f, stats.getMin());
+    TEST_ASSERT_EQUAL_FLOAT(-3.5f, stats.getMax());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.getStdDev());
+}
+
+void test_window_stats_channels_are_independent() {
+    WindowStats window;
+    for (int i = 0; i < 10; i++) {
+        window.add(STAT_TEMPERATURE, 20 + i);
+        window.add(STAT_ACCEL_MAGNITUDE, 9.81f);
+    }
+    window.add(STAT_HUMIDITY, 55);
+
+    TEST_ASSERT_EQUAL_UINT32(10, window.get(STAT_TEMPERATURE).getCount());
+    TEST_ASSERT_EQUAL_FLOAT(24.5f, window.get(STAT_TEMPERATURE).getMean());
+    TEST_ASSERT_EQUAL_UINT32(1, window.get(STAT_HUMIDITY).getCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, window.get(STAT_ACCEL_MAGNITUDE).getStdDev());
+    TEST_ASSERT_EQUAL_UINT32(0, window.get(STAT_GYRO_X).getCount());
+    TEST_ASSERT_EQUAL_STRING("accelMagnitude", statChannelName(STAT_ACCEL_MAGNITUDE));
+
+    window.reset();
+    for (uint8_t c = 0; c < STAT_CHANNEL_COUNT; c++) {
+        TEST_ASSERT_EQUAL_UINT32(0, window.get((StatChannel)c).getCount());
+    }
+}
+
+void test_merged_windows_match_one_window() {
+    // Upload windows the policy suppressed, folded into the next one sent
+    Noise noise(11);
+    RunningStats whole;
+    WindowStats merged;
+    const size_t sizes[] = { 1000, 1, 0, 250, 1000 };
+    for (size_t w = 0; w < 5; w++) {
+        WindowStats window;
+        for (size_t i = 0; i < sizes[w]; i++) {
+            float value = 4096 + 150 * w + 80 * noise.next();
+            window.add(STAT_ACCEL_MAGNITUDE, value);
+            whole.add(value);
+        }
+        merged.merge(window);
+    }
+
+    const RunningStats& stats = merged.get(STAT_ACCEL_MAGNITUDE);
+    TEST_ASSERT_EQUAL_UINT32(whole.getCount(), stats.getCount());
+    TEST_ASSERT_EQUAL_FLOAT(whole.getMin(), stats.getMin());
+    TEST_ASSERT_EQUAL_FLOAT(whole.getMax(), stats.getMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, whole.getMean(), stats.getMean());
+    TEST_ASSERT_FLOAT_WITHIN(whole.getStdDev() * 1e-3f, whole.getStdDev(), stats.getStdDev());
+    TEST_ASSERT_EQUAL_UINT32(0, merged.get(STAT_TEMPERATURE).getCount());
+
+    // Merging into an empty summary copies it
+    RunningStats empty;
+    empty.merge(stats);
+    TEST_ASSERT_EQUAL_UINT32(stats.getCount(), empty.getCount());
+    TEST_ASSERT_EQUAL_FLOAT(stats.getStdDev(), empty.getStdDev());
+}
+
+void test_excursion_is_one_opened_and_one_resolved_write() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    Stream temperature(TEMPERATURE_RULE, limiter, TEMP_MIN_THRESHOLD, TEMP_MAX_THRESHOLD);
+    Noise noise(1);
+
+    // A parcel left in the sun for ten minutes, peaking at 44 °C
+    temperature.hold(22, 5 * 60000UL, &noise, 0.4f);
+    uint32_t outAt = temperature.now;
+    temperature.hold(42, 4 * 60000UL, &noise, 0.8f);
+    temperature.hold(44, 2 * 60000UL);
+    temperature.hold(42, 4 * 60000UL, &noise, 0.8f);
+    uint32_t backAt = temperature.now;
+    temperature.hold(22, 10 * 60000UL, &noise, 0.4f);
+
+    // 300 readings out of range, two writes
+    TEST_ASSERT_EQUAL_UINT32(2, temperature.writes.size());
+    const AlertEvent& opened = temperature.writes[0];
+    TEST_ASSERT_EQUAL(ALERT_EVENT_OPENED, opened.kind);
+    TEST_ASSERT_EQUAL(ALERT_HIGH, opened.side);
+    TEST_ASSERT_EQUAL_UINT32(outAt, opened.startMs);
+    TEST_ASSERT_EQUAL_FLOAT(TEMP_MAX_THRESHOLD, opened.threshold);
+    TEST_ASSERT_GREATER_THAN(TEMP_MAX_THRESHOLD, opened.openValue);
+
+    const AlertEvent& resolved = temperature.writes[1];
+    TEST_ASSERT_EQUAL(ALERT_EVENT_RESOLVED, resolved.kind);
+    TEST_ASSERT_EQUAL_UINT32(outAt, resolved.startMs);
+    TEST_ASSERT_EQUAL_UINT32(backAt - outAt, resolved.durationMs);
+    TEST_ASSERT_EQUAL_FLOAT(44.0f, resolved.peak);
+    TEST_ASSERT_EQUAL_FLOAT(opened.openValue, resolved.openValue);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, temperature.monitor.getState());  // Cooled down since
+
+    const AlertMonitor::Stats& stats = temperature.monitor.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.opened);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.resolved);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.suppressed);
+}
+
+void test_debounce_ignores_short_excursions() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    Stream temperature(TEMPERATURE_RULE, limiter, TEMP_MIN_THRESHOLD, TEMP_MAX_THRESHOLD);
+
+    // A door opened next to a heater: out of range just under the debounce, twenty times
+    for (int i = 0; i < 20; i++) {
+        temperature.hold(25, 60000UL);
+        temperature.hold(41, ALERT_ENV_DEBOUNCE_MS - STEP_MS);
+        TEST_ASSERT_EQUAL(ALERT_PENDING, temperature.monitor.getState());
+    }
+    temperature.feed(25);
+    TEST_ASSERT_EQUAL(ALERT_NORMAL, temperature.monitor.getState());
+    TEST_ASSERT_EQUAL_UINT32(0, temperature.writes.size());
+
+    // Out of range for the whole debounce and it opens, dated to the first reading
+    uint32_t outAt = temperature.now;
+    temperature.hold(41, ALERT_ENV_DEBOUNCE_MS + STEP_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, temperature.writes.size());
+    TEST_ASSERT_EQUAL_UINT32(outAt, temperature.writes[0].startMs);
+    TEST_ASSERT_TRUE(temperature.monitor.isActive());
+}
+
+void test_hysteresis_stops_flapping_on_the_limit() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    Stream temperature(TEMPERATURE_RULE, limiter, TEMP_MIN_THRESHOLD, TEMP_MAX_THRESHOLD);
+    temperature.hold(41, ALERT_ENV_DEBOUNCE_MS + STEP_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, temperature.writes.size());
+
+    // Hovering either side of 40 °C, never a full degree inside
+    for (int i = 0; i < 300; i++) {
+        temperature.feed(i % 2 ? 39.5f : 40.5f);
+    }
+    // Inside the margin, but not for long enough
+    temperature.hold(38, ALERT_ENV_CLEAR_MS - STEP_MS);
+    temperature.feed(40.5f);
+    temperature.hold(38.5f, ALERT_ENV_CLEAR_MS - STEP_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, temperature.writes.size());
+    TEST_ASSERT_TRUE(temperature.monitor.isActive());
+
+    // NaN (sensor not ready) neither extends nor breaks the clear time
+    temperature.feed(NAN);
+    temperature.feed(38.5f);
+    TEST_ASSERT_EQUAL_UINT32(2, temperature.writes.size());
+    TEST_ASSERT_EQUAL(ALERT_EVENT_RESOLVED, temperature.writes[1].kind);
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, temperature.writes[1].peak);
+}
+
+void test_low_side_tracks_the_minimum() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    Stream humidity(HUMIDITY_RULE, limiter, HUMIDITY_MIN_THRESHOLD, HUMIDITY_MAX_THRESHOLD);
+
+    humidity.hold(45, 60000UL);
+    humidity.hold(18, 60000UL);
+    humidity.hold(12, 30000UL);
+    humidity.hold(19, 60000UL);
+    humidity.hold(22, 60000UL);  // Inside the limit, not by the 3 % margin
+    TEST_ASSERT_EQUAL_UINT32(1, humidity.writes.size());
+    humidity.hold(24, 60000UL);
+
+    TEST_ASSERT_EQUAL_UINT32(2, humidity.writes.size());
+    TEST_ASSERT_EQUAL(ALERT_LOW, humidity.writes[0].side);
+    TEST_ASSERT_EQUAL_FLOAT(HUMIDITY_MIN_THRESHOLD, humidity.writes[0].threshold);
+    TEST_ASSERT_EQUAL(ALERT_LOW, humidity.writes[1].side);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, humidity.writes[1].peak);
+    TEST_ASSERT_EQUAL_UINT32(3 * 60000UL + 30000UL, humidity.writes[1].durationMs);
+}
+
+void test_cooldown_holds_back_the_next_alert() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    Stream vibration(VIBRATION_RULE, limiter, -HUGE_VALF, VIBRATION_THRESHOLD);
+
+    // Rough handling opens at once, then clears
+    vibration.hold(25, 20000UL);
+    vibration.hold(2, ALERT_VIBRATION_CLEAR_MS + STEP_MS);
+    TEST_ASSERT_EQUAL_UINT32(2, vibration.writes.size());
+    uint32_t resolvedAt = vibration.now - STEP_MS;
+
+    // Thrown about again straight away: quiet until the cooldown is over
+    while (vibration.now - resolvedAt < ALERT_COOLDOWN_MS) {
+        vibration.feed(30);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, vibration.writes.size());
+    TEST_ASSERT_EQUAL(ALERT_RESOLVED, vibration.monitor.getState());
+
+    vibration.feed(30);
+    TEST_ASSERT_EQUAL_UINT32(3, vibration.writes.size());
+    TEST_ASSERT_EQUAL(ALERT_EVENT_OPENED, vibration.writes[2].kind);
+    TEST_ASSERT_EQUAL_UINT32(resolvedAt + ALERT_COOLDOWN_MS, vibration.writes[2].startMs);
+}
+
+void test_rate_limit_is_shared_and_silences_whole_excursions() {
+    // More alert types than the burst, all tripping in the same record
+    const int TYPES = ALERT_RATE_BURST + 3;
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    std::vector<Stream> streams(TYPES, Stream(VIBRATION_RULE, limiter, -HUGE_VALF, VIBRATION_THRESHOLD));
+
+    for (Stream& stream : streams) stream.feed(20);
+    for (Stream& stream : streams) stream.hold(1, ALERT_VIBRATION_CLEAR_MS + STEP_MS);
+
+    int written = 0, silent = 0;
+    for (Stream& stream : streams) {
+        TEST_ASSERT_EQUAL(ALERT_RESOLVED, stream.monitor.getState());
+        if (stream.writes.empty()) {
+            silent++;
+            TEST_ASSERT_EQUAL_UINT32(1, stream.monitor.getStats().suppressed);
+        } else {
+            // Never an orphan: an opened write always gets its resolved write
+            TEST_ASSERT_EQUAL_UINT32(2, stream.writes.size());
+            written++;
+        }
+    }
+    TEST_ASSERT_EQUAL(ALERT_RATE_BURST, written);
+    TEST_ASSERT_EQUAL(3, silent);
+    TEST_ASSERT_EQUAL_UINT32(3, limiter.getDenied());
+
+    // One more token per refill period
+    Stream late(VIBRATION_RULE, limiter, -HUGE_VALF, VIBRATION_THRESHOLD);
+    late.now = ALERT_RATE_REFILL_MS - STEP_MS;
+    late.feed(20);
+    TEST_ASSERT_EQUAL_UINT32(0, late.writes.size());
+    Stream later(VIBRATION_RULE, limiter, -HUGE_VALF, VIBRATION_THRESHOLD);
+    later.now = ALERT_RATE_REFILL_MS;
+    later.feed(20);
+    TEST_ASSERT_EQUAL_UINT32(1, later.writes.size());
+}
+
+void test_drops_close_together_are_one_alert() {
+    AlertRateLimiter limiter(ALERT_RATE_BURST, ALERT_RATE_REFILL_MS);
+    AlertMonitor drops(AlertRule{ 0, 0, 0, ALERT_DROP_COOLDOWN_MS });
+    AlertEvent event;
+
+    // Tumbling down a flight of stairs: an impact every 800 ms
+    int written = 0;
+    uint32_t at = 1000;
+    for (int i = 0; i < 8; i++, at += 800) {
+        if (drops.pulse(3.0f + i, 2.5f, at, limiter, event)) {
+            written++;
+            TEST_ASSERT_EQUAL(ALERT_EVENT_OPENED, event.kind);
+            TEST_ASSERT_EQUAL_FLOAT(3.0f, event.peak);
+            TEST_ASSERT_EQUAL_UINT32(1000, event.startMs);
+        }
+    }
+    TEST_ASSERT_EQUAL(1, written);
+    TEST_ASSERT_EQUAL_UINT32(7, drops.getStats().suppressed);
+
+    // The next drop after the cooldown is its own alert
+    TEST_ASSERT_TRUE(drops.pulse(4.0f, 2.5f, 1000 + ALERT_DROP_COOLDOWN_MS, limiter, event));
+    TEST_ASSERT_EQUAL_UINT32(2, drops.getStats().opened);
+    TEST_ASSERT_EQUAL_UINT32(0, drops.getStats().resolved);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_running_stats_match_two_pass);
+    RUN_TEST(test_window_stats_channels_are_independent);
+    RUN_TEST(test_merged_windows_match_one_window);
+    RUN_TEST(test_excursion_is_one_opened_and_one_resolved_write);
+    RUN_TEST(test_debounce_ignores_short_excursions);
+    RUN_TEST(test_hysteresis_stops_flapping_on_the_limit);
+    RUN_TEST(test_low_side_tracks_the_minimum);
+    RUN_TEST(test_cooldown_holds_back_the_next_alert);
+    RUN_TEST(test_rate_limit_is_shared_and_silences_whole_excursions);
+    RUN_TEST(test_drops_close_together_are_one_alert);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+// Config stream: SseParser on split input, and ConfigSubscription
+// against the fake network: chunked put / patch events, keep-alive, drop,
+// poll fallback and reconnect.
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "configsubscription.cpp"
+#include "firebaseclient.cpp"
+
+namespace {
+
+struct Recorder {
+    std::vector<std::string> events;
+    std::vector<std::string> data;
+
+    void onEvent(const char* event, const char* payload, size_t length) {
+        events.push_back(event);
+        data.push_back(std::string(payload, length));
+    }
+};
+
+const AlertThresholds DEFAULTS = { 5.0f, 40.0f, 20.0f, 80.0f, 15.0f };
+
+const char STREAM_HEAD[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n\r\n";
+
+std::string chunk(const std::string& body) {
+    char size[16];
+    snprintf(size, sizeof(size), "%zx\r\n", body.size());
+    return size + body + "\r\n";
+}
+
+std::string event(const char* name, const std::string& data) {
+    return std::string("event: ") + name + "\ndata: " + data + "\n\n";
+}
+
+/**
+ * Plays the database: answers stream requests with streamHead (and keeps
+ * the socket in stream), or 401 while streamRefused; polls with
+ * pollResponse.
+ */
+struct FakeDatabase {
+    std::shared_ptr<FakeSocket> stream;
+    std::string streamHead = STREAM_HEAD;
+    bool streamRefused = false;
+    std::string pollResponse = "HTTP/1.1 200 OK\r\nETag: e1\r\nContent-Length: 4\r\n\r\nnull";
+    std::vector<std::string> streamHosts;
+    uint32_t polls = 0;
+
+    void serve(FakeSocket& socket) {
+        size_t end = socket.sent.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            return;
+        }
+        std::string request = socket.sent.substr(0, end + 4);
+        socket.sent.erase(0, end + 4);
+
+        if (request.find("Accept: text/event-stream") != std::string::npos) {
+            stream = fakeNetwork().last;
+            streamHosts.push_back(socket.host);
+            socket.reply(streamRefused ? "HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\n\r\n" : streamHead);
+        } else {
+            polls++;
+            socket.reply(pollResponse);
+        }
+    }
+};
+
+FakeDatabase* database = nullptr;
+
+void pushStream(const std::string& bytes) {
+    TEST_ASSERT_NOT_NULL(database->stream.get());
+    database->stream->reply(bytes);
+}
+
+}  // namespace
+
+void setUp() {
+    fakeNetwork().reset();
+    database = new FakeDatabase();
+    fakeNetwork().serve = [](FakeSocket& socket) { database->serve(socket); };
+}
+
+void tearDown() {
+    fakeNetwork().reset();
+    delete database;
+    database = nullptr;
+}
+
+void test_parser_any_split() {
+    std::string input = event("put", "{\"path\":\"/\",\"data\":1}") + ":comment\r\n" +
+                        "event: keep-alive\r\ndata: null\r\n\r\n" + "event:patch\rdata:a\rdata:b\r\r";
+
+    for (size_t split = 1; split <= input.size(); split++) {
+        SseParser<64> parser;
+        Recorder recorder;
+        for (size_t at = 0; at < input.size(); at += split) {
+            size_t n = input.size() - at < split ? input.size() - at : split;
+            parser.feed(input.data() + at, n, recorder);
+        }
+        TEST_ASSERT_EQUAL(3, recorder.events.size());
+        TEST_ASSERT_EQUAL_STRING("put", recorder.events[0].c_str());
+        TEST_ASSERT_EQUAL_STRING("{\"path\":\"/\",\"data\":1}", recorder.data[0].c_str());
+        TEST_ASSERT_EQUAL_STRING("keep-alive", recorder.events[1].c_str());
+        TEST_ASSERT_EQUAL_STRING("a\nb", recorder.data[2].c_str());
+    }
+}
+
+void test_parser_drops_oversized_event() {
+    SseParser<16> parser;
+    Recorder recorder;
+    std::string input = event("put", std::string(40, 'x')) + event("put", "ok");
+    parser.feed(input.data(), input.size(), recorder);
+
+    TEST_ASSERT_EQUAL(1, recorder.events.size());
+    TEST_ASSERT_EQUAL_STRING("ok", recorder.data[0].c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, parser.getOverflows());
+}
+
+void test_stream_applies_put_and_patch_split_across_chunks() {
+    FirebaseClient firebase("db.example", "");
+    DeviceConfig config(DEFAULTS);
+    ConfigSubscription subscription(firebase, config);
+    subscription.begin("dev/config");
+
+    subscription.service();   // Connect, request sent
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    subscription.service();   // Head read
+    TEST_ASSERT_TRUE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(0, database->polls);
+
+    // Snapshot of config/ split in the middle of the event and of a chunk
+    std::string snapshot =
+        event("put", "{\"path\":\"/\",\"data\":{\"assignedParcelId\":\"P7\",\"thresholds\":{\"vibration\":9.5}}}");
+    pushStream(chunk(snapshot.substr(0, 20)));
+    std::string second = chunk(snapshot.substr(20));
+    pushStream(second.substr(0, 5));
+    subscription.service();
+    TEST_ASSERT_FALSE(config.isAssigned());
+    pushStream(second.substr(5));
+    subscription.service();
+
+    TEST_ASSERT_EQUAL_STRING("P7", config.getAssignedParcelId());
+    TEST_ASSERT_EQUAL_FLOAT(9.5f, config.getThresholds().vibration);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, config.getThresholds().temperatureMax);
+
+    // Patch touches only its children; a put deep in the tree replaces that leaf
+    pushStream(chunk(event("patch", "{\"path\":\"/thresholds\",\"data\":{\"temperature/max\":30}}")));
+    pushStream(chunk(event("keep-alive", "null")));
+    pushStream(chunk(event("put", "{\"path\":\"/assignedParcelId\",\"data\":null}")));
+    subscription.service();
+
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, config.getThresholds().temperatureMax);
+    TEST_ASSERT_EQUAL_FLOAT(9.5f, config.getThresholds().vibration);
+    TEST_ASSERT_FALSE(config.isAssigned());
+    TEST_ASSERT_EQUAL_UINT32(3, subscription.getStats().events);
+}
+
+void test_keep_alive_holds_stream_silence_drops_it() {
+    FirebaseClient firebase("db.example", "");
+    DeviceConfig config(DEFAULTS);
+    ConfigSubscription subscription(firebase, config);
+    subscription.begin("dev/config");
+    subscription.service();
+    subscription.service();
+    TEST_ASSERT_TRUE(subscription.isStreaming());
+
+    for (int i = 0; i < 4; i++) {
+        hostAdvanceMillis(30000);
+        pushStream(chunk(event("keep-alive", "null")));
+        subscription.service();
+        TEST_ASSERT_TRUE(subscription.isStreaming());
+    }
+
+    // Silent past the keep-alive interval: dropped; while the stream
+    // cannot be reopened, config/ is polled instead
+    hostAdvanceMillis(CONFIG_STREAM_TIMEOUT_MS);
+    subscription.service();
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(1, subscription.getStats().drops);
+
+    database->streamRefused = true;
+    subscription.service();   // Reopen attempt
+    subscription.service();   // Refused
+    subscription.service();
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(1, database->polls);
+
+    // Stream retried after CONFIG_STREAM_RETRY_MS, and its snapshot applied
+    database->streamRefused = false;
+    hostAdvanceMillis(CONFIG_STREAM_RETRY_MS);
+    subscription.service();
+    subscription.service();
+    TEST_ASSERT_TRUE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(2, subscription.getStats().connects);
+
+    pushStream(chunk(event("put", "{\"path\":\"/\",\"data\":{\"thresholds\":{\"humidity\":{\"max\":70}}}}")));
+    subscription.service();
+    TEST_ASSERT_EQUAL_FLOAT(70.0f, config.getThresholds().humidityMax);
+}
+
+void test_closed_or_cancelled_stream_falls_back_to_poll() {
+    FirebaseClient firebase("db.example", "");
+    DeviceConfig config(DEFAULTS);
+    ConfigSubscription subscription(firebase, config);
+    subscription.begin("dev/config");
+    subscription.service();
+    subscription.service();
+
+    pushStream(chunk(event("cancel", "null")));
+    subscription.service();
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(1, subscription.getStats().drops);
+
+    // Poll: full value first, then 304 (not parsed again)
+    database->pollResponse =
+        "HTTP/1.1 200 OK\r\nETag: e1\r\nContent-Length: 25\r\n\r\n{\"assignedParcelId\":\"P9\"}";
+    hostAdvanceMillis(CONFIG_POLL_INTERVAL);
+    subscription.service();
+    TEST_ASSERT_EQUAL_STRING("P9", config.getAssignedParcelId());
+
+    database->pollResponse = "HTTP/1.1 304 Not Modified\r\n\r\n";
+    hostAdvanceMillis(CONFIG_POLL_INTERVAL);
+    subscription.service();
+    TEST_ASSERT_EQUAL_UINT32(2, subscription.getStats().polls);
+    TEST_ASSERT_EQUAL_UINT32(1, subscription.getStats().unchanged);
+
+    // Server closing the stream counts as a drop too
+    hostAdvanceMillis(CONFIG_STREAM_RETRY_MS);
+    subscription.service();
+    subscription.service();
+    TEST_ASSERT_TRUE(subscription.isStreaming());
+    database->stream->close();
+    subscription.service();
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL_UINT32(2, subscription.getStats().drops);
+}
+
+void test_head_read_across_calls_with_redirect() {
+    FirebaseClient firebase("db.example", "");
+    DeviceConfig config(DEFAULTS);
+    ConfigSubscription subscription(firebase, config);
+
+    database->streamHead = "";
+    subscription.begin("dev/config");
+    subscription.service();
+
+    // Head trickles in: nothing is waited for in between
+    std::string redirect = "HTTP/1.1 307 Temporary Redirect\r\nLocation: https://shard.example/dev/config.json\r\n\r\n";
+    for (size_t i = 0; i < redirect.size(); i += 7) {
+        database->streamHead = STREAM_HEAD;   // For the redirected request
+        pushStream(redirect.substr(i, 7));
+        subscription.service();
+    }
+    subscription.service();
+
+    TEST_ASSERT_TRUE(subscription.isStreaming());
+    TEST_ASSERT_EQUAL(2, database->streamHosts.size());
+    TEST_ASSERT_EQUAL_STRING("db.example", database->streamHosts[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("shard.example", database->streamHosts[1].c_str());
+}
+
+void test_unanswered_stream_gives_up_and_polls() {
+    FirebaseClient firebase("db.example", "");
+    DeviceConfig config(DEFAULTS);
+    ConfigSubscription subscription(firebase, config);
+
+    database->streamHead = "";   // Connected, never answers
+    subscription.begin("dev/config");
+    subscription.service();
+    uint32_t started = millis();
+    subscription.service();
+    TEST_ASSERT_EQUAL_UINT32(started, millis());   // Did not wait
+    TEST_ASSERT_EQUAL_UINT32(0, database->polls);
+
+    hostAdvanceMillis(CONFIG_STREAM_HEAD_MS);
+    subscription.service();
+    TEST_ASSERT_FALSE(subscription.isStreaming());
+    subscription.service();
+    TEST_ASSERT_EQUAL_UINT32(1, database->polls);
+    TEST_ASSERT_EQUAL_UINT32(0, subscription.getStats().connects);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_parser_any_split);
+    RUN_TEST(test_parser_drops_oversized_event);
+    RUN_TEST(test_stream_applies_put_and_patch_split_across_chunks);
+    RUN_TEST(test_keep_alive_holds_stream_silence_drops_it);
+    RUN_TEST(test_closed_or_cancelled_stream_falls_back_to_poll);
+    RUN_TEST(test_head_read_across_calls_with_redirect);
+    RUN_TEST(test_unanswered_stream_gives_up_and_polls);
+    return UNITY_END();
+}
\ No newline at end of file
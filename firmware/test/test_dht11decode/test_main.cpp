@@ -0,0 +1,220 @@
+// DHT11 decode: decodeDht11 on synthetic edge trains shaped like what the
+// ISR records - response pulse, 40 bits, release - built from the nominal
+// datasheet pulse widths plus simulated ISR latency, the rejected frames,
+// heat index against NOAA table values, decode time. No hardware captures.
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "dht11decode.h"
+
+namespace {
+
+/**
+ * A synthetic capture, generated rather than recorded: the edges the ISR
+ * would see from the release of the start signal, at nominal datasheet
+ * timing. The line rises on the pull-up, the sensor answers 80 µs low /
+ * 80 µs high, then per bit 50 µs low and 26 (0) or 70 µs (1) high, then
+ * 50 µs low and release. Each timestamp is late by up to jitterUs
+ * (interrupt latency, from a fixed LCG).
+ */
+class Capture {
+public:
+    std::vector<DhtEdge> edges;
+
+    Capture(const uint8_t data[5], uint32_t jitterUs = 0, uint32_t seed = 1)
+        : jitterUs(jitterUs), state(seed), t(1000000) {
+        edge(1, 0);      // Released, pulled up
+        edge(0, 30);     // Sensor pulls low
+        edge(1, 80);     // Response
+        edge(0, 80);
+        for (int bit = 0; bit < 40; bit++) {
+            bool one = (data[bit / 8] >> (7 - bit % 8)) & 1;
+            edge(1, 50);
+            edge(0, one ? 70 : 27);
+        }
+        edge(1, 50);     // End of frame, line released
+    }
+
+private:
+    uint32_t jitterUs;
+    uint32_t state;
+    uint32_t t;
+
+    void edge(uint8_t level, uint32_t afterUs) {
+        t += afterUs;
+        uint32_t late = 0;
+        if (jitterUs > 0) {
+            state = state * 1664525u + 1013904223u;
+            late = (state >> 16) % (jitterUs + 1);
+        }
+        edges.push_back(DhtEdge{ t + late, level });
+    }
+};
+
+void frame(uint8_t humidity, uint8_t humidityTenths, uint8_t temperature, uint8_t temperatureTenths, uint8_t out[5]) {
+    out[0] = humidity;
+    out[1] = humidityTenths;
+    out[2] = temperature;
+    out[3] = temperatureTenths;
+    out[4] = (uint8_t)(out[0] + out[1] + out[2] + out[3]);
+}
+
+uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_decodes_a_nominal_frame() {
+    uint8_t data[5];
+    frame(55, 0, 24, 3, data);
+    Capture capture(data);
+    TEST_ASSERT_EQUAL_UINT32(85, capture.edges.size());
+    TEST_ASSERT_LESS_OR_EQUAL(DHT_MAX_EDGES, capture.edges.size());
+
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, decodeDht11(capture.edges.data(), capture.edges.size(), reading));
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(24.3f, reading.temperature);
+
+    // Sign bit of the newer parts: -1 - integral + tenths
+    frame(30, 0, 5, 0x82, data);
+    Capture below(data);
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, decodeDht11(below.edges.data(), below.edges.size(), reading));
+    TEST_ASSERT_EQUAL_FLOAT(-5.8f, reading.temperature);
+}
+
+void test_every_reading_survives_isr_jitter() {
+    // The DHT11 range, each frame with up to 15 µs interrupt latency per edge
+    uint32_t frames = 0;
+    for (uint8_t humidity = 20; humidity <= 90; humidity++) {
+        for (uint8_t temperature = 0; temperature <= 50; temperature++) {
+            uint8_t data[5];
+            frame(humidity, 0, temperature, (humidity + temperature) % 10, data);
+            Capture capture(data, 15, humidity * 100 + temperature);
+
+            DhtReading reading;
+            TEST_ASSERT_EQUAL(DHT_DECODE_OK, decodeDht11(capture.edges.data(), capture.edges.size(), reading));
+            TEST_ASSERT_EQUAL_FLOAT(humidity, reading.humidity);
+            TEST_ASSERT_FLOAT_WITHIN(0.001f, temperature + ((humidity + temperature) % 10) * 0.1f, reading.temperature);
+            frames++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(71 * 51, frames);
+}
+
+void test_bad_captures_are_rejected() {
+    uint8_t data[5];
+    frame(55, 0, 24, 3, data);
+    DhtReading reading = { 99.0f, 99.0f };
+
+    // Capture timed out part way through the bits
+    Capture truncated(data);
+    TEST_ASSERT_EQUAL(DHT_DECODE_TOO_FEW_BITS, decodeDht11(truncated.edges.data(), 4 + 2 * 30, reading));
+    TEST_ASSERT_EQUAL(DHT_DECODE_TOO_FEW_BITS, decodeDht11(truncated.edges.data(), 0, reading));
+
+    // A bit read wrong
+    Capture flipped(data);
+    flipped.edges[4 + 2 * 12 + 1].timeUs += 43;  // 27 µs zero stretched into a one
+    for (size_t i = 4 + 2 * 12 + 2; i < flipped.edges.size(); i++) flipped.edges[i].timeUs += 43;
+    TEST_ASSERT_EQUAL(DHT_DECODE_CHECKSUM, decodeDht11(flipped.edges.data(), flipped.edges.size(), reading));
+
+    // Two edges lost while interrupts were held off: a high pulse runs into the next bit
+    Capture missed(data);
+    missed.edges.erase(missed.edges.begin() + 4 + 2 * 20 + 1, missed.edges.begin() + 4 + 2 * 20 + 3);
+    TEST_ASSERT_EQUAL(DHT_DECODE_BAD_PULSE, decodeDht11(missed.edges.data(), missed.edges.size(), reading));
+
+    // A sensor that never answered, just the pull-up
+    DhtEdge released[] = { { 1000, 1 } };
+    TEST_ASSERT_EQUAL(DHT_DECODE_TOO_FEW_BITS, decodeDht11(released, 1, reading));
+
+    // Rejections leave the last reading alone
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, reading.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, reading.humidity);
+}
+
+void test_glitch_before_the_response_is_ignored() {
+    uint8_t data[5];
+    frame(41, 0, 19, 7, data);
+    Capture capture(data);
+
+    // Ringing on release: a short extra pulse ahead of the response
+    DhtEdge ring[] = { { 999980, 1 }, { 999985, 0 } };
+    capture.edges.insert(capture.edges.begin(), ring, ring + 2);
+    TEST_ASSERT_LESS_OR_EQUAL(DHT_MAX_EDGES, capture.edges.size());
+
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, decodeDht11(capture.edges.data(), capture.edges.size(), reading));
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(19.7f, reading.temperature);
+}
+
+void test_heat_index_matches_the_noaa_table() {
+    // (°F, %RH, heat index °F) from the NWS heat index chart
+    const float table[][3] = {
+        { 80, 40, 80 }, { 86, 50, 88 }, { 90, 50, 95 }, { 90, 70, 106 }, { 96, 55, 112 }, { 100, 40, 109 },
+    };
+    for (const auto& row : table) {
+        float tempC = (row[0] - 32) / 1.8f;
+        TEST_ASSERT_FLOAT_WITHIN(1.5f, row[2], dhtHeatIndex(tempC, row[1], true));
+        TEST_ASSERT_FLOAT_WITHIN(1.5f / 1.8f, (row[2] - 32) / 1.8f, dhtHeatIndex(tempC, row[1], false));
+    }
+
+    // Below 80 °F the simple formula: about the air temperature
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 20.0f, dhtHeatIndex(20, 50, false));
+}
+
+void test_benchmark_decode() {
+    // Every 2 s on the sensor task, after the capture is complete
+    std::vector<Capture> captures;
+    for (uint32_t i = 0; i < 64; i++) {
+        uint8_t data[5];
+        frame(20 + i, 0, i % 50, i % 10, data);
+        captures.push_back(Capture(data, 10, i + 1));
+    }
+
+    const uint32_t DECODES = 200000;
+    float checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startCycles = cycleCount();
+    for (uint32_t i = 0; i < DECODES; i++) {
+        const Capture& capture = captures[i % captures.size()];
+        DhtReading reading;
+        if (decodeDht11(capture.edges.data(), capture.edges.size(), reading) == DHT_DECODE_OK) {
+            checksum += reading.temperature;
+        }
+    }
+    uint64_t cycles = cycleCount() - startCycles;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_GREATER_THAN(0, checksum);
+
+    char report[128];
+    snprintf(report, sizeof(report), "decodeDht11: %.0f ns, %.0f host cycles per frame (%u edges)",
+             ns / DECODES, (double)cycles / DECODES, (unsigned)captures[0].edges.size());
+    TEST_MESSAGE(report);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_a_nominal_frame);
+    RUN_TEST(test_every_reading_survives_isr_jitter);
+    RUN_TEST(test_bad_captures_are_rejected);
+    RUN_TEST(test_glitch_before_the_response_is_ignored);
+    RUN_TEST(test_heat_index_matches_the_noaa_table);
+    RUN_TEST(test_benchmark_decode);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+// Firebase REST client: one kept-alive connection for every
+// request of a sample cycle, reconnect when the server closes it, a stale
+// reused connection retried once, a started response never retried.
+#include <unity.h>
+
+#include <deque>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "firebaseclient.cpp"
+
+namespace {
+
+struct Request {
+    std::string line;       // "PUT /path.json?auth=... HTTP/1.1"
+    std::string head;
+    std::string body;
+    uint32_t connection;    // fakeNetwork().connects when it arrived
+};
+
+const std::string OK_NULL = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nnull";
+
+/**
+ * The database end: splits what the client wrote into requests and
+ * answers each with the next scripted response (OK_NULL when none is
+ * left). An empty response string closes the connection unanswered.
+ */
+struct FakeDatabase {
+    std::vector<Request> requests;
+    std::deque<std::string> responses;
+    uint32_t writes = 0;
+
+    void serve(FakeSocket& socket) {
+        writes++;
+        while (true) {
+            size_t end = socket.sent.find("\r\n\r\n");
+            if (end == std::string::npos) return;
+            std::string head = socket.sent.substr(0, end + 2);
+            size_t length = 0;
+            size_t at = head.find("Content-Length: ");
+            if (at != std::string::npos) length = strtoul(head.c_str() + at + 16, nullptr, 10);
+            if (socket.sent.size() < end + 4 + length) return;
+
+            Request request{ head.substr(0, head.find("\r\n")), head, socket.sent.substr(end + 4, length),
+                             fakeNetwork().connects };
+            socket.sent.erase(0, end + 4 + length);
+            requests.push_back(request);
+
+            std::string response = OK_NULL;
+            if (!responses.empty()) {
+                response = responses.front();
+                responses.pop_front();
+            }
+            if (response.empty()) {
+                socket.close();
+                return;
+            }
+            socket.reply(response);
+        }
+    }
+};
+
+FakeDatabase* database = nullptr;
+FirebaseClient* firebase = nullptr;
+
+// What one sample cycle of the network task sends
+void sampleCycle(int cycle) {
+    char json[64];
+    snprintf(json, sizeof(json), "{\"temperature\":%d.5,\"humidity\":51}", 20 + cycle);
+    TEST_ASSERT_TRUE(firebase->patch("SmartParcels/dev1/current", json));
+    TEST_ASSERT_TRUE(firebase->post("SmartParcels/dev1/history", json));
+    TEST_ASSERT_TRUE(firebase->put("SmartParcels/dev1/info/lastSeen", "\"1700000000000\""));
+    String config;
+    TEST_ASSERT_TRUE(firebase->get("SmartParcels/dev1/config", config));
+    TEST_ASSERT_TRUE(firebase->put("SmartParcels/dev1/alerts/-Nabc", "{\"type\":\"drop\"}"));
+}
+
+const int REQUESTS_PER_CYCLE = 5;
+
+}  // namespace
+
+void setUp() {
+    fakeNetwork().reset();
+    database = new FakeDatabase();
+    fakeNetwork().serve = [](FakeSocket& socket) { database->serve(socket); };
+    firebase = new FirebaseClient("https://traceon-test.firebaseio.com/", "secret");
+    firebase->begin();
+}
+
+void tearDown() {
+    delete firebase;
+    delete database;
+    fakeNetwork().reset();
+}
+
+void test_requests_share_one_connection() {
+    const int CYCLES = 20;
+    for (int cycle = 0; cycle < CYCLES; cycle++) {
+        sampleCycle(cycle);
+    }
+
+    // One handshake in all, where a connection per request paid one each
+    const FirebaseClient::Stats& stats = firebase->getStats();
+    TEST_ASSERT_EQUAL_UINT32(CYCLES * REQUESTS_PER_CYCLE, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.failures);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.handshakes);
+    TEST_ASSERT_EQUAL_UINT32(1, fakeNetwork().connects);
+    TEST_ASSERT_EQUAL_UINT32(CYCLES * REQUESTS_PER_CYCLE, database->requests.size());
+
+    char report[128];
+    snprintf(report, sizeof(report), "%d requests per cycle, %.2f handshakes per cycle over %d cycles",
+             REQUESTS_PER_CYCLE, (double)stats.handshakes / CYCLES, CYCLES);
+    TEST_MESSAGE(report);
+}
+
+void test_request_head_and_body() {
+    const char* json = "{\"temperature\":21.5}";
+    TEST_ASSERT_TRUE(firebase->put("SmartParcels/dev1/current", json));
+
+    const Request& request = database->requests.at(0);
+    TEST_ASSERT_EQUAL_STRING("PUT /SmartParcels/dev1/current.json?auth=secret HTTP/1.1", request.line.c_str());
+    TEST_ASSERT_TRUE(request.head.find("\r\nHost: traceon-test.firebaseio.com\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(request.head.find("\r\nConnection: keep-alive\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(request.head.find("\r\nContent-Length: 20\r\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING(json, request.body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, database->writes);  // Head and body in one segment
+
+    // A GET has no body and no Content-Length
+    String value;
+    database->responses.push_back("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                  "5\r\n{\"a\":\r\n3\r\n12}\r\n0\r\n\r\n");
+    TEST_ASSERT_TRUE(firebase->get("SmartParcels/dev1/config", value));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":12}", value.c_str());
+    TEST_ASSERT_TRUE(database->requests.at(1).head.find("Content-Length") == std::string::npos);
+}
+
+void test_bodies_without_content_keep_the_connection_aligned() {
+    // 204 and 304 carry no body even without a Content-Length
+    database->responses.push_back("HTTP/1.1 204 No Content\r\n\r\n");
+    database->responses.push_back("HTTP/1.1 304 Not Modified\r\nETag: \"abc\"\r\n\r\n");
+    database->responses.push_back("HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n\"after\"");
+
+    TEST_ASSERT_TRUE(firebase->put("a", "1"));
+    String etag = "\"abc\"", value = "kept";
+    bool changed = true;
+    TEST_ASSERT_TRUE(firebase->getIfChanged("b", etag, value, changed));
+    TEST_ASSERT_FALSE(changed);
+    TEST_ASSERT_EQUAL_STRING("kept", value.c_str());
+    TEST_ASSERT_TRUE(firebase->get("c", value));
+    TEST_ASSERT_EQUAL_STRING("\"after\"", value.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, firebase->getStats().handshakes);
+}
+
+void test_reconnects_after_the_server_closes() {
+    sampleCycle(0);
+
+    // Connection: close honoured, the next request opens a new connection
+    database->responses.push_back("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 4\r\n\r\nnull");
+    TEST_ASSERT_TRUE(firebase->put("a", "1"));
+    TEST_ASSERT_FALSE(firebase->isConnected());
+    TEST_ASSERT_TRUE(firebase->put("a", "2"));
+    TEST_ASSERT_EQUAL_UINT32(2, firebase->getStats().handshakes);
+
+    // Closed while idle: no retry needed, just a fresh connection
+    fakeNetwork().last->close();
+    sampleCycle(1);
+    TEST_ASSERT_EQUAL_UINT32(3, firebase->getStats().handshakes);
+    TEST_ASSERT_EQUAL_UINT32(0, firebase->getStats().failures);
+}
+
+void test_stale_reused_connection_is_retried_once() {
+    TEST_ASSERT_TRUE(firebase->put("a", "1"));
+
+    // The server dropped the idle connection as the request went out
+    database->responses.push_back("");
+    TEST_ASSERT_TRUE(firebase->put("SmartParcels/dev1/info/lastSeen", "\"1700000000000\""));
+
+    // Sent twice, answered once, on a second connection
+    TEST_ASSERT_EQUAL_UINT32(3, database->requests.size());
+    TEST_ASSERT_EQUAL_UINT32(1, database->requests[1].connection);
+    TEST_ASSERT_EQUAL_UINT32(2, database->requests[2].connection);
+    TEST_ASSERT_EQUAL_UINT32(2, firebase->getStats().handshakes);
+    TEST_ASSERT_EQUAL_UINT32(1, firebase->getStats().failures);
+
+    // A fresh connection failing the same way is not retried
+    fakeNetwork().last->close();
+    database->responses.push_back("");
+    TEST_ASSERT_FALSE(firebase->put("a", "3"));
+    TEST_ASSERT_EQUAL_UINT32(4, database->requests.size());
+}
+
+void test_started_response_is_not_retried() {
+    TEST_ASSERT_TRUE(firebase->put("a", "1"));
+
+    // Status line and part of the body, then the connection drops
+    database->responses.push_back("HTTP/1.1 200 OK\r\nContent-Length: 40\r\n\r\n{\"partial\"");
+    fakeNetwork().serve = [](FakeSocket& socket) {
+        database->serve(socket);
+        if (database->requests.size() == 2) socket.close();
+    };
+    TEST_ASSERT_FALSE(firebase->post("SmartParcels/dev1/history", "{\"t\":1}"));
+
+    // The write may have been applied, so it went out exactly once
+    TEST_ASSERT_EQUAL_UINT32(2, database->requests.size());
+    TEST_ASSERT_FALSE(firebase->isConnected());
+    TEST_ASSERT_TRUE(firebase->put("a", "2"));
+    TEST_ASSERT_EQUAL_UINT32(2, firebase->getStats().handshakes);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_requests_share_one_connection);
+    RUN_TEST(test_request_head_and_body);
+    RUN_TEST(test_bodies_without_content_keep_the_connection_aligned);
+    RUN_TEST(test_reconnects_after_the_server_closes);
+    RUN_TEST(test_stale_reused_connection_is_retried_once);
+    RUN_TEST(test_started_response_is_not_retried);
+    return UNITY_END();
+}
\ No newline at end of file
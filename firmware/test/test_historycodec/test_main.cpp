@@ -0,0 +1,332 @@
+// History blocks: round trips, partial encodes, consume() and retiming,
+// and bytes / ns per sample on a replayed parcel trip.
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+#include "historyschema.h"
+#include "tripreplay.h"
+
+namespace {
+
+typedef HistoryBlockEncoder<HISTORY_BLOCK_SAMPLES, HISTORY_NUMERIC_COUNT, HISTORY_STRING_COUNT> Block;
+
+struct Row {
+    uint64_t timestampMs;
+    std::vector<float> values;
+    std::vector<std::string> strings;
+};
+
+struct Decoded {
+    uint16_t schemaId = 0;
+    uint32_t samples = 0;
+    size_t numeric = 0;
+    size_t strings = 0;
+    std::vector<uint64_t> timestamps;
+    std::vector<std::vector<double>> values;
+    std::vector<std::vector<bool>> present;
+    std::vector<std::vector<std::string>> text;
+
+    void onBlock(uint16_t id, uint32_t count, size_t numericColumns, size_t stringColumns) {
+        schemaId = id;
+        samples = count;
+        numeric = numericColumns;
+        strings = stringColumns;
+        timestamps.assign(count, 0);
+        values.assign(numericColumns, std::vector<double>(count));
+        present.assign(numericColumns, std::vector<bool>(count));
+        text.assign(stringColumns, std::vector<std::string>(count));
+    }
+    void onTimestamp(uint32_t sample, uint64_t timestampMs) { timestamps[sample] = timestampMs; }
+    void onValue(size_t column, uint32_t sample, double value, bool isPresent) {
+        values[column][sample] = value;
+        present[column][sample] = isPresent;
+    }
+    void onString(size_t column, uint32_t sample, const char* data, size_t length) {
+        text[column][sample] = std::string(data, length);
+    }
+};
+
+Block* block = nullptr;
+
+bool add(const Row& row) {
+    const char* strings[HISTORY_STRING_COUNT];
+    for (size_t s = 0; s < HISTORY_STRING_COUNT; s++) {
+        strings[s] = row.strings[s].c_str();
+    }
+    return block->add(row.timestampMs, row.values.data(), strings);
+}
+
+// Decoded samples must be rows[first ...] at the column resolutions
+void assertRows(const Decoded& decoded, const std::vector<Row>& rows, size_t first) {
+    for (uint32_t i = 0; i < decoded.samples; i++) {
+        const Row& row = rows[first + i];
+        TEST_ASSERT_EQUAL_UINT64(row.timestampMs, decoded.timestamps[i]);
+        for (size_t c = 0; c < HISTORY_NUMERIC_COUNT; c++) {
+            if (isnan(row.values[c])) {
+                TEST_ASSERT_FALSE(decoded.present[c][i]);
+                continue;
+            }
+            double step = 1.0 / HistoryWire::scale(historyNumericColumns()[c].decimals);
+            TEST_ASSERT_TRUE(decoded.present[c][i]);
+            TEST_ASSERT_DOUBLE_WITHIN(step / 2 + 1e-6, row.values[c], decoded.values[c][i]);
+        }
+        for (size_t s = 0; s < HISTORY_STRING_COUNT; s++) {
+            TEST_ASSERT_EQUAL_STRING(row.strings[s].c_str(), decoded.text[s][i].c_str());
+        }
+    }
+}
+
+std::vector<Row> syntheticRows(size_t count) {
+    std::vector<Row> rows;
+    uint64_t timestamp = 1760000000000ULL;
+    const char* ssids[] = { "depot", "depot", "van-7", "van-7", "depot" };
+    for (size_t i = 0; i < count; i++) {
+        Row row;
+        timestamp += 2000 + (i == 6 ? 13 : 0);   // One late sample
+        row.timestampMs = timestamp;
+        for (size_t c = 0; c < HISTORY_NUMERIC_COUNT; c++) {
+            // Up to 8 steps of jitter, steps no finer than 0.01
+            double step = std::min(0.01, 1.0 / HistoryWire::scale(historyNumericColumns()[c].decimals));
+            row.values.push_back(c % 7 == 3 && i == 4 ? NAN : 20.0f + c + step * ((i * 37 + c * 11) % 9));
+        }
+        row.strings = { i < 10 ? "Upright" : "Tilted", ssids[(i / 3) % 5], "heartbeat" };
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+}  // namespace
+
+void setUp() {
+    block = new Block(historyNumericColumns(), HISTORY_SCHEMA_ID);
+}
+
+void tearDown() {
+    delete block;
+    block = nullptr;
+}
+
+void test_full_block_round_trip_through_base64() {
+    std::vector<Row> rows = syntheticRows(HISTORY_BLOCK_SAMPLES);
+    for (const Row& row : rows) {
+        TEST_ASSERT_TRUE(add(row));
+    }
+    TEST_ASSERT_TRUE(block->isFull());
+    TEST_ASSERT_FALSE(add(rows[0]));
+
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    size_t length = block->encode(encoded, sizeof(encoded), HISTORY_BLOCK_SAMPLES);
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL(0, block->encode(encoded, 100, HISTORY_BLOCK_SAMPLES));   // Does not fit
+
+    char text[2 * HISTORY_BLOCK_MAX_BYTES];
+    size_t textLength = base64Encode(encoded, length, text, sizeof(text));
+    uint8_t decoded[HISTORY_BLOCK_MAX_BYTES];
+    TEST_ASSERT_EQUAL(length, base64Decode(text, textLength, decoded, sizeof(decoded)));
+
+    Decoded block;
+    TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(decoded, length, block));
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_SCHEMA_ID, block.schemaId);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_BLOCK_SAMPLES, block.samples);
+    TEST_ASSERT_EQUAL(HISTORY_NUMERIC_COUNT, block.numeric);
+    TEST_ASSERT_EQUAL(HISTORY_STRING_COUNT, block.strings);
+    assertRows(block, rows, 0);
+}
+
+void test_partial_encode_sends_only_referenced_strings() {
+    // Every string column gets a new entry on each of the first samples,
+    // so the dictionaries outgrow a one-sample prefix
+    std::vector<Row> rows = syntheticRows(6);
+    const char* reasons[] = { "heartbeat", "alert", "motion", "deadband", "heartbeat", "motion" };
+    for (size_t i = 0; i < rows.size(); i++) {
+        rows[i].strings = { i % 2 ? "Tilted" : "Upright", "net-" + std::to_string(i / 2), reasons[i] };
+        TEST_ASSERT_TRUE(add(rows[i]));
+    }
+
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    for (size_t samples = 1; samples <= rows.size(); samples++) {
+        size_t length = block->encode(encoded, sizeof(encoded), samples);
+        Decoded prefix;
+        TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(encoded, length, prefix));
+        TEST_ASSERT_EQUAL_UINT32(samples, prefix.samples);
+        assertRows(prefix, rows, 0);
+    }
+
+    // One sample carries one entry per string column, not the whole dictionary
+    size_t one = block->encode(encoded, sizeof(encoded), 1);
+    TEST_ASSERT_EQUAL(NULL, memmem(encoded, one, "Tilted", 6));
+    TEST_ASSERT_EQUAL(NULL, memmem(encoded, one, "net-1", 5));
+    TEST_ASSERT_NOT_NULL(memmem(encoded, one, "Upright", 7));
+}
+
+void test_consume_keeps_the_rest_decodable() {
+    std::vector<Row> rows = syntheticRows(HISTORY_BLOCK_SAMPLES);
+    for (const Row& row : rows) {
+        add(row);
+    }
+
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    block->consume(5);
+    TEST_ASSERT_EQUAL(HISTORY_BLOCK_SAMPLES - 5, block->getCount());
+    TEST_ASSERT_EQUAL_UINT64(rows[5].timestampMs, block->getTimestamp(0));
+
+    size_t length = block->encode(encoded, sizeof(encoded), block->getCount());
+    Decoded rest;
+    TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(encoded, length, rest));
+    assertRows(rest, rows, 5);
+
+    // Refilled after a consume, new strings append to the compacted dictionary
+    Row late = rows[0];
+    late.timestampMs = rows.back().timestampMs + 2000;
+    late.strings = { "Upside Down", "depot", "alert" };
+    rows.push_back(late);
+    TEST_ASSERT_TRUE(add(late));
+    length = block->encode(encoded, sizeof(encoded), block->getCount());
+    TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(encoded, length, rest));
+    assertRows(rest, rows, 5);
+
+    block->consume(100);
+    TEST_ASSERT_EQUAL(0, block->getCount());
+}
+
+void test_retime_redates_only_the_timestamps() {
+    // Samples stamped in monotonic ms before the first sync, then mapped
+    // to Unix time with an offset and 150 ppm of drift
+    std::vector<Row> rows = syntheticRows(HISTORY_BLOCK_SAMPLES);
+    uint64_t monotonicMs = 8000;
+    for (Row& row : rows) {
+        row.timestampMs = monotonicMs;
+        monotonicMs += 2000 + (row.values[0] > 20.05f ? 1 : 0);
+        add(row);
+    }
+    auto toUnix = [](uint64_t ms) { return 1760000000000ULL + ms + ms * 150 / 1000000; };
+
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    size_t length = block->encode(encoded, sizeof(encoded), HISTORY_BLOCK_SAMPLES);
+    uint8_t redated[HISTORY_BLOCK_MAX_BYTES + 16];
+    uint32_t samples = 0;
+    uint64_t from = 0, to = 0;
+    size_t redatedLength = HistoryBlockDecoder::retime(encoded, length, redated, sizeof(redated), toUnix,
+                                                       samples, from, to);
+    TEST_ASSERT_GREATER_THAN(0, redatedLength);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_BLOCK_SAMPLES, samples);
+    TEST_ASSERT_EQUAL_UINT64(toUnix(rows.front().timestampMs), from);
+    TEST_ASSERT_EQUAL_UINT64(toUnix(rows.back().timestampMs), to);
+
+    for (Row& row : rows) {
+        row.timestampMs = toUnix(row.timestampMs);
+    }
+    Decoded decoded;
+    TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(redated, redatedLength, decoded));
+    assertRows(decoded, rows, 0);
+
+    // The same bytes as re-dating the held samples before encoding
+    block->retime(toUnix);
+    uint8_t direct[HISTORY_BLOCK_MAX_BYTES + 16];
+    TEST_ASSERT_EQUAL(redatedLength, block->encode(direct, sizeof(direct), HISTORY_BLOCK_SAMPLES));
+    TEST_ASSERT_EQUAL_MEMORY(direct, redated, redatedLength);
+
+    // Malformed or too large for the output
+    TEST_ASSERT_EQUAL(0, HistoryBlockDecoder::retime(encoded, 10, redated, sizeof(redated), toUnix, samples, from, to));
+    TEST_ASSERT_EQUAL(0, HistoryBlockDecoder::retime(encoded, length, redated, length / 2, toUnix, samples, from, to));
+}
+
+void test_corrupt_blocks_are_rejected() {
+    std::vector<Row> rows = syntheticRows(HISTORY_BLOCK_SAMPLES);
+    for (const Row& row : rows) {
+        add(row);
+    }
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    size_t length = block->encode(encoded, sizeof(encoded), HISTORY_BLOCK_SAMPLES);
+
+    for (size_t cut = 0; cut < length; cut++) {
+        Decoded truncated;
+        TEST_ASSERT_FALSE(HistoryBlockDecoder::decode(encoded, cut, truncated));
+    }
+
+    TraceNoise noise(7);
+    for (int i = 0; i < 2000; i++) {
+        uint8_t junk[200];
+        for (uint8_t& b : junk) {
+            b = (uint8_t)noise.next(127);
+        }
+        junk[0] = HISTORY_CODEC_VERSION;
+        Decoded garbage;
+        HistoryBlockDecoder::decode(junk, sizeof(junk), garbage);   // Must not crash
+    }
+}
+
+void test_trip_bytes_and_time_per_sample() {
+    // Three trips back to back
+    ImuTrace trace = parcelTripTrace(MPU6050_SAMPLE_RATE_HZ);
+    for (uint32_t seed = 2; seed <= 3; seed++) {
+        ImuTrace next = parcelTripTrace(MPU6050_SAMPLE_RATE_HZ, 350.0f, seed);
+        trace.samples.insert(trace.samples.end(), next.samples.begin(), next.samples.end());
+    }
+    std::vector<SensorRecord> records = replayTrip(trace, parcelTripClimate(180));
+    TEST_ASSERT_GREATER_OR_EQUAL(HISTORY_BLOCK_SAMPLES, records.size());
+
+    std::vector<Row> rows;
+    uint64_t epochMs = 1760000000000ULL;
+    for (const SensorRecord& record : records) {
+        Row row;
+        row.timestampMs = epochMs + record.uptimeMs;
+        row.values.resize(HISTORY_NUMERIC_COUNT);
+        historyValues(record, VIBRATION_THRESHOLD, -61, row.values.data());
+        row.strings = { orientationName(record.orientation), "depot", "heartbeat" };
+        rows.push_back(row);
+    }
+
+    uint8_t encoded[HISTORY_BLOCK_MAX_BYTES];
+    size_t blocks = 0;
+    size_t bytes = 0;
+    size_t samples = 0;
+    double encodeNs = 0;
+    for (size_t first = 0; first + HISTORY_BLOCK_SAMPLES <= rows.size(); first += HISTORY_BLOCK_SAMPLES) {
+        block->clear();
+        for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; i++) {
+            add(rows[first + i]);
+        }
+
+        const int REPEAT = 200;
+        size_t length = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEAT; r++) {
+            length = block->encode(encoded, sizeof(encoded), HISTORY_BLOCK_SAMPLES);
+        }
+        encodeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / REPEAT;
+        TEST_ASSERT_GREATER_THAN(0, length);
+
+        Decoded decoded;
+        TEST_ASSERT_TRUE(HistoryBlockDecoder::decode(encoded, length, decoded));
+        assertRows(decoded, rows, first);
+
+        blocks++;
+        bytes += length;
+        samples += HISTORY_BLOCK_SAMPLES;
+    }
+
+    char report[160];
+    snprintf(report, sizeof(report), "history: %zu blocks, %.1f bytes/sample, encode %.0f ns/sample (host)",
+             blocks, (double)bytes / samples, encodeNs / samples);
+    TEST_MESSAGE(report);
+
+    // A current/ JSON record is ~700 bytes; a block sample must stay a small fraction of that
+    TEST_ASSERT_LESS_THAN(100, bytes / samples);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_block_round_trip_through_base64);
+    RUN_TEST(test_partial_encode_sends_only_referenced_strings);
+    RUN_TEST(test_consume_keeps_the_rest_decodable);
+    RUN_TEST(test_retime_redates_only_the_timestamps);
+    RUN_TEST(test_corrupt_blocks_are_rejected);
+    RUN_TEST(test_trip_bytes_and_time_per_sample);
+    return UNITY_END();
+}
\ No newline at end of file
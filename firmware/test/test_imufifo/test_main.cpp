@@ -0,0 +1,254 @@
+// MPU6050 FIFO driver against an in-memory register source:
+// configuration writes, burst drains, partial samples, overflow reset.
+#include <unity.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "imufifo.h"
+
+namespace {
+
+/**
+ * In-memory MPU6050: a register file plus the 1 KB FIFO, fed by the test
+ */
+class FakeMpuBus {
+public:
+    std::map<uint8_t, uint8_t> registers;
+    std::vector<std::pair<uint8_t, uint8_t>> writes;
+    std::deque<uint8_t> fifo;
+    size_t readLimit = 32;
+    size_t largestRead = 0;
+    uint32_t fifoReads = 0;
+    bool failing = false;
+
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        if (failing) {
+            return false;
+        }
+        writes.push_back({ reg, value });
+        registers[reg] = value;
+        if (reg == MPU6050Fifo<FakeMpuBus>::REG_USER_CTRL && (value & MPU6050Fifo<FakeMpuBus>::USER_CTRL_FIFO_RESET)) {
+            fifo.clear();
+        }
+        return true;
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* dst, size_t len) {
+        if (failing || len > readLimit) {
+            return false;
+        }
+        largestRead = len > largestRead ? len : largestRead;
+
+        if (reg == MPU6050Fifo<FakeMpuBus>::REG_FIFO_COUNTH) {
+            size_t count = fifo.size();
+            dst[0] = (uint8_t)(count >> 8);
+            dst[1] = (uint8_t)count;
+        } else if (reg == MPU6050Fifo<FakeMpuBus>::REG_FIFO_R_W) {
+            fifoReads++;
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = fifo.empty() ? 0 : fifo.front();
+                if (!fifo.empty()) fifo.pop_front();
+            }
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = registers[(uint8_t)(reg + i)];
+            }
+        }
+        return true;
+    }
+
+    size_t maxReadLength() const { return readLimit; }
+
+    uint8_t reg(uint8_t address) { return registers[address]; }
+
+    // The sensor writing one sample, big endian, while the FIFO is enabled
+    void sample(const ImuRawSample& s) {
+        if (!(reg(MPU6050Fifo<FakeMpuBus>::REG_USER_CTRL) & MPU6050Fifo<FakeMpuBus>::USER_CTRL_FIFO_EN)) {
+            return;
+        }
+        const int16_t values[] = { s.ax, s.ay, s.az, s.gx, s.gy, s.gz };
+        for (int16_t v : values) {
+            if (fifo.size() < MPU6050Fifo<FakeMpuBus>::FIFO_SIZE) fifo.push_back((uint8_t)((uint16_t)v >> 8));
+            if (fifo.size() < MPU6050Fifo<FakeMpuBus>::FIFO_SIZE) fifo.push_back((uint8_t)v);
+        }
+    }
+};
+
+typedef MPU6050Fifo<FakeMpuBus> Fifo;
+
+ImuRawSample numbered(int16_t n) {
+    return ImuRawSample{ n, (int16_t)-n, (int16_t)(4096 + n), (int16_t)(n * 3), -32768, 32767 };
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_begin_configures_rate_filter_and_fifo() {
+    FakeMpuBus bus;
+    Fifo fifo(bus);
+
+    TEST_ASSERT_TRUE(fifo.begin(500, 3));
+    TEST_ASSERT_EQUAL_UINT16(500, fifo.getSampleRate());
+    TEST_ASSERT_EQUAL_HEX8(1, bus.reg(Fifo::REG_SMPLRT_DIV));
+    TEST_ASSERT_EQUAL_HEX8(3, bus.reg(Fifo::REG_CONFIG));
+    TEST_ASSERT_EQUAL_HEX8(Fifo::FIFO_EN_ACCEL_GYRO, bus.reg(Fifo::REG_FIFO_EN));
+    TEST_ASSERT_EQUAL_HEX8(Fifo::USER_CTRL_FIFO_EN, bus.reg(Fifo::REG_USER_CTRL));
+
+    // FIFO is reset before sampling starts, and enabled last
+    TEST_ASSERT_EQUAL_HEX8(Fifo::REG_USER_CTRL, bus.writes.back().first);
+    TEST_ASSERT_EQUAL_HEX8(Fifo::USER_CTRL_FIFO_RESET, bus.writes[bus.writes.size() - 3].second);
+
+    // 1 kHz divided down: 300 Hz is not reachable, 333 Hz is used
+    TEST_ASSERT_TRUE(fifo.begin(300, 1));
+    TEST_ASSERT_EQUAL_UINT16(333, fifo.getSampleRate());
+
+    TEST_ASSERT_FALSE(fifo.begin(0, 3));
+    TEST_ASSERT_FALSE(fifo.begin(2000, 3));
+    TEST_ASSERT_FALSE(fifo.begin(500, 0));   // 8 kHz gyro
+    TEST_ASSERT_FALSE(fifo.begin(500, 7));
+}
+
+void test_drain_keeps_order_and_bursts_within_the_bus_limit() {
+    FakeMpuBus bus;
+    bus.readLimit = 32;   // Two samples per read
+    Fifo fifo(bus);
+    fifo.begin(500, 3);
+
+    for (int16_t n = 0; n < 25; n++) {
+        bus.sample(numbered(n));
+    }
+    bus.fifo.push_back(0xAB);   // Half-written next sample stays in the FIFO
+
+    RingBuffer<ImuRawSample, 64> ring;
+    TEST_ASSERT_EQUAL(25, fifo.drain(ring));
+    TEST_ASSERT_LESS_OR_EQUAL(32, bus.largestRead);
+    TEST_ASSERT_EQUAL_UINT32(13, bus.fifoReads);
+    TEST_ASSERT_EQUAL(1, bus.fifo.size());
+
+    ImuRawSample s = {};
+    for (int16_t n = 0; n < 25; n++) {
+        TEST_ASSERT_TRUE(ring.pop(s));
+        ImuRawSample expected = numbered(n);
+        TEST_ASSERT_EQUAL_MEMORY(&expected, &s, sizeof(s));
+    }
+    TEST_ASSERT_FALSE(ring.pop(s));
+}
+
+void test_drain_uses_large_bursts_when_the_bus_allows() {
+    FakeMpuBus bus;
+    bus.readLimit = 128;
+    Fifo fifo(bus);
+    fifo.begin(1000, 1);
+
+    for (int16_t n = 0; n < 40; n++) {
+        bus.sample(numbered(n));
+    }
+    RingBuffer<ImuRawSample, 64> ring;
+    TEST_ASSERT_EQUAL(40, fifo.drain(ring));
+    TEST_ASSERT_EQUAL_UINT32(4, bus.fifoReads);   // MAX_BURST_SAMPLES per read
+    TEST_ASSERT_EQUAL(Fifo::MAX_BURST_SAMPLES * Fifo::BYTES_PER_SAMPLE, bus.largestRead);
+}
+
+void test_full_fifo_is_reset_and_counted() {
+    FakeMpuBus bus;
+    Fifo fifo(bus);
+    fifo.begin(500, 3);
+
+    for (int16_t n = 0; n < 100; n++) {   // 1200 bytes into a 1024 byte FIFO
+        bus.sample(numbered(n));
+    }
+    RingBuffer<ImuRawSample, 128> ring;
+    TEST_ASSERT_EQUAL(0, fifo.drain(ring));
+    TEST_ASSERT_EQUAL_UINT32(1, fifo.getOverflowCount());
+    TEST_ASSERT_EQUAL(0, bus.fifo.size());
+    TEST_ASSERT_EQUAL_HEX8(Fifo::USER_CTRL_FIFO_EN, bus.reg(Fifo::REG_USER_CTRL));
+
+    // Aligned again from the next sample on
+    bus.sample(numbered(7));
+    TEST_ASSERT_EQUAL(1, fifo.drain(ring));
+    ImuRawSample s = {};
+    ring.pop(s);
+    TEST_ASSERT_EQUAL_INT16(7, s.ax);
+}
+
+void test_full_ring_drops_and_reports_pushed() {
+    FakeMpuBus bus;
+    Fifo fifo(bus);
+    fifo.begin(500, 3);
+
+    for (int16_t n = 0; n < 20; n++) {
+        bus.sample(numbered(n));
+    }
+    RingBuffer<ImuRawSample, 16> ring;
+    size_t pushed = fifo.drain(ring);
+    TEST_ASSERT_EQUAL(ring.size(), pushed);
+    TEST_ASSERT_EQUAL_UINT32(20 - pushed, ring.getDropped());
+    TEST_ASSERT_EQUAL(0, bus.fifo.size());   // Still read out, the FIFO stays aligned
+}
+
+void test_stopped_fifo_is_not_read_and_restarts_clean() {
+    FakeMpuBus bus;
+    Fifo fifo(bus);
+    RingBuffer<ImuRawSample, 16> ring;
+    TEST_ASSERT_FALSE(fifo.start());   // Never configured
+
+    fifo.begin(500, 3);
+    bus.sample(numbered(1));
+    fifo.stop();
+    TEST_ASSERT_FALSE(fifo.isRunning());
+    bus.sample(numbered(2));   // FIFO disabled, not written
+    TEST_ASSERT_EQUAL(0, fifo.drain(ring));
+
+    TEST_ASSERT_TRUE(fifo.start());
+    TEST_ASSERT_EQUAL(0, bus.fifo.size());   // Stale sample discarded
+    bus.sample(numbered(3));
+    TEST_ASSERT_EQUAL(1, fifo.drain(ring));
+}
+
+void test_direct_reads_and_bus_errors() {
+    FakeMpuBus bus;
+    Fifo fifo(bus);
+    const uint8_t output[14] = { 0x10, 0x00, 0xF0, 0x00, 0x00, 0x01,   // accel
+                                 0xFE, 0x0C,                           // temperature
+                                 0x00, 0x83, 0xFF, 0x7D, 0x7F, 0xFF }; // gyro
+    for (uint8_t i = 0; i < 14; i++) {
+        bus.registers[Fifo::REG_ACCEL_XOUT_H + i] = output[i];
+    }
+
+    ImuRawSample s = {};
+    int16_t temperature = 0;
+    TEST_ASSERT_TRUE(fifo.readSample(s, temperature));
+    TEST_ASSERT_EQUAL_INT16(4096, s.ax);
+    TEST_ASSERT_EQUAL_INT16(-4096, s.ay);
+    TEST_ASSERT_EQUAL_INT16(1, s.az);
+    TEST_ASSERT_EQUAL_INT16(-500, temperature);
+    TEST_ASSERT_EQUAL_INT16(131, s.gx);
+    TEST_ASSERT_EQUAL_INT16(-131, s.gy);
+    TEST_ASSERT_EQUAL_INT16(32767, s.gz);
+
+    temperature = 0;
+    TEST_ASSERT_TRUE(fifo.readTemperature(temperature));
+    TEST_ASSERT_EQUAL_INT16(-500, temperature);
+
+    bus.failing = true;
+    TEST_ASSERT_FALSE(fifo.readSample(s, temperature));
+    TEST_ASSERT_FALSE(fifo.begin(500, 3));
+    RingBuffer<ImuRawSample, 16> ring;
+    TEST_ASSERT_EQUAL(0, fifo.drain(ring));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_configures_rate_filter_and_fifo);
+    RUN_TEST(test_drain_keeps_order_and_bursts_within_the_bus_limit);
+    RUN_TEST(test_drain_uses_large_bursts_when_the_bus_allows);
+    RUN_TEST(test_full_fifo_is_reset_and_counted);
+    RUN_TEST(test_full_ring_drops_and_reports_pushed);
+    RUN_TEST(test_stopped_fifo_is_not_read_and_restarts_clean);
+    RUN_TEST(test_direct_reads_and_bus_errors);
+    return UNITY_END();
+}
\ No newline at end of file
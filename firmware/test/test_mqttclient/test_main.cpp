@@ -0,0 +1,527 @@
+// MQTT client: packets as the broker sees them, acks, split and
+// oversized input, keep-alive, against an in-process fake broker; and the
+// same client against a real broker when MQTT_TEST_BROKER=host:port is set.
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mqttclient.h"
+
+namespace {
+
+struct Packet {
+    uint8_t type;
+    uint8_t flags;
+    std::vector<uint8_t> body;
+
+    uint16_t word(size_t at) const { return (uint16_t)((body[at] << 8) | body[at + 1]); }
+    std::string text(size_t at) const { return std::string(body.begin() + at + 2, body.begin() + at + 2 + word(at)); }
+};
+
+std::vector<uint8_t> encodeLength(size_t length) {
+    std::vector<uint8_t> bytes;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        bytes.push_back(digit | (length > 0 ? 0x80 : 0x00));
+    } while (length > 0);
+    return bytes;
+}
+
+std::vector<uint8_t> packet(uint8_t header, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> bytes(1, header);
+    std::vector<uint8_t> length = encodeLength(body.size());
+    bytes.insert(bytes.end(), length.begin(), length.end());
+    bytes.insert(bytes.end(), body.begin(), body.end());
+    return bytes;
+}
+
+std::vector<uint8_t> publishPacket(const std::string& topic, const std::string& payload, uint8_t qos,
+                                   uint16_t id, bool retain) {
+    std::vector<uint8_t> body = { (uint8_t)(topic.size() >> 8), (uint8_t)topic.size() };
+    body.insert(body.end(), topic.begin(), topic.end());
+    if (qos > 0) {
+        body.push_back(id >> 8);
+        body.push_back(id & 0xFF);
+    }
+    body.insert(body.end(), payload.begin(), payload.end());
+    return packet(0x30 | (qos << 1) | (retain ? 1 : 0), body);
+}
+
+/**
+ * The client's socket, with the broker end in the test: what the client
+ * writes is split into packets and handed to respond(), what the broker
+ * queues is read back at most readLimit bytes at a time.
+ */
+struct FakeBrokerSocket {
+    std::function<void(const Packet&)> respond;
+    std::vector<Packet> packets;      // Everything the client sent
+    std::vector<uint8_t> sent;
+    size_t parsed = 0;
+    std::deque<uint8_t> inbox;
+    size_t readLimit = 1 << 20;
+    bool open = false;
+    bool refuse = false;
+    uint32_t stops = 0;
+
+    void queue(const std::vector<uint8_t>& bytes) { inbox.insert(inbox.end(), bytes.begin(), bytes.end()); }
+
+    bool connect(const char*, uint16_t) {
+        open = !refuse;
+        return open;
+    }
+
+    size_t write(const uint8_t* data, size_t length) {
+        if (!open) return 0;
+        sent.insert(sent.end(), data, data + length);
+        while (true) {
+            size_t at = parsed + 1, remaining = 0, shift = 0;
+            while (at < sent.size() && (sent[at] & 0x80)) {
+                remaining |= (size_t)(sent[at++] & 0x7F) << shift;
+                shift += 7;
+            }
+            if (at >= sent.size()) break;
+            remaining |= (size_t)(sent[at++] & 0x7F) << shift;
+            if (sent.size() - at < remaining) break;
+
+            Packet p{ (uint8_t)(sent[parsed] >> 4), (uint8_t)(sent[parsed] & 0x0F),
+                      std::vector<uint8_t>(sent.begin() + at, sent.begin() + at + remaining) };
+            parsed = at + remaining;
+            packets.push_back(p);
+            if (respond) respond(p);
+        }
+        return length;
+    }
+
+    int available() { return (int)inbox.size(); }
+
+    int read(uint8_t* buffer, size_t length) {
+        size_t n = std::min(std::min(length, readLimit), inbox.size());
+        for (size_t i = 0; i < n; i++) {
+            buffer[i] = inbox.front();
+            inbox.pop_front();
+        }
+        return (int)n;
+    }
+
+    bool connected() { return open; }
+
+    void stop() {
+        open = false;
+        stops++;
+    }
+
+    const Packet* last(uint8_t type) const {
+        for (size_t i = packets.size(); i > 0; i--) {
+            if (packets[i - 1].type == type) return &packets[i - 1];
+        }
+        return nullptr;
+    }
+};
+
+// Simulated time: waiting for an ack moves it on
+struct FakePlatform {
+    uint32_t now = 1000;
+    uint32_t millis() { return now; }
+    void delay(uint32_t ms) { now += ms; }
+};
+
+struct Inbox {
+    std::vector<std::string> topics;
+    std::vector<std::string> payloads;
+    std::vector<bool> retained;
+
+    void onMessage(const char* topic, size_t topicLength, const uint8_t* payload, size_t length, bool isRetained) {
+        topics.push_back(std::string(topic, topicLength));
+        payloads.push_back(std::string((const char*)payload, length));
+        retained.push_back(isRetained);
+    }
+};
+
+const size_t MAX_PACKET = 256;
+typedef MqttClient<FakeBrokerSocket, FakePlatform, Inbox, MAX_PACKET> Client;
+
+const uint32_t ACK_TIMEOUT_MS = 2000;
+
+Client::Options deviceOptions() {
+    return Client::Options{ "dev1", "user", "secret", 60, false, "r/dev1/status", "offline", true, ACK_TIMEOUT_MS };
+}
+
+// A broker that accepts the session and acknowledges everything
+void acknowledgeAll(FakeBrokerSocket& socket, bool sessionPresent = false) {
+    socket.respond = [&socket, sessionPresent](const Packet& p) {
+        if (p.type == 1) socket.queue({ 0x20, 0x02, (uint8_t)(sessionPresent ? 1 : 0), 0x00 });
+        if (p.type == 3 && (p.flags & 0x06)) {
+            size_t at = 2 + p.word(0);
+            socket.queue({ 0x40, 0x02, p.body[at], p.body[at + 1] });
+        }
+        if (p.type == 8) socket.queue({ 0x90, 0x03, p.body[0], p.body[1], p.body.back() });
+        if (p.type == 12) socket.queue({ 0xD0, 0x00 });
+    };
+}
+
+FakeBrokerSocket* broker = nullptr;
+FakePlatform* platform = nullptr;
+Inbox* inbox = nullptr;
+Client* client = nullptr;
+
+}  // namespace
+
+void setUp() {
+    broker = new FakeBrokerSocket();
+    platform = new FakePlatform();
+    inbox = new Inbox();
+    client = new Client(*broker, *platform, *inbox);
+}
+
+void tearDown() {
+    delete client;
+    delete inbox;
+    delete platform;
+    delete broker;
+}
+
+void test_connect_encodes_will_credentials_and_session() {
+    acknowledgeAll(*broker, true);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+    TEST_ASSERT_TRUE(client->isSessionPresent());
+    TEST_ASSERT_EQUAL_UINT32(1, client->getStats().connects);
+
+    const Packet& p = broker->packets.at(0);
+    TEST_ASSERT_EQUAL_UINT8(1, p.type);
+    TEST_ASSERT_EQUAL_STRING("MQTT", p.text(0).c_str());
+    TEST_ASSERT_EQUAL_UINT8(4, p.body[6]);                        // 3.1.1
+    TEST_ASSERT_EQUAL_HEX8(0x80 | 0x40 | 0x20 | 0x08 | 0x04, p.body[7]);  // No clean session, retained QoS 1 will
+    TEST_ASSERT_EQUAL_UINT16(60, p.word(8));
+    size_t at = 10;
+    const char* fields[] = { "dev1", "r/dev1/status", "offline", "user", "secret" };
+    for (const char* field : fields) {
+        TEST_ASSERT_EQUAL_STRING(field, p.text(at).c_str());
+        at += 2 + p.word(at);
+    }
+    TEST_ASSERT_EQUAL_UINT32(p.body.size(), at);
+}
+
+void test_refused_connect_closes_the_socket() {
+    broker->respond = [](const Packet& p) {
+        if (p.type == 1) broker->queue({ 0x20, 0x02, 0x00, 0x05 });  // Not authorized
+    };
+    TEST_ASSERT_FALSE(client->connect("broker", 1883, deviceOptions()));
+    TEST_ASSERT_FALSE(client->connected());
+    TEST_ASSERT_EQUAL_UINT32(1, broker->stops);
+    TEST_ASSERT_EQUAL_UINT32(0, client->getStats().connects);
+
+    broker->refuse = true;
+    TEST_ASSERT_FALSE(client->connect("broker", 1883, deviceOptions()));
+}
+
+void test_publish_waits_for_the_matching_puback() {
+    acknowledgeAll(*broker);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+
+    // Another id first: not the ack being waited for
+    broker->respond = [](const Packet& p) {
+        if (p.type != 3) return;
+        size_t at = 2 + p.word(0);
+        broker->queue({ 0x40, 0x02, 0x7F, 0x7F });
+        platform->now += 40;
+        broker->queue({ 0x40, 0x02, p.body[at], p.body[at + 1] });
+    };
+    const char* json = "{\"t\":21.5}";
+    TEST_ASSERT_TRUE(client->publish("r/dev1/current", (const uint8_t*)json, strlen(json), 1, true));
+
+    const Packet* p = broker->last(3);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_HEX8(0x03, p->flags);  // QoS 1, retain
+    TEST_ASSERT_EQUAL_STRING("r/dev1/current", p->text(0).c_str());
+    size_t at = 2 + p->word(0);
+    TEST_ASSERT_NOT_EQUAL(0, p->word(at));
+    TEST_ASSERT_EQUAL_STRING(json, std::string(p->body.begin() + at + 2, p->body.end()).c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, client->getStats().acked);
+    TEST_ASSERT_EQUAL_UINT32(40, client->getStats().lastAckMs);
+
+    // QoS 0 goes out without an id and without waiting
+    broker->respond = nullptr;
+    TEST_ASSERT_TRUE(client->publish("r/dev1/live", (const uint8_t*)"1", 1, 0, false));
+    TEST_ASSERT_EQUAL_HEX8(0x00, broker->last(3)->flags);
+    TEST_ASSERT_EQUAL_UINT32(2 + 11 + 1, broker->last(3)->body.size());
+}
+
+void test_unacknowledged_publish_times_out_and_closes() {
+    acknowledgeAll(*broker);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+    broker->respond = nullptr;
+
+    uint32_t start = platform->now;
+    TEST_ASSERT_FALSE(client->publish("r/dev1/current", (const uint8_t*)"{}", 2, 1, false));
+    TEST_ASSERT_GREATER_OR_EQUAL(ACK_TIMEOUT_MS, platform->now - start);
+    TEST_ASSERT_FALSE(client->connected());
+    TEST_ASSERT_EQUAL_UINT32(1, client->getStats().failures);
+}
+
+void test_streamed_publish_encodes_long_lengths() {
+    acknowledgeAll(*broker);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+
+    // 127 / 128 and 16383 / 16384 are where the length grows a byte
+    const size_t sizes[] = { 100, 111, 112, 3000, 16368, 16369, 70000 };
+    for (size_t size : sizes) {
+        std::string body(size, 'x');
+        for (size_t i = 0; i < size; i++) body[i] = 'a' + i % 26;
+        size_t before = broker->sent.size();
+
+        TEST_ASSERT_TRUE(client->beginPublish("r/dev1/batch", size, 1, false));
+        for (size_t i = 0; i < size; i += 700) {
+            TEST_ASSERT_TRUE(client->write((const uint8_t*)body.data() + i, std::min<size_t>(700, size - i)));
+        }
+        TEST_ASSERT_TRUE(client->endPublish());
+
+        size_t remaining = 2 + strlen("r/dev1/batch") + 2 + size;
+        TEST_ASSERT_EQUAL_UINT32(1 + encodeLength(remaining).size() + remaining, broker->sent.size() - before);
+        const Packet* p = broker->last(3);
+        TEST_ASSERT_EQUAL_UINT32(remaining, p->body.size());
+        TEST_ASSERT_TRUE(std::equal(body.begin(), body.end(), p->body.begin() + 2 + 12 + 2));
+    }
+
+    // Short of the announced length: the stream is lost, so is the connection
+    TEST_ASSERT_TRUE(client->beginPublish("r/dev1/batch", 10, 1, false));
+    TEST_ASSERT_TRUE(client->write((const uint8_t*)"abc", 3));
+    TEST_ASSERT_FALSE(client->write((const uint8_t*)"0123456789", 10));
+    TEST_ASSERT_FALSE(client->endPublish());
+    TEST_ASSERT_FALSE(client->connected());
+}
+
+void test_subscribe_granted_and_refused() {
+    acknowledgeAll(*broker);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+    TEST_ASSERT_TRUE(client->subscribe("r/dev1/config/#", 1));
+
+    const Packet* p = broker->last(8);
+    TEST_ASSERT_EQUAL_HEX8(0x02, p->flags);
+    TEST_ASSERT_EQUAL_STRING("r/dev1/config/#", p->text(2).c_str());
+    TEST_ASSERT_EQUAL_UINT8(1, p->body.back());
+
+    broker->respond = [](const Packet& p) {
+        if (p.type == 8) broker->queue({ 0x90, 0x03, p.body[0], p.body[1], 0x80 });
+    };
+    TEST_ASSERT_FALSE(client->subscribe("r/other/#", 1));
+    TEST_ASSERT_EQUAL_UINT32(1, client->getStats().failures);
+}
+
+void test_incoming_messages_split_acked_and_oversized() {
+    acknowledgeAll(*broker);
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, deviceOptions()));
+
+    // One byte per read, a retained QoS 1 message then a QoS 0 one
+    broker->readLimit = 1;
+    broker->queue(publishPacket("r/dev1/config/thresholds", "{\"temperature\":{\"max\":30}}", 1, 0x1234, true));
+    broker->queue(publishPacket("r/dev1/config/assignedParcelId", "\"P1\"", 0, 0, false));
+    client->loop();
+    TEST_ASSERT_EQUAL_UINT32(2, inbox->topics.size());
+    TEST_ASSERT_EQUAL_STRING("r/dev1/config/thresholds", inbox->topics[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"temperature\":{\"max\":30}}", inbox->payloads[0].c_str());
+    TEST_ASSERT_TRUE(inbox->retained[0]);
+    TEST_ASSERT_EQUAL_STRING("\"P1\"", inbox->payloads[1].c_str());
+    TEST_ASSERT_FALSE(inbox->retained[1]);
+
+    const Packet* ack = broker->last(4);
+    TEST_ASSERT_NOT_NULL(ack);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, ack->word(0));
+
+    // Too big to keep: acked so the broker stops resending, not delivered,
+    // and the message behind it still comes through
+    broker->readLimit = 1 << 20;
+    broker->queue(publishPacket("r/dev1/config/big", std::string(MAX_PACKET * 2, 'y'), 1, 0x0042, false));
+    broker->queue(publishPacket("r/dev1/config/assignedParcelId", "\"P2\"", 0, 0, false));
+    client->loop();
+    TEST_ASSERT_EQUAL_UINT32(1, client->getStats().oversized);
+    TEST_ASSERT_EQUAL_UINT16(0x0042, broker->last(4)->word(0));
+    TEST_ASSERT_EQUAL_UINT32(3, inbox->topics.size());
+    TEST_ASSERT_EQUAL_STRING("\"P2\"", inbox->payloads[2].c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, client->getStats().received);
+}
+
+void test_keep_alive_ping_and_missing_pingresp() {
+    acknowledgeAll(*broker);
+    Client::Options options = deviceOptions();
+    options.keepAliveSec = 4;
+    TEST_ASSERT_TRUE(client->connect("broker", 1883, options));
+
+    // Idle for 3/4 of the keep-alive: PINGREQ, answered
+    platform->now += 2999;
+    client->loop();
+    TEST_ASSERT_NULL(broker->last(12));
+    platform->now += 1;
+    client->loop();
+    TEST_ASSERT_NOT_NULL(broker->last(12));
+    client->loop();
+    TEST_ASSERT_TRUE(client->connected());
+
+    // Broker gone silent: the next ping goes unanswered
+    broker->respond = nullptr;
+    size_t pings = broker->packets.size();
+    platform->now += 3000;
+    client->loop();
+    TEST_ASSERT_GREATER_THAN(pings, broker->packets.size());
+    platform->now += ACK_TIMEOUT_MS;
+    client->loop();
+    TEST_ASSERT_FALSE(client->connected());
+}
+
+// ---------------------------------------------------------------------------
+// Real broker: MQTT_TEST_BROKER=host:port pio test -e native -f test_mqttclient
+// ---------------------------------------------------------------------------
+namespace {
+
+struct PosixSocket {
+    int fd = -1;
+
+    bool connect(const char* host, uint16_t port) {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host, std::to_string(port).c_str(), &hints, &found) != 0) return false;
+        for (addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+            fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(found);
+        return fd >= 0;
+    }
+
+    size_t write(const uint8_t* data, size_t length) {
+        ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        return n < 0 ? 0 : (size_t)n;
+    }
+
+    int available() {
+        int n = 0;
+        return fd >= 0 && ioctl(fd, FIONREAD, &n) == 0 ? n : 0;
+    }
+
+    int read(uint8_t* buffer, size_t length) { return (int)::recv(fd, buffer, length, 0); }
+
+    bool connected() {
+        char c;
+        return fd >= 0 && ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 0;
+    }
+
+    void stop() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+};
+
+struct SteadyPlatform {
+    uint32_t millis() {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+};
+
+typedef MqttClient<PosixSocket, SteadyPlatform, Inbox, MAX_PACKET> BrokerClient;
+
+void pumpFor(BrokerClient& client, SteadyPlatform& platform, uint32_t ms) {
+    for (uint32_t start = platform.millis(); platform.millis() - start < ms; platform.delay(10)) {
+        client.loop();
+    }
+}
+
+}  // namespace
+
+void test_against_a_real_broker() {
+    const char* broker = getenv("MQTT_TEST_BROKER");
+    if (!broker || !*broker) {
+        TEST_IGNORE_MESSAGE("MQTT_TEST_BROKER=host:port not set");
+    }
+    std::string host(broker);
+    size_t colon = host.rfind(':');
+    uint16_t port = colon == std::string::npos ? 1883 : (uint16_t)atoi(host.c_str() + colon + 1);
+    host = host.substr(0, colon);
+
+    // Unique names, the broker may be shared
+    std::string id = "traceon-test-" + std::to_string(getpid());
+    std::string root = "traceon-test/" + std::to_string(getpid());
+    std::string config = root + "/config/thresholds";
+
+    SteadyPlatform platform;
+    PosixSocket dashboardSocket, deviceSocket;
+    Inbox dashboardInbox, deviceInbox;
+    BrokerClient dashboard(dashboardSocket, platform, dashboardInbox);
+    BrokerClient device(deviceSocket, platform, deviceInbox);
+    std::string dashboardId = id + "-dash";
+    std::string deviceId = id + "-dev";
+    BrokerClient::Options dashboardOptions{ dashboardId.c_str(), nullptr, nullptr, 30, true,
+                                            nullptr, nullptr, false, 5000 };
+    std::string status = root + "/status";
+    BrokerClient::Options deviceOptions{ deviceId.c_str(), nullptr, nullptr, 30, false,
+                                         status.c_str(), "offline", false, 5000 };
+
+    // A retained config message reaches a later subscriber
+    const char* thresholds = "{\"temperature\":{\"max\":30}}";
+    TEST_ASSERT_TRUE(dashboard.connect(host.c_str(), port, dashboardOptions));
+    TEST_ASSERT_TRUE(dashboard.publish(config.c_str(), (const uint8_t*)thresholds, strlen(thresholds), 1, true));
+    TEST_ASSERT_TRUE(device.connect(host.c_str(), port, deviceOptions));
+    TEST_ASSERT_TRUE(device.subscribe((root + "/config/#").c_str(), 1));
+    pumpFor(device, platform, 500);
+    TEST_ASSERT_EQUAL_UINT32(1, deviceInbox.payloads.size());
+    TEST_ASSERT_EQUAL_STRING(thresholds, deviceInbox.payloads[0].c_str());
+    TEST_ASSERT_TRUE(deviceInbox.retained[0]);
+
+    // A streamed QoS 1 publish is acknowledged
+    std::string batch(3000, 'x');
+    TEST_ASSERT_TRUE(device.beginPublish((root + "/batch").c_str(), batch.size(), 1, false));
+    for (size_t i = 0; i < batch.size(); i += 700) {
+        TEST_ASSERT_TRUE(device.write((const uint8_t*)batch.data() + i, std::min<size_t>(700, batch.size() - i)));
+    }
+    TEST_ASSERT_TRUE(device.endPublish());
+
+    // Offline, the persistent session keeps a QoS 1 message for the device
+    device.disconnect();
+    const char* parcel = "\"P1\"";
+    std::string assigned = root + "/config/assignedParcelId";
+    TEST_ASSERT_TRUE(dashboard.publish(assigned.c_str(), (const uint8_t*)parcel, strlen(parcel), 1, false));
+    TEST_ASSERT_TRUE(device.connect(host.c_str(), port, deviceOptions));
+    TEST_ASSERT_TRUE(device.isSessionPresent());
+    pumpFor(device, platform, 500);
+    TEST_ASSERT_EQUAL_STRING(parcel, deviceInbox.payloads.back().c_str());
+
+    // Leave nothing behind: clear the retained message and the session
+    TEST_ASSERT_TRUE(dashboard.publish(config.c_str(), nullptr, 0, 1, true));
+    device.disconnect();
+    deviceOptions.cleanSession = true;
+    TEST_ASSERT_TRUE(device.connect(host.c_str(), port, deviceOptions));
+    device.disconnect();
+    dashboard.disconnect();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_encodes_will_credentials_and_session);
+    RUN_TEST(test_refused_connect_closes_the_socket);
+    RUN_TEST(test_publish_waits_for_the_matching_puback);
+    RUN_TEST(test_unacknowledged_publish_times_out_and_closes);
+    RUN_TEST(test_streamed_publish_encodes_long_lengths);
+    RUN_TEST(test_subscribe_granted_and_refused);
+    RUN_TEST(test_incoming_messages_split_acked_and_oversized);
+    RUN_TEST(test_keep_alive_ping_and_missing_pingresp);
+    RUN_TEST(test_against_a_real_broker);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+// Offline record log: append / next / commit, wrap when the ring
+// is full, and remount after power loss mid-append, mid-commit and mid
+// sector header, on a file-backed NOR flash.
+#include <unity.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "recordlog.h"
+
+namespace {
+
+/**
+ * NOR flash in a temporary file: writes only clear bits, erases set a
+ * whole sector back to 0xFF. A write can be torn after `budget` bytes,
+ * the byte it stops in is left half programmed.
+ */
+struct FileFlash {
+    static const uint32_t SECTOR = 4096;
+
+    FILE* file;
+    uint32_t bytes;
+    long budget;          // Bytes still written before power is lost, -1: no loss
+    uint32_t erases;
+
+    explicit FileFlash(uint32_t sectors) : file(tmpfile()), bytes(sectors * SECTOR), budget(-1), erases(0) {
+        std::vector<uint8_t> erased(bytes, 0xFF);
+        fwrite(erased.data(), 1, erased.size(), file);
+        fflush(file);
+    }
+    ~FileFlash() { fclose(file); }
+
+    uint32_t size() { return bytes; }
+
+    bool read(uint32_t offset, void* data, size_t length) {
+        if (offset + length > bytes) return false;
+        fseek(file, offset, SEEK_SET);
+        return fread(data, 1, length, file) == length;
+    }
+
+    bool write(uint32_t offset, const void* data, size_t length) {
+        std::vector<uint8_t> cells(length);
+        if (!read(offset, cells.data(), length)) return false;
+
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        size_t written = length;
+        if (budget >= 0 && (long)length > budget) {
+            written = budget;
+        }
+        for (size_t i = 0; i < written; i++) {
+            cells[i] &= in[i];
+        }
+        if (written < length) {
+            cells[written] &= in[written] | 0x0F;  // Power lost mid-byte
+            budget = 0;
+        } else if (budget >= 0) {
+            budget -= written;
+        }
+
+        fseek(file, offset, SEEK_SET);
+        fwrite(cells.data(), 1, length, file);
+        fflush(file);
+        return written == length;
+    }
+
+    bool eraseSector(uint32_t offset) {
+        erases++;
+        std::vector<uint8_t> erased(SECTOR, 0xFF);
+        fseek(file, offset, SEEK_SET);
+        fwrite(erased.data(), 1, erased.size(), file);
+        fflush(file);
+        return true;
+    }
+
+    // Erase count in the header of one sector (magic, sequence, erases, crc)
+    uint32_t sectorErases(uint32_t sector) {
+        uint32_t header[4];
+        read(sector * SECTOR, header, sizeof(header));
+        return header[2];
+    }
+};
+
+typedef RecordLog<FileFlash> Log;
+
+const uint32_t SECTORS = 8;
+
+FileFlash* flash = nullptr;
+
+std::string payload(int i) {
+    return "{\"i\":" + std::to_string(i) + ",\"pad\":\"" + std::string(300 + i % 50, 'x') + "\"}";
+}
+
+void appendRange(Log& log, int from, int to) {
+    for (int i = from; i < to; i++) {
+        std::string text = payload(i);
+        TEST_ASSERT_TRUE(log.append(1, i, text.data(), text.size()));
+    }
+}
+
+// Reads up to `limit` records from the oldest pending on, checking each is
+// payload(first + n); returns how many were read
+int readFrom(Log& log, int first, int limit) {
+    static char buffer[Log::MAX_PAYLOAD];
+    Log::Record record;
+    int n = 0;
+    log.rewind();
+    while (n < limit && log.next(record, buffer, sizeof(buffer))) {
+        TEST_ASSERT_EQUAL_UINT64(first + n, record.timestampMs);
+        std::string expected = payload(first + n);
+        std::string actual(buffer, record.length);
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), actual.c_str());
+        n++;
+    }
+    return n;
+}
+
+}  // namespace
+
+void setUp() { flash = new FileFlash(SECTORS); }
+void tearDown() { delete flash; }
+
+void test_append_next_commit_and_replay_after_remount() {
+    {
+        Log log(*flash);
+        TEST_ASSERT_TRUE(log.mount());
+        TEST_ASSERT_EQUAL_UINT32(SECTORS, log.getSectorCount());
+        appendRange(log, 0, 30);
+        TEST_ASSERT_EQUAL_UINT32(30, log.getPendingCount());
+
+        TEST_ASSERT_EQUAL(10, readFrom(log, 0, 10));
+        TEST_ASSERT_TRUE(log.commit());
+        TEST_ASSERT_EQUAL_UINT32(20, log.getPendingCount());
+        TEST_ASSERT_EQUAL_UINT32(10, log.getStats().replayed);
+
+        TEST_ASSERT_EQUAL(5, readFrom(log, 10, 5));  // Delivered, power lost before commit
+    }
+
+    // At least once: the uncommitted batch comes back
+    Log log(*flash);
+    TEST_ASSERT_TRUE(log.mount());
+    TEST_ASSERT_EQUAL_UINT32(20, log.getPendingCount());
+    TEST_ASSERT_EQUAL(20, readFrom(log, 10, 100));
+    TEST_ASSERT_TRUE(log.commit());
+    TEST_ASSERT_EQUAL_UINT32(0, log.getPendingCount());
+
+    Log again(*flash);
+    TEST_ASSERT_TRUE(again.mount());
+    TEST_ASSERT_EQUAL_UINT32(0, again.getPendingCount());
+    TEST_ASSERT_EQUAL(0, readFrom(again, 30, 100));
+}
+
+void test_wraps_when_full_and_levels_wear() {
+    const int COUNT = 200;  // About eighteen sectors' worth on an eight sector ring
+    Log log(*flash);
+    TEST_ASSERT_TRUE(log.mount());
+    appendRange(log, 0, COUNT);
+
+    // The oldest sectors were given up whole, the newest records survive in order
+    uint32_t pending = log.getPendingCount();
+    TEST_ASSERT_LESS_THAN(COUNT, pending);
+    TEST_ASSERT_GREATER_THAN(COUNT / 4, pending);  // Seven sectors or more are kept
+    TEST_ASSERT_EQUAL_UINT32(COUNT - pending, log.getStats().lost);
+    TEST_ASSERT_EQUAL((int)pending, readFrom(log, COUNT - pending, COUNT));
+
+    uint32_t least = 0xFFFFFFFF, most = 0;
+    for (uint32_t s = 0; s < SECTORS; s++) {
+        uint32_t erases = flash->sectorErases(s);
+        least = erases < least ? erases : least;
+        most = erases > most ? erases : most;
+    }
+    TEST_ASSERT_GREATER_THAN(0, least);
+    TEST_ASSERT_LESS_OR_EQUAL(least + 1, most);
+    TEST_ASSERT_EQUAL_UINT32(most, log.getStats().maxSectorErases);
+
+    Log remounted(*flash);
+    TEST_ASSERT_TRUE(remounted.mount());
+    TEST_ASSERT_EQUAL_UINT32(pending, remounted.getPendingCount());
+    TEST_ASSERT_EQUAL((int)pending, readFrom(remounted, COUNT - pending, COUNT));
+}
+
+void test_remount_after_torn_append() {
+    {
+        Log log(*flash);
+        TEST_ASSERT_TRUE(log.mount());
+        appendRange(log, 0, 5);
+
+        std::string text = payload(5);
+        flash->budget = 50;  // Header and part of the payload reach the flash
+        TEST_ASSERT_FALSE(log.append(1, 5, text.data(), text.size()));
+        flash->budget = -1;
+    }
+
+    Log log(*flash);
+    TEST_ASSERT_TRUE(log.mount());
+    TEST_ASSERT_EQUAL_UINT32(5, log.getPendingCount());
+    TEST_ASSERT_EQUAL_UINT32(1, log.getStats().corrupt);
+
+    // Appends continue in a fresh sector, nothing is written over the torn bytes
+    appendRange(log, 5, 10);
+    TEST_ASSERT_EQUAL_UINT32(10, log.getPendingCount());
+    TEST_ASSERT_EQUAL(10, readFrom(log, 0, 100));
+    TEST_ASSERT_TRUE(log.commit());
+
+    Log remounted(*flash);
+    TEST_ASSERT_TRUE(remounted.mount());
+    TEST_ASSERT_EQUAL_UINT32(0, remounted.getPendingCount());
+}
+
+void test_remount_after_torn_commit() {
+    {
+        Log log(*flash);
+        TEST_ASSERT_TRUE(log.mount());
+        appendRange(log, 0, 12);
+        TEST_ASSERT_EQUAL(8, readFrom(log, 0, 8));
+
+        flash->budget = 0;  // The state byte is left half cleared
+        TEST_ASSERT_FALSE(log.commit());
+        flash->budget = -1;
+    }
+
+    // Any cleared bit counts: the batch stays consumed
+    Log log(*flash);
+    TEST_ASSERT_TRUE(log.mount());
+    TEST_ASSERT_EQUAL_UINT32(4, log.getPendingCount());
+    TEST_ASSERT_EQUAL(4, readFrom(log, 8, 100));
+
+    // And the log carries on behind it
+    appendRange(log, 12, 20);
+    TEST_ASSERT_EQUAL(12, readFrom(log, 8, 100));
+}
+
+void test_remount_after_torn_sector_header() {
+    // Records that exactly fill the first sector (16 byte sector and record
+    // headers, records padded to 4 bytes)
+    int count = 0;
+    for (uint32_t used = 16; used + ((16 + payload(count).size() + 3) & ~3u) <= FileFlash::SECTOR; count++) {
+        used += (16 + payload(count).size() + 3) & ~3u;
+    }
+
+    {
+        Log log(*flash);
+        TEST_ASSERT_TRUE(log.mount());
+        appendRange(log, 0, count);
+
+        // The next append moves the head on: erase done, header write cut short
+        std::string text = payload(count);
+        flash->budget = 6;
+        TEST_ASSERT_FALSE(log.append(1, count, text.data(), text.size()));
+        flash->budget = -1;
+    }
+
+    // The half-written sector is free, the records before it are intact
+    Log log(*flash);
+    TEST_ASSERT_TRUE(log.mount());
+    TEST_ASSERT_EQUAL_UINT32(count, log.getPendingCount());
+    appendRange(log, count, count + 10);
+    TEST_ASSERT_EQUAL(count + 10, readFrom(log, 0, 100));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_append_next_commit_and_replay_after_remount);
+    RUN_TEST(test_wraps_when_full_and_levels_wear);
+    RUN_TEST(test_remount_after_torn_append);
+    RUN_TEST(test_remount_after_torn_commit);
+    RUN_TEST(test_remount_after_torn_sector_header);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+// Sensor task hand-off: the SPSC RingBuffer and SensorProducer
+// between a producer and a consumer thread - order kept, every record
+// either delivered or counted as dropped, high water mark.
+#include <unity.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ringbuffer.h"
+#include "tripreplay.h"
+
+namespace {
+
+const uint32_t STEP_MS = 10;
+const size_t QUEUE = 8;
+
+typedef SensorProducer<ReplayPipeline, ReplayPlatform, QUEUE> Producer;
+
+// The device pipeline on a replayed trip, stepped like the sensor task
+struct Trip {
+    ImuTrace trace;
+    std::vector<DhtReading> climate;
+    ReplayImu imu;
+    ReplayEnv env;
+    std::unique_ptr<ReplayPipeline> pipeline;
+    std::unique_ptr<Producer> producer;
+
+    Trip()
+        : trace(parcelTripTrace(500)), climate(parcelTripClimate(60)),
+          imu(trace.samples.data(), trace.samples.size(), trace.rateHz, trace.rateHz * STEP_MS / 1000),
+          env(climate.data(), climate.size()),
+          pipeline(new ReplayPipeline(imu, env)) {
+        pipeline->begin(deviceSensorConfig());
+        ReplayPlatform::now() = 1000;
+        producer.reset(new Producer(*pipeline, { SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, VIBRATION_THRESHOLD }));
+    }
+
+    bool step() {
+        if (imu.finished()) return false;
+        ReplayPlatform::now() += STEP_MS;
+        producer->step();
+        return true;
+    }
+};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_ring_buffer_drops_when_full_and_wraps() {
+    RingBuffer<uint32_t, 4> ring;
+    uint32_t item = 0;
+    TEST_ASSERT_FALSE(ring.pop(item));
+
+    for (uint32_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL(i < 4, ring.push(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.getHighWater());
+
+    // Peek leaves the items in place
+    TEST_ASSERT_TRUE(ring.peek(3, item));
+    TEST_ASSERT_EQUAL_UINT32(3, item);
+    TEST_ASSERT_FALSE(ring.peek(4, item));
+
+    // Indices run past the capacity many times over, the order holds
+    uint32_t next = 0, pushed = 4;
+    for (int round = 0; round < 100; round++) {
+        TEST_ASSERT_TRUE(ring.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(next++, item);
+        TEST_ASSERT_TRUE(ring.push(pushed++));
+    }
+    while (ring.pop(item)) {
+        TEST_ASSERT_EQUAL_UINT32(next++, item);
+    }
+    TEST_ASSERT_EQUAL_UINT32(pushed, next);
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.getHighWater());
+}
+
+void test_ring_buffer_between_threads() {
+    const uint32_t COUNT = 1000000;
+    RingBuffer<uint32_t, 16> ring;
+    std::atomic<bool> done(false);
+
+    // No retries: whatever does not fit is dropped and counted
+    std::thread producer([&] {
+        for (uint32_t i = 1; i <= COUNT; i++) {
+            ring.push(i);
+        }
+        done = true;
+    });
+
+    uint32_t received = 0, last = 0, outOfOrder = 0, item;
+    while (!done.load() || !ring.empty()) {
+        while (ring.pop(item)) {
+            if (item <= last) outOfOrder++;
+            last = item;
+            received++;
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(COUNT, received + ring.getDropped());
+    TEST_ASSERT_LESS_OR_EQUAL(16, ring.getHighWater());
+    if (ring.getDropped() > 0) {
+        TEST_ASSERT_EQUAL_UINT32(16, ring.getHighWater());
+    }
+}
+
+void test_stalled_consumer_loses_newest_records_only() {
+    Trip trip;
+    const uint32_t STALL_RECORDS = QUEUE + 5;
+
+    // The network task is stuck in a request
+    while (trip.producer->getStats().records < STALL_RECORDS && trip.step()) {
+    }
+    Producer::Stats stats = trip.producer->getStats();
+    TEST_ASSERT_EQUAL_UINT32(STALL_RECORDS, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(QUEUE, stats.highWater);
+    TEST_ASSERT_EQUAL_UINT32(QUEUE, trip.producer->getQueuedRecords());
+
+    // The queued ones are the oldest, one record interval apart
+    SensorRecord record;
+    uint32_t first = 0, previous = 0, count = 0;
+    while (trip.producer->popRecord(record)) {
+        if (count == 0) {
+            first = record.uptimeMs;
+        } else {
+            TEST_ASSERT_EQUAL_UINT32(SENSOR_UPLOAD_INTERVAL, record.uptimeMs - previous);
+        }
+        previous = record.uptimeMs;
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(QUEUE, count);
+    TEST_ASSERT_EQUAL_UINT32(1000 + SENSOR_UPLOAD_INTERVAL, first);
+
+    // Once it drains, nothing more is lost
+    while (trip.step()) {
+        while (trip.producer->popRecord(record)) {
+            TEST_ASSERT_GREATER_THAN(previous, record.uptimeMs);
+            previous = record.uptimeMs;
+            count++;
+        }
+    }
+    stats = trip.producer->getStats();
+    TEST_ASSERT_EQUAL_UINT32(5, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(stats.records, count + stats.dropped);
+}
+
+void test_producer_and_consumer_threads() {
+    Trip trip;
+    std::atomic<bool> done(false);
+
+    std::thread sensor([&] {
+        while (trip.step()) {
+        }
+        done = true;
+    });
+
+    // A network task that now and then stalls on a slow request
+    uint32_t received = 0, last = 0, outOfOrder = 0, empty = 0;
+    SensorRecord record;
+    while (!done.load() || trip.producer->getQueuedRecords() > 0) {
+        while (trip.producer->popRecord(record)) {
+            if (record.uptimeMs <= last) outOfOrder++;
+            if (record.stats.get(STAT_ACCEL_MAGNITUDE).getCount() == 0) empty++;
+            last = record.uptimeMs;
+            if (++received % 20 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+    sensor.join();
+
+    Producer::Stats stats = trip.producer->getStats();
+    TEST_ASSERT_GREATER_THAN(0, received);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, empty);
+    TEST_ASSERT_EQUAL_UINT32(stats.records, received + stats.dropped);
+    TEST_ASSERT_LESS_OR_EQUAL(QUEUE, stats.highWater);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_buffer_drops_when_full_and_wraps);
+    RUN_TEST(test_ring_buffer_between_threads);
+    RUN_TEST(test_stalled_consumer_loses_newest_records_only);
+    RUN_TEST(test_producer_and_consumer_threads);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+// Live sample seqlock: one writer and several std::thread readers
+// hammering the same value, and SensorProducer::readLive() from another
+// thread while the sensor task replays a parcel trip.
+#include <unity.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "seqlock.h"
+#include "tripreplay.h"
+
+namespace {
+
+// Every field derives from n, so a mix of two publishes is detectable.
+// Odd size on purpose: the last word is partial
+struct Stamped {
+    uint32_t n;
+    float values[37];
+    bool odd;
+    uint8_t tail[3];
+    uint8_t low;
+};
+
+Stamped stamp(uint32_t n) {
+    Stamped value;
+    value.n = n;
+    for (float& v : value.values) v = (float)n;
+    value.odd = n & 1;
+    for (uint8_t& t : value.tail) t = (uint8_t)(n * 3);
+    value.low = (uint8_t)n;
+    return value;
+}
+
+bool isWhole(const Stamped& value) {
+    bool ok = value.odd == (bool)(value.n & 1) && value.low == (uint8_t)value.n;
+    for (float v : value.values) ok = ok && v == (float)value.n;
+    for (uint8_t t : value.tail) ok = ok && t == (uint8_t)(value.n * 3);
+    return ok;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_read_before_and_after_publish() {
+    SeqLock<Stamped> lock;
+    Stamped out = stamp(77);
+    TEST_ASSERT_FALSE(lock.read(out));
+    TEST_ASSERT_EQUAL_UINT32(77, out.n);  // Untouched
+    TEST_ASSERT_FALSE(lock.tryRead(out));
+    TEST_ASSERT_EQUAL_UINT32(0, lock.getVersion());
+
+    lock.publish(stamp(5));
+    lock.publish(stamp(6));
+    TEST_ASSERT_TRUE(lock.read(out));
+    TEST_ASSERT_EQUAL_UINT32(6, out.n);
+    TEST_ASSERT_TRUE(isWhole(out));
+    TEST_ASSERT_TRUE(lock.tryRead(out));
+    TEST_ASSERT_EQUAL_UINT32(2, lock.getVersion());
+}
+
+void test_readers_never_see_a_torn_value() {
+    const uint32_t PUBLISHES = 300000;
+    const int READERS = 3;
+    SeqLock<Stamped> lock;
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> reads(0), torn(0), backwards(0);
+
+    // Readers only count, Unity asserts stay on the main thread
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&] {
+            uint32_t last = 0;
+            Stamped value;
+            while (!stop.load()) {
+                if (!lock.read(value)) continue;
+                if (!isWhole(value)) torn++;
+                if (value.n < last) backwards++;
+                last = value.n;
+                reads++;
+            }
+        });
+    }
+
+    for (uint32_t n = 1; n <= PUBLISHES; n++) {
+        lock.publish(stamp(n));
+    }
+    stop = true;
+    for (std::thread& reader : readers) reader.join();
+
+    TEST_ASSERT_GREATER_THAN(0, reads.load());
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHES, lock.getVersion());
+
+    Stamped last;
+    TEST_ASSERT_TRUE(lock.read(last));
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHES, last.n);
+}
+
+void test_live_reads_during_a_replayed_trip() {
+    const uint32_t STEP_MS = 10;
+    ImuTrace trace = parcelTripTrace(500);
+    std::vector<DhtReading> climate = parcelTripClimate(60);
+    ReplayImu imu(trace.samples.data(), trace.samples.size(), trace.rateHz, trace.rateHz * STEP_MS / 1000);
+    ReplayEnv env(climate.data(), climate.size());
+    std::unique_ptr<ReplayPipeline> pipeline(new ReplayPipeline(imu, env));
+    pipeline->begin(deviceSensorConfig());
+
+    ReplayPlatform::now() = 1000;
+    SensorProducer<ReplayPipeline, ReplayPlatform, 8> producer(
+        *pipeline, { SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, VIBRATION_THRESHOLD });
+
+    // The web server's side: read as fast as possible, check each sample is one capture
+    const float edges[] = VIBRATION_BAND_EDGES_HZ;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> reads(0), inconsistent(0);
+    std::thread web([&] {
+        uint32_t lastMs = 0;
+        LiveSample live;
+        while (!done.load()) {
+            if (!producer.readLive(live)) continue;
+            bool ok = live.uptimeMs >= lastMs;
+            ok = ok && live.heatIndex == (live.envValid ? dhtHeatIndex(live.temperature, live.humidity, false) : 0);
+            for (uint8_t b = 0; b <= live.vibration.bandCount && b <= VIBRATION_MAX_BANDS; b++) {
+                ok = ok && live.bandEdgesHz[b] == edges[b];
+            }
+            if (!ok) inconsistent++;
+            lastMs = live.uptimeMs;
+            reads++;
+        }
+    });
+
+    SensorRecord record;
+    while (!imu.finished()) {
+        ReplayPlatform::now() += STEP_MS;
+        producer.step();
+        while (producer.popRecord(record)) {
+        }
+    }
+    done = true;
+    web.join();
+
+    TEST_ASSERT_GREATER_THAN(0, reads.load());
+    TEST_ASSERT_EQUAL_UINT32(0, inconsistent.load());
+    TEST_ASSERT_GREATER_THAN(0, producer.getLiveVersion());
+
+    LiveSample last;
+    TEST_ASSERT_TRUE(producer.readLive(last));
+    TEST_ASSERT_EQUAL_UINT32(producer.getLastReadMs(), last.uptimeMs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_before_and_after_publish);
+    RUN_TEST(test_readers_never_see_a_torn_value);
+    RUN_TEST(test_live_reads_during_a_replayed_trip);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Shock detector: free fall -> impact on the synthetic trip trace of
+// test/support/imutrace.h at device thresholds - peak g, impact duration, fall time, drop height
+// and axis - no events from carrying or tipping, and the cost per sample.
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "tripreplay.h"
+
+namespace {
+
+const ShockDetector::Config DEVICE = { DROP_FREE_FALL_G, DROP_MIN_FREE_FALL_MS, DROP_IMPACT_G, DROP_IMPACT_END_G,
+                                       DROP_IMPACT_WINDOW_MS };
+const int32_t LSB_PER_G = 4096;  // ±8 g, like the trace
+const float G = 9.80665f;
+
+struct Detected {
+    DropEvent event;
+    size_t at;  // Index of the sample that completed it
+};
+
+std::vector<Detected> detect(const std::vector<ImuRawSample>& samples, uint16_t rateHz) {
+    ShockDetector detector;
+    detector.configure(DEVICE, rateHz, LSB_PER_G);
+    std::vector<Detected> events;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (detector.update(samples[i].ax, samples[i].ay, samples[i].az)) {
+            events.push_back(Detected{ detector.getEvent(), i });
+        }
+    }
+    return events;
+}
+
+// Steady samples of a given acceleration (g), no noise
+void hold(std::vector<ImuRawSample>& samples, float xG, float yG, float zG, size_t count) {
+    ImuRawSample s = {};
+    s.ax = (int16_t)lroundf(xG * LSB_PER_G);
+    s.ay = (int16_t)lroundf(yG * LSB_PER_G);
+    s.az = (int16_t)lroundf(zG * LSB_PER_G);
+    samples.insert(samples.end(), count, s);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_trip_drop_is_one_event() {
+    ImuTrace trace = parcelTripTrace(1000);
+    std::vector<Detected> events = detect(trace.samples, trace.rateHz);
+
+    // Carrying (0.7 - 1.3 g) and tipping over are not drops
+    TEST_ASSERT_EQUAL_UINT32(1, events.size());
+    const DropEvent& drop = events[0].event;
+    TEST_ASSERT_EQUAL_UINT32(trace.impactAt + 30, events[0].at);  // First sample after the 30 ms impact
+
+    // Impact (1.5, 1.0, 5.5) g: |a| = 5.79 g, straight up the Z axis
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, sqrtf(1.5f * 1.5f + 1.0f * 1.0f + 5.5f * 5.5f), drop.peakG);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, drop.impactDurationMs);
+    TEST_ASSERT_EQUAL_FLOAT(350.0f, drop.freeFallMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f * G * 0.35f * 0.35f, drop.dropHeightM);  // 0.60 m
+    TEST_ASSERT_EQUAL('Z', drop.impactAxis);
+    TEST_ASSERT_EQUAL(1, drop.impactSign);
+}
+
+void test_fall_time_and_height_across_rates() {
+    // Table height to a loading dock, at the FIFO rates the device uses
+    const float fallMs[] = { 150, 250, 350, 500 };
+    const uint16_t rates[] = { 250, 500, 1000 };
+    for (uint16_t rate : rates) {
+        for (float ms : fallMs) {
+            ImuTrace trace = parcelTripTrace(rate, ms, rate + (uint32_t)ms);
+            std::vector<Detected> events = detect(trace.samples, rate);
+            TEST_ASSERT_EQUAL_UINT32(1, events.size());
+
+            const DropEvent& drop = events[0].event;
+            float sampleMs = 1000.0f / rate;
+            TEST_ASSERT_FLOAT_WITHIN(sampleMs, ms, drop.freeFallMs);
+            float t = ms / 1000;
+            TEST_ASSERT_FLOAT_WITHIN(G * t * sampleMs / 1000 + 0.001f, 0.5f * G * t * t, drop.dropHeightM);
+            TEST_ASSERT_FLOAT_WITHIN(sampleMs, 30.0f, drop.impactDurationMs);
+            TEST_ASSERT_EQUAL('Z', drop.impactAxis);
+        }
+    }
+}
+
+void test_impact_axis_and_sign() {
+    // Landing on each face: the axis that took the blow, and which way
+    const float faces[][3] = { { -6, 0.5f, 1 }, { 0.5f, 4, -1 }, { 1, -1, -7 } };
+    const char axes[] = { 'X', 'Y', 'Z' };
+    const int8_t signs[] = { -1, 1, -1 };
+    for (int f = 0; f < 3; f++) {
+        std::vector<ImuRawSample> samples;
+        hold(samples, 0, 0, 1, 500);
+        hold(samples, 0.05f, 0, 0.05f, 200);
+        hold(samples, faces[f][0], faces[f][1], faces[f][2], 8);
+        hold(samples, 0, 0, 1, 500);
+
+        std::vector<Detected> events = detect(samples, 1000);
+        TEST_ASSERT_EQUAL_UINT32(1, events.size());
+        TEST_ASSERT_EQUAL(axes[f], events[0].event.impactAxis);
+        TEST_ASSERT_EQUAL(signs[f], events[0].event.impactSign);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, sqrtf(faces[f][0] * faces[f][0] + faces[f][1] * faces[f][1] +
+                                              faces[f][2] * faces[f][2]), events[0].event.peakG);
+    }
+}
+
+void test_near_misses_are_not_drops() {
+    std::vector<ImuRawSample> samples;
+    hold(samples, 0, 0, 1, 500);
+
+    // A dip shorter than DROP_MIN_FREE_FALL_MS, then a knock
+    hold(samples, 0, 0, 0.1f, DROP_MIN_FREE_FALL_MS - 10);
+    hold(samples, 0, 0, 4, 5);
+    hold(samples, 0, 0, 1, 500);
+
+    // A real fall, caught: no impact within the window
+    hold(samples, 0, 0, 0.1f, 300);
+    hold(samples, 0, 0, 1.2f, DROP_IMPACT_WINDOW_MS + 50);
+    hold(samples, 0, 0, 3, 5);
+    hold(samples, 0, 0, 1, 500);
+
+    // A hard knock with no fall before it
+    hold(samples, 0, 0, 5, 10);
+    hold(samples, 0, 0, 1, 500);
+    TEST_ASSERT_EQUAL_UINT32(0, detect(samples, 1000).size());
+
+    // A fall that lands within the window still counts, a few samples late
+    hold(samples, 0, 0, 0.1f, 300);
+    hold(samples, 0, 0, 1.2f, DROP_IMPACT_WINDOW_MS - 10);
+    hold(samples, 0, 0, 3, 5);
+    hold(samples, 0, 0, 1, 500);
+    std::vector<Detected> events = detect(samples, 1000);
+    TEST_ASSERT_EQUAL_UINT32(1, events.size());
+    TEST_ASSERT_EQUAL_FLOAT(300.0f, events[0].event.freeFallMs);
+}
+
+void test_drop_through_the_sensor_pipeline() {
+    ImuTrace trace = parcelTripTrace(1000);
+    std::vector<ReplayDrop> drops;
+    replayTrip(trace, parcelTripClimate(60), &drops);
+
+    // The same event as the detector on its own
+    TEST_ASSERT_EQUAL_UINT32(1, drops.size());
+    std::vector<Detected> events = detect(trace.samples, trace.rateHz);
+    const DropEvent& drop = drops[0].event;
+    TEST_ASSERT_EQUAL_FLOAT(events[0].event.peakG, drop.peakG);
+    TEST_ASSERT_EQUAL_FLOAT(events[0].event.freeFallMs, drop.freeFallMs);
+    TEST_ASSERT_EQUAL_FLOAT(events[0].event.dropHeightM, drop.dropHeightM);
+
+    // Dated within the read interval that consumed the impact samples
+    uint32_t readUs = drops[0].takenMs * 1000;
+    TEST_ASSERT_GREATER_THAN_UINT32(readUs - SENSOR_READ_INTERVAL * 1000, (uint32_t)drop.atUs);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(readUs, (uint32_t)drop.atUs);
+}
+
+void test_benchmark_per_sample() {
+    ImuTrace trace = parcelTripTrace(1000);
+    ShockDetector detector;
+    detector.configure(DEVICE, trace.rateHz, LSB_PER_G);
+
+    const int PASSES = 20;
+    uint32_t events = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (const ImuRawSample& s : trace.samples) {
+            events += detector.update(s.ax, s.ay, s.az);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32(PASSES, events);
+
+    double perSample = ns / (PASSES * trace.samples.size());
+    char report[128];
+    snprintf(report, sizeof(report), "ShockDetector: %.1f ns per sample, %.4f%% of a core at 1 kHz",
+             perSample, perSample * 1000 / 1e9 * 100);
+    TEST_MESSAGE(report);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_trip_drop_is_one_event);
+    RUN_TEST(test_fall_time_and_height_across_rates);
+    RUN_TEST(test_impact_axis_and_sign);
+    RUN_TEST(test_near_misses_are_not_drops);
+    RUN_TEST(test_drop_through_the_sensor_pipeline);
+    RUN_TEST(test_benchmark_per_sample);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+// Sleep scheduler: the wake/sleep decisions on a simulated clock
+// and MPU6050 motion interrupt - sleeps end on the SENSOR_READ_INTERVAL /
+// SENSOR_UPLOAD_INTERVAL deadlines, the IMU stops when still, motion wakes.
+#include <unity.h>
+
+#include <deque>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "config.h"
+#include "imumotion.h"
+#include "sleepscheduler.h"
+
+namespace {
+
+/**
+ * MPU6050 registers as far as the motion interrupt goes: INT_STATUS is
+ * latched by motion and cleared by reading it, the INT pin follows it.
+ */
+class FakeMotionBus {
+public:
+    typedef MPU6050Motion<FakeMotionBus> Motion;
+
+    uint8_t regs[128];
+
+    FakeMotionBus() { memset(regs, 0, sizeof(regs)); }
+
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        regs[reg] = value;
+        return true;
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* dst, size_t len) {
+        memcpy(dst, regs + reg, len);
+        if (reg == Motion::REG_INT_STATUS) {
+            regs[reg] = 0;
+        }
+        return true;
+    }
+
+    void motion() {
+        if (regs[Motion::REG_INT_ENABLE] & Motion::INT_MOTION) {
+            regs[Motion::REG_INT_STATUS] |= Motion::INT_MOTION;
+        }
+    }
+
+    bool intPin() const { return (regs[Motion::REG_INT_STATUS] & Motion::INT_MOTION) != 0; }
+};
+
+/**
+ * EspSleepPlatform on a simulated clock: motion is scheduled at given
+ * times, light sleep ends at its timeout or on the INT pin.
+ */
+class SimPlatform {
+public:
+    FakeMotionBus bus;
+    FakeMotionBus::Motion motion;
+    uint32_t now;
+    std::deque<uint32_t> motionAt;
+    bool allowed;
+    bool imuStill;
+    uint32_t imuStops;
+    uint32_t asleepMs;
+    std::vector<uint32_t> sleeps;
+
+    explicit SimPlatform(uint32_t start = 0)
+        : motion(bus), now(start), allowed(true), imuStill(false), imuStops(0), asleepMs(0) {}
+
+    uint32_t millis() { return now; }
+
+    bool motionPending() { return bus.intPin() && motion.clear(); }
+
+    bool sleepAllowed() { return allowed; }
+
+    void setImuStill(bool still) {
+        imuStill = still;
+        if (still) imuStops++;
+    }
+
+    void lightSleep(uint32_t ms) {
+        sleeps.push_back(ms);
+        uint32_t wake = now + ms;
+        if (!bus.intPin() && !motionAt.empty() && motionAt.front() - now < ms) {
+            wake = motionAt.front();  // GPIO wake on the INT pin
+        }
+        if (bus.intPin()) {
+            wake = now;  // Level triggered: a latched interrupt wakes at once
+        }
+        asleepMs += wake - now;
+        advance(wake - now);
+    }
+
+    // Time passing awake (a loop pass, a delay)
+    void advance(uint32_t ms) {
+        uint32_t to = now + ms;
+        while (!motionAt.empty() && motionAt.front() - now <= ms) {
+            motionAt.pop_front();
+            bus.motion();
+        }
+        now = to;
+    }
+};
+
+typedef SleepScheduler<SimPlatform> Scheduler;
+
+const Scheduler::Config CONFIG = { SENSOR_READ_INTERVAL, SENSOR_UPLOAD_INTERVAL, MOTION_IDLE_TIMEOUT,
+                                   LOW_POWER_MIN_SLEEP_MS, LOW_POWER_ACTIVE_MAX_SLEEP_MS };
+
+const uint32_t PASS_MS = 1;   // Work per sensor task pass
+const uint32_t DELAY_MS = 10; // delay() when it does not sleep
+
+/**
+ * The sensor task loop under LOW_POWER_MODE: a pass, read / record when
+ * their interval is up, then idle() or delay().
+ */
+struct SensorLoop {
+    SimPlatform& platform;
+    Scheduler& scheduler;
+    uint32_t lastRead, lastRecord;
+    uint32_t reads, records;
+    uint32_t maxLateMs;
+
+    SensorLoop(SimPlatform& platform, Scheduler& scheduler)
+        : platform(platform), scheduler(scheduler), lastRead(platform.now), lastRecord(platform.now),
+          reads(0), records(0), maxLateMs(0) {}
+
+    void pass() {
+        platform.advance(PASS_MS);
+        uint32_t now = platform.now;
+        if (now - lastRead >= CONFIG.readIntervalMs) {
+            late(now - lastRead - CONFIG.readIntervalMs);
+            lastRead = now;
+            reads++;
+        }
+        if (now - lastRecord >= CONFIG.uploadIntervalMs) {
+            late(now - lastRecord - CONFIG.uploadIntervalMs);
+            lastRecord = now;
+            records++;
+        }
+        if (scheduler.idle(lastRead, lastRecord) == 0) {
+            platform.advance(DELAY_MS);
+        }
+    }
+
+    void runFor(uint32_t ms) {
+        for (uint32_t end = platform.now + ms; (int32_t)(end - platform.now) > 0;) {
+            pass();
+        }
+    }
+
+    void late(uint32_t ms) {
+        if (ms > maxLateMs) maxLateMs = ms;
+    }
+};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_next_deadline_is_the_earliest_timer() {
+    SimPlatform platform;
+    Scheduler scheduler(platform, Scheduler::Config{ 2000, 5000, MOTION_IDLE_TIMEOUT, 5, 50 });
+
+    TEST_ASSERT_EQUAL_UINT32(1500, scheduler.timeToNextDeadline(10500, 10000, 10000));
+    TEST_ASSERT_EQUAL_UINT32(500, scheduler.timeToNextDeadline(10500, 10000, 6000));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.timeToNextDeadline(13000, 10000, 10000));  // Overdue
+
+    // Across the millis() wrap
+    uint32_t last = 0xFFFFFF00u;
+    TEST_ASSERT_EQUAL_UINT32(2000 - 0x200, scheduler.timeToNextDeadline(last + 0x200, last, last));
+}
+
+void test_motion_interrupt_is_programmed_and_latched() {
+    SimPlatform platform;
+    TEST_ASSERT_TRUE(platform.motion.begin(MOTION_THRESHOLD_MG, MOTION_DURATION_MS));
+
+    typedef FakeMotionBus::Motion Motion;
+    TEST_ASSERT_EQUAL_HEX8(MOTION_THRESHOLD_MG / 2, platform.bus.regs[Motion::REG_MOT_THR]);  // 2 mg per LSB
+    TEST_ASSERT_EQUAL_HEX8(MOTION_DURATION_MS, platform.bus.regs[Motion::REG_MOT_DUR]);
+    TEST_ASSERT_EQUAL_HEX8(Motion::INT_PIN_LATCH, platform.bus.regs[Motion::REG_INT_PIN_CFG]);
+    TEST_ASSERT_EQUAL_HEX8(Motion::INT_MOTION, platform.bus.regs[Motion::REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(Motion::ACCEL_HPF_0_63HZ, platform.bus.regs[Motion::REG_ACCEL_CONFIG] & Motion::ACCEL_HPF_MASK);
+
+    // Latched until read, reported once
+    TEST_ASSERT_FALSE(platform.motionPending());
+    platform.bus.motion();
+    TEST_ASSERT_TRUE(platform.bus.intPin());
+    TEST_ASSERT_TRUE(platform.motionPending());
+    TEST_ASSERT_FALSE(platform.motionPending());
+}
+
+void test_still_parcel_sleeps_to_each_deadline() {
+    SimPlatform platform(1000);
+    platform.motion.begin(MOTION_THRESHOLD_MG, MOTION_DURATION_MS);
+    Scheduler scheduler(platform, CONFIG);
+    SensorLoop loop(platform, scheduler);
+
+    // An hour on a shelf
+    const uint32_t HOUR = 3600000UL;
+    loop.runFor(HOUR);
+
+    // The IMU stopped once, after the idle timeout
+    TEST_ASSERT_TRUE(scheduler.isStill());
+    TEST_ASSERT_TRUE(platform.imuStill);
+    TEST_ASSERT_EQUAL_UINT32(1, platform.imuStops);
+
+    // Every read and record on time, none early
+    TEST_ASSERT_UINT32_WITHIN(1, HOUR / SENSOR_READ_INTERVAL, loop.reads);
+    TEST_ASSERT_UINT32_WITHIN(1, HOUR / SENSOR_UPLOAD_INTERVAL, loop.records);
+    TEST_ASSERT_LESS_OR_EQUAL(PASS_MS, loop.maxLateMs);
+
+    // Asleep nearly all the time, about one sleep per deadline once still
+    TEST_ASSERT_GREATER_THAN(0.99 * HOUR, platform.asleepMs);
+    uint32_t stillSleeps = 0;
+    for (uint32_t ms : platform.sleeps) {
+        if (ms > LOW_POWER_ACTIVE_MAX_SLEEP_MS) stillSleeps++;
+    }
+    TEST_ASSERT_UINT32_WITHIN(2, (HOUR - MOTION_IDLE_TIMEOUT) / SENSOR_READ_INTERVAL, stillSleeps);
+
+    const Scheduler::Stats& stats = scheduler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(platform.sleeps.size(), stats.sleeps);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.motionWakes);
+
+    char report[128];
+    snprintf(report, sizeof(report), "Still hour: %u sleeps, %.2f%% asleep, reads at most %u ms late",
+             (unsigned)stats.sleeps, 100.0 * platform.asleepMs / HOUR, (unsigned)loop.maxLateMs);
+    TEST_MESSAGE(report);
+}
+
+void test_moving_parcel_caps_sleep_for_the_fifo() {
+    SimPlatform platform;
+    platform.motion.begin(MOTION_THRESHOLD_MG, MOTION_DURATION_MS);
+    Scheduler scheduler(platform, CONFIG);
+    SensorLoop loop(platform, scheduler);
+
+    // On a conveyor: motion every 200 ms for ten minutes
+    for (uint32_t t = 200; t < 600000UL; t += 200) {
+        platform.motionAt.push_back(t);
+    }
+    loop.runFor(600000UL);
+
+    TEST_ASSERT_FALSE(scheduler.isStill());
+    TEST_ASSERT_EQUAL_UINT32(0, platform.imuStops);
+    for (uint32_t ms : platform.sleeps) {
+        TEST_ASSERT_LESS_OR_EQUAL(LOW_POWER_ACTIVE_MAX_SLEEP_MS, ms);
+        TEST_ASSERT_GREATER_OR_EQUAL(LOW_POWER_MIN_SLEEP_MS, ms);
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 600000UL / SENSOR_READ_INTERVAL, loop.reads);
+    TEST_ASSERT_LESS_OR_EQUAL(LOW_POWER_MIN_SLEEP_MS + DELAY_MS, loop.maxLateMs);
+}
+
+void test_motion_wakes_a_still_parcel() {
+    SimPlatform platform;
+    platform.motion.begin(MOTION_THRESHOLD_MG, MOTION_DURATION_MS);
+    Scheduler scheduler(platform, CONFIG);
+    SensorLoop loop(platform, scheduler);
+
+    loop.runFor(MOTION_IDLE_TIMEOUT + 10000UL);
+    TEST_ASSERT_TRUE(scheduler.isStill());
+
+    // Picked up half way through a sleep
+    uint32_t pickedUp = platform.now + SENSOR_READ_INTERVAL / 2;
+    platform.motionAt.push_back(pickedUp);
+    while (platform.now < pickedUp) {
+        loop.pass();
+    }
+    TEST_ASSERT_EQUAL_UINT32(pickedUp, platform.now);  // Woke on the pin, not the timer
+
+    loop.pass();
+    TEST_ASSERT_FALSE(scheduler.isStill());
+    TEST_ASSERT_FALSE(platform.imuStill);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats().motionWakes);
+    TEST_ASSERT_LESS_OR_EQUAL(LOW_POWER_ACTIVE_MAX_SLEEP_MS, platform.sleeps.back());
+
+    // Put down again: still once the idle timeout has passed without motion
+    loop.runFor(MOTION_IDLE_TIMEOUT - 1000UL);
+    TEST_ASSERT_FALSE(scheduler.isStill());
+    loop.runFor(2000UL);
+    TEST_ASSERT_TRUE(scheduler.isStill());
+    TEST_ASSERT_EQUAL_UINT32(2, platform.imuStops);
+}
+
+void test_no_sleep_when_vetoed_or_too_short() {
+    SimPlatform platform;
+    Scheduler scheduler(platform, CONFIG);
+
+    // A client on the direct AP
+    platform.allowed = false;
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.idle(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, platform.sleeps.size());
+
+    // A deadline closer than the shortest useful sleep
+    platform.allowed = true;
+    platform.now = SENSOR_READ_INTERVAL - (LOW_POWER_MIN_SLEEP_MS - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.idle(0, 0));
+    platform.now = SENSOR_READ_INTERVAL - LOW_POWER_MIN_SLEEP_MS;
+    TEST_ASSERT_EQUAL_UINT32(LOW_POWER_MIN_SLEEP_MS, scheduler.idle(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats().sleeps);
+}
+
+void test_motion_from_a_drop_restarts_the_imu() {
+    SimPlatform platform;
+    Scheduler scheduler(platform, CONFIG);
+    platform.now = MOTION_IDLE_TIMEOUT;
+    scheduler.idle(platform.now, platform.now);
+    TEST_ASSERT_TRUE(scheduler.isStill());
+
+    // Without the interrupt, not counted as a motion wake
+    scheduler.notifyMotion();
+    TEST_ASSERT_FALSE(scheduler.isStill());
+    TEST_ASSERT_FALSE(platform.imuStill);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getStats().motionWakes);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_next_deadline_is_the_earliest_timer);
+    RUN_TEST(test_motion_interrupt_is_programmed_and_latched);
+    RUN_TEST(test_still_parcel_sleeps_to_each_deadline);
+    RUN_TEST(test_moving_parcel_caps_sleep_for_the_fifo);
+    RUN_TEST(test_motion_wakes_a_still_parcel);
+    RUN_TEST(test_no_sleep_when_vetoed_or_too_short);
+    RUN_TEST(test_motion_from_a_drop_restarts_the_imu);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Vibration spectrum: RealFft against a direct DFT, features of
+// synthetic vibration merged across intervals, and cycles / ns per window of the device FFT size.
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "config.h"
+#include "vibrationspectrum.h"
+
+namespace {
+
+const uint16_t RATE_HZ = 500;
+const float TWO_PI = 6.28318530718f;
+
+// |X[k]|² by the definition, in double
+std::vector<double> directPower(const std::vector<float>& x) {
+    size_t n = x.size();
+    std::vector<double> power(n / 2 + 1);
+    for (size_t k = 0; k <= n / 2; k++) {
+        double re = 0, im = 0;
+        for (size_t i = 0; i < n; i++) {
+            re += x[i] * cos(2 * M_PI * k * i / n);
+            im -= x[i] * sin(2 * M_PI * k * i / n);
+        }
+        power[k] = re * re + im * im;
+    }
+    return power;
+}
+
+template <size_t N>
+void checkAgainstDft() {
+    static RealFft<N> fft;
+    std::vector<float> x(N), data(N);
+    for (size_t i = 0; i < N; i++) {
+        x[i] = sinf(i * 0.3f) + 0.5f * cosf(i * 1.7f) + 0.1f * i / N + (i % 7 == 0 ? 0.25f : 0);
+    }
+    data = x;
+    float power[RealFft<N>::BINS];
+    fft.powerSpectrum(data.data(), power);
+
+    std::vector<double> expected = directPower(x);
+    double peak = 0;
+    for (double p : expected) peak = p > peak ? p : peak;
+    for (size_t k = 0; k < RealFft<N>::BINS; k++) {
+        TEST_ASSERT_DOUBLE_WITHIN(peak * 1e-5, expected[k], power[k]);
+    }
+}
+
+// Windows of raw |a| counts: 1 g plus the given tones (amplitude, Hz)
+template <size_t N>
+const VibrationFeatures& analyse(VibrationSpectrum<N>& spectrum, const float* amplitudes, const float* hz,
+                                 size_t tones, size_t windows) {
+    static const float edges[] = VIBRATION_BAND_EDGES_HZ;
+    spectrum.configure(RATE_HZ, edges, sizeof(edges) / sizeof(edges[0]));
+    for (size_t i = 0; i < N * windows; i++) {
+        float value = 4096;
+        for (size_t t = 0; t < tones; t++) {
+            value += amplitudes[t] * sinf(TWO_PI * hz[t] * i / RATE_HZ);
+        }
+        if (spectrum.add(value)) {
+            spectrum.compute();
+        }
+    }
+    return spectrum.getFeatures();
+}
+
+uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_fft_matches_direct_dft() {
+    checkAgainstDft<8>();
+    checkAgainstDft<64>();
+    checkAgainstDft<256>();
+    checkAgainstDft<512>();
+}
+
+void test_single_tone_features() {
+    static VibrationSpectrum<VIBRATION_FFT_SIZE> spectrum;
+    const float amplitude[] = { 200 }, hz[] = { 40 };
+    const VibrationFeatures& f = analyse(spectrum, amplitude, hz, 1, 4);
+
+    const float binHz = (float)RATE_HZ / VIBRATION_FFT_SIZE;
+    TEST_ASSERT_EQUAL_UINT32(4, f.windows);
+    TEST_ASSERT_FLOAT_WITHIN(binHz, 40.0f, f.dominantHz);
+    TEST_ASSERT_FLOAT_WITHIN(200 / sqrtf(2) * 0.05f, 200 / sqrtf(2), f.rms);  // Gravity removed
+
+    // Nearly all of it in the 30-80 Hz band
+    float total = 0;
+    for (uint8_t b = 0; b < f.bandCount; b++) total += f.bandEnergy[b];
+    TEST_ASSERT_EQUAL_UINT8(4, f.bandCount);
+    TEST_ASSERT_GREATER_THAN(0.95f * total, f.bandEnergy[2]);
+}
+
+void test_tones_land_in_their_bands() {
+    static VibrationSpectrum<VIBRATION_FFT_SIZE> spectrum;
+    const float amplitudes[] = { 300, 100 }, hz[] = { 4, 120 };  // Road sway and a motor
+    const VibrationFeatures& f = analyse(spectrum, amplitudes, hz, 2, 8);
+
+    const float binHz = (float)RATE_HZ / VIBRATION_FFT_SIZE;
+    TEST_ASSERT_FLOAT_WITHIN(binHz, 4.0f, f.dominantHz);
+
+    // Mean squares A²/2, within the Hann leakage
+    TEST_ASSERT_FLOAT_WITHIN(300 * 300 / 2 * 0.1f, 300 * 300 / 2, f.bandEnergy[0]);
+    TEST_ASSERT_FLOAT_WITHIN(100 * 100 / 2 * 0.1f, 100 * 100 / 2, f.bandEnergy[3]);
+    TEST_ASSERT_LESS_THAN(0.02f * f.bandEnergy[3], f.bandEnergy[2]);
+}
+
+void test_still_parcel_has_no_vibration() {
+    static VibrationSpectrum<VIBRATION_FFT_SIZE> spectrum;
+    const float none[] = { 0 }, hz[] = { 0 };
+    const VibrationFeatures& f = analyse(spectrum, none, hz, 1, 2);
+    TEST_ASSERT_EQUAL_UINT32(2, f.windows);
+    TEST_ASSERT_LESS_THAN(0.01f, f.rms);
+}
+
+void test_merged_features_match_one_average() {
+    // Two upload intervals of different vibration, as one Welch average and merged
+    static VibrationSpectrum<VIBRATION_FFT_SIZE> first, second, whole;
+    static const float edges[] = VIBRATION_BAND_EDGES_HZ;
+    first.configure(RATE_HZ, edges, sizeof(edges) / sizeof(edges[0]));
+    second.configure(RATE_HZ, edges, sizeof(edges) / sizeof(edges[0]));
+    whole.configure(RATE_HZ, edges, sizeof(edges) / sizeof(edges[0]));
+    for (size_t i = 0; i < VIBRATION_FFT_SIZE * 6; i++) {
+        bool late = i >= VIBRATION_FFT_SIZE * 2;
+        float value = 4096 + (late ? 80 * sinf(TWO_PI * 120 * i / RATE_HZ) : 250 * sinf(TWO_PI * 40 * i / RATE_HZ));
+        VibrationSpectrum<VIBRATION_FFT_SIZE>& part = late ? second : first;
+        if (part.add(value)) part.compute();
+        if (whole.add(value)) whole.compute();
+    }
+
+    VibrationFeatures merged = {};
+    merged.merge(first.getFeatures());
+    merged.merge(second.getFeatures());
+    const VibrationFeatures& expected = whole.getFeatures();
+    TEST_ASSERT_EQUAL_UINT32(6, merged.windows);
+    TEST_ASSERT_EQUAL_UINT8(expected.bandCount, merged.bandCount);
+    TEST_ASSERT_FLOAT_WITHIN(expected.rms * 1e-4f, expected.rms, merged.rms);
+    TEST_ASSERT_EQUAL_FLOAT(expected.dominantHz, merged.dominantHz);
+    for (uint8_t b = 0; b < merged.bandCount; b++) {
+        TEST_ASSERT_FLOAT_WITHIN(expected.rms * expected.rms * 1e-4f, expected.bandEnergy[b], merged.bandEnergy[b]);
+    }
+}
+
+template <size_t N>
+void benchmarkWindow(char* line, size_t capacity) {
+    static VibrationSpectrum<N> spectrum;
+    static const float edges[] = VIBRATION_BAND_EDGES_HZ;
+    spectrum.configure(RATE_HZ, edges, sizeof(edges) / sizeof(edges[0]));
+
+    const int WINDOWS = 2000;
+    uint64_t cycles = 0;
+    double ns = 0;
+    for (int w = 0; w < WINDOWS; w++) {
+        for (size_t i = 0; i < N; i++) {
+            spectrum.add(4096 + 200 * sinf(TWO_PI * 40 * i / RATE_HZ) + (float)(w % 13));
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t startCycles = cycleCount();
+        spectrum.compute();  // What SensorPipeline times as spectrumCycles
+        cycles += cycleCount() - startCycles;
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    TEST_ASSERT_EQUAL_UINT32(WINDOWS, spectrum.getFeatures().windows);
+
+    snprintf(line, capacity, "N=%u: %.0f host cycles, %.1f us per window (%.1f ns per sample)",
+             (unsigned)N, (double)cycles / WINDOWS, ns / WINDOWS / 1000, ns / WINDOWS / N);
+}
+
+void test_benchmark_cycles_per_window() {
+    char report[160];
+    benchmarkWindow<256>(report, sizeof(report));
+    TEST_MESSAGE(report);
+    benchmarkWindow<512>(report, sizeof(report));
+    TEST_MESSAGE(report);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fft_matches_direct_dft);
+    RUN_TEST(test_single_tone_features);
+    RUN_TEST(test_tones_land_in_their_bands);
+    RUN_TEST(test_still_parcel_has_no_vibration);
+    RUN_TEST(test_merged_features_match_one_average);
+    RUN_TEST(test_benchmark_cycles_per_window);
+    return UNITY_END();
+}
\ No newline at end of file
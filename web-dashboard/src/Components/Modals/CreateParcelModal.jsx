@@ -107,26 +107,34 @@ export default function CreateParcelModal({ availableDevices, onClose, warehouse
       await set(ref(database, `parcels/${parcelId}`), parcelData);
 
       // ✅ FIX 1: Update device thresholds with parcel custom thresholds
+      const deviceThresholds = {
+        temperature: {
+          min: parseFloat(formData.tempMin) || 5,
+          max: parseFloat(formData.tempMax) || 40
+        },
+        humidity: {
+          min: parseFloat(formData.humidityMin) || 20,
+          max: parseFloat(formData.humidityMax) || 80
+        },
+        vibration: parseFloat(formData.vibrationThreshold) || 15
+      };
       await update(ref(database, `SmartParcels/${formData.deviceId}/info`), {
         status: 'assigned',
         assignedParcelId: parcelId,
         lastSeen: now.toString(),
-        thresholds: {
-          temperature: {
-            min: parseFloat(formData.tempMin) || 5,
-            max: parseFloat(formData.tempMax) || 40
-          },
-          humidity: {
-            min: parseFloat(formData.humidityMin) || 20,
-            max: parseFloat(formData.humidityMax) || 80
-          },
-          vibration: parseFloat(formData.vibrationThreshold) || 15
-        }
+        thresholds: deviceThresholds
+      });
+
+      // The device follows config/ only (its own info/ writes stay off the stream)
+      await set(ref(database, `SmartParcels/${formData.deviceId}/config`), {
+        assignedParcelId: parcelId,
+        thresholds: deviceThresholds
       });
 
       // ✅ FIX 2: Clear old alerts and history for this device
       await set(ref(database, `SmartParcels/${formData.deviceId}/alerts`), {});
       await set(ref(database, `SmartParcels/${formData.deviceId}/history`), {});
+      await set(ref(database, `SmartParcels/${formData.deviceId}/historyBlocks`), {});
       
       // Re-initialize current data
       await set(ref(database, `SmartParcels/${formData.deviceId}/current`), {
@@ -2,6 +2,7 @@ import { useState, useEffect } from 'react';
 import { X, Thermometer, Droplets, Activity, AlertTriangle, TrendingUp, Package, MapPin, User, Trash2 } from 'lucide-react';
 import { ref, onValue, remove, update, set } from 'firebase/database';
 import { database } from '../../utils/firebase';
+import { decodeHistoryBlocks } from '../../utils/historyBlocks';
 import { LineChart, Line, XAxis, YAxis, CartesianGrid, Tooltip, ResponsiveContainer, Legend } from 'recharts';
 import { useToast } from '../../hooks/useToast';
 
@@ -25,6 +26,8 @@ export default function ParcelDetailModal({ parcel, onClose, role }) {
 
     const currentRef = ref(database, `SmartParcels/${parcel.info.deviceId}/current`);
     const historyRef = ref(database, `SmartParcels/${parcel.info.deviceId}/history`);
+    const historyBlocksRef = ref(database, `SmartParcels/${parcel.info.deviceId}/historyBlocks`);
+    const historySchemaRef = ref(database, `SmartParcels/${parcel.info.deviceId}/historySchema`);
     const alertsRef = ref(database, `SmartParcels/${parcel.info.deviceId}/alerts`);
     
     // Subscribe to current data
@@ -57,9 +60,17 @@ export default function ParcelDetailModal({ parcel, onClose, role }) {
       }
     });
 
-    // Subscribe to history data
-    const historyUnsub = onValue(historyRef, (snapshot) => {
-      const data = snapshot.val();
+    // Subscribe to history data: per-sample entries (older firmware) and
+    // compressed blocks, decoded with the device's schema
+    let historyEntries = null;
+    let historyBlocks = null;
+    let historySchema = null;
+
+    const updateChart = () => {
+      const decoded = decodeHistoryBlocks(historyBlocks, historySchema);
+      const data = Object.keys(decoded).length > 0 || historyEntries
+        ? { ...(historyEntries || {}), ...decoded }
+        : null;
       
       if (data) {
         console.log('[MODAL] History data received:', Object.keys(data).length, 'entries');
@@ -96,11 +107,26 @@ export default function ParcelDetailModal({ parcel, onClose, role }) {
         console.log('[MODAL] No history data available');
       }
       setLoading(false);
+    };
+
+    const historyUnsub = onValue(historyRef, (snapshot) => {
+      historyEntries = snapshot.val();
+      updateChart();
+    });
+    const historyBlocksUnsub = onValue(historyBlocksRef, (snapshot) => {
+      historyBlocks = snapshot.val();
+      updateChart();
+    });
+    const historySchemaUnsub = onValue(historySchemaRef, (snapshot) => {
+      historySchema = snapshot.val();
+      updateChart();
     });
 
     return () => {
       currentUnsub();
       historyUnsub();
+      historyBlocksUnsub();
+      historySchemaUnsub();
       alertsUnsub();
     };
   }, [parcel?.info?.deviceId]);
@@ -123,6 +149,9 @@ export default function ParcelDetailModal({ parcel, onClose, role }) {
           status: 'available',
           assignedParcelId: ''
         });
+        await update(ref(database, `SmartParcels/${parcel.info.deviceId}/config`), {
+          assignedParcelId: ''
+        });
       }
 
       await remove(ref(database, `parcels/${parcel.id}`));
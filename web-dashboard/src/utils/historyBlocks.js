@@ -0,0 +1,129 @@
+// Decoder for the compressed history blocks devices upload to historyBlocks/
+// (layout: firmware/src/components/historycodec.h). Column names come from
+// the device's historySchema node.
+
+class BlockReader {
+  constructor(bytes) {
+    this.bytes = bytes;
+    this.offset = 0;
+  }
+
+  byte() {
+    if (this.offset >= this.bytes.length) throw new Error('Truncated history block');
+    return this.bytes[this.offset++];
+  }
+
+  skip(count) {
+    if (this.offset + count > this.bytes.length) throw new Error('Truncated history block');
+    const start = this.offset;
+    this.offset += count;
+    return this.bytes.subarray(start, this.offset);
+  }
+
+  // Numbers stay exact up to 2^53, plenty for epoch milliseconds
+  varint() {
+    let value = 0;
+    let scale = 1;
+    for (let i = 0; i < 10; i++) {
+      const b = this.byte();
+      value += (b & 0x7f) * scale;
+      if (!(b & 0x80)) return value;
+      scale *= 128;
+    }
+    throw new Error('Bad varint in history block');
+  }
+
+  zigzag() {
+    const raw = this.varint();
+    return raw % 2 ? -(raw + 1) / 2 : raw / 2;
+  }
+}
+
+const textDecoder = new TextDecoder();
+
+const base64ToBytes = (text) => {
+  const binary = atob(text);
+  const bytes = new Uint8Array(binary.length);
+  for (let i = 0; i < binary.length; i++) bytes[i] = binary.charCodeAt(i);
+  return bytes;
+};
+
+/**
+ * Expand one historyBlocks entry into samples shaped like history/ entries
+ * ({ timestamp, temperature, ..., 'stats.accelX.min': ..., orientation, ... }).
+ * Values the device did not have are left out.
+ */
+export function decodeHistoryBlock(block, schema) {
+  if (!block?.data || !schema || block.schema !== schema.schema) return [];
+
+  const r = new BlockReader(base64ToBytes(block.data));
+  if (r.byte() !== 1) return [];
+
+  r.varint();  // schema id, checked above
+  const count = r.varint();
+  const numericCount = r.varint();
+  const decimals = r.skip(numericCount);
+  const stringCount = r.varint();
+
+  const samples = [];
+  let timestamp = 0;
+  let delta = 0;
+  for (let i = 0; i < count; i++) {
+    if (i === 0) {
+      timestamp = r.varint();
+    } else {
+      delta += r.zigzag();
+      timestamp += delta;
+    }
+    // Blocks built before the device's first time sync carry uptime ms
+    samples.push(block.timeSynced === false
+      ? { timestamp: String(timestamp), timeSynced: false }
+      : { timestamp: String(timestamp) });
+  }
+
+  for (let c = 0; c < numericCount; c++) {
+    const name = schema.numeric?.[c]?.name ?? `column${c}`;
+    const bitmap = r.byte() !== 0 ? r.skip(Math.ceil(count / 8)) : null;
+    const scale = 10 ** decimals[c];
+    let value = 0;
+    for (let i = 0; i < count; i++) {
+      if (bitmap && !((bitmap[i >> 3] >> (i & 7)) & 1)) continue;
+      value += r.zigzag();
+      samples[i][name] = value / scale;
+    }
+  }
+
+  for (let s = 0; s < stringCount; s++) {
+    const name = schema.strings?.[s] ?? `string${s}`;
+    const dictionary = [];
+    const entries = r.varint();
+    for (let d = 0; d < entries; d++) {
+      dictionary.push(textDecoder.decode(r.skip(r.varint())));
+    }
+    for (let i = 0; i < count;) {
+      const text = dictionary[r.varint()];
+      const run = r.varint();
+      for (let k = 0; k < run && i < count; k++, i++) samples[i][name] = text;
+    }
+  }
+
+  return samples;
+}
+
+/**
+ * All samples of a historyBlocks snapshot, keyed like history/ entries.
+ * Blocks that fail to decode are skipped.
+ */
+export function decodeHistoryBlocks(blocks, schema) {
+  const samples = {};
+  Object.entries(blocks || {}).forEach(([key, block]) => {
+    try {
+      decodeHistoryBlock(block, schema).forEach((sample, i) => {
+        samples[`${key}-${i}`] = sample;
+      });
+    } catch (error) {
+      console.warn('[HISTORY] Skipping unreadable block', key, error.message);
+    }
+  });
+  return samples;
+}
\ No newline at end of file